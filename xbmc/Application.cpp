@@ -1871,7 +1871,7 @@ void CApplication::Render()
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.ResetFrameCache();
 
   if (hasRendered)
   {
@@ -4217,7 +4217,7 @@ void CApplication::ProcessSlow()
 
   g_largeTextureManager.CleanupUnusedImages();
 
-  g_TextureManager.FreeUnusedTextures(5000);
+  g_TextureManager.FreeUnusedTextures();
 
 #ifdef HAS_DVD_DRIVE
   // checks whats in the DVD drive and tries to autostart the content (xbox games, dvd, cdda, avi files...)
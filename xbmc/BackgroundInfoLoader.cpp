@@ -19,11 +19,16 @@
  */
 
 #include "BackgroundInfoLoader.h"
+
+#include <algorithm>
+
 #include "FileItem.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "URL.h"
 
+#define PREFETCH_PAGE_SIZE 50
+
 CBackgroundInfoLoader::CBackgroundInfoLoader() : m_thread (NULL)
 {
   m_bStop = true;
@@ -55,6 +60,13 @@ void CBackgroundInfoLoader::Run()
         if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
           break;
 
+        // the first page holds the items that are visible at first
+        if ((iter - m_vecItems.begin()) % PREFETCH_PAGE_SIZE == 0)
+        {
+          std::vector<CFileItemPtr>::const_iterator end = iter + std::min<ptrdiff_t>(PREFETCH_PAGE_SIZE, m_vecItems.end() - iter);
+          PrefetchItems(std::vector<CFileItemPtr>(iter, end));
+        }
+
         try
         {
           if (LoadItemCached(pItem.get()) && m_pObserver)
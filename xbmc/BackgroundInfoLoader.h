@@ -59,6 +59,13 @@ protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
+  /*! \brief Called before the cached info of a page of items is loaded.
+   Allows loaders to fetch what they need for all items of the page at once,
+   rather than one item at a time.
+   \param items the items of the page.
+   */
+  virtual void PrefetchItems(const std::vector<CFileItemPtr>& items) {};
+
   CFileItemList *m_pVecItems;
   std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
@@ -58,6 +58,7 @@
 #include "settings/GameSettings.h"
 #include "settings/MediaSettings.h"
 #include "settings/Settings.h"
+#include "settings/lib/SettingsManager.h"
 #include "settings/SkinSettings.h"
 #include "guilib/LocalizeStrings.h"
 #include "guilib/StereoscopicsManager.h"
@@ -166,7 +167,7 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowTime = false;
   m_playerShowInfo = false;
   m_fps = 0.0f;
-  m_refreshCounter = 0;
+  m_lastEvaluations = 0;
   ResetLibraryBools();
 }
 
@@ -5484,6 +5485,8 @@ int CGUIInfoManager::TranslateSingleString(const std::string &strCondition, bool
         {
           std::string paramCopy = param;
           StringUtils::ToLower(paramCopy);
+          // watch the setting so conditions using it are refreshed when it changes
+          CServiceBroker::GetSettings().GetSettingsManager()->RegisterCallback(this, { paramCopy });
           return AddMultiInfo(GUIInfo(SYSTEM_GET_BOOL, ConditionalStringParameter(paramCopy, true)));
         }
         for (size_t i = 0; i < sizeof(system_param) / sizeof(infomap); i++)
@@ -6892,9 +6895,9 @@ INFO::InfoPtr CGUIInfoManager::Register(const std::string &expression, int conte
   std::pair<INFOBOOLTYPE::iterator, bool> res;
 
   if (condition.find_first_of("|+[]!") != condition.npos)
-    res = m_bools.insert(std::make_shared<InfoExpression>(condition, context, m_refreshCounter));
+    res = m_bools.insert(std::make_shared<InfoExpression>(condition, context, m_refreshCounters));
   else
-    res = m_bools.insert(std::make_shared<InfoSingle>(condition, context, m_refreshCounter));
+    res = m_bools.insert(std::make_shared<InfoSingle>(condition, context, m_refreshCounters));
 
   if (res.second)
     res.first->get()->Initialize();
@@ -9325,6 +9328,7 @@ void CGUIInfoManager::Clear()
 {
   CSingleLock lock(m_critInfo);
   m_skinVariableStrings.clear();
+  // the setting callbacks are kept, info bools outlive the skin and aren't initialized again
 
   /*
     Erase any info bools that are unused. We do this repeatedly as each run
@@ -10684,7 +10688,61 @@ void CGUIInfoManager::ResetCache()
   m_containerMoves.clear();
   // mark our infobools as dirty
   CSingleLock lock(m_critInfo);
-  ++m_refreshCounter;
+  for (auto &counter : m_refreshCounters.counters)
+    ++counter;
+}
+
+void CGUIInfoManager::ResetFrameCache()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+  // mark our per frame infobools as dirty
+  CSingleLock lock(m_critInfo);
+  ++m_refreshCounters.counters[INFO_DEPENDENCY_FRAME];
+  m_lastEvaluations = m_refreshCounters.evaluations;
+  m_refreshCounters.evaluations = 0;
+}
+
+void CGUIInfoManager::PublishChange(InfoDependency source)
+{
+  CSingleLock lock(m_critInfo);
+  ++m_refreshCounters.counters[source];
+}
+
+unsigned int CGUIInfoManager::GetBoolDependencies(int condition) const
+{
+  condition = abs(condition);
+
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+      (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_WIN10))
+    return 0;
+
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_COMPILATIONS)
+    return 1 << INFO_DEPENDENCY_LIBRARY;
+
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    switch (abs(m_multiInfo[condition - MULTI_INFO_START].m_info))
+    {
+      case SKIN_BOOL:
+      case SKIN_STRING:
+        return 1 << INFO_DEPENDENCY_SKIN;
+      case SYSTEM_GET_BOOL:
+        return 1 << INFO_DEPENDENCY_SETTINGS;
+      case SYSTEM_HAS_CORE_ID:
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  // anything else may change at any time
+  return 1 << INFO_DEPENDENCY_FRAME;
+}
+
+void CGUIInfoManager::OnSettingChanged(std::shared_ptr<const CSetting> setting)
+{
+  PublishChange(INFO_DEPENDENCY_SETTINGS);
 }
 
 std::string CGUIInfoManager::GetPictureLabel(int info)
@@ -10854,6 +10912,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  PublishChange(INFO_DEPENDENCY_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -10866,6 +10925,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasSingles = -1;
   m_libraryHasCompilations = -1;
   m_libraryRoleCounts.clear();
+  PublishChange(INFO_DEPENDENCY_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
@@ -33,6 +33,7 @@
 #include "inttypes.h"
 #include "XBDateTime.h"
 #include "utils/Observer.h"
+#include "settings/lib/ISettingCallback.h"
 #include "utils/Temperature.h"
 #include "interfaces/info/InfoBool.h"
 #include "interfaces/info/SkinVariable.h"
@@ -95,7 +96,7 @@ class CSetCurrentItemJob;
  \brief
  */
 class CGUIInfoManager : public IMsgTargetCallback, public Observable,
-                        public KODI::MESSAGING::IMessageTarget
+                        public KODI::MESSAGING::IMessageTarget, public ISettingCallback
 {
 friend CSetCurrentItemJob;
 
@@ -204,7 +205,33 @@ public:
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
 
+  /*! \brief Mark all info bools as dirty, whatever they depend on
+   */
   void ResetCache();
+
+  /*! \brief Mark the info bools which depend on per frame state as dirty
+   Called once per frame, info bools which only depend on sources that publish
+   their changes keep their cached value.
+   */
+  void ResetFrameCache();
+
+  /*! \brief Mark the info bools which depend on the given source as dirty
+   \param source the source which has changed
+   */
+  void PublishChange(INFO::InfoDependency source);
+
+  /*! \brief Get the sources a condition depends on
+   \param condition the condition as returned by TranslateSingleString
+   \return bitmask of (1 << INFO::InfoDependency) values
+   */
+  unsigned int GetBoolDependencies(int condition) const;
+
+  /*! \brief Get the number of info bool updates during the last frame
+   */
+  unsigned int GetEvaluations() const { return m_lastEvaluations; }
+
+  void OnSettingChanged(std::shared_ptr<const CSetting> setting) override;
+
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   std::string GetItemLabel(const CFileItem *item, int info, std::string *fallback = NULL);
   std::string GetItemImage(const CFileItem *item, int info, std::string *fallback = NULL);
@@ -330,7 +357,8 @@ protected:
 
   typedef std::set<INFO::InfoPtr, bool(*)(const INFO::InfoPtr&, const INFO::InfoPtr&)> INFOBOOLTYPE;
   INFOBOOLTYPE m_bools;
-  unsigned int m_refreshCounter;
+  INFO::InfoRefreshCounters m_refreshCounters;
+  unsigned int m_lastEvaluations;
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
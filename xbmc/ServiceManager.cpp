@@ -65,6 +65,9 @@ CServiceManager::~CServiceManager()
 
 bool CServiceManager::InitForTesting()
 {
+  m_announcementManager.reset(new ANNOUNCEMENT::CAnnouncementManager());
+  m_announcementManager->Start();
+
   m_settings.reset(new CSettings());
   m_network.reset(SetupNetwork());
 
@@ -103,6 +106,7 @@ void CServiceManager::DeinitTesting()
   m_profileManager.reset();
   m_network.reset();
   m_settings.reset();
+  m_announcementManager.reset();
 }
 
 bool CServiceManager::InitStageOne()
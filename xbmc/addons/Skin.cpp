@@ -35,6 +35,7 @@
 #include "settings/Settings.h"
 #include "settings/lib/Setting.h"
 #include "threads/Timer.h"
+#include "utils/Crc32.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -310,6 +311,18 @@ void CSkinInfo::LoadIncludes()
   CLog::Log(LOGINFO, "Loading skin includes from %s", includesPath.c_str());
   m_includes.Clear();
   m_includes.Load(includesPath);
+
+  // stamp the skin's XML files so cached windows are rebuilt once any of them changes
+  CFileItemList items;
+  CDirectory::GetDirectory(URIUtils::GetDirectory(includesPath), items, ".xml", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE);
+  Crc32 crc;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    std::string entry = StringUtils::Format("%s:%" PRId64 ":%s", items[i]->GetLabel().c_str(), items[i]->m_dwSize,
+                                            items[i]->m_dateTime.GetAsDBDateTime().c_str());
+    crc.Compute(entry.c_str(), entry.size());
+  }
+  m_cacheStamp = StringUtils::Format("%s-%08x", Version().asString().c_str(), static_cast<uint32_t>(crc));
 }
 
 void CSkinInfo::ResolveIncludes(TiXmlElement *node, std::map<INFO::InfoPtr, bool>* xmlIncludeConditions /* = NULL */)
@@ -180,6 +180,13 @@ public:
   const std::string& GetCurrentAspect() const { return m_currentAspect; }
 
   void LoadIncludes();
+
+  /*! \brief Get a stamp of the skin's XML files, changes whenever any of them is modified
+   Used to invalidate windows in the skin cache. Updated by LoadIncludes().
+   \return the stamp of the XML files
+   */
+  const std::string& GetCacheStamp() const { return m_cacheStamp; }
+
   void ToggleDebug();
   const INFO::CSkinVariableString* CreateSkinVariable(const std::string& name, int context);
 
@@ -241,6 +248,7 @@ protected:
 
   std::vector<CStartupWindow> m_startupWindows;
   bool m_debugging;
+  std::string m_cacheStamp;
 
 private:
   std::map<int, CSkinSettingStringPtr> m_strings;
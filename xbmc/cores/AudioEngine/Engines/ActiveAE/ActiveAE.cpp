@@ -28,6 +28,7 @@ using namespace ActiveAE;
 #include "ServiceBroker.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSP.h"
 #include "cores/AudioEngine/Engines/ActiveAE/AudioDSPAddons/ActiveAEDSPProcess.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 #include "cores/AudioEngine/AEResampleFactory.h"
@@ -2023,7 +2024,7 @@ bool CActiveAE::RunStages()
             (*it)->m_processingBuffers->m_outputSamples.pop_front();
 
             int nb_floats = out->pkt->nb_samples * out->pkt->config.channels / out->pkt->planes;
-            int nb_loops = 1;
+            bool perFrame = false;
             float fadingStep = 0.0f;
 
             // fading
@@ -2041,8 +2042,7 @@ bool CActiveAE::RunStages()
             }
             if ((*it)->m_fadingSamples > 0)
             {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
+              perFrame = true;
               float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
               int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
               fadingStep = delta / samples;
@@ -2053,43 +2053,20 @@ bool CActiveAE::RunStages()
             // or if sink format is float (in order to prevent from clipping)
             // we need to run on a per sample basis
             if ((*it)->m_amplify != 1.0 || !(*it)->m_processingBuffers->DoesNormalize() || (m_sinkFormat.m_dataFormat == AE_FMT_FLOAT))
+              perFrame = true;
+
+            if (perFrame)
             {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
+              const float *gains = CalcFrameGains(*it, *out->pkt, fadingStep);
+              for(int j=0; j<out->pkt->planes; j++)
+                CAEKernels::MulFrames((float*)out->pkt->data[j], gains, out->pkt->nb_samples, out->pkt->config.channels / out->pkt->planes);
             }
-
-            for(int i=0; i<nb_loops; i++)
+            else
             {
-              if ((*it)->m_fadingSamples > 0)
-              {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
-              }
-
               // volume for stream
               float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
-
               for(int j=0; j<out->pkt->planes; j++)
-              {
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
+                CAEKernels::MulArray((float*)out->pkt->data[j], volume, nb_floats);
             }
           }
           else
@@ -2099,7 +2076,7 @@ bool CActiveAE::RunStages()
             (*it)->m_processingBuffers->m_outputSamples.pop_front();
 
             int nb_floats = mix->pkt->nb_samples * mix->pkt->config.channels / mix->pkt->planes;
-            int nb_loops = 1;
+            bool perFrame = false;
             float fadingStep = 0.0f;
 
             // fading
@@ -2110,8 +2087,7 @@ bool CActiveAE::RunStages()
             }
             if ((*it)->m_fadingSamples > 0)
             {
-              nb_floats = mix->pkt->config.channels / mix->pkt->planes;
-              nb_loops = mix->pkt->nb_samples;
+              perFrame = true;
               float delta = (*it)->m_fadingTarget - (*it)->m_fadingBase;
               int samples = m_internalFormat.m_sampleRate * (float)(*it)->m_fadingTime / 1000.0f;
               fadingStep = delta / samples;
@@ -2120,53 +2096,31 @@ bool CActiveAE::RunStages()
             // for streams amplification of turned off downmix normalization
             // we need to run on a per sample basis
             if ((*it)->m_amplify != 1.0 || !(*it)->m_processingBuffers->DoesNormalize())
-            {
-              nb_floats = out->pkt->config.channels / out->pkt->planes;
-              nb_loops = out->pkt->nb_samples;
-            }
+              perFrame = true;
 
-            for(int i=0; i<nb_loops; i++)
+            if (perFrame)
             {
-              if ((*it)->m_fadingSamples > 0)
+              const float *gains = CalcFrameGains(*it, *mix->pkt, fadingStep);
+              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
               {
-                (*it)->m_volume += fadingStep;
-                (*it)->m_fadingSamples--;
-
-                if ((*it)->m_fadingSamples == 0)
-                {
-                  // set variables being polled via stream interface
-                  CSingleLock lock((*it)->m_streamLock);
-                  (*it)->m_streamFading = false;
-                }
+                float *dst = (float*)out->pkt->data[j];
+                float *src = (float*)mix->pkt->data[j];
+                float peak = CAEKernels::MulAddFrames(dst, src, gains, mix->pkt->nb_samples, mix->pkt->config.channels / mix->pkt->planes);
+                if (peak > 1.0f)
+                  needClamp = true;
               }
-
+            }
+            else
+            {
               // volume for stream
               float volume = (*it)->m_volume * (*it)->m_rgain;
-              if(nb_loops > 1)
-                volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
-
               for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
               {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
+                float *dst = (float*)out->pkt->data[j];
+                float *src = (float*)mix->pkt->data[j];
+                float peak = CAEKernels::MulAddArray(dst, src, volume, nb_floats);
+                if (peak > 1.0f)
+                  needClamp = true;
               }
             }
             mix->Return();
@@ -2545,12 +2499,7 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
       out = (float*)dstSample.data[j];
       sample_buffer = (float*)(it->sound->GetSound(false)->data[j]+start);
       int nb_floats = mix_samples * dstSample.config.channels / dstSample.planes;
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulAddArray(out, sample_buffer, volume, nb_floats);
-#else
-      for (int k = 0; k < nb_floats; ++k)
-        *out++ += *sample_buffer++ * volume;
-#endif
+      CAEKernels::MulAddArray(out, sample_buffer, volume, nb_floats);
     }
 
     it->samples_played += mix_samples;
@@ -2575,15 +2524,38 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
     for(int j=0; j<dstSample.planes; j++)
     {
       float* buffer = reinterpret_cast<float*>(dstSample.data[j]);
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulArray(buffer, volume, nb_floats);
-#else
-      float *fbuffer = buffer;
-      for (int i = 0; i < nb_floats; i++)
-        *fbuffer++ *= volume;
-#endif
+      CAEKernels::MulArray(buffer, volume, nb_floats);
+    }
+  }
+}
+
+float* CActiveAE::CalcFrameGains(CActiveAEStream *stream, CSoundPacket &sample, float fadingStep)
+{
+  // the limiter only depends on the peaks of the frames, so all gains
+  // can be calculated before the samples are touched
+  m_frameGains.resize(sample.nb_samples);
+  float *gains = m_frameGains.data();
+  stream->m_limiter.RunFrames((float**)sample.data, sample.config.channels, sample.nb_samples, gains, 0, sample.planes > 1);
+
+  for (int i = 0; i < sample.nb_samples; i++)
+  {
+    if (stream->m_fadingSamples > 0)
+    {
+      stream->m_volume += fadingStep;
+      stream->m_fadingSamples--;
+
+      if (stream->m_fadingSamples == 0)
+      {
+        // set variables being polled via stream interface
+        CSingleLock lock(stream->m_streamLock);
+        stream->m_streamFading = false;
+      }
     }
+
+    // volume for stream
+    gains[i] *= stream->m_volume * stream->m_rgain;
   }
+  return gains;
 }
 
 //-----------------------------------------------------------------------------
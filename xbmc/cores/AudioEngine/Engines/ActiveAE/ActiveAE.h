@@ -328,6 +328,7 @@ protected:
   bool ResampleSound(CActiveAESound *sound);
   void MixSounds(CSoundPacket &dstSample);
   void Deamplify(CSoundPacket &dstSample);
+  float* CalcFrameGains(CActiveAEStream *stream, CSoundPacket &sample, float fadingStep);
 
   bool CompareFormat(AEAudioFormat &lhs, AEAudioFormat &rhs);
 
@@ -370,6 +371,7 @@ protected:
   CActiveAEBufferPool *m_vizBuffersInput;
   CActiveAEBufferPool *m_silenceBuffers;  // needed to drive gui sounds if we have no streams
   CActiveAEBufferPool *m_encoderBuffers;
+  std::vector<float> m_frameGains;
 
   // streams
   std::list<CActiveAEStream*> m_streams;
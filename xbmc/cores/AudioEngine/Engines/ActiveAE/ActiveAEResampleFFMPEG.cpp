@@ -18,10 +18,13 @@
  *
  */
 
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "ActiveAEResampleFFMPEG.h"
 #include "utils/log.h"
 
+#include <string.h>
+
 extern "C" {
 #include "libavutil/channel_layout.h"
 #include "libavutil/opt.h"
@@ -34,6 +37,7 @@ CActiveAEResampleFFMPEG::CActiveAEResampleFFMPEG()
 {
   m_pContext = NULL;
   m_doesResample = false;
+  m_convertOnly = false;
 }
 
 CActiveAEResampleFFMPEG::~CActiveAEResampleFFMPEG()
@@ -105,6 +109,10 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
      av_opt_set_double(m_pContext, "rematrix_maxval", 1.0, 0);
   }
 
+  // without resampling and remixing plain sample format conversions are done by CAEKernels
+  m_convertOnly = !force_resample && m_src_rate == m_dst_rate && m_src_channels == m_dst_channels &&
+                  (remapLayout || m_src_chan_layout == m_dst_chan_layout) && CanConvert();
+
   if (remapLayout)
   {
     // one-to-one mapping of channels
@@ -120,6 +128,9 @@ bool CActiveAEResampleFFMPEG::Init(uint64_t dst_chan_layout, int dst_channels, i
       {
         m_rematrix[out][idx] = 1.0;
       }
+      // channels have to stay in place for a plain conversion
+      if (idx != (int)out)
+        m_convertOnly = false;
     }
 
     av_opt_set_int(m_pContext, "out_channel_count", m_dst_channels, 0);
@@ -198,11 +209,19 @@ int CActiveAEResampleFFMPEG::Resample(uint8_t **dst_buffer, int dst_samples, uin
     }
   }
 
-  int ret = swr_convert(m_pContext, dst_buffer, dst_samples, (const uint8_t**)src_buffer, src_samples);
-  if (ret < 0)
+  int ret;
+  if (m_convertOnly && !m_doesResample && src_samples <= dst_samples && swr_get_delay(m_pContext, m_src_rate) == 0)
   {
-    CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Resample - resample failed");
-    return -1;
+    ret = Convert(dst_buffer, src_buffer, src_samples);
+  }
+  else
+  {
+    ret = swr_convert(m_pContext, dst_buffer, dst_samples, (const uint8_t**)src_buffer, src_samples);
+    if (ret < 0)
+    {
+      CLog::Log(LOGERROR, "CActiveAEResampleFFMPEG::Resample - resample failed");
+      return -1;
+    }
   }
 
   // special handling for S24 formats which are carried in S32
@@ -283,3 +302,97 @@ int CActiveAEResampleFFMPEG::GetDstBufferSize(int samples)
 {
   return av_samples_get_buffer_size(NULL, m_dst_channels, samples, m_dst_fmt, 1);
 }
+
+bool CActiveAEResampleFFMPEG::CanConvert() const
+{
+  AVSampleFormat src = av_get_packed_sample_fmt(m_src_fmt);
+  AVSampleFormat dst = av_get_packed_sample_fmt(m_dst_fmt);
+
+  // conversions from and to float, or changing planarity of 32 bit samples
+  if (src == AV_SAMPLE_FMT_FLT)
+    return dst == AV_SAMPLE_FMT_FLT || dst == AV_SAMPLE_FMT_S16 || dst == AV_SAMPLE_FMT_S32;
+  if (src == AV_SAMPLE_FMT_S16 || src == AV_SAMPLE_FMT_S32)
+    return dst == AV_SAMPLE_FMT_FLT || (src == AV_SAMPLE_FMT_S32 && dst == AV_SAMPLE_FMT_S32);
+
+  return false;
+}
+
+void CActiveAEResampleFFMPEG::ConvertSamples(void *dst, const void *src, int count)
+{
+  AVSampleFormat srcFmt = av_get_packed_sample_fmt(m_src_fmt);
+  AVSampleFormat dstFmt = av_get_packed_sample_fmt(m_dst_fmt);
+
+  if (srcFmt == dstFmt)
+  {
+    if (dst != src)
+      memcpy(dst, src, count * av_get_bytes_per_sample(srcFmt));
+  }
+  else if (srcFmt == AV_SAMPLE_FMT_S16)
+    CAEKernels::ConvertS16ToFloat(static_cast<float*>(dst), static_cast<const int16_t*>(src), count);
+  else if (srcFmt == AV_SAMPLE_FMT_S32)
+    CAEKernels::ConvertS32ToFloat(static_cast<float*>(dst), static_cast<const int32_t*>(src), count);
+  else if (dstFmt == AV_SAMPLE_FMT_S16)
+    CAEKernels::ConvertFloatToS16(static_cast<int16_t*>(dst), static_cast<const float*>(src), count);
+  else
+    CAEKernels::ConvertFloatToS32(static_cast<int32_t*>(dst), static_cast<const float*>(src), count);
+}
+
+int CActiveAEResampleFFMPEG::Convert(uint8_t **dst_buffer, uint8_t **src_buffer, int samples)
+{
+  if (samples <= 0)
+    return 0;
+
+  const int channels = m_src_channels;
+  const bool srcPlanar = av_sample_fmt_is_planar(m_src_fmt) != 0;
+  const bool dstPlanar = av_sample_fmt_is_planar(m_dst_fmt) != 0;
+
+  if (srcPlanar == dstPlanar)
+  {
+    int planes = srcPlanar ? channels : 1;
+    for (int i = 0; i < planes; i++)
+      ConvertSamples(dst_buffer[i], src_buffer[i], samples * channels / planes);
+    return samples;
+  }
+
+  // planar <-> interleaved is done on 32 bit samples, 16 bit samples
+  // go through m_convertBuffer before or after the conversion
+  uint32_t* srcPlanes[AE_CH_MAX];
+  uint32_t* dstPlanes[AE_CH_MAX];
+  const bool srcS16 = av_get_packed_sample_fmt(m_src_fmt) == AV_SAMPLE_FMT_S16;
+  const bool dstS16 = av_get_packed_sample_fmt(m_dst_fmt) == AV_SAMPLE_FMT_S16;
+
+  if (srcS16 || dstS16)
+    m_convertBuffer.resize(samples * channels);
+  uint32_t *scratch = m_convertBuffer.data();
+
+  for (int i = 0; i < channels; i++)
+  {
+    srcPlanes[i] = srcS16 ? scratch + i * samples : reinterpret_cast<uint32_t*>(src_buffer[i]);
+    dstPlanes[i] = dstS16 ? scratch + i * samples : reinterpret_cast<uint32_t*>(dst_buffer[i]);
+  }
+
+  if (srcPlanar)
+  {
+    if (srcS16)
+    {
+      for (int i = 0; i < channels; i++)
+        ConvertSamples(srcPlanes[i], src_buffer[i], samples);
+    }
+    CAEKernels::Interleave32(dstS16 ? scratch : reinterpret_cast<uint32_t*>(dst_buffer[0]), srcPlanes, channels, samples);
+    if (!srcS16)
+      ConvertSamples(dst_buffer[0], dstS16 ? scratch : dst_buffer[0], samples * channels);
+  }
+  else
+  {
+    if (srcS16)
+      ConvertSamples(scratch, src_buffer[0], samples * channels);
+    CAEKernels::Deinterleave32(dstPlanes, srcS16 ? scratch : reinterpret_cast<uint32_t*>(src_buffer[0]), channels, samples);
+    if (!srcS16)
+    {
+      for (int i = 0; i < channels; i++)
+        ConvertSamples(dst_buffer[i], dstPlanes[i], samples);
+    }
+  }
+
+  return samples;
+}
@@ -24,6 +24,8 @@
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include "cores/AudioEngine/Interfaces/AEResample.h"
 
+#include <vector>
+
 extern "C" {
 #include "libavutil/samplefmt.h"
 }
@@ -49,6 +51,10 @@ public:
   int GetDstBufferSize(int samples) override;
 
 protected:
+  bool CanConvert() const;
+  int Convert(uint8_t **dst_buffer, uint8_t **src_buffer, int samples);
+  void ConvertSamples(void *dst, const void *src, int count);
+
   bool m_loaded;
   bool m_doesResample;
   uint64_t m_src_chan_layout, m_dst_chan_layout;
@@ -59,6 +65,8 @@ protected:
   int m_src_dither_bits, m_dst_dither_bits;
   SwrContext *m_pContext;
   double m_rematrix[AE_CH_MAX][AE_CH_MAX];
+  bool m_convertOnly;
+  std::vector<uint32_t> m_convertBuffer;
 };
 
 }
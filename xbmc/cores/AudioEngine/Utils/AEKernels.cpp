@@ -0,0 +1,870 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+#include "utils/CPUInfo.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+// AVX2 code is compiled for the kernels only and used if the cpu supports it
+#if defined(__GNUC__)
+#include <immintrin.h>
+#define AE_KERNELS_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(HAS_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+
+struct Kernels
+{
+  const char *name;
+  void (*MulArray)(float *data, float mul, unsigned int count);
+  float (*MulAddArray)(float *data, const float *add, float mul, unsigned int count);
+  void (*MulFrames)(float *data, const float *gains, unsigned int frames, unsigned int channels);
+  float (*MulAddFrames)(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels);
+  void (*PeakFrames)(float *peaks, const float *data, unsigned int frames, unsigned int channels);
+  void (*ConvertS16ToFloat)(float *dst, const int16_t *src, unsigned int count);
+  void (*ConvertFloatToS16)(int16_t *dst, const float *src, unsigned int count);
+  void (*ConvertS32ToFloat)(float *dst, const int32_t *src, unsigned int count);
+  void (*ConvertFloatToS32)(int32_t *dst, const float *src, unsigned int count);
+  void (*Interleave32)(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames);
+  void (*Deinterleave32)(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames);
+};
+
+const float S16_SCALE = 1.0f / (1 << 15);
+const float S32_SCALE = 1.0f / (1U << 31);
+
+//------------------------------------------------------------------------------
+// plain C
+//------------------------------------------------------------------------------
+
+void MulArrayC(float *data, float mul, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+    data[i] *= mul;
+}
+
+float MulAddArrayC(float *data, const float *add, float mul, unsigned int count)
+{
+  float peak = 0.0f;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    data[i] += add[i] * mul;
+    peak = std::max(peak, fabsf(data[i]));
+  }
+  return peak;
+}
+
+void MulFramesC(float *data, const float *gains, unsigned int frames, unsigned int channels)
+{
+  for (unsigned int f = 0; f < frames; ++f, data += channels)
+  {
+    for (unsigned int c = 0; c < channels; ++c)
+      data[c] *= gains[f];
+  }
+}
+
+float MulAddFramesC(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels)
+{
+  float peak = 0.0f;
+  for (unsigned int f = 0; f < frames; ++f, data += channels, add += channels)
+  {
+    for (unsigned int c = 0; c < channels; ++c)
+    {
+      data[c] += add[c] * gains[f];
+      peak = std::max(peak, fabsf(data[c]));
+    }
+  }
+  return peak;
+}
+
+void PeakFramesC(float *peaks, const float *data, unsigned int frames, unsigned int channels)
+{
+  for (unsigned int f = 0; f < frames; ++f, data += channels)
+  {
+    for (unsigned int c = 0; c < channels; ++c)
+      peaks[f] = std::max(peaks[f], fabsf(data[c]));
+  }
+}
+
+void ConvertS16ToFloatC(float *dst, const int16_t *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+    dst[i] = src[i] * S16_SCALE;
+}
+
+void ConvertFloatToS16C(int16_t *dst, const float *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    long value = lrintf(src[i] * (1 << 15));
+    dst[i] = static_cast<int16_t>(std::max(std::min(value, 32767L), -32768L));
+  }
+}
+
+void ConvertS32ToFloatC(float *dst, const int32_t *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+    dst[i] = src[i] * S32_SCALE;
+}
+
+void ConvertFloatToS32C(int32_t *dst, const float *src, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    long long value = llrintf(src[i] * (1U << 31));
+    dst[i] = static_cast<int32_t>(std::max(std::min(value, 2147483647LL), -2147483647LL - 1));
+  }
+}
+
+void Interleave32C(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames)
+{
+  for (unsigned int f = 0; f < frames; ++f)
+  {
+    for (unsigned int c = 0; c < channels; ++c)
+      *dst++ = src[c][f];
+  }
+}
+
+void Deinterleave32C(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames)
+{
+  for (unsigned int f = 0; f < frames; ++f)
+  {
+    for (unsigned int c = 0; c < channels; ++c)
+      dst[c][f] = *src++;
+  }
+}
+
+//------------------------------------------------------------------------------
+// SSE2
+//------------------------------------------------------------------------------
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+inline __m128 AbsSSE(__m128 value)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+inline float HorizontalMaxSSE(__m128 value)
+{
+  value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+  value = _mm_max_ss(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(value);
+}
+
+void MulArraySSE2(float *data, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+float MulAddArraySSE2(float *data, const float *add, float mul, unsigned int count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  __m128 peak = _mm_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 out = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), m));
+    _mm_storeu_ps(data + i, out);
+    peak = _mm_max_ps(peak, AbsSSE(out));
+  }
+  return std::max(HorizontalMaxSSE(peak), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+void MulFramesSSE2(float *data, const float *gains, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+      _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), _mm_loadu_ps(gains + i)));
+    MulFramesC(data + i, gains + i, frames - i, 1);
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      const __m128 m = _mm_set1_ps(gains[f]);
+      for (unsigned int c = 0; c < channels; c += 4)
+        _mm_storeu_ps(data + c, _mm_mul_ps(_mm_loadu_ps(data + c), m));
+    }
+  }
+  else
+    MulFramesC(data, gains, frames, channels);
+}
+
+float MulAddFramesSSE2(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels)
+{
+  __m128 peak = _mm_setzero_ps();
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+      __m128 out = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), _mm_loadu_ps(gains + i)));
+      _mm_storeu_ps(data + i, out);
+      peak = _mm_max_ps(peak, AbsSSE(out));
+    }
+    return std::max(HorizontalMaxSSE(peak), MulAddFramesC(data + i, add + i, gains + i, frames - i, 1));
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels, add += channels)
+    {
+      const __m128 m = _mm_set1_ps(gains[f]);
+      for (unsigned int c = 0; c < channels; c += 4)
+      {
+        __m128 out = _mm_add_ps(_mm_loadu_ps(data + c), _mm_mul_ps(_mm_loadu_ps(add + c), m));
+        _mm_storeu_ps(data + c, out);
+        peak = _mm_max_ps(peak, AbsSSE(out));
+      }
+    }
+    return HorizontalMaxSSE(peak);
+  }
+
+  return MulAddFramesC(data, add, gains, frames, channels);
+}
+
+void PeakFramesSSE2(float *peaks, const float *data, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+      _mm_storeu_ps(peaks + i, _mm_max_ps(_mm_loadu_ps(peaks + i), AbsSSE(_mm_loadu_ps(data + i))));
+    PeakFramesC(peaks + i, data + i, frames - i, 1);
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      __m128 peak = _mm_set1_ps(peaks[f]);
+      for (unsigned int c = 0; c < channels; c += 4)
+        peak = _mm_max_ps(peak, AbsSSE(_mm_loadu_ps(data + c)));
+      peaks[f] = HorizontalMaxSSE(peak);
+    }
+  }
+  else
+    PeakFramesC(peaks, data, frames, channels);
+}
+
+void ConvertS16ToFloatSSE2(float *dst, const int16_t *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(S16_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // sign extend by moving the samples to the upper half and shifting back
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+  ConvertS16ToFloatC(dst + i, src + i, count - i);
+}
+
+void ConvertFloatToS16SSE2(int16_t *dst, const float *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(1 << 15);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    // cvtps rounds to nearest even like lrintf, packs saturates like av_clip_int16
+    __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+    __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+  }
+  ConvertFloatToS16C(dst + i, src + i, count - i);
+}
+
+void ConvertS32ToFloatSSE2(float *dst, const int32_t *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(S32_SCALE);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(in), scale));
+  }
+  ConvertS32ToFloatC(dst + i, src + i, count - i);
+}
+
+void ConvertFloatToS32SSE2(int32_t *dst, const float *src, unsigned int count)
+{
+  const __m128 scale = _mm_set1_ps(1U << 31);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 in = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+    // cvtps returns INT32_MIN on overflow, flip it to INT32_MAX for positive values
+    __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(in, scale));
+    __m128i out = _mm_xor_si128(_mm_cvtps_epi32(in), overflow);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+  }
+  ConvertFloatToS32C(dst + i, src + i, count - i);
+}
+
+void Interleave32SSE2(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames)
+{
+  if (channels == 2)
+  {
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 l = _mm_loadu_ps(reinterpret_cast<const float*>(src[0] + f));
+      __m128 r = _mm_loadu_ps(reinterpret_cast<const float*>(src[1] + f));
+      _mm_storeu_ps(reinterpret_cast<float*>(dst + f * 2), _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(reinterpret_cast<float*>(dst + f * 2 + 4), _mm_unpackhi_ps(l, r));
+    }
+    const uint32_t* const rest[2] = { src[0] + f, src[1] + f };
+    Interleave32C(dst + f * 2, rest, 2, frames - f);
+  }
+  else if (channels % 4 == 0)
+  {
+    // transpose blocks of 4 frames x 4 channels
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      for (unsigned int c = 0; c < channels; c += 4)
+      {
+        __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(src[c] + f));
+        __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(src[c + 1] + f));
+        __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(src[c + 2] + f));
+        __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(src[c + 3] + f));
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        float *out = reinterpret_cast<float*>(dst + f * channels + c);
+        _mm_storeu_ps(out, r0);
+        _mm_storeu_ps(out + channels, r1);
+        _mm_storeu_ps(out + channels * 2, r2);
+        _mm_storeu_ps(out + channels * 3, r3);
+      }
+    }
+    for (; f < frames; ++f)
+    {
+      for (unsigned int c = 0; c < channels; ++c)
+        dst[f * channels + c] = src[c][f];
+    }
+  }
+  else
+    Interleave32C(dst, src, channels, frames);
+}
+
+void Deinterleave32SSE2(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames)
+{
+  if (channels == 2)
+  {
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(src + f * 2));
+      __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(src + f * 2 + 4));
+      _mm_storeu_ps(reinterpret_cast<float*>(dst[0] + f), _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(reinterpret_cast<float*>(dst[1] + f), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    uint32_t* const rest[2] = { dst[0] + f, dst[1] + f };
+    Deinterleave32C(rest, src + f * 2, 2, frames - f);
+  }
+  else if (channels % 4 == 0)
+  {
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      for (unsigned int c = 0; c < channels; c += 4)
+      {
+        const float *in = reinterpret_cast<const float*>(src + f * channels + c);
+        __m128 r0 = _mm_loadu_ps(in);
+        __m128 r1 = _mm_loadu_ps(in + channels);
+        __m128 r2 = _mm_loadu_ps(in + channels * 2);
+        __m128 r3 = _mm_loadu_ps(in + channels * 3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[c] + f), r0);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[c + 1] + f), r1);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[c + 2] + f), r2);
+        _mm_storeu_ps(reinterpret_cast<float*>(dst[c + 3] + f), r3);
+      }
+    }
+    for (; f < frames; ++f)
+    {
+      for (unsigned int c = 0; c < channels; ++c)
+        dst[c][f] = src[f * channels + c];
+    }
+  }
+  else
+    Deinterleave32C(dst, src, channels, frames);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// AVX2
+//------------------------------------------------------------------------------
+
+#if defined(AE_KERNELS_AVX2)
+AVX2_TARGET inline __m256 AbsAVX2(__m256 value)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+}
+
+AVX2_TARGET inline float HorizontalMaxAVX2(__m256 value)
+{
+  __m128 half = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+  return HorizontalMaxSSE(half);
+}
+
+AVX2_TARGET void MulArrayAVX2(float *data, float mul, unsigned int count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  MulArrayC(data + i, mul, count - i);
+}
+
+AVX2_TARGET float MulAddArrayAVX2(float *data, const float *add, float mul, unsigned int count)
+{
+  // no fma here, the result has to match the other implementations
+  const __m256 m = _mm256_set1_ps(mul);
+  __m256 peak = _mm256_setzero_ps();
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), m));
+    _mm256_storeu_ps(data + i, out);
+    peak = _mm256_max_ps(peak, AbsAVX2(out));
+  }
+  return std::max(HorizontalMaxAVX2(peak), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+AVX2_TARGET void MulFramesAVX2(float *data, const float *gains, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= frames; i += 8)
+      _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), _mm256_loadu_ps(gains + i)));
+    MulFramesC(data + i, gains + i, frames - i, 1);
+  }
+  else if (channels % 8 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      const __m256 m = _mm256_set1_ps(gains[f]);
+      for (unsigned int c = 0; c < channels; c += 8)
+        _mm256_storeu_ps(data + c, _mm256_mul_ps(_mm256_loadu_ps(data + c), m));
+    }
+  }
+  else
+    MulFramesSSE2(data, gains, frames, channels);
+}
+
+AVX2_TARGET float MulAddFramesAVX2(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels)
+{
+  __m256 peak = _mm256_setzero_ps();
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+      __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), _mm256_loadu_ps(gains + i)));
+      _mm256_storeu_ps(data + i, out);
+      peak = _mm256_max_ps(peak, AbsAVX2(out));
+    }
+    return std::max(HorizontalMaxAVX2(peak), MulAddFramesC(data + i, add + i, gains + i, frames - i, 1));
+  }
+  else if (channels % 8 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels, add += channels)
+    {
+      const __m256 m = _mm256_set1_ps(gains[f]);
+      for (unsigned int c = 0; c < channels; c += 8)
+      {
+        __m256 out = _mm256_add_ps(_mm256_loadu_ps(data + c), _mm256_mul_ps(_mm256_loadu_ps(add + c), m));
+        _mm256_storeu_ps(data + c, out);
+        peak = _mm256_max_ps(peak, AbsAVX2(out));
+      }
+    }
+    return HorizontalMaxAVX2(peak);
+  }
+
+  return MulAddFramesSSE2(data, add, gains, frames, channels);
+}
+
+AVX2_TARGET void PeakFramesAVX2(float *peaks, const float *data, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= frames; i += 8)
+      _mm256_storeu_ps(peaks + i, _mm256_max_ps(_mm256_loadu_ps(peaks + i), AbsAVX2(_mm256_loadu_ps(data + i))));
+    PeakFramesC(peaks + i, data + i, frames - i, 1);
+  }
+  else if (channels % 8 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      __m256 peak = _mm256_set1_ps(peaks[f]);
+      for (unsigned int c = 0; c < channels; c += 8)
+        peak = _mm256_max_ps(peak, AbsAVX2(_mm256_loadu_ps(data + c)));
+      peaks[f] = HorizontalMaxAVX2(peak);
+    }
+  }
+  else
+    PeakFramesSSE2(peaks, data, frames, channels);
+}
+
+AVX2_TARGET void ConvertS16ToFloatAVX2(float *dst, const int16_t *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(S16_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i in = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(in), scale));
+  }
+  ConvertS16ToFloatC(dst + i, src + i, count - i);
+}
+
+AVX2_TARGET void ConvertFloatToS16AVX2(int16_t *dst, const float *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(1 << 15);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale));
+    __m256i hi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale));
+    // packs works per 128 bit lane, restore the order of the samples
+    __m256i out = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+  }
+  ConvertFloatToS16SSE2(dst + i, src + i, count - i);
+}
+
+AVX2_TARGET void ConvertS32ToFloatAVX2(float *dst, const int32_t *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(S32_SCALE);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(in), scale));
+  }
+  ConvertS32ToFloatC(dst + i, src + i, count - i);
+}
+
+AVX2_TARGET void ConvertFloatToS32AVX2(int32_t *dst, const float *src, unsigned int count)
+{
+  const __m256 scale = _mm256_set1_ps(1U << 31);
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 in = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+    __m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(in, scale, _CMP_GE_OQ));
+    __m256i out = _mm256_xor_si256(_mm256_cvtps_epi32(in), overflow);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+  }
+  ConvertFloatToS32C(dst + i, src + i, count - i);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// NEON
+//------------------------------------------------------------------------------
+
+#if defined(HAS_NEON)
+inline float HorizontalMaxNEON(float32x4_t value)
+{
+  float32x2_t half = vpmax_f32(vget_low_f32(value), vget_high_f32(value));
+  half = vpmax_f32(half, half);
+  return vget_lane_f32(half, 0);
+}
+
+void MulArrayNEON(float *data, float mul, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), mul));
+  MulArrayC(data + i, mul, count - i);
+}
+
+float MulAddArrayNEON(float *data, const float *add, float mul, unsigned int count)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t out = vaddq_f32(vld1q_f32(data + i), vmulq_n_f32(vld1q_f32(add + i), mul));
+    vst1q_f32(data + i, out);
+    peak = vmaxq_f32(peak, vabsq_f32(out));
+  }
+  return std::max(HorizontalMaxNEON(peak), MulAddArrayC(data + i, add + i, mul, count - i));
+}
+
+void MulFramesNEON(float *data, const float *gains, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+      vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), vld1q_f32(gains + i)));
+    MulFramesC(data + i, gains + i, frames - i, 1);
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      for (unsigned int c = 0; c < channels; c += 4)
+        vst1q_f32(data + c, vmulq_n_f32(vld1q_f32(data + c), gains[f]));
+    }
+  }
+  else
+    MulFramesC(data, gains, frames, channels);
+}
+
+float MulAddFramesNEON(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels)
+{
+  float32x4_t peak = vdupq_n_f32(0.0f);
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+      float32x4_t out = vaddq_f32(vld1q_f32(data + i), vmulq_f32(vld1q_f32(add + i), vld1q_f32(gains + i)));
+      vst1q_f32(data + i, out);
+      peak = vmaxq_f32(peak, vabsq_f32(out));
+    }
+    return std::max(HorizontalMaxNEON(peak), MulAddFramesC(data + i, add + i, gains + i, frames - i, 1));
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels, add += channels)
+    {
+      for (unsigned int c = 0; c < channels; c += 4)
+      {
+        float32x4_t out = vaddq_f32(vld1q_f32(data + c), vmulq_n_f32(vld1q_f32(add + c), gains[f]));
+        vst1q_f32(data + c, out);
+        peak = vmaxq_f32(peak, vabsq_f32(out));
+      }
+    }
+    return HorizontalMaxNEON(peak);
+  }
+
+  return MulAddFramesC(data, add, gains, frames, channels);
+}
+
+void PeakFramesNEON(float *peaks, const float *data, unsigned int frames, unsigned int channels)
+{
+  if (channels == 1)
+  {
+    unsigned int i = 0;
+    for (; i + 4 <= frames; i += 4)
+      vst1q_f32(peaks + i, vmaxq_f32(vld1q_f32(peaks + i), vabsq_f32(vld1q_f32(data + i))));
+    PeakFramesC(peaks + i, data + i, frames - i, 1);
+  }
+  else if (channels % 4 == 0)
+  {
+    for (unsigned int f = 0; f < frames; ++f, data += channels)
+    {
+      float32x4_t peak = vdupq_n_f32(peaks[f]);
+      for (unsigned int c = 0; c < channels; c += 4)
+        peak = vmaxq_f32(peak, vabsq_f32(vld1q_f32(data + c)));
+      peaks[f] = HorizontalMaxNEON(peak);
+    }
+  }
+  else
+    PeakFramesC(peaks, data, frames, channels);
+}
+
+void ConvertS16ToFloatNEON(float *dst, const int16_t *src, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    int16x8_t in = vld1q_s16(src + i);
+    vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), S16_SCALE));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), S16_SCALE));
+  }
+  ConvertS16ToFloatC(dst + i, src + i, count - i);
+}
+
+void ConvertS32ToFloatNEON(float *dst, const int32_t *src, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), S32_SCALE));
+  ConvertS32ToFloatC(dst + i, src + i, count - i);
+}
+
+void Interleave32NEON(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames)
+{
+  if (channels == 2)
+  {
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      uint32x4x2_t out;
+      out.val[0] = vld1q_u32(src[0] + f);
+      out.val[1] = vld1q_u32(src[1] + f);
+      vst2q_u32(dst + f * 2, out);
+    }
+    const uint32_t* const rest[2] = { src[0] + f, src[1] + f };
+    Interleave32C(dst + f * 2, rest, 2, frames - f);
+  }
+  else
+    Interleave32C(dst, src, channels, frames);
+}
+
+void Deinterleave32NEON(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames)
+{
+  if (channels == 2)
+  {
+    unsigned int f = 0;
+    for (; f + 4 <= frames; f += 4)
+    {
+      uint32x4x2_t in = vld2q_u32(src + f * 2);
+      vst1q_u32(dst[0] + f, in.val[0]);
+      vst1q_u32(dst[1] + f, in.val[1]);
+    }
+    uint32_t* const rest[2] = { dst[0] + f, dst[1] + f };
+    Deinterleave32C(rest, src + f * 2, 2, frames - f);
+  }
+  else
+    Deinterleave32C(dst, src, channels, frames);
+}
+#endif
+
+Kernels SelectKernels()
+{
+  Kernels kernels = { "C", MulArrayC, MulAddArrayC, MulFramesC, MulAddFramesC, PeakFramesC,
+                      ConvertS16ToFloatC, ConvertFloatToS16C, ConvertS32ToFloatC, ConvertFloatToS32C,
+                      Interleave32C, Deinterleave32C };
+
+  unsigned int features = g_cpuInfo.GetCPUFeatures();
+  (void)features;
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  if (features & CPU_FEATURE_SSE2)
+  {
+    kernels = { "SSE2", MulArraySSE2, MulAddArraySSE2, MulFramesSSE2, MulAddFramesSSE2, PeakFramesSSE2,
+                ConvertS16ToFloatSSE2, ConvertFloatToS16SSE2, ConvertS32ToFloatSSE2, ConvertFloatToS32SSE2,
+                Interleave32SSE2, Deinterleave32SSE2 };
+  }
+#endif
+#if defined(AE_KERNELS_AVX2)
+  // (de)interleaving is limited by memory bandwidth, the SSE2 versions are used
+  if ((features & CPU_FEATURE_SSE2) && (features & CPU_FEATURE_AVX2))
+  {
+    kernels = { "AVX2", MulArrayAVX2, MulAddArrayAVX2, MulFramesAVX2, MulAddFramesAVX2, PeakFramesAVX2,
+                ConvertS16ToFloatAVX2, ConvertFloatToS16AVX2, ConvertS32ToFloatAVX2, ConvertFloatToS32AVX2,
+                Interleave32SSE2, Deinterleave32SSE2 };
+  }
+#endif
+#if defined(HAS_NEON)
+  // float to integer conversions stay in C, rounding to nearest is not available on all NEON versions
+  if (features & CPU_FEATURE_NEON)
+  {
+    kernels = { "NEON", MulArrayNEON, MulAddArrayNEON, MulFramesNEON, MulAddFramesNEON, PeakFramesNEON,
+                ConvertS16ToFloatNEON, ConvertFloatToS16C, ConvertS32ToFloatNEON, ConvertFloatToS32C,
+                Interleave32NEON, Deinterleave32NEON };
+  }
+#endif
+
+  return kernels;
+}
+
+const Kernels& GetKernels()
+{
+  static const Kernels kernels = SelectKernels();
+  return kernels;
+}
+
+}
+
+void CAEKernels::MulArray(float *data, float mul, unsigned int count)
+{
+  GetKernels().MulArray(data, mul, count);
+}
+
+float CAEKernels::MulAddArray(float *data, const float *add, float mul, unsigned int count)
+{
+  return GetKernels().MulAddArray(data, add, mul, count);
+}
+
+void CAEKernels::MulFrames(float *data, const float *gains, unsigned int frames, unsigned int channels)
+{
+  GetKernels().MulFrames(data, gains, frames, channels);
+}
+
+float CAEKernels::MulAddFrames(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels)
+{
+  return GetKernels().MulAddFrames(data, add, gains, frames, channels);
+}
+
+void CAEKernels::PeakFrames(float *peaks, const float *data, unsigned int frames, unsigned int channels)
+{
+  GetKernels().PeakFrames(peaks, data, frames, channels);
+}
+
+void CAEKernels::ConvertS16ToFloat(float *dst, const int16_t *src, unsigned int count)
+{
+  GetKernels().ConvertS16ToFloat(dst, src, count);
+}
+
+void CAEKernels::ConvertFloatToS16(int16_t *dst, const float *src, unsigned int count)
+{
+  GetKernels().ConvertFloatToS16(dst, src, count);
+}
+
+void CAEKernels::ConvertS32ToFloat(float *dst, const int32_t *src, unsigned int count)
+{
+  GetKernels().ConvertS32ToFloat(dst, src, count);
+}
+
+void CAEKernels::ConvertFloatToS32(int32_t *dst, const float *src, unsigned int count)
+{
+  GetKernels().ConvertFloatToS32(dst, src, count);
+}
+
+void CAEKernels::Interleave32(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames)
+{
+  GetKernels().Interleave32(dst, src, channels, frames);
+}
+
+void CAEKernels::Deinterleave32(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames)
+{
+  GetKernels().Deinterleave32(dst, src, channels, frames);
+}
+
+const char* CAEKernels::GetName()
+{
+  return GetKernels().name;
+}
@@ -0,0 +1,70 @@
+#pragma once
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+/*!
+ \brief Sample processing kernels used by the audio engine.
+
+ The implementation (plain C, SSE2, AVX2 or NEON) is selected once at runtime
+ from the features reported by CCPUInfo. Buffers do not need to be aligned.
+ Frame based methods take interleaved data, planar data is passed plane by
+ plane with channels = 1.
+ */
+class CAEKernels
+{
+public:
+  /*! \brief data[i] *= mul */
+  static void MulArray(float *data, float mul, unsigned int count);
+
+  /*! \brief data[i] += add[i] * mul
+   \return the highest absolute value written to data
+   */
+  static float MulAddArray(float *data, const float *add, float mul, unsigned int count);
+
+  /*! \brief Applies one gain per frame, data[f * channels + c] *= gains[f] */
+  static void MulFrames(float *data, const float *gains, unsigned int frames, unsigned int channels);
+
+  /*! \brief Mixes with one gain per frame, data[f * channels + c] += add[f * channels + c] * gains[f]
+   \return the highest absolute value written to data
+   */
+  static float MulAddFrames(float *data, const float *add, const float *gains, unsigned int frames, unsigned int channels);
+
+  /*! \brief Updates the peak of every frame, peaks[f] = max(peaks[f], |data[f * channels + c]|) */
+  static void PeakFrames(float *peaks, const float *data, unsigned int frames, unsigned int channels);
+
+  /*! \name Sample format conversions, matching the rounding and clipping of swresample */
+  //@{
+  static void ConvertS16ToFloat(float *dst, const int16_t *src, unsigned int count);
+  static void ConvertFloatToS16(int16_t *dst, const float *src, unsigned int count);
+  static void ConvertS32ToFloat(float *dst, const int32_t *src, unsigned int count);
+  static void ConvertFloatToS32(int32_t *dst, const float *src, unsigned int count);
+  //@}
+
+  /*! \name Planar <-> interleaved conversion of 32 bit samples (float or S32) */
+  //@{
+  static void Interleave32(uint32_t *dst, const uint32_t* const* src, unsigned int channels, unsigned int frames);
+  static void Deinterleave32(uint32_t* const* dst, const uint32_t *src, unsigned int channels, unsigned int frames);
+  //@}
+
+  /*! \brief Name of the selected implementation, for logging */
+  static const char* GetName();
+};
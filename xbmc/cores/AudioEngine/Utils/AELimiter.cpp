@@ -19,6 +19,7 @@
  */
 
 #include "AELimiter.h"
+#include "AEKernels.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/MathUtils.h"
 #include <algorithm>
@@ -51,6 +52,27 @@ float CAELimiter::Run(float* frame[AE_CH_MAX], int channels, int offset /*= 0*/,
     }
   }
 
+  return Process(highest);
+}
+
+void CAELimiter::RunFrames(float* frame[AE_CH_MAX], int channels, int frames, float *gains, int offset /*= 0*/, bool planar /*= false*/)
+{
+  // find the peak of every frame first, the gains depend on each other
+  std::fill(gains, gains + frames, 0.0f);
+  if (!planar)
+    CAEKernels::PeakFrames(gains, frame[0] + offset * channels, frames, channels);
+  else
+  {
+    for (int i = 0; i < channels; i++)
+      CAEKernels::PeakFrames(gains, frame[i] + offset, frames, 1);
+  }
+
+  for (int i = 0; i < frames; i++)
+    gains[i] = Process(gains[i]);
+}
+
+float CAELimiter::Process(float highest)
+{
   float sample = highest * m_amplify;
   if (sample * m_attenuation > 1.0f)
   {
@@ -50,4 +50,12 @@ class CAELimiter
     }
 
     float Run(float* frame[AE_CH_MAX], int channels, int offset = 0, bool planar = false);
+
+    /*! \brief Same as calling Run() for each frame
+     \param gains receives the gain of each of the frames starting at frame offset
+     */
+    void RunFrames(float* frame[AE_CH_MAX], int channels, int frames, float *gains, int offset = 0, bool planar = false);
+
+  private:
+    float Process(float highest);
 };
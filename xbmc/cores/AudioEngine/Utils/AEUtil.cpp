@@ -231,105 +231,6 @@ const char* CAEUtil::DataFormatToStr(const enum AEDataFormat dataFormat)
   return formats[dataFormat];
 }
 
-#if defined(HAVE_SSE) && defined(__SSE__)
-void CAEUtil::SSEMulArray(float *data, const float mul, uint32_t count)
-{
-  const __m128 m = _mm_set_ps1(mul);
-
-  /* work around invalid alignment */
-  while (((uintptr_t)data & 0xF) && count > 0)
-  {
-    data[0] *= mul;
-    ++data;
-    --count;
-  }
-
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4)
-  {
-    __m128 to      = _mm_load_ps(data);
-    *(__m128*)data = _mm_mul_ps (to, m);
-  }
-
-  if (even != count)
-  {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] *= mul;
-    else
-    {
-      __m128 to;
-      if (odd == 2)
-      {
-        to = _mm_setr_ps(data[0], data[1], 0, 0);
-        __m128 ou = _mm_mul_ps(to, m);
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-      }
-      else
-      {
-        to = _mm_setr_ps(data[0], data[1], data[2], 0);
-        __m128 ou = _mm_mul_ps(to, m);
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-        data[2] = ((float*)&ou)[2];
-      }
-    }
-  }
-}
-
-void CAEUtil::SSEMulAddArray(float *data, float *add, const float mul, uint32_t count)
-{
-  const __m128 m = _mm_set_ps1(mul);
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)add & 0xF)) && count > 0)
-  {
-    data[0] += add[0] * mul;
-    ++add;
-    ++data;
-    --count;
-  }
-
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4, add+=4)
-  {
-    __m128 ad      = _mm_load_ps(add );
-    __m128 to      = _mm_load_ps(data);
-    *(__m128*)data = _mm_add_ps (to, _mm_mul_ps(ad, m));
-  }
-
-  if (even != count)
-  {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] += add[0] * mul;
-    else
-    {
-      __m128 ad;
-      __m128 to;
-      if (odd == 2)
-      {
-        ad = _mm_setr_ps(add [0], add [1], 0, 0);
-        to = _mm_setr_ps(data[0], data[1], 0, 0);
-        __m128 ou = _mm_add_ps(to, _mm_mul_ps(ad, m));
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-      }
-      else
-      {
-        ad = _mm_setr_ps(add [0], add [1], add [2], 0);
-        to = _mm_setr_ps(data[0], data[1], data[2], 0);
-        __m128 ou = _mm_add_ps(to, _mm_mul_ps(ad, m));
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-        data[2] = ((float*)&ou)[2];
-      }
-    }
-  }
-}
-#endif
-
 inline float CAEUtil::SoftClamp(const float x)
 {
 #if 1
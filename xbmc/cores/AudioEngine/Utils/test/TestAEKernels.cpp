@@ -0,0 +1,124 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEKernels.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+TEST(TestAEKernels, MulAdd)
+{
+  // odd sizes to run through the vector and the remaining parts
+  const unsigned int count = 19;
+  std::vector<float> data(count), add(count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    data[i] = i * 0.1f;
+    add[i] = 1.0f - i * 0.1f;
+  }
+
+  CAEKernels::MulArray(data.data(), 0.5f, count);
+  EXPECT_FLOAT_EQ(0.9f, data[18]);
+
+  float peak = CAEKernels::MulAddArray(data.data(), add.data(), 2.0f, count);
+  EXPECT_FLOAT_EQ(2.0f, data[0]);
+  EXPECT_FLOAT_EQ(-0.7f, data[18]);
+  EXPECT_FLOAT_EQ(2.0f, peak);
+}
+
+TEST(TestAEKernels, Frames)
+{
+  const unsigned int frames = 7;
+  for (unsigned int channels : { 1u, 2u, 6u, 8u })
+  {
+    std::vector<float> data(frames * channels), gains(frames), peaks(frames, 0.0f);
+    for (unsigned int i = 0; i < data.size(); i++)
+      data[i] = (i % 2 ? -1.0f : 1.0f) * (i / channels + 1) / 10.0f;
+    for (unsigned int f = 0; f < frames; f++)
+      gains[f] = f;
+
+    CAEKernels::PeakFrames(peaks.data(), data.data(), frames, channels);
+    EXPECT_FLOAT_EQ(0.7f, peaks[6]);
+
+    std::vector<float> mix(data);
+    CAEKernels::MulFrames(data.data(), gains.data(), frames, channels);
+    EXPECT_FLOAT_EQ(0.0f, data[0]);
+    EXPECT_FLOAT_EQ(0.2f, std::abs(data[channels]));
+
+    float peak = CAEKernels::MulAddFrames(data.data(), mix.data(), gains.data(), frames, channels);
+    EXPECT_FLOAT_EQ(0.7f * 6 * 2, peak);
+  }
+}
+
+TEST(TestAEKernels, Convert)
+{
+  const float in[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.0f / 32768, 0.25f };
+  const unsigned int count = sizeof(in) / sizeof(in[0]);
+
+  int16_t s16[count];
+  CAEKernels::ConvertFloatToS16(s16, in, count);
+  EXPECT_EQ(16384, s16[1]);
+  EXPECT_EQ(32767, s16[3]);
+  EXPECT_EQ(-32768, s16[4]);
+  EXPECT_EQ(32767, s16[5]);
+  EXPECT_EQ(-32768, s16[6]);
+  EXPECT_EQ(1, s16[7]);
+
+  float out[count];
+  CAEKernels::ConvertS16ToFloat(out, s16, count);
+  EXPECT_FLOAT_EQ(-0.5f, out[2]);
+  EXPECT_FLOAT_EQ(0.25f, out[8]);
+
+  int32_t s32[count];
+  CAEKernels::ConvertFloatToS32(s32, in, count);
+  EXPECT_EQ(1073741824, s32[1]);
+  EXPECT_EQ(2147483647, s32[3]);
+  EXPECT_EQ(-2147483647 - 1, s32[4]);
+  EXPECT_EQ(2147483647, s32[5]);
+
+  CAEKernels::ConvertS32ToFloat(out, s32, count);
+  EXPECT_FLOAT_EQ(-0.5f, out[2]);
+  EXPECT_FLOAT_EQ(-1.0f, out[6]);
+}
+
+TEST(TestAEKernels, Interleave)
+{
+  const unsigned int frames = 9;
+  for (unsigned int channels : { 2u, 6u, 8u })
+  {
+    std::vector<uint32_t> interleaved(frames * channels), result(frames * channels);
+    for (unsigned int i = 0; i < interleaved.size(); i++)
+      interleaved[i] = i;
+
+    std::vector<std::vector<uint32_t>> planes(channels, std::vector<uint32_t>(frames));
+    std::vector<uint32_t*> planePtrs;
+    for (auto &plane : planes)
+      planePtrs.push_back(plane.data());
+
+    CAEKernels::Deinterleave32(planePtrs.data(), interleaved.data(), channels, frames);
+    EXPECT_EQ(channels + 1, planes[1][1]);
+    EXPECT_EQ(frames * channels - 1, planes[channels - 1][frames - 1]);
+
+    CAEKernels::Interleave32(result.data(), planePtrs.data(), channels, frames);
+    EXPECT_EQ(interleaved, result);
+  }
+}
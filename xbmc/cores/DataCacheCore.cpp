@@ -361,3 +361,22 @@ int64_t CDataCacheCore::GetMaxTime()
   CSingleLock lock(m_stateSection);
   return m_timeInfo.m_timeMax;
 }
+
+void CDataCacheCore::SetDemuxPacketPoolStats(uint64_t hits, uint64_t misses)
+{
+  CSingleLock lock(m_stateSection);
+  m_demuxInfo.m_packetPoolHits = hits;
+  m_demuxInfo.m_packetPoolMisses = misses;
+}
+
+uint64_t CDataCacheCore::GetDemuxPacketPoolHits()
+{
+  CSingleLock lock(m_stateSection);
+  return m_demuxInfo.m_packetPoolHits;
+}
+
+uint64_t CDataCacheCore::GetDemuxPacketPoolMisses()
+{
+  CSingleLock lock(m_stateSection);
+  return m_demuxInfo.m_packetPoolMisses;
+}
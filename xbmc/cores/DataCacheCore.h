@@ -113,6 +113,19 @@ public:
    */
   int64_t GetMaxTime();
 
+  // demuxer info
+  void SetDemuxPacketPoolStats(uint64_t hits, uint64_t misses);
+
+  /*!
+   * \brief Get the number of demux packet buffers served from the packet pool
+   */
+  uint64_t GetDemuxPacketPoolHits();
+
+  /*!
+   * \brief Get the number of demux packet buffers that had to be allocated
+   */
+  uint64_t GetDemuxPacketPoolMisses();
+
 protected:
   std::atomic_bool m_hasAVInfoChanges;
 
@@ -163,4 +176,10 @@ protected:
     int64_t m_timeMax;
     int64_t m_timeMin;
   } m_timeInfo = {};
+
+  struct SDemuxInfo
+  {
+    uint64_t m_packetPoolHits;
+    uint64_t m_packetPoolMisses;
+  } m_demuxInfo = {};
 };
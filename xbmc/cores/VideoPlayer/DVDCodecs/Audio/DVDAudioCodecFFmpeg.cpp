@@ -27,6 +27,7 @@
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
 #include "DVDCodecs/DVDCodecs.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
 extern "C" {
 #include "libavutil/opt.h"
 }
@@ -149,6 +150,8 @@ bool CDVDAudioCodecFFmpeg::AddData(const DemuxPacket &packet)
 
   AVPacket avpkt;
   av_init_packet(&avpkt);
+  // let ffmpeg reference the demuxer's buffer instead of copying the payload
+  avpkt.buf = CDVDDemuxUtils::GetPacketBuffer(packet);
   avpkt.data = packet.pData;
   avpkt.size = packet.iSize;
   avpkt.dts = (packet.dts == DVD_NOPTS_VALUE) ? AV_NOPTS_VALUE : static_cast<int64_t>(packet.dts / DVD_TIME_BASE * AV_TIME_BASE);
@@ -21,6 +21,7 @@
 #include "system.h"
 #include "DVDVideoCodecFFmpeg.h"
 #include "DVDDemuxers/DVDDemux.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
 #include "DVDStreamInfo.h"
 #include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
 #include "DVDCodecs/DVDCodecs.h"
@@ -588,6 +589,8 @@ bool CDVDVideoCodecFFmpeg::AddData(const DemuxPacket &packet)
 
   AVPacket avpkt;
   av_init_packet(&avpkt);
+  // let ffmpeg reference the demuxer's buffer instead of copying the payload
+  avpkt.buf = CDVDDemuxUtils::GetPacketBuffer(packet);
   avpkt.data = packet.pData;
   avpkt.size = packet.iSize;
   avpkt.dts = (packet.dts == DVD_NOPTS_VALUE) ? AV_NOPTS_VALUE : static_cast<int64_t>(packet.dts / DVD_TIME_BASE * AV_TIME_BASE);
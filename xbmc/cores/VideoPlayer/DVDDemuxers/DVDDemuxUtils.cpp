@@ -21,8 +21,14 @@
 #include "DVDDemuxUtils.h"
 #include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
 #include "cores/VideoPlayer/Interface/Addon/DemuxCrypto.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
 #ifdef TARGET_POSIX
 #include "platform/linux/XMemUtils.h"
 #endif
@@ -31,12 +37,197 @@ extern "C" {
 #include "libavcodec/avcodec.h"
 }
 
+namespace
+{
+
+/*!
+ * Packets handed out by the pool. If the payload was taken over from an
+ * AVPacket, avBuffer holds the reference to it and pData points into it.
+ */
+struct SPooledDemuxPacket : public DemuxPacket
+{
+  AVBufferRef* avBuffer = nullptr;
+};
+
+/*!
+ * Recycles demux packets and their payload buffers, which otherwise are allocated
+ * and freed for every single packet passing demuxer, message queues and codecs.
+ * Buffers are kept in power of two size classes. Every buffer starts with a small
+ * header holding its size class, pData points right behind it.
+ */
+class CDemuxPacketPool
+{
+public:
+  ~CDemuxPacketPool()
+  {
+    for (auto packet : m_packets)
+      delete packet;
+    for (auto &buffers : m_buffers)
+      for (auto buffer : buffers)
+        _aligned_free(buffer);
+  }
+
+  SPooledDemuxPacket* GetPacket()
+  {
+    {
+      CSingleLock lock(m_section);
+      if (!m_packets.empty())
+      {
+        SPooledDemuxPacket* packet = m_packets.back();
+        m_packets.pop_back();
+        return packet;
+      }
+    }
+    return new SPooledDemuxPacket();
+  }
+
+  void ReturnPacket(SPooledDemuxPacket* packet)
+  {
+    *packet = SPooledDemuxPacket();
+
+    CSingleLock lock(m_section);
+    if (m_packets.size() < MAX_PACKETS)
+    {
+      m_packets.push_back(packet);
+      return;
+    }
+    lock.Leave();
+    delete packet;
+  }
+
+  uint8_t* GetBuffer(size_t size)
+  {
+    size += HEADER_SIZE;
+
+    unsigned int sizeClass = MIN_CLASS;
+    while (sizeClass <= MAX_CLASS && (static_cast<size_t>(1) << sizeClass) < size)
+      sizeClass++;
+
+    uint8_t* buffer = nullptr;
+    if (sizeClass <= MAX_CLASS)
+    {
+      size = static_cast<size_t>(1) << sizeClass;
+
+      CSingleLock lock(m_section);
+      std::vector<uint8_t*> &buffers = m_buffers[sizeClass - MIN_CLASS];
+      if (!buffers.empty())
+      {
+        buffer = buffers.back();
+        buffers.pop_back();
+        m_cachedBytes -= size;
+      }
+    }
+    else
+      sizeClass = UNPOOLED;
+
+    if (buffer)
+      m_hits++;
+    else
+    {
+      m_misses++;
+      buffer = static_cast<uint8_t*>(_aligned_malloc(size, 16));
+      if (!buffer)
+        return nullptr;
+    }
+
+    *reinterpret_cast<unsigned int*>(buffer) = sizeClass;
+    return buffer + HEADER_SIZE;
+  }
+
+  void ReturnBuffer(uint8_t* data)
+  {
+    uint8_t* buffer = data - HEADER_SIZE;
+    unsigned int sizeClass = *reinterpret_cast<unsigned int*>(buffer);
+    if (sizeClass != UNPOOLED)
+    {
+      size_t size = static_cast<size_t>(1) << sizeClass;
+
+      CSingleLock lock(m_section);
+      if (m_cachedBytes + size <= MAX_CACHED_BYTES)
+      {
+        m_buffers[sizeClass - MIN_CLASS].push_back(buffer);
+        m_cachedBytes += size;
+        return;
+      }
+    }
+    _aligned_free(buffer);
+  }
+
+  /*!
+   * Attach a reference counted payload to a packet. The buffer is registered
+   * by its data pointer, so codecs can look it up for any DemuxPacket they get.
+   */
+  bool AttachAVBuffer(SPooledDemuxPacket* packet, AVBufferRef* buffer, uint8_t* data)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (!m_avBuffers.emplace(data, buffer).second)
+        return false;
+    }
+    packet->avBuffer = buffer;
+    packet->pData = data;
+    return true;
+  }
+
+  void DetachAVBuffer(SPooledDemuxPacket* packet)
+  {
+    {
+      CSingleLock lock(m_section);
+      m_avBuffers.erase(packet->pData);
+    }
+    av_buffer_unref(&packet->avBuffer);
+    packet->pData = nullptr;
+  }
+
+  AVBufferRef* FindAVBuffer(const uint8_t* data)
+  {
+    CSingleLock lock(m_section);
+    auto it = m_avBuffers.find(data);
+    if (it == m_avBuffers.end())
+      return nullptr;
+    return it->second;
+  }
+
+  uint64_t GetHits() const { return m_hits; }
+  uint64_t GetMisses() const { return m_misses; }
+
+private:
+  // the header keeps pData aligned to 16 bytes
+  static const size_t HEADER_SIZE = 16;
+  // size classes from 256 bytes to 4 MiB, larger buffers are not recycled
+  static const unsigned int MIN_CLASS = 8;
+  static const unsigned int MAX_CLASS = 22;
+  static const unsigned int UNPOOLED = 0xFF;
+  static const size_t MAX_CACHED_BYTES = 32 * 1024 * 1024;
+  static const size_t MAX_PACKETS = 2048;
+
+  CCriticalSection m_section;
+  std::vector<SPooledDemuxPacket*> m_packets;
+  std::vector<uint8_t*> m_buffers[MAX_CLASS - MIN_CLASS + 1];
+  std::unordered_map<const uint8_t*, AVBufferRef*> m_avBuffers;
+  size_t m_cachedBytes = 0;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
+
+CDemuxPacketPool& GetPacketPool()
+{
+  static CDemuxPacketPool pool;
+  return pool;
+}
+
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
-    if (pPacket->pData)
-      _aligned_free(pPacket->pData);
+    // packets are only ever allocated by the pool
+    SPooledDemuxPacket* pooled = static_cast<SPooledDemuxPacket*>(pPacket);
+    if (pooled->avBuffer)
+      GetPacketPool().DetachAVBuffer(pooled);
+    else if (pPacket->pData)
+      GetPacketPool().ReturnBuffer(pPacket->pData);
     if (pPacket->iSideDataElems)
     {
       AVPacket avPkt;
@@ -45,13 +236,13 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
       avPkt.side_data_elems = pPacket->iSideDataElems;
       av_packet_free_side_data(&avPkt);
     }
-    delete pPacket;
+    GetPacketPool().ReturnPacket(pooled);
   }
 }
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket();
+  DemuxPacket* pPacket = GetPacketPool().GetPacket();
 
   if (iDataSize > 0)
   {
@@ -64,7 +255,7 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
      * Note, if the first 23 bits of the additional bytes are not 0 then damaged
      * MPEG bitstreams could cause overread and segfault
      */
-    pPacket->pData =(uint8_t*)_aligned_malloc(iDataSize + AV_INPUT_BUFFER_PADDING_SIZE, 16);
+    pPacket->pData = GetPacketPool().GetBuffer(iDataSize + AV_INPUT_BUFFER_PADDING_SIZE);
     if (!pPacket->pData)
     {
       FreeDemuxPacket(pPacket);
@@ -86,6 +277,52 @@ DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(unsigned int iDataSize, unsigne
   return ret;
 }
 
+DemuxPacket* CDVDDemuxUtils::MoveDemuxPacket(AVPacket* pkt)
+{
+  // ffmpeg pads reference counted packets the same way we do, only take over
+  // the payload if the padding is really there
+  AVBufferRef* buffer = pkt->buf;
+  if (buffer && pkt->data && pkt->size > 0 &&
+      pkt->data >= buffer->data &&
+      pkt->data + pkt->size + AV_INPUT_BUFFER_PADDING_SIZE <= buffer->data + buffer->size)
+  {
+    SPooledDemuxPacket* pPacket = GetPacketPool().GetPacket();
+    if (GetPacketPool().AttachAVBuffer(pPacket, buffer, pkt->data))
+    {
+      pPacket->iSize = pkt->size;
+
+      // the reference now belongs to the demux packet
+      pkt->buf = nullptr;
+      pkt->data = nullptr;
+      pkt->size = 0;
+
+      return pPacket;
+    }
+    GetPacketPool().ReturnPacket(pPacket);
+  }
+
+  DemuxPacket* pPacket = AllocateDemuxPacket(pkt->size);
+  if (pPacket && pkt->data && pkt->size > 0)
+  {
+    memcpy(pPacket->pData, pkt->data, pkt->size);
+    pPacket->iSize = pkt->size;
+  }
+  return pPacket;
+}
+
+AVBufferRef* CDVDDemuxUtils::GetPacketBuffer(const DemuxPacket &packet)
+{
+  if (!packet.pData)
+    return nullptr;
+  return GetPacketPool().FindAVBuffer(packet.pData);
+}
+
+void CDVDDemuxUtils::GetPacketPoolStats(uint64_t &hits, uint64_t &misses)
+{
+  hits = GetPacketPool().GetHits();
+  misses = GetPacketPool().GetMisses();
+}
+
 void CDVDDemuxUtils::StoreSideData(DemuxPacket *pkt, AVPacket *src)
 {
   AVPacket avPkt;
@@ -32,5 +32,27 @@ public:
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
   static DemuxPacket* AllocateDemuxPacket(unsigned int iDataSize, unsigned int encryptedSubsampleCount);
   static void StoreSideData(DemuxPacket *pkt, AVPacket *src);
+
+  /*!
+   * \brief Allocate a demux packet holding the payload of an ffmpeg packet
+   *
+   * If pkt is reference counted and padded, the packet takes over its buffer
+   * reference instead of copying the payload and pkt is left without data.
+   * Otherwise the payload is copied. Timestamps and side data are not touched.
+   */
+  static DemuxPacket* MoveDemuxPacket(AVPacket* pkt);
+
+  /*!
+   * \brief Get the ffmpeg buffer backing the payload of a packet
+   *
+   * \return the buffer reference owned by the packet or nullptr if the payload
+   *         was copied. The reference stays valid until the packet is freed.
+   */
+  static AVBufferRef* GetPacketBuffer(const DemuxPacket &packet);
+
+  /*!
+   * \brief Get the number of payload buffers served from / missing in the packet pool
+   */
+  static void GetPacketPoolStats(uint64_t &hits, uint64_t &misses);
 };
 
@@ -619,6 +619,14 @@ int64_t CProcessInfo::GetMaxTime()
   return m_timeMax;
 }
 
+void CProcessInfo::SetDemuxPacketPoolStats(uint64_t hits, uint64_t misses)
+{
+  if (m_dataCache)
+  {
+    m_dataCache->SetDemuxPacketPoolStats(hits, misses);
+  }
+}
+
 //******************************************************************************
 // settings
 //******************************************************************************
@@ -111,6 +111,9 @@ public:
   void SetPlayTimes(time_t start, int64_t current, int64_t min, int64_t max);
   int64_t GetMaxTime();
 
+  // demuxer info
+  void SetDemuxPacketPoolStats(uint64_t hits, uint64_t misses);
+
   // settings
   CVideoSettings GetVideoSettings();
   void SetVideoSettings(CVideoSettings &settings);
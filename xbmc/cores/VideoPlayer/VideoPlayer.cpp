@@ -4703,6 +4703,10 @@ void CVideoPlayer::UpdatePlayState(double timeout)
   state.timestamp = m_clock.GetAbsoluteClock();
 
   m_processInfo->SetPlayTimes(state.startTime, state.time, state.timeMin, state.timeMax);
+
+  uint64_t poolHits, poolMisses;
+  CDVDDemuxUtils::GetPacketPoolStats(poolHits, poolMisses);
+  m_processInfo->SetDemuxPacketPoolStats(poolHits, poolMisses);
   
   CSingleLock lock(m_StateSection);
   m_State = state;
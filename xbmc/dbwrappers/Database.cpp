@@ -31,6 +31,9 @@
 #include "DbUrl.h"
 #include "ServiceBroker.h"
 
+#include <algorithm>
+#include <cctype>
+
 #if defined(HAS_MYSQL) || defined(HAS_MARIADB) 
 #include "mysqldataset.h"
 #endif
@@ -42,6 +45,7 @@
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
+#define BATCH_SAVEPOINT "batch_update"
 
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
@@ -157,6 +161,9 @@ CDatabase::CDatabase() :
   m_sqlite = true;
   m_bMultiWrite = false;
   m_multipleExecute = false;
+  m_batchTransaction = false;
+  m_batchDepth = 0;
+  m_searchIndex = false;
 }
 
 CDatabase::~CDatabase(void)
@@ -214,6 +221,26 @@ std::string CDatabase::GetSingleValue(const std::string &query, std::unique_ptr<
   return ret;
 }
 
+std::string CDatabase::GetSingleValue(const std::string &query, const std::vector<field_value> &params, std::unique_ptr<Dataset> &ds)
+{
+  std::string ret;
+  try
+  {
+    if (!m_pDB.get() || !ds.get())
+      return ret;
+
+    if (ds->query(query, params) && ds->num_rows() > 0)
+      ret = ds->fv(0).get_asString();
+
+    ds->close();
+  }
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - failed on query '%s'", __FUNCTION__, query.c_str());
+  }
+  return ret;
+}
+
 std::string CDatabase::GetSingleValue(const std::string &strTable, const std::string &strColumn, const std::string &strWhereClause /* = std::string() */, const std::string &strOrderBy /* = std::string() */)
 {
   std::string query = PrepareSQL("SELECT %s FROM %s", strColumn.c_str(), strTable.c_str());
@@ -491,6 +518,8 @@ bool CDatabase::Connect(const std::string &dbName, const DatabaseSettings &dbSet
       m_pDS->exec("PRAGMA cache_size=4096\n");
       m_pDS->exec("PRAGMA synchronous='NORMAL'\n");
       m_pDS->exec("PRAGMA count_changes='OFF'\n");
+
+      m_searchIndex = !GetSingleValue("SELECT name FROM sqlite_master WHERE type = 'table' AND sql LIKE 'CREATE VIRTUAL TABLE % USING fts5%' LIMIT 1").empty();
     }
   }
   catch (DbErrors &error)
@@ -531,6 +560,9 @@ void CDatabase::Close()
 
   m_openCount = 0;
   m_multipleExecute = false;
+  m_batchTransaction = false;
+  m_batchDepth = 0;
+  m_searchIndex = false;
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
@@ -583,6 +615,14 @@ void CDatabase::Interrupt()
 
 void CDatabase::BeginTransaction()
 {
+  // within a batch each update gets a savepoint, so a failing one only rolls back itself
+  if (m_batchTransaction)
+  {
+    if (m_batchDepth++ == 0 && !m_pDB->start_savepoint(BATCH_SAVEPOINT))
+      CLog::Log(LOGERROR, "database:begintransaction failed to start savepoint");
+    return;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -596,6 +636,16 @@ void CDatabase::BeginTransaction()
 
 bool CDatabase::CommitTransaction()
 {
+  if (m_batchTransaction)
+  {
+    if (m_batchDepth > 0 && --m_batchDepth == 0 && !m_pDB->release_savepoint(BATCH_SAVEPOINT))
+    {
+      CLog::Log(LOGERROR, "database:committransaction failed to release savepoint");
+      return false;
+    }
+    return true;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -611,6 +661,20 @@ bool CDatabase::CommitTransaction()
 
 void CDatabase::RollbackTransaction()
 {
+  if (m_batchTransaction)
+  {
+    if (m_batchDepth == 0)
+      return;
+
+    m_batchDepth = 0;
+    if (m_pDB->rollback_savepoint(BATCH_SAVEPOINT))
+      return;
+
+    // the database may have rolled back the whole transaction by itself on errors
+    CLog::Log(LOGWARNING, "database:rolling back batch transaction");
+    m_batchTransaction = false;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -622,6 +686,30 @@ void CDatabase::RollbackTransaction()
   }
 }
 
+void CDatabase::BeginBatchTransaction()
+{
+  if (m_batchTransaction)
+    return;
+
+  BeginTransaction();
+  m_batchTransaction = true;
+}
+
+bool CDatabase::CommitBatchTransaction()
+{
+  if (!m_batchTransaction)
+    return true;
+
+  m_batchTransaction = false;
+  if (m_batchDepth > 0)
+  {
+    CLog::Log(LOGWARNING, "database:committing batch with %u unfinished updates", m_batchDepth);
+    m_pDB->release_savepoint(BATCH_SAVEPOINT);
+    m_batchDepth = 0;
+  }
+  return CommitTransaction();
+}
+
 bool CDatabase::InTransaction()
 {
   if (NULL != m_pDB.get()) return false;
@@ -675,6 +763,65 @@ bool CDatabase::BuildSQL(const std::string &strQuery, const Filter &filter, std:
   return true;
 }
 
+std::string CDatabase::GetSearchMatch(const std::string &search)
+{
+  // the tokenizer splits on anything but letters and digits, there's nothing to match without them
+  bool hasWords = std::any_of(search.begin(), search.end(), [](char c)
+  {
+    return (static_cast<unsigned char>(c) & 0x80) || isalnum(static_cast<unsigned char>(c));
+  });
+  if (!hasWords)
+    return "";
+
+  std::string phrase(search);
+  StringUtils::Replace(phrase, "\"", "\"\"");
+  return "\"" + phrase + "\"*";
+}
+
+void CDatabase::CreateSearchTable(const std::string &searchTable, const std::string &table, const std::string &idColumn, const std::string &column)
+{
+  if (!m_sqlite || GetSingleValue("SELECT sqlite_compileoption_used('ENABLE_FTS5')") != "1")
+    return;
+
+  CLog::Log(LOGINFO, "create %s table", searchTable.c_str());
+  m_pDS->exec(PrepareSQL("CREATE VIRTUAL TABLE %s USING fts5(%s, content='%s', content_rowid='%s', "
+                         "tokenize='unicode61 remove_diacritics 1', prefix='2 3')",
+                         searchTable.c_str(), column.c_str(), table.c_str(), idColumn.c_str()));
+}
+
+void CDatabase::CreateSearchTriggers(const std::string &searchTable, const std::string &table, const std::string &idColumn, const std::string &column)
+{
+  if (!m_sqlite || GetSingleValue(PrepareSQL("SELECT name FROM sqlite_master WHERE type = 'table' AND name = '%s'", searchTable.c_str())).empty())
+    return;
+
+  CLog::Log(LOGINFO, "%s - rebuilding %s", __FUNCTION__, searchTable.c_str());
+  m_pDS->exec(PrepareSQL("INSERT INTO %s(%s) VALUES ('rebuild')", searchTable.c_str(), searchTable.c_str()));
+
+  // the full text table doesn't store the text, removing it needs the old values
+  std::string insert = PrepareSQL("INSERT INTO %s(rowid, %s) VALUES (new.%s, new.%s);",
+                                  searchTable.c_str(), column.c_str(), idColumn.c_str(), column.c_str());
+  std::string remove = PrepareSQL("INSERT INTO %s(%s, rowid, %s) VALUES ('delete', old.%s, old.%s);",
+                                  searchTable.c_str(), searchTable.c_str(), column.c_str(), idColumn.c_str(), column.c_str());
+  m_pDS->exec(PrepareSQL("CREATE TRIGGER %s_insert AFTER INSERT ON %s BEGIN ", searchTable.c_str(), table.c_str()) + insert + " END");
+  m_pDS->exec(PrepareSQL("CREATE TRIGGER %s_delete AFTER DELETE ON %s BEGIN ", searchTable.c_str(), table.c_str()) + remove + " END");
+  m_pDS->exec(PrepareSQL("CREATE TRIGGER %s_update AFTER UPDATE OF %s ON %s BEGIN ", searchTable.c_str(), column.c_str(), table.c_str()) + remove + " " + insert + " END");
+}
+
+bool CDatabase::GetSearchFilter(const std::string &searchTable, const std::string &idField, const std::string &search, Filter &filter) const
+{
+  if (!m_searchIndex)
+    return false;
+
+  std::string match = GetSearchMatch(search);
+  if (match.empty())
+    return false;
+
+  filter.AppendJoin(PrepareSQL("JOIN %s ON %s.rowid = %s", searchTable.c_str(), searchTable.c_str(), idField.c_str()));
+  filter.AppendWhere(PrepareSQL("%s MATCH '%s'", searchTable.c_str(), match.c_str()));
+  filter.AppendOrder(searchTable + ".rank");
+  return true;
+}
+
 bool CDatabase::BuildSQL(const std::string &strBaseDir, const std::string &strQuery, Filter &filter, std::string &strSQL, CDbUrl &dbUrl)
 {
   SortDescription sorting;
@@ -23,6 +23,7 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class field_value;
 }
 
 #include <memory>
@@ -87,11 +88,44 @@ public:
   virtual bool CommitTransaction();
   void RollbackTransaction();
   bool InTransaction();
+
+  /*!
+   * @brief Start a transaction that spans many updates.
+   *        Transactions begun and committed by the updates themselves are
+   *        merged into it as savepoints until CommitBatchTransaction() is called.
+   *        A rollback only rolls back the update it belongs to.
+   * @sa CommitBatchTransaction, InBatchTransaction
+   */
+  void BeginBatchTransaction();
+
+  /*!
+   * @brief Commit the transaction started by BeginBatchTransaction().
+   * @return True if the batch was committed or no batch was active, false otherwise.
+   * @sa BeginBatchTransaction
+   */
+  bool CommitBatchTransaction();
+
+  bool InBatchTransaction() const { return m_batchTransaction; }
   void CopyDB(const std::string& latestDb);
   void DropAnalytics();
 
   std::string PrepareSQL(std::string strStmt, ...) const;
 
+  /*!
+   * @brief Whether the database has full text search tables (SQLite with FTS5).
+   * @sa GetSearchFilter
+   */
+  bool HasSearchIndex() const { return m_searchIndex; }
+
+  /*!
+   * @brief Get the full text search query for a search as entered by the user.
+   *        The words are matched as a phrase with the last one as a prefix, like
+   *        "LIKE 'search%' OR LIKE '% search%'" matched them.
+   * @param search The search.
+   * @return The query for MATCH, still to be PrepareSQL'ed. Empty if the search has no words.
+   */
+  static std::string GetSearchMatch(const std::string &search);
+
   /*!
    * @brief Get a single value from a table.
    * @remarks The values of the strWhereClause and strOrderBy parameters have to be FormatSQL'ed when used.
@@ -111,6 +145,14 @@ public:
    */
   std::string GetSingleValue(const std::string &query, std::unique_ptr<dbiplus::Dataset> &ds);
 
+  /*! \brief Get a single value from a query with bound parameters on a dataset.
+   \param query the query in question, with '?' placeholders for the parameters.
+   \param params the values for the placeholders.
+   \param ds the dataset to use for the query.
+   \return the value from the query, empty on failure.
+   */
+  std::string GetSingleValue(const std::string &query, const std::vector<dbiplus::field_value> &params, std::unique_ptr<dbiplus::Dataset> &ds);
+
   /*!
    * @brief Delete values from a table.
    * @param strTable The table to delete the values from.
@@ -217,6 +259,32 @@ protected:
 
   bool BuildSQL(const std::string &strQuery, const Filter &filter, std::string &strSQL);
 
+  /*! \brief Create a full text search table (SQLite FTS5) over a text column of a table.
+   Does nothing if the database doesn't support it. The table is kept up to date by the
+   triggers created by CreateSearchTriggers().
+   \param searchTable name of the full text search table
+   \param table the table to index
+   \param idColumn the integer primary key of the table
+   \param column the text column to index
+   */
+  void CreateSearchTable(const std::string &searchTable, const std::string &table, const std::string &idColumn, const std::string &column);
+
+  /*! \brief Create the triggers keeping a full text search table up to date and rebuild its
+   content, as it isn't maintained while the analytics are dropped. Does nothing if the full
+   text search table doesn't exist. Parameters as for CreateSearchTable().
+   */
+  void CreateSearchTriggers(const std::string &searchTable, const std::string &table, const std::string &idColumn, const std::string &column);
+
+  /*! \brief Restrict a query to the rows matching a search through a full text search table,
+   best matches first.
+   \param searchTable the full text search table
+   \param idField the id of the indexed table in the query, e.g. "songview.idSong"
+   \param search the search as entered by the user
+   \param filter [in/out] filter the join, condition and order are added to
+   \return false if there is no search index or the search can't use it, the filter is unchanged then
+   */
+  bool GetSearchFilter(const std::string &searchTable, const std::string &idField, const std::string &search, Filter &filter) const;
+
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
   std::unique_ptr<dbiplus::Database> m_pDB;
@@ -236,4 +304,8 @@ private:
 
   bool m_multipleExecute;
   std::vector<std::string> m_multipleQueries;
+
+  bool m_batchTransaction;
+  unsigned int m_batchDepth; ///< nesting of the transactions of updates within the batch
+  bool m_searchIndex;
 };
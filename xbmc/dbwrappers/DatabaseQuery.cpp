@@ -49,7 +49,8 @@ static const operatorField operators[] = {
   { "notinthelast",    CDatabaseQueryRule::OPERATOR_NOT_IN_THE_LAST,   21411 },
   { "true",            CDatabaseQueryRule::OPERATOR_TRUE,              20122 },
   { "false",           CDatabaseQueryRule::OPERATOR_FALSE,             20424 },
-  { "between",         CDatabaseQueryRule::OPERATOR_BETWEEN,           21456 }
+  { "between",         CDatabaseQueryRule::OPERATOR_BETWEEN,           21456 },
+  { "search",          CDatabaseQueryRule::OPERATOR_SEARCH,            21483 }
 };
 
 static const size_t NUM_OPERATORS = sizeof(operators) / sizeof(operatorField);
@@ -284,6 +285,7 @@ std::string CDatabaseQueryRule::GetOperatorString(SEARCH_OPERATOR op) const
     switch (op)
     {
     case OPERATOR_CONTAINS:
+    case OPERATOR_SEARCH: // without a search index
       operatorString = " LIKE '%%%s%%'"; break;
     case OPERATOR_DOES_NOT_CONTAIN:
       operatorString = " LIKE '%%%s%%'"; break;
@@ -52,6 +52,7 @@ public:
                          OPERATOR_TRUE,
                          OPERATOR_FALSE,
                          OPERATOR_BETWEEN,
+                         OPERATOR_SEARCH,
                          OPERATOR_END
                        };
 
@@ -426,6 +426,50 @@ const field_value Dataset::f_old(const char *f_name) {
   return fv;
 }
 
+std::string Dataset::bind_sql(const std::string &sql, const sql_record &params) {
+  std::string result;
+  result.reserve(sql.size() + params.size() * 16);
+
+  bool inLiteral = false;
+  size_t param = 0;
+  for (size_t i = 0; i < sql.size(); i++) {
+    const char c = sql[i];
+    if (c == '\'')
+      inLiteral = !inLiteral;
+    if (c != '?' || inLiteral) {
+      result += c;
+      continue;
+    }
+    if (param >= params.size())
+      throw DbErrors("Not enough parameters for query: %s", sql.c_str());
+
+    const field_value &value = params[param++];
+    if (value.get_isNull())
+      result += "NULL";
+    else switch (value.get_fType()) {
+    case ft_String:
+    case ft_Char:
+      result += db->prepare("'%s'", value.get_asString().c_str());
+      break;
+    case ft_Boolean:
+      result += value.get_asBool() ? "1" : "0";
+      break;
+    default:
+      result += value.get_asString();
+      break;
+    }
+  }
+  return result;
+}
+
+bool Dataset::query(const std::string &sql, const sql_record &params) {
+  return query(bind_sql(sql, params));
+}
+
+int Dataset::exec(const std::string &sql, const sql_record &params) {
+  return exec(bind_sql(sql, params));
+}
+
 int Dataset::str_compare(const char * s1, const char * s2) {
  	std::string ts1 = s1; 
  	std::string ts2 = s2;
@@ -147,6 +147,12 @@ public:
   virtual void commit_transaction() {};
   virtual void rollback_transaction() {};
 
+/* savepoints within a transaction, false if the database failed to handle it */
+
+  virtual bool start_savepoint(const char *name) { return false; };
+  virtual bool release_savepoint(const char *name) { return false; };
+  virtual bool rollback_savepoint(const char *name) { return false; };
+
 /* virtual methods for formatting */
 
   /*! \brief Prepare a SQL statement for execution or querying using C printf nomenclature.
@@ -263,6 +269,9 @@ protected:
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
+/* Replaces the '?' placeholders outside of string literals with the escaped params */
+  std::string bind_sql(const std::string &sql, const sql_record &params);
+
 public:
 
  virtual int str_compare(const char * s1, const char * s2);
@@ -308,6 +317,15 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exec Sql */
   virtual bool query(const std::string &sql) = 0;
+/* as query/exec, but with the '?' placeholders in sql replaced by params.
+   sql should be a constant template, backends may keep it compiled for reuse */
+  virtual bool query(const std::string &sql, const sql_record &params);
+  virtual int  exec (const std::string &sql, const sql_record &params);
+/* as query, but opens a forward-only cursor: rows are read one at a time by
+   next(), so only first(), next(), eof() and the current record are valid and
+   num_rows() does not count the whole result. Backends without such a cursor
+   run a normal query */
+  virtual bool stream_query(const std::string &sql) { return query(sql); }
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -530,6 +530,29 @@ void MysqlDatabase::rollback_transaction() {
   }
 }
 
+bool MysqlDatabase::start_savepoint(const char *name) {
+  if (!active)
+    return false;
+  std::string sql = std::string("SAVEPOINT ") + name;
+  return mysql_real_query(conn, sql.c_str(), sql.size()) == MYSQL_OK;
+}
+
+bool MysqlDatabase::release_savepoint(const char *name) {
+  if (!active)
+    return false;
+  std::string sql = std::string("RELEASE SAVEPOINT ") + name;
+  return mysql_real_query(conn, sql.c_str(), sql.size()) == MYSQL_OK;
+}
+
+bool MysqlDatabase::rollback_savepoint(const char *name) {
+  if (!active)
+    return false;
+  std::string sql = std::string("ROLLBACK TO SAVEPOINT ") + name;
+  if (mysql_real_query(conn, sql.c_str(), sql.size()) != MYSQL_OK)
+    return false;
+  return release_savepoint(name);
+}
+
 bool MysqlDatabase::exists(void) {
   bool ret = false;
 
@@ -1347,6 +1370,7 @@ MysqlDataset::MysqlDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
 MysqlDataset::MysqlDataset(MysqlDatabase *newDb):Dataset(newDb) {
@@ -1354,9 +1378,11 @@ MysqlDataset::MysqlDataset(MysqlDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
 MysqlDataset::~MysqlDataset() {
+   if (cursor) mysql_free_result(cursor);
    if (errmsg) free(errmsg);
  }
 
@@ -1538,7 +1564,7 @@ const void* MysqlDataset::getExecRes() {
   return &exec_res;
 }
 
-bool MysqlDataset::query(const std::string &query) {
+MYSQL_RES *MysqlDataset::select_result(const std::string &query) {
   if(!handle()) throw DbErrors("No Database Connection");
   std::string qry = query;
   int fs = qry.find("select");
@@ -1554,80 +1580,33 @@ bool MysqlDataset::query(const std::string &query) {
   while ((loc = ci_find(qry, "as integer)")) != std::string::npos)
     qry = qry.insert(loc + 3, "signed ");
 
-  MYSQL_RES *stmt = NULL;
-
   if ( static_cast<MysqlDatabase*>(db)->setErr(static_cast<MysqlDatabase*>(db)->query_with_reconnect(qry.c_str()), qry.c_str()) != MYSQL_OK )
     throw DbErrors(db->getErrorMsg());
 
-  MYSQL* conn = handle();
-  stmt = mysql_store_result(conn);
+  MYSQL_RES *stmt = mysql_store_result(handle());
   if (stmt == NULL)
     throw DbErrors("Missing result set!");
 
   // column headers
   const unsigned int numColumns = mysql_num_fields(stmt);
   MYSQL_FIELD *fields = mysql_fetch_fields(stmt);
-  MYSQL_ROW row;
   result.record_header.resize(numColumns);
   for (unsigned int i = 0; i < numColumns; i++)
     result.record_header[i].name = fields[i].name;
 
+  return stmt;
+}
+
+bool MysqlDataset::query(const std::string &query) {
+  MYSQL_RES *stmt = select_result(query);
+  MYSQL_FIELD *fields = mysql_fetch_fields(stmt);
+  MYSQL_ROW row;
+
   // returned rows
   while ((row = mysql_fetch_row(stmt)))
   { // have a row of data
     sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (fields[i].type)
-      {
-        case MYSQL_TYPE_LONGLONG:
-        case MYSQL_TYPE_DECIMAL:
-        case MYSQL_TYPE_NEWDECIMAL:
-        case MYSQL_TYPE_TINY:
-        case MYSQL_TYPE_SHORT:
-        case MYSQL_TYPE_INT24:
-        case MYSQL_TYPE_LONG:
-          if (row[i] != NULL)
-          {
-            v.set_asInt(atoi(row[i]));
-          }
-          else
-          {
-            v.set_asInt(0);
-          }
-          break;
-        case MYSQL_TYPE_FLOAT:
-        case MYSQL_TYPE_DOUBLE:
-          if (row[i] != NULL)
-          {
-            v.set_asDouble(atof(row[i]));
-          }
-          else
-          {
-            v.set_asDouble(0);
-          }
-          break;
-        case MYSQL_TYPE_STRING:
-        case MYSQL_TYPE_VAR_STRING:
-        case MYSQL_TYPE_VARCHAR:
-          if (row[i] != NULL) v.set_asString((const char *)row[i] );
-          break;
-        case MYSQL_TYPE_TINY_BLOB:
-        case MYSQL_TYPE_MEDIUM_BLOB:
-        case MYSQL_TYPE_LONG_BLOB:
-        case MYSQL_TYPE_BLOB:
-          if (row[i] != NULL) v.set_asString((const char *)row[i]);
-          break;
-        case MYSQL_TYPE_NULL:
-        default:
-          CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
-          v.set_asString("");
-          v.set_isNull();
-          break;
-      }
-    }
+    read_row(row, fields, *res);
     result.records.push_back(res);
   }
   mysql_free_result(stmt);
@@ -1637,6 +1616,99 @@ bool MysqlDataset::query(const std::string &query) {
   return true;
 }
 
+void MysqlDataset::read_row(MYSQL_ROW row, MYSQL_FIELD *fields, sql_record &rec) {
+  // records are reused while streaming, so every value starts out blank
+  const unsigned int numColumns = result.record_header.size();
+  rec.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = rec[i];
+    v = field_value();
+    switch (fields[i].type)
+    {
+      case MYSQL_TYPE_LONGLONG:
+      case MYSQL_TYPE_DECIMAL:
+      case MYSQL_TYPE_NEWDECIMAL:
+      case MYSQL_TYPE_TINY:
+      case MYSQL_TYPE_SHORT:
+      case MYSQL_TYPE_INT24:
+      case MYSQL_TYPE_LONG:
+        if (row[i] != NULL)
+        {
+          v.set_asInt(atoi(row[i]));
+        }
+        else
+        {
+          v.set_asInt(0);
+        }
+        break;
+      case MYSQL_TYPE_FLOAT:
+      case MYSQL_TYPE_DOUBLE:
+        if (row[i] != NULL)
+        {
+          v.set_asDouble(atof(row[i]));
+        }
+        else
+        {
+          v.set_asDouble(0);
+        }
+        break;
+      case MYSQL_TYPE_STRING:
+      case MYSQL_TYPE_VAR_STRING:
+      case MYSQL_TYPE_VARCHAR:
+        if (row[i] != NULL) v.set_asString((const char *)row[i] );
+        break;
+      case MYSQL_TYPE_TINY_BLOB:
+      case MYSQL_TYPE_MEDIUM_BLOB:
+      case MYSQL_TYPE_LONG_BLOB:
+      case MYSQL_TYPE_BLOB:
+        if (row[i] != NULL) v.set_asString((const char *)row[i]);
+        break;
+      case MYSQL_TYPE_NULL:
+      default:
+        CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
+        v.set_asString("");
+        v.set_isNull();
+        break;
+    }
+  }
+}
+
+bool MysqlDataset::stream_query(const std::string &query) {
+  // the result is still transferred as a whole, mysql_use_result would block
+  // any other query on the connection until all rows are read. Only the
+  // conversion into records is done row by row.
+  cursor = select_result(query);
+
+  fetch_next();
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+bool MysqlDataset::fetch_next() {
+  if (!cursor)
+    return false;
+
+  MYSQL_ROW row = mysql_fetch_row(cursor);
+  if (row)
+  {
+    if (result.records.empty())
+      result.records.push_back(new sql_record);
+    read_row(row, mysql_fetch_fields(cursor), *result.records[0]);
+    return true;
+  }
+
+  mysql_free_result(cursor);
+  cursor = NULL;
+  for (auto record : result.records)
+    delete record;
+  result.records.clear();
+  return false;
+}
+
 void MysqlDataset::open(const std::string &sql) {
    set_select_sql(sql);
    open();
@@ -1655,6 +1727,11 @@ void MysqlDataset::open() {
 
 void MysqlDataset::close() {
   Dataset::close();
+  if (cursor)
+  {
+    mysql_free_result(cursor);
+    cursor = NULL;
+  }
   result.clear();
   edit_object->clear();
   fields_object->clear();
@@ -1700,6 +1777,16 @@ void MysqlDataset::prev(void) {
 }
 
 void MysqlDataset::next(void) {
+  if (cursor)
+  {
+    // streaming, the next row replaces the current one
+    fbof = false;
+    if (fetch_next())
+      fill_fields();
+    else
+      feof = true;
+    return;
+  }
   Dataset::next();
   if (!eof())
       fill_fields();
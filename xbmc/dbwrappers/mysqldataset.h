@@ -82,6 +82,9 @@ public:
   void start_transaction() override;
   void commit_transaction() override;
   void rollback_transaction() override;
+  bool start_savepoint(const char *name) override;
+  bool release_savepoint(const char *name) override;
+  bool rollback_savepoint(const char *name) override;
 
 /* virtual methods for formatting */
   std::string vprepare(const char *format, va_list args) override;
@@ -131,6 +134,15 @@ protected:
   void fill_fields() override;
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
+/* Runs a select query and reads its column headers, the caller frees the returned result */
+  MYSQL_RES *select_result(const std::string &query);
+/* Converts a row of the result into rec */
+  void read_row(MYSQL_ROW row, MYSQL_FIELD *fields, sql_record &rec);
+/* Converts the next row of the streaming result, replacing the current record. Returns false at the end */
+  bool fetch_next();
+
+/* result of a streaming query, NULL unless streaming */
+  MYSQL_RES *cursor;
 
 public:
 /* constructor */
@@ -153,6 +165,8 @@ or insert() operations default = false) */
   const void* getExecRes() override;
 /* as open, but with our query exec Sql */
   bool query(const std::string &query) override;
+/* converts the rows of the result one by one in next() */
+  bool stream_query(const std::string &query) override;
 /* func. closes a query */
   void close(void) override;
 /* Cancel changes, made in insert or edit states of dataset */
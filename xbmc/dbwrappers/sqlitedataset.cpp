@@ -37,6 +37,8 @@
 #include "platform/linux/XTimeUtils.h"
 #endif
 
+#define MAX_CACHED_STATEMENTS 64
+
 namespace dbiplus {
 //************* Callback function ***************************
 
@@ -256,10 +258,37 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clearStatements();
   sqlite3_close(conn);
   active = false;
 }
 
+sqlite3_stmt *SqliteDatabase::getStatement(const std::string &sql) {
+  auto it = statements.find(sql);
+  if (it != statements.end())
+    return it->second;
+
+  // most statements are used by a few hot paths only, don't let one off
+  // queries grow the cache forever
+  if (statements.size() >= MAX_CACHED_STATEMENTS)
+    clearStatements();
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+  {
+    sqlite3_finalize(stmt);
+    throw DbErrors(getErrorMsg());
+  }
+  statements.insert(std::make_pair(sql, stmt));
+  return stmt;
+}
+
+void SqliteDatabase::clearStatements() {
+  for (auto &it : statements)
+    sqlite3_finalize(it.second);
+  statements.clear();
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -410,6 +439,30 @@ void SqliteDatabase::rollback_transaction() {
   }  
 }
 
+bool SqliteDatabase::start_savepoint(const char *name) {
+  if (!active)
+    return false;
+  std::string sql = std::string("SAVEPOINT ") + name;
+  return sqlite3_exec(conn, sql.c_str(), NULL, NULL, NULL) == SQLITE_OK;
+}
+
+bool SqliteDatabase::release_savepoint(const char *name) {
+  if (!active)
+    return false;
+  std::string sql = std::string("RELEASE SAVEPOINT ") + name;
+  return sqlite3_exec(conn, sql.c_str(), NULL, NULL, NULL) == SQLITE_OK;
+}
+
+bool SqliteDatabase::rollback_savepoint(const char *name) {
+  if (!active)
+    return false;
+  // rolling back to a savepoint keeps it, it still has to be released
+  std::string sql = std::string("ROLLBACK TO SAVEPOINT ") + name;
+  if (sqlite3_exec(conn, sql.c_str(), NULL, NULL, NULL) != SQLITE_OK)
+    return false;
+  return release_savepoint(name);
+}
+
 
 // methods for formatting
 // ---------------------------------------------
@@ -450,6 +503,7 @@ SqliteDataset::SqliteDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
 
@@ -458,9 +512,11 @@ SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
  SqliteDataset::~SqliteDataset(){
+   if (cursor) sqlite3_finalize(cursor);
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -649,54 +705,206 @@ bool SqliteDataset::query(const std::string &query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&stmt, NULL),query.c_str()) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
-  // column headers
+  fetch_rows(stmt);
+  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const std::string &query, const sql_record &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  if (query.find("select") == std::string::npos && query.find("SELECT") == std::string::npos)
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(query);
+  try
+  {
+    bind_params(stmt, params, query);
+    fetch_rows(stmt);
+  }
+  catch (...)
+  {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    throw;
+  }
+
+  // an error of the last step is reported by reset
+  int res = sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(res,query.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+int SqliteDataset::exec(const std::string &sql, const sql_record &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql);
+  try
+  {
+    bind_params(stmt, params, sql);
+  }
+  catch (...)
+  {
+    sqlite3_clear_bindings(stmt);
+    throw;
+  }
+
+  while (sqlite3_step(stmt) == SQLITE_ROW)
+    ;
+  int res = sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(res,sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return res;
+}
+
+void SqliteDataset::bind_params(sqlite3_stmt *stmt, const sql_record &params, const std::string &sql) {
+  if (sqlite3_bind_parameter_count(stmt) != static_cast<int>(params.size()))
+    throw DbErrors("Parameter count mismatch for query: %s", sql.c_str());
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int res;
+    if (v.get_isNull())
+      res = sqlite3_bind_null(stmt, i + 1);
+    else switch (v.get_fType())
+    {
+    case ft_Boolean:
+    case ft_Short:
+    case ft_UShort:
+    case ft_Int:
+    case ft_UInt:
+    case ft_Int64:
+      res = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+      break;
+    case ft_Float:
+    case ft_Double:
+      res = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+      break;
+    default:
+      {
+        const std::string str = v.get_asString();
+        res = sqlite3_bind_text(stmt, i + 1, str.c_str(), str.size(), SQLITE_TRANSIENT);
+      }
+      break;
+    }
+    if (db->setErr(res,sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+}
+
+void SqliteDataset::fetch_header(sqlite3_stmt *stmt) {
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
   for (unsigned int i = 0; i < numColumns; i++)
     result.record_header[i].name = sqlite3_column_name(stmt, i);
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
+  // column headers
+  fetch_header(stmt);
 
   // returned rows
   while (sqlite3_step(stmt) == SQLITE_ROW)
   { // have a row of data
     sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
+    read_row(stmt, *res);
+    result.records.push_back(res);
+  }
+}
+
+void SqliteDataset::read_row(sqlite3_stmt *stmt, sql_record &rec) {
+  // records are reused while streaming, so every value is assigned as a
+  // whole to also reset the null flag
+  const unsigned int numColumns = result.record_header.size();
+  rec.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    field_value &v = rec[i];
+    switch (sqlite3_column_type(stmt, i))
     {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
+    case SQLITE_INTEGER:
+      v = field_value(static_cast<int64_t>(sqlite3_column_int64(stmt, i)));
+      break;
+    case SQLITE_FLOAT:
+      v = field_value(sqlite3_column_double(stmt, i));
+      break;
+    case SQLITE_TEXT:
+    case SQLITE_BLOB:
+      v = field_value((const char *)sqlite3_column_text(stmt, i));
+      break;
+    case SQLITE_NULL:
+    default:
+      v = field_value("");
+      v.set_isNull();
+      break;
     }
-    result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query.c_str()) == SQLITE_OK)
+}
+
+bool SqliteDataset::stream_query(const std::string &query) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  if (query.find("select") == std::string::npos && query.find("SELECT") == std::string::npos)
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&cursor, NULL),query.c_str()) != SQLITE_OK)
   {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
+    sqlite3_finalize(cursor);
+    cursor = NULL;
+    throw DbErrors(db->getErrorMsg());
   }
-  else
+
+  fetch_header(cursor);
+  fetch_next();
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+bool SqliteDataset::fetch_next() {
+  if (!cursor)
+    return false;
+
+  int res = sqlite3_step(cursor);
+  if (res == SQLITE_ROW)
   {
+    if (result.records.empty())
+      result.records.push_back(new sql_record);
+    read_row(cursor, *result.records[0]);
+    return true;
+  }
+
+  // end of the result, finalize reports any error of the last step
+  res = sqlite3_finalize(cursor);
+  cursor = NULL;
+  for (auto record : result.records)
+    delete record;
+  result.records.clear();
+  if (db->setErr(res,"stream_query") != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
-  }  
+  return false;
 }
 
 void SqliteDataset::open(const std::string &sql) {
@@ -716,6 +924,11 @@ void SqliteDataset::open() {
 
 void SqliteDataset::close() {
   Dataset::close();
+  if (cursor)
+  {
+    sqlite3_finalize(cursor);
+    cursor = NULL;
+  }
   result.clear();
   edit_object->clear();
   fields_object->clear();
@@ -765,6 +978,16 @@ void SqliteDataset::prev(void) {
 }
 
 void SqliteDataset::next(void) {
+  if (cursor)
+  {
+    // streaming, the next row replaces the current one
+    fbof = false;
+    if (fetch_next())
+      fill_fields();
+    else
+      feof = true;
+    return;
+  }
   Dataset::next();
   if (!eof()) 
       fill_fields();
@@ -29,6 +29,7 @@
  **********************************************************************/
 
 #include <stdio.h>
+#include <unordered_map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -44,6 +45,8 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* compiled statements of queries with bound parameters, by sql */
+  std::unordered_map<std::string, sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -55,6 +58,11 @@ public:
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
+/* func. returns the cached compiled statement for sql, compiling it if needed.
+   The statement must be reset after use, it is owned by the database */
+  sqlite3_stmt *getStatement(const std::string &sql);
+/* func. finalizes all cached statements */
+  void clearStatements();
 /* func. returns current status about SQLite-server connection */
   int status() override;
   int setErr(int err_code,const char * qry) override;
@@ -90,6 +98,9 @@ public:
   void start_transaction() override;
   void commit_transaction() override;
   void rollback_transaction() override;
+  bool start_savepoint(const char *name) override;
+  bool release_savepoint(const char *name) override;
+  bool rollback_savepoint(const char *name) override;
 
 /* virtual methods for formatting */
   std::string vprepare(const char *format, va_list args) override;
@@ -126,6 +137,19 @@ protected:
   void fill_fields() override;
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
+/* Binds params to the placeholders of stmt */
+  void bind_params(sqlite3_stmt *stmt, const sql_record &params, const std::string &sql);
+/* Reads the column headers of stmt into the result */
+  void fetch_header(sqlite3_stmt *stmt);
+/* Reads the column headers and all rows of stmt into the result */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* Reads the current row of stmt into rec */
+  void read_row(sqlite3_stmt *stmt, sql_record &rec);
+/* Steps the streaming cursor, replacing the current record. Returns false at the end */
+  bool fetch_next();
+
+/* statement of a streaming query, NULL unless streaming */
+  sqlite3_stmt *cursor;
 
 public:
 /* constructor */
@@ -148,6 +172,11 @@ or insert() operations default = false) */
   const void* getExecRes() override;
 /* as open, but with our query exec Sql */
   bool query(const std::string &query) override;
+/* as query/exec, using a cached compiled statement with typed parameters */
+  bool query(const std::string &query, const sql_record &params) override;
+  int  exec (const std::string &sql, const sql_record &params) override;
+/* forward-only cursor, rows are stepped in next() */
+  bool stream_query(const std::string &query) override;
 /* func. closes a query */
   void close(void) override;
 /* Cancel changes, made in insert or edit states of dataset */
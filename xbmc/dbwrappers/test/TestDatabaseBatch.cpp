@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/Database.h"
+#include "dbwrappers/dataset.h"
+#include "test/TestDatabase.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+  /* episodes added the way CVideoInfoScanner::OnProcessSeriesFolder adds them */
+  class CBatchTestDatabase : public CDatabase
+  {
+  public:
+    /* an update like SetDetailsForEpisode, rolling back its own transaction on errors */
+    bool SetEpisode(const std::string &title, bool fail)
+    {
+      try
+      {
+        BeginTransaction();
+        m_pDS->exec(PrepareSQL("INSERT INTO episode (strTitle) VALUES ('%s')", title.c_str()));
+        if (fail)
+          m_pDS->exec("INSERT INTO nosuchtable (strTitle) VALUES ('fail')");
+        CommitTransaction();
+        return true;
+      }
+      catch (...)
+      {
+        RollbackTransaction();
+        return false;
+      }
+    }
+
+    /* what the scanner does per episode, the file is added before the details */
+    bool AddEpisode(const std::string &title, bool fail)
+    {
+      BeginTransaction();
+      m_pDS->exec(PrepareSQL("INSERT INTO files (strFilename) VALUES ('%s.mkv')", title.c_str()));
+      if (!SetEpisode(title, fail))
+      {
+        RollbackTransaction();
+        return false;
+      }
+      CommitTransaction();
+      return true;
+    }
+
+    std::vector<std::string> GetColumn(const std::string &sql)
+    {
+      std::vector<std::string> values;
+      m_pDS->query(sql);
+      while (!m_pDS->eof())
+      {
+        values.push_back(m_pDS->fv(0).get_asString());
+        m_pDS->next();
+      }
+      m_pDS->close();
+      return values;
+    }
+
+  protected:
+    void CreateTables() override
+    {
+      m_pDS->exec("CREATE TABLE files (idFile integer primary key, strFilename text)");
+      m_pDS->exec("CREATE TABLE episode (idEpisode integer primary key, strTitle text)");
+    }
+
+    void CreateAnalytics() override
+    {
+    }
+
+    int GetSchemaVersion() const override { return 1; }
+    const char *GetBaseDBName() const override { return "TestDatabaseBatch"; }
+  };
+}
+
+class TestDatabaseBatch : public testing::Test
+{
+protected:
+  TestDatabaseBatch() : m_file(m_db, "TestDatabaseBatch")
+  {
+  }
+
+  CBatchTestDatabase m_db;
+  CTestDatabase m_file;
+};
+
+TEST_F(TestDatabaseBatch, FailedUpdateKeepsBatch)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  m_db.BeginBatchTransaction();
+  EXPECT_TRUE(m_db.SetEpisode("Pilot", false));
+  EXPECT_FALSE(m_db.SetEpisode("Broken", true));
+  EXPECT_TRUE(m_db.InBatchTransaction());
+  EXPECT_TRUE(m_db.SetEpisode("Finale", false));
+  EXPECT_TRUE(m_db.CommitBatchTransaction());
+
+  EXPECT_EQ(std::vector<std::string>({ "Pilot", "Finale" }),
+            m_db.GetColumn("SELECT strTitle FROM episode ORDER BY idEpisode"));
+}
+
+TEST_F(TestDatabaseBatch, FailedEpisodeRollsBackOnlyItself)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  m_db.BeginBatchTransaction();
+  EXPECT_TRUE(m_db.AddEpisode("Pilot", false));
+  EXPECT_TRUE(m_db.AddEpisode("Second", false));
+  EXPECT_FALSE(m_db.AddEpisode("Broken", true));
+  EXPECT_TRUE(m_db.AddEpisode("Finale", false));
+  EXPECT_TRUE(m_db.CommitBatchTransaction());
+
+  // the file of the failed episode is gone with its details
+  EXPECT_EQ(std::vector<std::string>({ "Pilot", "Second", "Finale" }),
+            m_db.GetColumn("SELECT strTitle FROM episode ORDER BY idEpisode"));
+  EXPECT_EQ(std::vector<std::string>({ "Pilot.mkv", "Second.mkv", "Finale.mkv" }),
+            m_db.GetColumn("SELECT strFilename FROM files ORDER BY idFile"));
+}
+
+TEST_F(TestDatabaseBatch, TransactionsOutsideBatch)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  EXPECT_TRUE(m_db.SetEpisode("Pilot", false));
+  EXPECT_FALSE(m_db.SetEpisode("Broken", true));
+  EXPECT_FALSE(m_db.InBatchTransaction());
+
+  EXPECT_EQ(std::vector<std::string>({ "Pilot" }),
+            m_db.GetColumn("SELECT strTitle FROM episode ORDER BY idEpisode"));
+}
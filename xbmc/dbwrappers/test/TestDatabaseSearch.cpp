@@ -0,0 +1,132 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/Database.h"
+#include "dbwrappers/dataset.h"
+#include "test/TestDatabase.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace dbiplus;
+
+namespace
+{
+  /* a song table searched like CMusicDatabase::SearchSongs does it */
+  class CSearchTestDatabase : public CDatabase
+  {
+  public:
+    using CDatabase::BuildSQL;
+    using CDatabase::GetSearchFilter;
+
+    Dataset& DS() { return *m_pDS; }
+
+  protected:
+    void CreateTables() override
+    {
+      m_pDS->exec("CREATE TABLE song (idSong integer primary key, strTitle varchar(512))");
+      CreateSearchTable("songsearch", "song", "idSong", "strTitle");
+    }
+
+    void CreateAnalytics() override
+    {
+      m_pDS->exec("CREATE INDEX idxSong ON song(strTitle(255))");
+      CreateSearchTriggers("songsearch", "song", "idSong", "strTitle");
+    }
+
+    int GetSchemaVersion() const override { return 1; }
+    const char *GetBaseDBName() const override { return "TestDatabaseSearch"; }
+  };
+}
+
+class TestDatabaseSearch : public testing::Test
+{
+protected:
+  TestDatabaseSearch() : m_file(m_db, "TestDatabaseSearch")
+  {
+  }
+
+  std::vector<std::string> Search(const std::string &search)
+  {
+    CDatabase::Filter filter;
+    if (!m_db.GetSearchFilter("songsearch", "song.idSong", search, filter))
+      filter.AppendWhere(m_db.PrepareSQL("strTitle like '%s%%' or strTitle like '%% %s%%'", search.c_str(), search.c_str()));
+
+    std::string sql;
+    m_db.BuildSQL("select song.* from song ", filter, sql);
+
+    std::vector<std::string> titles;
+    m_db.DS().query(sql);
+    while (!m_db.DS().eof())
+    {
+      titles.push_back(m_db.DS().fv(1).get_asString());
+      m_db.DS().next();
+    }
+    m_db.DS().close();
+    return titles;
+  }
+
+  CSearchTestDatabase m_db;
+  CTestDatabase m_file;
+};
+
+TEST(TestDatabaseSearchMatch, GetSearchMatch)
+{
+  EXPECT_EQ("\"hey ju\"*", CDatabase::GetSearchMatch("hey ju"));
+  EXPECT_EQ("\"say \"\"hi\"\"\"*", CDatabase::GetSearchMatch("say \"hi\""));
+  EXPECT_EQ("\"\xc3\xa9\"*", CDatabase::GetSearchMatch("\xc3\xa9"));
+  EXPECT_EQ("", CDatabase::GetSearchMatch(" ?!- "));
+}
+
+TEST_F(TestDatabaseSearch, Search)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+  if (!m_db.HasSearchIndex())
+    return; // sqlite built without FTS5, searches fall back to LIKE
+
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('Hey Jude')");
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('J\xc3\xbc" "dische Lieder')");
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('AC/DC: Back in Black')");
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('Yesterday')");
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('Yesterday Once More, Once More Again')");
+  m_db.DS().exec("INSERT INTO song (strTitle) VALUES ('Let It Be')");
+
+  EXPECT_EQ(std::vector<std::string>({ "Hey Jude" }), Search("hey ju"));
+  EXPECT_EQ(2u, Search("jud").size()); // diacritics don't matter
+  EXPECT_EQ(1u, Search("ac/dc back").size());
+  EXPECT_EQ(0u, Search("esterday").size()); // words match from their start only
+
+  // best match first
+  EXPECT_EQ(std::vector<std::string>({ "Yesterday", "Yesterday Once More, Once More Again" }), Search("yester"));
+
+  // the triggers keep the index up to date
+  m_db.DS().exec("UPDATE song SET strTitle='Let It Go' WHERE strTitle='Let It Be'");
+  EXPECT_EQ(0u, Search("let it be").size());
+  EXPECT_EQ(1u, Search("let it go").size());
+  m_db.DS().exec("DELETE FROM song WHERE strTitle='Hey Jude'");
+  EXPECT_EQ(0u, Search("hey").size());
+
+  // a search without words falls back to LIKE
+  CDatabase::Filter filter;
+  EXPECT_FALSE(m_db.GetSearchFilter("songsearch", "song.idSong", "!?", filter));
+  EXPECT_TRUE(filter.join.empty());
+}
@@ -0,0 +1,127 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/SpecialProtocol.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <memory>
+
+using namespace dbiplus;
+
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    m_path = CSpecialProtocol::TranslatePath("special://temp/");
+    m_db.setHostName(m_path.c_str());
+    m_db.setDatabase("TestSqliteDataset");
+    m_path += "TestSqliteDataset.db";
+    m_db.connect(true);
+    m_ds.reset(m_db.CreateDataset());
+    m_ds->exec("DROP TABLE IF EXISTS files");
+    m_ds->exec("DROP TABLE IF EXISTS art");
+    m_ds->exec("CREATE TABLE files (idFile integer primary key, idPath integer, strFileName text)");
+    m_ds->exec("CREATE UNIQUE INDEX ix_files ON files (idPath, strFileName)");
+    m_ds->exec("CREATE TABLE art (art_id integer primary key, media_id integer, media_type text, type text, url text)");
+    m_ds->exec("CREATE INDEX ix_art ON art (media_id, media_type, type)");
+  }
+
+  ~TestSqliteDataset() override
+  {
+    m_ds.reset();
+    m_db.disconnect();
+    std::remove(m_path.c_str());
+  }
+
+  std::string m_path;
+  SqliteDatabase m_db;
+  std::unique_ptr<Dataset> m_ds;
+};
+
+TEST_F(TestSqliteDataset, BindParams)
+{
+  m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (?, ?)", { field_value(1), field_value("it's.mkv") });
+  m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (?, ?)", { field_value(1), field_value("other.mkv") });
+  int64_t id = m_ds->lastinsertid();
+
+  ASSERT_TRUE(m_ds->query("SELECT idFile, strFileName FROM files WHERE idPath=? AND strFileName=?",
+                          { field_value(1), field_value("it's.mkv") }));
+  ASSERT_EQ(1, m_ds->num_rows());
+  EXPECT_EQ(ft_Int64, m_ds->fv(0).get_fType());
+  EXPECT_EQ("it's.mkv", m_ds->fv("strFileName").get_asString());
+  m_ds->close();
+
+  // the cached statement is reused with other values
+  ASSERT_TRUE(m_ds->query("SELECT idFile, strFileName FROM files WHERE idPath=? AND strFileName=?",
+                          { field_value(1), field_value("other.mkv") }));
+  ASSERT_EQ(1, m_ds->num_rows());
+  EXPECT_EQ(id, m_ds->fv(0).get_asInt64());
+  m_ds->close();
+
+  // '?' within literals is no placeholder
+  field_value null;
+  null.set_isNull();
+  m_ds->exec("UPDATE files SET strFileName=? WHERE strFileName='?' OR idFile=?", { null, field_value(id) });
+  ASSERT_TRUE(m_ds->query("SELECT strFileName FROM files WHERE idFile=?", { field_value(id) }));
+  EXPECT_TRUE(m_ds->fv(0).get_isNull());
+  m_ds->close();
+
+  EXPECT_THROW(m_ds->query("SELECT * FROM files WHERE idFile=?", sql_record()), DbErrors);
+  EXPECT_THROW(m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (?, ?)", { field_value(1), field_value("it's.mkv") }), DbErrors);
+}
+
+TEST_F(TestSqliteDataset, StreamQuery)
+{
+  m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (1, 'a.mkv')");
+  m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (2, NULL)");
+  m_ds->exec("INSERT INTO files (idPath, strFileName) VALUES (3, 'c.mkv')");
+
+  ASSERT_TRUE(m_ds->stream_query("SELECT idPath, strFileName FROM files ORDER BY idPath"));
+  std::string names;
+  int rows = 0;
+  while (!m_ds->eof())
+  {
+    const sql_record *record = m_ds->get_sql_record();
+    EXPECT_EQ(++rows, record->at(0).get_asInt());
+    EXPECT_EQ(rows == 2, record->at(1).get_isNull());
+    names += record->at(1).get_asString() + ";";
+    m_ds->next();
+  }
+  m_ds->close();
+  EXPECT_EQ(3, rows);
+  EXPECT_EQ("a.mkv;;c.mkv;", names);
+
+  // an empty result is at eof right away
+  ASSERT_TRUE(m_ds->stream_query("SELECT idPath FROM files WHERE idPath > 3"));
+  EXPECT_TRUE(m_ds->eof());
+  m_ds->close();
+
+  // closing in the middle of the rows releases the cursor
+  ASSERT_TRUE(m_ds->stream_query("SELECT idPath FROM files ORDER BY idPath"));
+  EXPECT_EQ(1, m_ds->fv(0).get_asInt());
+  m_ds->close();
+  m_ds->exec("DELETE FROM files");
+
+  EXPECT_THROW(m_ds->stream_query("SELECT * FROM nonexisting"), DbErrors);
+}
@@ -25,69 +25,79 @@
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
 #include "URL.h"
-#include "climits"
 
-#include <algorithm>
+#include <inttypes.h>
 
-// Maximum number of directories to keep in our cache
-#define MAX_CACHED_DIRS 50
+// Estimated number of bytes the folders which may be evicted can use
+#define MAX_CACHED_BYTES (32 * 1024 * 1024)
 
 using namespace XFILE;
 
-CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
+CDirectoryCache::CDir::CDir(const std::string &path, DIR_CACHE_TYPE cacheType, std::shared_ptr<CFileItemList> items)
+  : m_path(path)
+  , m_Items(std::move(items))
+  , m_cacheType(cacheType)
 {
-  m_cacheType = cacheType;
-  m_lastAccess = 0;
-  m_Items = new CFileItemList;
-  m_Items->SetIgnoreURLOptions(true);
-  m_Items->SetFastLookup(true);
+  m_size = EstimateSize(*m_Items);
 }
 
-CDirectoryCache::CDir::~CDir()
+CDirectoryCache::CDir::~CDir() = default;
+
+size_t CDirectoryCache::CDir::EstimateSize(const CFileItemList &items)
 {
-  delete m_Items;
+  size_t size = sizeof(CFileItemList) + items.GetPath().capacity();
+  for (int i = 0; i < items.Size(); i++)
+    size += EstimateSize(*items[i]);
+  return size;
 }
 
-void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
+size_t CDirectoryCache::CDir::EstimateSize(const CFileItem &item)
 {
-  m_lastAccess = accessCounter++;
+  // the item, its shared_ptr control block and the fast lookup entry
+  return sizeof(CFileItem) + 2 * item.GetPath().capacity() + 96 +
+         item.GetLabel().capacity() + item.GetLabel2().capacity();
 }
 
 CDirectoryCache::CDirectoryCache(void)
+  : m_maxSize(MAX_CACHED_BYTES)
 {
-  m_accessCounter = 0;
-#ifdef _DEBUG
-  m_cacheHits = 0;
-  m_cacheMisses = 0;
-#endif
 }
 
 CDirectoryCache::~CDirectoryCache(void) = default;
 
 bool CDirectoryCache::GetDirectory(const std::string& strPath, CFileItemList &items, bool retrieveAll)
 {
-  CSingleLock lock (m_cs);
+  std::shared_ptr<CFileItemList> cached;
+  {
+    CSingleLock lock (m_cs);
 
-  // Get rid of any URL options, else the compare may be wrong
-  std::string storedPath = CURL(strPath).GetWithoutOptions();
-  URIUtils::RemoveSlashAtEnd(storedPath);
+    // Get rid of any URL options, else the compare may be wrong
+    std::string storedPath = CURL(strPath).GetWithoutOptions();
+    URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
-  {
-    CDir* dir = i->second;
-    if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
-       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+    ciCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
+    {
+      CDir* dir = i->second;
+      if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
+         (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+      {
+        cached = dir->m_Items;
+        Touch(dir);
+        m_cacheHits++;
+      }
+    }
+    if (!cached)
     {
-      items.Copy(*dir->m_Items);
-      dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
-      return true;
+      m_cacheMisses++;
+      return false;
     }
   }
-  return false;
+
+  // the list is not modified while we hold a reference, so the (expensive)
+  // copy for the caller does not need to block the cache
+  items.Copy(*cached);
+  return true;
 }
 
 void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
@@ -106,20 +116,29 @@ void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemLi
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
-  CSingleLock lock (m_cs);
+  std::shared_ptr<CFileItemList> copy(new CFileItemList);
+  copy->SetIgnoreURLOptions(true);
+  copy->SetFastLookup(true);
+  copy->Copy(items);
 
   // Get rid of any URL options, else the compare may be wrong
   std::string storedPath = CURL(strPath).GetWithoutOptions();
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ClearDirectory(storedPath);
+  CDir* dir = new CDir(storedPath, cacheType, std::move(copy));
 
-  CheckIfFull();
+  CSingleLock lock (m_cs);
+
+  ClearDirectory(storedPath);
 
-  CDir* dir = new CDir(cacheType);
-  dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
   m_cache.insert(std::pair<std::string, CDir*>(storedPath, dir));
+  if (cacheType != DIR_CACHE_ALWAYS)
+  {
+    LinkFront(dir);
+    m_size += dir->m_size;
+  }
+
+  CheckIfFull();
 }
 
 void CDirectoryCache::ClearFile(const std::string& strFile)
@@ -172,9 +191,24 @@ void CDirectoryCache::AddFile(const std::string& strFile)
   if (i != m_cache.end())
   {
     CDir *dir = i->second;
+    if (dir->m_Items.use_count() > 1)
+    {
+      // a reader is still copying the list, modify a copy of our own
+      std::shared_ptr<CFileItemList> copy(new CFileItemList);
+      copy->SetIgnoreURLOptions(true);
+      copy->SetFastLookup(true);
+      copy->Copy(*dir->m_Items);
+      dir->m_Items = std::move(copy);
+    }
     CFileItemPtr item(new CFileItem(strFile, false));
     dir->m_Items->Add(item);
-    dir->SetLastAccess(m_accessCounter);
+
+    // only the new item adds to the estimate, the rest of the list is unchanged
+    size_t size = CDir::EstimateSize(*item);
+    if (dir->m_cacheType != DIR_CACHE_ALWAYS)
+      m_size += size;
+    dir->m_size += size;
+    Touch(dir);
   }
 }
 
@@ -194,15 +228,11 @@ bool CDirectoryCache::FileExists(const std::string& strFile, bool& bInCache)
   {
     bInCache = true;
     CDir *dir = i->second;
-    dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
+    Touch(dir);
     m_cacheHits++;
-#endif
     return (URIUtils::PathEquals(strPath, storedPath) || dir->m_Items->Contains(strFile));
   }
-#ifdef _DEBUG
   m_cacheMisses++;
-#endif
   return false;
 }
 
@@ -216,6 +246,13 @@ void CDirectoryCache::Clear()
     Delete(i++);
 }
 
+void CDirectoryCache::SetMaxSize(size_t bytes)
+{
+  CSingleLock lock (m_cs);
+  m_maxSize = bytes;
+  CheckIfFull();
+}
+
 void CDirectoryCache::InitCache(std::set<std::string>& dirs)
 {
   std::set<std::string>::iterator it;
@@ -244,46 +281,81 @@ void CDirectoryCache::CheckIfFull()
 {
   CSingleLock lock (m_cs);
 
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  // drop the least recently used folders until we are within budget, but
+  // always keep the most recent one, even if it is larger than the budget
+  while (m_size > m_maxSize && m_lruTail && m_lruTail != m_lruHead)
   {
-    // ensure dirs that are always cached aren't cleared
-    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
-    {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
-        lastAccessed = i;
-      numCached++;
-    }
+    Delete(m_cache.find(m_lruTail->m_path));
+    m_evictions++;
   }
-  if (lastAccessed != m_cache.end() && numCached >= MAX_CACHED_DIRS)
-    Delete(lastAccessed);
 }
 
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  if (dir->m_cacheType != DIR_CACHE_ALWAYS)
+  {
+    Unlink(dir);
+    m_size -= dir->m_size;
+  }
   delete dir;
   m_cache.erase(it);
 }
 
-#ifdef _DEBUG
-void CDirectoryCache::PrintStats() const
+void CDirectoryCache::LinkFront(CDir* dir)
+{
+  dir->m_prev = nullptr;
+  dir->m_next = m_lruHead;
+  if (m_lruHead)
+    m_lruHead->m_prev = dir;
+  m_lruHead = dir;
+  if (!m_lruTail)
+    m_lruTail = dir;
+}
+
+void CDirectoryCache::Unlink(CDir* dir)
+{
+  if (dir->m_prev)
+    dir->m_prev->m_next = dir->m_next;
+  else
+    m_lruHead = dir->m_next;
+  if (dir->m_next)
+    dir->m_next->m_prev = dir->m_prev;
+  else
+    m_lruTail = dir->m_prev;
+  dir->m_prev = dir->m_next = nullptr;
+}
+
+void CDirectoryCache::Touch(CDir* dir)
+{
+  if (dir->m_cacheType == DIR_CACHE_ALWAYS || dir == m_lruHead)
+    return;
+  Unlink(dir);
+  LinkFront(dir);
+}
+
+CDirectoryCache::Stats CDirectoryCache::GetStats() const
 {
   CSingleLock lock (m_cs);
-  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, m_cacheHits, m_cacheMisses);
-  // run through and find the oldest and the number of items cached
-  unsigned int oldest = UINT_MAX;
-  unsigned int numItems = 0;
-  unsigned int numDirs = 0;
+  Stats stats;
+  stats.hits = m_cacheHits;
+  stats.misses = m_cacheMisses;
+  stats.evictions = m_evictions;
+  stats.size = m_size;
+  stats.maxSize = m_maxSize;
   for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
   {
-    CDir *dir = i->second;
-    oldest = std::min(oldest, dir->GetLastAccess());
-    numItems += dir->m_Items->Size();
-    numDirs++;
+    stats.items += i->second->m_Items->Size();
+    stats.folders++;
   }
-  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total.  Oldest is %u, current is %u", __FUNCTION__, numDirs, numItems, oldest, m_accessCounter);
+  return stats;
+}
+
+void CDirectoryCache::PrintStats() const
+{
+  Stats stats = GetStats();
+  CLog::Log(LOGDEBUG, "%s - total of %" PRIu64 " cache hits, %" PRIu64 " cache misses and %" PRIu64 " evictions",
+            __FUNCTION__, stats.hits, stats.misses, stats.evictions);
+  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total, using about %zu of %zu bytes",
+            __FUNCTION__, stats.folders, stats.items, stats.size, stats.maxSize);
 }
-#endif
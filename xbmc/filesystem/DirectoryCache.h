@@ -24,7 +24,9 @@
 #include "threads/CriticalSection.h"
 
 #include <map>
+#include <memory>
 #include <set>
+#include <stdint.h>
 
 class CFileItem;
 
@@ -35,18 +37,32 @@ namespace XFILE
     class CDir
     {
     public:
-      explicit CDir(DIR_CACHE_TYPE cacheType);
+      CDir(const std::string &path, DIR_CACHE_TYPE cacheType, std::shared_ptr<CFileItemList> items);
       virtual ~CDir();
 
-      void SetLastAccess(unsigned int &accessCounter);
-      unsigned int GetLastAccess() const { return m_lastAccess; };
+      /*!
+       \brief Estimate the memory used by a cached list, used for the cache budget
+       */
+      static size_t EstimateSize(const CFileItemList &items);
 
-      CFileItemList* m_Items;
+      /*!
+       \brief Estimate the memory used by an item of a cached list
+       */
+      static size_t EstimateSize(const CFileItem &item);
+
+      const std::string m_path;
+      // shared with readers copying it outside of the cache lock, so it
+      // must not be modified once there is more than one reference
+      std::shared_ptr<CFileItemList> m_Items;
       DIR_CACHE_TYPE m_cacheType;
+      size_t m_size;
+
+      // intrusive LRU list, most recently used first
+      CDir* m_prev = nullptr;
+      CDir* m_next = nullptr;
     private:
       CDir(const CDir&) = delete;
       CDir& operator=(const CDir&) = delete;
-      unsigned int m_lastAccess;
     };
   public:
     CDirectoryCache(void);
@@ -59,9 +75,24 @@ namespace XFILE
     void Clear();
     void AddFile(const std::string& strFile);
     bool FileExists(const std::string& strPath, bool& bInCache);
-#ifdef _DEBUG
+
+    /*!
+     \brief Set the estimated number of bytes the evictable folders may use
+     */
+    void SetMaxSize(size_t bytes);
+
+    struct Stats
+    {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t evictions = 0;
+      unsigned int folders = 0;
+      unsigned int items = 0;
+      size_t size = 0;
+      size_t maxSize = 0;
+    };
+    Stats GetStats() const;
     void PrintStats() const;
-#endif
   protected:
     void InitCache(std::set<std::string>& dirs);
     void ClearCache(std::set<std::string>& dirs);
@@ -72,14 +103,21 @@ namespace XFILE
     typedef std::map<std::string, CDir*>::const_iterator ciCache;
     void Delete(iCache i);
 
+    void LinkFront(CDir* dir);
+    void Unlink(CDir* dir);
+    void Touch(CDir* dir);
+
     CCriticalSection m_cs;
 
-    unsigned int m_accessCounter;
+    // folders which may be evicted, DIR_CACHE_ALWAYS folders are never in it
+    CDir* m_lruHead = nullptr;
+    CDir* m_lruTail = nullptr;
+    size_t m_size = 0;
+    size_t m_maxSize;
 
-#ifdef _DEBUG
-    unsigned int m_cacheHits;
-    unsigned int m_cacheMisses;
-#endif
+    uint64_t m_cacheHits = 0;
+    uint64_t m_cacheMisses = 0;
+    uint64_t m_evictions = 0;
   };
 }
 extern XFILE::CDirectoryCache g_directoryCache;
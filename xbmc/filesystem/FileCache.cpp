@@ -25,6 +25,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "RangeFetcher.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -44,6 +45,8 @@
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (128*1024)
+#define RANGE_SEGMENT_SIZE    (1024*1024)
+#define RANGE_RUN_SEGMENTS    4
 
 class CWriteRate
 {
@@ -254,6 +257,21 @@ void CFileCache::Process()
     return;
   }
 
+  /* internet streams of a known size are fetched over several ranged requests at once,
+   * a single connection rarely gets the full bandwidth over high latency links
+   */
+  std::unique_ptr<CRangeFetcher> fetcher;
+  CURL url(m_sourcePath);
+  if (m_seekPossible > 0 && m_fileSize > 2 * RANGE_SEGMENT_SIZE && g_advancedSettings.m_cacheRangeConnections > 1 &&
+      (url.IsProtocol("http") || url.IsProtocol("https")))
+  {
+    /* each connection reads a run of RANGE_RUN_SEGMENTS segments on one request */
+    size_t readAhead = RANGE_SEGMENT_SIZE * g_advancedSettings.m_cacheRangeConnections * RANGE_RUN_SEGMENTS;
+    size_t retain = RANGE_SEGMENT_SIZE * g_advancedSettings.m_cacheRangeConnections * 2;
+    fetcher.reset(new CRangeFetcher(m_sourcePath, m_fileSize, g_advancedSettings.m_cacheRangeConnections,
+                                    RANGE_SEGMENT_SIZE, readAhead, retain));
+  }
+
   CWriteRate limiter;
   CWriteRate average;
   bool cacheReachEOF = false;
@@ -272,7 +290,10 @@ void CFileCache::Process()
       bool sourceSeekFailed = false;
       if (!cacheReachEOF)
       {
-        m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
+        if (fetcher)
+          m_nSeekResult = fetcher->Seek(cacheMaxPos);
+        else
+          m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
         {
           CLog::Log(LOGERROR,"CFileCache::Process - Error %d seeking. Seek returned %" PRId64, (int)GetLastError(), m_nSeekResult);
@@ -325,7 +346,21 @@ void CFileCache::Process()
     }
 
     ssize_t iRead = 0;
-    if (!cacheReachEOF)
+    if (!cacheReachEOF && fetcher)
+    {
+      iRead = fetcher->Read(m_writePos, buffer.get(), maxWrite, 100);
+      if (iRead == RANGE_RC_WOULD_BLOCK)
+        continue;
+
+      if (iRead < 0)
+      {
+        CLog::Log(LOGWARNING, "CFileCache::Process - ranged fetch failed at %" PRId64 ", continuing on a single connection", m_writePos);
+        fetcher.reset();
+        if (m_source.Seek(m_writePos, SEEK_SET) == m_writePos)
+          iRead = m_source.Read(buffer.get(), maxWrite);
+      }
+    }
+    else if (!cacheReachEOF)
       iRead = m_source.Read(buffer.get(), maxWrite);
     if (iRead == 0)
     {
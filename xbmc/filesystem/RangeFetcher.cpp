@@ -0,0 +1,445 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RangeFetcher.h"
+#include "File.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef TARGET_POSIX
+#include "platform/linux/ConvUtils.h"
+#endif
+
+using namespace XFILE;
+
+#define RANGE_READ_SIZE       (64*1024)
+#define RANGE_ADAPT_INTERVAL  2000
+
+class CRangeFetcher::CConnection : public CThread
+{
+public:
+  CConnection(CRangeFetcher& fetcher, unsigned int index)
+    : CThread("RangeFetcher")
+    , m_fetcher(fetcher)
+    , m_index(index)
+    , m_opened(false)
+  {
+  }
+
+  ~CConnection() override
+  {
+    StopThread();
+  }
+
+protected:
+  void Process() override
+  {
+    while (!m_bStop)
+    {
+      SegmentPtr segment;
+      {
+        CSingleLock lock(m_fetcher.m_sync);
+        while (!m_bStop && !(segment = m_fetcher.Claim(m_index)))
+          m_fetcher.m_work.wait(lock, 500);
+      }
+      if (!segment)
+        break;
+
+      m_fetcher.Release(segment, !Fetch(segment));
+    }
+    m_file.Close();
+  }
+
+private:
+  bool Open(int64_t position)
+  {
+    m_file.Close();
+    m_opened = m_file.Open(m_fetcher.m_path, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED);
+    if (!m_opened)
+      return false;
+
+    bool retry = false;
+    m_file.IoControl(IOCTRL_SET_RETRY, &retry);
+    return position == 0 || m_file.Seek(position, SEEK_SET) == position;
+  }
+
+  bool Fetch(const SegmentPtr& segment)
+  {
+    // a segment following the last one continues on the open request, anything else is a new range
+    int64_t position = segment->start;
+    if (!m_opened || (m_file.GetPosition() != position && m_file.Seek(position, SEEK_SET) != position))
+    {
+      if (!Open(position))
+      {
+        CLog::Log(LOGERROR, "CRangeFetcher - failed to request range at %" PRId64 " of %s", position, m_fetcher.m_path.c_str());
+        return false;
+      }
+    }
+
+    bool retried = false;
+    size_t done = 0;
+    while (done < segment->size && !m_bStop)
+    {
+      ssize_t read = m_file.Read(m_buffer, std::min(sizeof(m_buffer), segment->size - done));
+      if (read <= 0)
+      {
+        // connections get dropped by servers, give it one more go from where we are
+        if (retried || !Open(position + done))
+        {
+          CLog::Log(LOGERROR, "CRangeFetcher - failed to read range at %" PRId64 " of %s", position + done, m_fetcher.m_path.c_str());
+          m_opened = false;
+          return false;
+        }
+        retried = true;
+        continue;
+      }
+
+      if (!m_fetcher.Fill(segment, m_buffer, read))
+        break;
+      done += read;
+    }
+    return true;
+  }
+
+  CRangeFetcher& m_fetcher;
+  unsigned int m_index;
+  CFile m_file;
+  bool m_opened;
+  char m_buffer[RANGE_READ_SIZE];
+};
+
+CRangeFetcher::CRangeFetcher(const std::string& path, int64_t fileSize, unsigned int maxConnections,
+                             size_t segmentSize, size_t readAhead, size_t retain)
+  : m_path(path)
+  , m_fileSize(fileSize)
+  , m_segmentSize(segmentSize)
+  , m_readAhead(std::max(readAhead, segmentSize))
+  , m_retain(retain)
+  , m_runSize(std::max(m_readAhead / std::max(maxConnections, 1u) / segmentSize, (size_t)1) * segmentSize)
+  , m_position(0)
+  , m_cursor(0)
+  , m_runs(std::max(maxConnections, 1u), Run(0, 0))
+  , m_connections(std::min(std::max(maxConnections, 1u), 2u))
+  , m_lastRate(0)
+  , m_rateStamp(XbmcThreads::SystemClockMillis())
+  , m_rateBytes(0)
+{
+  for (unsigned int i = 0; i < std::max(maxConnections, 1u); i++)
+  {
+    m_workers.emplace_back(new CConnection(*this, i));
+    m_workers.back()->Create();
+  }
+}
+
+CRangeFetcher::~CRangeFetcher()
+{
+  for (auto& worker : m_workers)
+    worker->StopThread(false);
+  {
+    CSingleLock lock(m_sync);
+    for (auto& segment : m_segments)
+      segment.second->abandoned = true;
+    m_work.notifyAll();
+  }
+  m_workers.clear();
+}
+
+unsigned int CRangeFetcher::GetConnections() const
+{
+  CSingleLock lock(m_sync);
+  return m_connections;
+}
+
+CRangeFetcher::SegmentMap::iterator CRangeFetcher::Find(int64_t position)
+{
+  SegmentMap::iterator it = m_segments.upper_bound(position);
+  if (it == m_segments.begin())
+    return m_segments.end();
+
+  --it;
+  if (position < it->first + (int64_t)it->second->size)
+    return it;
+  return m_segments.end();
+}
+
+int64_t CRangeFetcher::Seek(int64_t position)
+{
+  CSingleLock lock(m_sync);
+
+  // the fetched or scheduled segments following the new position are kept going
+  m_position = position;
+  m_cursor = ScheduledEnd(position);
+
+  // so are the runs within them, the connections on runs elsewhere start new ones
+  for (auto& run : m_runs)
+  {
+    if (run.second <= m_position || run.first >= m_cursor)
+      run = Run(0, 0);
+    else
+      run.first = std::max(run.first, m_position);
+  }
+
+  // incomplete segments anywhere else are of no use now
+  for (SegmentMap::iterator it = m_segments.begin(); it != m_segments.end();)
+  {
+    CSegment& segment = *it->second;
+    bool active = segment.start + (int64_t)segment.size > m_position && segment.start < m_cursor;
+    if (segment.failed || (!active && segment.filled < segment.size))
+    {
+      segment.abandoned = true;
+      it = m_segments.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  Evict();
+  m_work.notifyAll();
+  return position;
+}
+
+ssize_t CRangeFetcher::Read(int64_t position, char* buffer, size_t size, unsigned int timeoutMs)
+{
+  CSingleLock lock(m_sync);
+
+  if (position >= m_fileSize)
+    return 0;
+
+  if (position != m_position)
+    Seek(position);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (;;)
+  {
+    SegmentMap::iterator it = Find(position);
+    if (it != m_segments.end())
+    {
+      CSegment& segment = *it->second;
+      size_t offset = (size_t)(position - segment.start);
+      if (segment.filled > offset)
+      {
+        size_t len = std::min(size, segment.filled - offset);
+        memcpy(buffer, segment.data.get() + offset, len);
+        m_position = position + len;
+
+        if (offset + len == segment.size)
+          Evict();
+        AdaptConnections();
+        m_work.notifyAll();
+        return len;
+      }
+
+      if (segment.failed)
+        return RANGE_RC_ERROR;
+    }
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+    if (elapsed >= timeoutMs)
+      return RANGE_RC_WOULD_BLOCK;
+    m_data.wait(lock, timeoutMs - elapsed);
+  }
+}
+
+CRangeFetcher::SegmentPtr CRangeFetcher::Claim(unsigned int connection)
+{
+  Run& run = m_runs[connection];
+  if (connection >= m_connections)
+  {
+    // the rest of the run is left to the connections still in use
+    run = Run(0, 0);
+    return SegmentPtr();
+  }
+
+  for (;;)
+  {
+    if (run.first >= run.second && !Reserve(run))
+      return SegmentPtr();
+
+    // the run is kept until the reader catches up
+    if (run.first - m_position >= (int64_t)m_readAhead)
+      return SegmentPtr();
+
+    // skip over segments kept from before
+    SegmentMap::iterator next = m_segments.lower_bound(run.first);
+    if (next != m_segments.end() && next->first == run.first)
+    {
+      run.first += next->second->size;
+      continue;
+    }
+
+    int64_t end = std::min(run.first + (int64_t)m_segmentSize, run.second);
+    if (next != m_segments.end())
+      end = std::min(end, next->first);
+
+    SegmentPtr segment(new CSegment());
+    segment->start = run.first;
+    segment->size = (size_t)(end - run.first);
+    segment->filled = 0;
+    segment->fetching = true;
+    segment->failed = false;
+    segment->abandoned = false;
+    segment->data.reset(new char[segment->size]);
+
+    m_segments.insert(std::make_pair(segment->start, segment));
+    run.first = end;
+    return segment;
+  }
+}
+
+bool CRangeFetcher::Reserve(Run& run)
+{
+  // the first gap from the reader on, left by segments and the runs of the other connections
+  int64_t start = ScheduledEnd(m_position);
+  if (start >= m_fileSize || start - m_position >= (int64_t)m_readAhead)
+    return false;
+
+  int64_t end = std::min(start + m_runSize, m_fileSize);
+  SegmentMap::iterator next = m_segments.upper_bound(start);
+  if (next != m_segments.end())
+    end = std::min(end, next->first);
+  for (const auto& other : m_runs)
+  {
+    if (other.first < other.second && other.first > start)
+      end = std::min(end, other.first);
+  }
+
+  run = Run(start, end);
+  m_cursor = std::max(m_cursor, end);
+  return true;
+}
+
+int64_t CRangeFetcher::ScheduledEnd(int64_t position)
+{
+  for (bool moved = true; moved && position < m_fileSize;)
+  {
+    moved = false;
+    SegmentMap::iterator it = Find(position);
+    if (it != m_segments.end())
+    {
+      position = it->first + it->second->size;
+      moved = true;
+    }
+
+    for (const auto& run : m_runs)
+    {
+      if (run.first <= position && position < run.second)
+      {
+        position = run.second;
+        moved = true;
+      }
+    }
+  }
+  return position;
+}
+
+bool CRangeFetcher::Fill(const SegmentPtr& segment, const char* data, size_t size)
+{
+  // only the fetching connection writes past filled, readers never look there
+  if (segment->abandoned.load())
+    return false;
+  memcpy(segment->data.get() + segment->filled, data, size);
+
+  CSingleLock lock(m_sync);
+  if (segment->abandoned)
+    return false;
+  segment->filled += size;
+  m_rateBytes += size;
+  m_data.notifyAll();
+  return true;
+}
+
+void CRangeFetcher::Release(const SegmentPtr& segment, bool failed)
+{
+  CSingleLock lock(m_sync);
+  segment->fetching = false;
+  if (segment->abandoned)
+    return;
+
+  if (failed || segment->filled < segment->size)
+    segment->failed = true;
+  m_data.notifyAll();
+}
+
+void CRangeFetcher::Evict()
+{
+  // complete segments outside of [m_position, m_cursor) are kept for seeks, furthest away go first
+  std::vector<std::pair<int64_t, int64_t>> kept;
+  size_t keptSize = 0;
+  for (SegmentMap::const_iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    int64_t end = it->first + it->second->size;
+    if (end <= m_position)
+      kept.push_back(std::make_pair(m_position - end, it->first));
+    else if (it->first >= m_cursor)
+      kept.push_back(std::make_pair(it->first - m_cursor, it->first));
+    else
+      continue;
+    keptSize += it->second->size;
+  }
+
+  if (keptSize <= m_retain)
+    return;
+
+  std::sort(kept.begin(), kept.end());
+  while (keptSize > m_retain && !kept.empty())
+  {
+    SegmentMap::iterator it = m_segments.find(kept.back().second);
+    keptSize -= it->second->size;
+    it->second->abandoned = true;
+    m_segments.erase(it);
+    kept.pop_back();
+  }
+}
+
+void CRangeFetcher::AdaptConnections()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  unsigned int elapsed = now - m_rateStamp;
+  if (elapsed < RANGE_ADAPT_INTERVAL)
+    return;
+
+  unsigned int rate = (unsigned int)(1000 * m_rateBytes / elapsed);
+  m_rateStamp = now;
+  m_rateBytes = 0;
+
+  // with the read ahead full it's the reader that sets the pace, that says nothing about the connections
+  if (m_cursor >= m_fileSize || m_cursor - m_position >= (int64_t)m_readAhead)
+    return;
+
+  unsigned int connections = m_connections;
+  if (m_lastRate == 0 || rate > m_lastRate + m_lastRate / 10)
+    connections = std::min(m_connections + 1, (unsigned int)m_workers.size());
+  else if (rate < m_lastRate - m_lastRate / 10 && m_connections > 1)
+    connections = m_connections - 1;
+  m_lastRate = rate;
+
+  if (connections != m_connections)
+  {
+    CLog::Log(LOGDEBUG, "CRangeFetcher - %u bytes/s on %u connections, now using %u", rate, m_connections, connections);
+    m_connections = connections;
+    m_work.notifyAll();
+  }
+}
@@ -0,0 +1,131 @@
+#pragma once
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PlatformDefs.h" // for ssize_t
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace XFILE
+{
+
+#define RANGE_RC_ERROR       -1
+#define RANGE_RC_WOULD_BLOCK -2
+
+/*!
+ \brief Fetches a file over several connections at once.
+
+ The file is split into segments which are requested with separate ranged reads
+ on up to maxConnections connections, so a single slow stream doesn't limit the
+ throughput. Each connection is given a run of consecutive segments, so it keeps
+ reading on its open request instead of requesting every segment anew. Segments
+ complete out of order but are handed out in file order by Read(). The number of
+ connections in use follows the observed throughput.
+
+ Segments that were already fetched are kept (up to the retain size) when the
+ position moves, so seeking back into them doesn't need the source again.
+ */
+class CRangeFetcher
+{
+public:
+  CRangeFetcher(const std::string& path, int64_t fileSize, unsigned int maxConnections,
+                size_t segmentSize, size_t readAhead, size_t retain);
+  ~CRangeFetcher();
+
+  /*!
+   \brief Move the fetch position, abandoning segments that are still being fetched elsewhere
+   \param position the new position in the file
+   \return the new position
+   */
+  int64_t Seek(int64_t position);
+
+  /*!
+   \brief Read fetched data at the given position
+   \param position position in the file to read from, seeks if it isn't fetched or scheduled
+   \param buffer buffer to copy the data to
+   \param size size of the buffer
+   \param timeoutMs time to wait for the data to arrive
+   \return number of bytes read, 0 at the end of the file, RANGE_RC_WOULD_BLOCK if no data
+           arrived within the timeout or RANGE_RC_ERROR if fetching the data failed
+   */
+  ssize_t Read(int64_t position, char* buffer, size_t size, unsigned int timeoutMs);
+
+  /*!
+   \brief Number of connections currently used for fetching
+   */
+  unsigned int GetConnections() const;
+
+private:
+  class CConnection;
+
+  struct CSegment
+  {
+    int64_t start;
+    size_t size;
+    size_t filled;
+    bool fetching;
+    bool failed;
+    std::atomic<bool> abandoned; /**< also checked by the fetching connection without the lock */
+    std::unique_ptr<char[]> data;
+  };
+  typedef std::shared_ptr<CSegment> SegmentPtr;
+  typedef std::map<int64_t, SegmentPtr> SegmentMap;
+
+  typedef std::pair<int64_t, int64_t> Run;
+
+  SegmentPtr Claim(unsigned int connection);
+  bool Reserve(Run& run);
+  int64_t ScheduledEnd(int64_t position);
+  bool Fill(const SegmentPtr& segment, const char* data, size_t size);
+  void Release(const SegmentPtr& segment, bool failed);
+  SegmentMap::iterator Find(int64_t position);
+  void Evict();
+  void AdaptConnections();
+
+  std::string m_path;
+  int64_t m_fileSize;
+  size_t m_segmentSize;
+  size_t m_readAhead;
+  size_t m_retain;
+  int64_t m_runSize;
+
+  SegmentMap m_segments;
+  int64_t m_position;       /**< position of the next read */
+  int64_t m_cursor;         /**< end of the range fetched or scheduled from m_position */
+  std::vector<Run> m_runs;  /**< per connection, the part of its run [first, second) it hasn't claimed yet */
+  unsigned int m_connections;
+  unsigned int m_lastRate;
+  unsigned int m_rateStamp;
+  int64_t m_rateBytes;
+
+  std::vector<std::unique_ptr<CConnection>> m_workers;
+  mutable CCriticalSection m_sync;
+  XbmcThreads::ConditionVariable m_work;
+  XbmcThreads::ConditionVariable m_data;
+};
+
+}
@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "filesystem/DirectoryCache.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+void FillList(CFileItemList &items, const std::string &path, int count)
+{
+  items.SetPath(path);
+  for (int i = 0; i < count; i++)
+    items.Add(CFileItemPtr(new CFileItem(path + "file" + std::to_string(i) + ".mkv", false)));
+}
+}
+
+TEST(TestDirectoryCache, GetDirectory)
+{
+  CDirectoryCache cache;
+  CFileItemList items;
+  FillList(items, "/media/a/", 10);
+  cache.SetDirectory("/media/a/", items, DIR_CACHE_ONCE);
+
+  CFileItemList cached;
+  EXPECT_FALSE(cache.GetDirectory("/media/a/", cached));
+  EXPECT_TRUE(cache.GetDirectory("/media/a/", cached, true));
+  EXPECT_EQ(10, cached.Size());
+
+  // the caller gets its own items
+  cached[0]->SetPath("/media/a/changed.mkv");
+  bool inCache;
+  EXPECT_TRUE(cache.FileExists("/media/a/file0.mkv", inCache));
+  EXPECT_TRUE(inCache);
+
+  CDirectoryCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+}
+
+TEST(TestDirectoryCache, EvictLeastRecentlyUsed)
+{
+  CDirectoryCache cache;
+  CFileItemList a, b, c;
+  FillList(a, "/media/a/", 100);
+  FillList(b, "/media/b/", 100);
+  FillList(c, "/media/c/", 100);
+
+  cache.SetDirectory("/media/a/", a, DIR_CACHE_ONCE);
+  cache.SetDirectory("/media/b/", b, DIR_CACHE_ONCE);
+  size_t twoFolders = cache.GetStats().size;
+  cache.SetMaxSize(twoFolders);
+
+  // a is used more recently than b now, so b goes first
+  CFileItemList items;
+  EXPECT_TRUE(cache.GetDirectory("/media/a/", items, true));
+  cache.SetDirectory("/media/c/", c, DIR_CACHE_ONCE);
+
+  EXPECT_TRUE(cache.GetDirectory("/media/a/", items, true));
+  EXPECT_FALSE(cache.GetDirectory("/media/b/", items, true));
+  EXPECT_TRUE(cache.GetDirectory("/media/c/", items, true));
+
+  CDirectoryCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1u, stats.evictions);
+  EXPECT_EQ(2u, stats.folders);
+  EXPECT_LE(stats.size, twoFolders);
+}
+
+TEST(TestDirectoryCache, AlwaysCachedNotEvicted)
+{
+  CDirectoryCache cache;
+  CFileItemList a, b;
+  FillList(a, "/media/a/", 100);
+  FillList(b, "/media/b/", 100);
+
+  cache.SetMaxSize(1);
+  cache.SetDirectory("/media/a/", a, DIR_CACHE_ALWAYS);
+  cache.SetDirectory("/media/b/", b, DIR_CACHE_ONCE);
+
+  CFileItemList items;
+  EXPECT_TRUE(cache.GetDirectory("/media/a/", items));
+  EXPECT_TRUE(cache.GetDirectory("/media/b/", items, true));
+  EXPECT_EQ(0u, cache.GetStats().evictions);
+}
+
+TEST(TestDirectoryCache, AddFile)
+{
+  CDirectoryCache cache;
+  CFileItemList items;
+  FillList(items, "/media/a/", 2);
+  cache.SetDirectory("/media/a/", items, DIR_CACHE_ALWAYS);
+
+  cache.AddFile("/media/a/new.mkv");
+
+  bool inCache;
+  EXPECT_TRUE(cache.FileExists("/media/a/new.mkv", inCache));
+  CFileItemList cached;
+  EXPECT_TRUE(cache.GetDirectory("/media/a/", cached));
+  EXPECT_EQ(3, cached.Size());
+}
+
+TEST(TestDirectoryCache, AddFileSize)
+{
+  CDirectoryCache cache;
+  CFileItemList items;
+  FillList(items, "/media/a/", 2);
+  cache.SetDirectory("/media/a/", items, DIR_CACHE_ONCE);
+  size_t size = cache.GetStats().size;
+  ASSERT_GT(size, 0u);
+
+  // every file adds its own share to the estimate, however many are cached already
+  cache.AddFile("/media/a/new1.mkv");
+  size_t added = cache.GetStats().size - size;
+  EXPECT_GT(added, 0u);
+  cache.AddFile("/media/a/new2.mkv");
+  EXPECT_EQ(size + 2 * added, cache.GetStats().size);
+
+  // files of folders that aren't cached add nothing
+  cache.AddFile("/media/b/new.mkv");
+  EXPECT_EQ(size + 2 * added, cache.GetStats().size);
+
+  cache.ClearDirectory("/media/a/");
+  EXPECT_EQ(0u, cache.GetStats().size);
+}
@@ -0,0 +1,86 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/RangeFetcher.h"
+#include "test/TestUtils.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+static std::string ReadAll(XFILE::CRangeFetcher& fetcher, int64_t position, int64_t length)
+{
+  std::string data;
+  char buf[77];
+  while (position < length)
+  {
+    ssize_t read = fetcher.Read(position, buf, sizeof(buf), 10000);
+    if (read <= 0)
+      break;
+    data.append(buf, read);
+    position += read;
+  }
+  return data;
+}
+
+TEST(TestRangeFetcher, Read)
+{
+  const std::string path = XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt");
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(path));
+  int64_t length = file.GetLength();
+  std::string expected(static_cast<size_t>(length), '\0');
+  ASSERT_EQ(length, file.Read(&expected[0], expected.size()));
+  file.Close();
+
+  // small segments so the file is spread over all connections
+  XFILE::CRangeFetcher fetcher(path, length, 3, 100, 300, 300);
+  EXPECT_EQ(expected, ReadAll(fetcher, 0, length));
+
+  char buf[16];
+  EXPECT_EQ(0, fetcher.Read(length, buf, sizeof(buf), 1000));
+
+  // back to kept segments and into ones that were dropped
+  EXPECT_EQ(length - 250, fetcher.Seek(length - 250));
+  EXPECT_EQ(expected.substr(length - 250), ReadAll(fetcher, length - 250, length));
+  EXPECT_EQ(expected.substr(10), ReadAll(fetcher, 10, length));
+  EXPECT_EQ(expected.substr(555), ReadAll(fetcher, 555, length));
+}
+
+TEST(TestRangeFetcher, ReadRuns)
+{
+  const std::string path = XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt");
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(path));
+  int64_t length = file.GetLength();
+  std::string expected(static_cast<size_t>(length), '\0');
+  ASSERT_EQ(length, file.Read(&expected[0], expected.size()));
+  file.Close();
+
+  // runs of four segments per connection, seeks cut into them
+  XFILE::CRangeFetcher fetcher(path, length, 2, 100, 800, 400);
+  EXPECT_EQ(expected, ReadAll(fetcher, 0, length));
+  EXPECT_EQ(expected.substr(150), ReadAll(fetcher, 150, length));
+  EXPECT_EQ(expected.substr(1234), ReadAll(fetcher, 1234, length));
+  EXPECT_EQ(expected.substr(321), ReadAll(fetcher, 321, length));
+}
@@ -0,0 +1,212 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUISkinCache.h"
+
+#include <stdexcept>
+
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#define SKIN_CACHE_PATH    "special://temp/skincache/"
+#define SKIN_CACHE_MAGIC   "KSC"
+#define SKIN_CACHE_VERSION 1
+
+// node types in the cache file
+#define SKIN_CACHE_ELEMENT 'E'
+#define SKIN_CACHE_TEXT    'T'
+#define SKIN_CACHE_END     'Z'
+
+// skin files are nowhere near this deep, a deeper tree means a broken file
+#define SKIN_CACHE_MAX_DEPTH 256
+
+std::string CGUISkinCache::GetCacheFile(const std::string &id)
+{
+  return StringUtils::Format(SKIN_CACHE_PATH "%08x.bin", Crc32::Compute(id));
+}
+
+bool CGUISkinCache::Save(const std::string &cacheFile, const std::string &key, const TiXmlElement &root, const Conditions &conditions)
+{
+  XFILE::CDirectory::Create(SKIN_CACHE_PATH);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(cacheFile, true))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, cacheFile.c_str());
+    return false;
+  }
+
+  CArchive ar(&file, CArchive::store);
+  ar << std::string(SKIN_CACHE_MAGIC);
+  ar << SKIN_CACHE_VERSION;
+  ar << key;
+  ar << static_cast<unsigned int>(conditions.size());
+  for (const auto &condition : conditions)
+  {
+    ar << condition.first;
+    ar << condition.second;
+  }
+  Serialize(ar, root);
+  ar << SKIN_CACHE_END;
+  ar.Close();
+  file.Close();
+  return true;
+}
+
+std::unique_ptr<TiXmlElement> CGUISkinCache::Load(const std::string &cacheFile, const std::string &key, Conditions &conditions)
+{
+  conditions.clear();
+
+  XFILE::CFile file;
+  if (!file.Open(cacheFile))
+    return nullptr;
+
+  std::unique_ptr<TiXmlNode> root;
+  try
+  {
+    CArchive ar(&file, CArchive::load);
+
+    std::string magic, cachedKey;
+    int version = 0;
+    ar >> magic;
+    ar >> version;
+    if (magic != SKIN_CACHE_MAGIC || version != SKIN_CACHE_VERSION)
+      return nullptr;
+
+    ar >> cachedKey;
+    if (cachedKey != key)
+      return nullptr;
+
+    unsigned int count = 0;
+    ar >> count;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      std::string expression;
+      bool value = false;
+      ar >> expression;
+      ar >> value;
+      if (expression.empty())
+        throw std::out_of_range("empty include condition");
+      conditions.emplace_back(expression, value);
+    }
+
+    root.reset(Deserialize(ar));
+
+    char end = 0;
+    ar >> end;
+    if (end != SKIN_CACHE_END || !root || root->Type() != TiXmlNode::TINYXML_ELEMENT)
+      throw std::out_of_range("truncated window tree");
+  }
+  catch (const std::out_of_range &ex)
+  {
+    CLog::Log(LOGWARNING, "%s - corrupt skin cache %s: %s", __FUNCTION__, cacheFile.c_str(), ex.what());
+    conditions.clear();
+    return nullptr;
+  }
+
+  return std::unique_ptr<TiXmlElement>(static_cast<TiXmlElement*>(root.release()));
+}
+
+void CGUISkinCache::Serialize(CArchive &ar, const TiXmlNode &node)
+{
+  if (node.Type() == TiXmlNode::TINYXML_TEXT)
+  {
+    ar << SKIN_CACHE_TEXT;
+    ar << std::string(node.Value());
+    ar << static_cast<const TiXmlText&>(node).CDATA();
+    return;
+  }
+
+  const TiXmlElement *element = node.ToElement();
+  if (!element)
+    return; // comments and the like don't affect the window
+
+  ar << SKIN_CACHE_ELEMENT;
+  ar << std::string(element->Value());
+
+  unsigned int attributes = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    attributes++;
+  ar << attributes;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    ar << std::string(attribute->Name());
+    ar << std::string(attribute->Value());
+  }
+
+  unsigned int children = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->Type() == TiXmlNode::TINYXML_TEXT || child->Type() == TiXmlNode::TINYXML_ELEMENT)
+      children++;
+  }
+  ar << children;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+    Serialize(ar, *child);
+}
+
+TiXmlNode* CGUISkinCache::Deserialize(CArchive &ar, unsigned int depth /* = 0 */)
+{
+  if (depth > SKIN_CACHE_MAX_DEPTH)
+    throw std::out_of_range("window tree too deep");
+
+  char type = 0;
+  std::string value;
+  ar >> type;
+  ar >> value;
+
+  if (type == SKIN_CACHE_TEXT)
+  {
+    bool cdata = false;
+    ar >> cdata;
+    TiXmlText *text = new TiXmlText(value);
+    text->SetCDATA(cdata);
+    return text;
+  }
+
+  if (type != SKIN_CACHE_ELEMENT || value.empty())
+    throw std::out_of_range("unknown node type");
+
+  std::unique_ptr<TiXmlElement> element(new TiXmlElement(value));
+
+  unsigned int attributes = 0;
+  ar >> attributes;
+  for (unsigned int i = 0; i < attributes; i++)
+  {
+    std::string name, attribute;
+    ar >> name;
+    ar >> attribute;
+    if (name.empty())
+      throw std::out_of_range("empty attribute name");
+    element->SetAttribute(name, attribute);
+  }
+
+  unsigned int children = 0;
+  ar >> children;
+  for (unsigned int i = 0; i < children; i++)
+    element->LinkEndChild(Deserialize(ar, depth + 1));
+
+  return element.release();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Kodi; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CArchive;
+class TiXmlElement;
+class TiXmlNode;
+
+/*!
+ \brief Binary cache of window XML with includes, constants and expressions resolved
+
+ Each cache file holds one resolved window tree together with the include
+ conditions it was resolved with. The key stored in the file identifies the
+ skin, its version, the resolution and the window file it was built from.
+ */
+class CGUISkinCache
+{
+public:
+  /*!
+   \brief include condition expressions and the value they had when resolving
+   */
+  typedef std::vector<std::pair<std::string, bool>> Conditions;
+
+  /*!
+   \brief Get the cache file used for a window
+   \param id identifies the skin, resolution and window file
+   \return path to the cache file under special://temp
+   */
+  static std::string GetCacheFile(const std::string &id);
+
+  /*!
+   \brief Write a resolved window tree to a cache file
+   \param cacheFile path to the cache file
+   \param key the key the tree must be loaded with
+   \param root the resolved window tree
+   \param conditions include conditions the tree was resolved with
+   \return true on success
+   */
+  static bool Save(const std::string &cacheFile, const std::string &key, const TiXmlElement &root, const Conditions &conditions);
+
+  /*!
+   \brief Read a resolved window tree from a cache file
+   \param cacheFile path to the cache file
+   \param key the key the tree was saved with
+   \param conditions [out] include conditions the tree was resolved with
+   \return the window tree, nullptr if there is no valid cache file for the key
+   */
+  static std::unique_ptr<TiXmlElement> Load(const std::string &cacheFile, const std::string &key, Conditions &conditions);
+
+  static void Serialize(CArchive &ar, const TiXmlNode &node);
+  static TiXmlNode* Deserialize(CArchive &ar, unsigned int depth = 0);
+};
@@ -24,9 +24,11 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "GUISkinCache.h"
 
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
+#include "filesystem/File.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
 #include "utils/TimeUtils.h"
@@ -133,6 +135,15 @@ bool CGUIWindow::Load(const std::string& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLowerPath)
 {
+  // use the already resolved window from the skin cache if it is still valid
+  std::string cacheFile, cacheKey;
+  if (GetSkinCacheKey(strPath, cacheFile, cacheKey))
+  {
+    std::unique_ptr<TiXmlElement> cachedRoot = LoadFromSkinCache(cacheFile, cacheKey);
+    if (cachedRoot)
+      return Load(cachedRoot.get());
+  }
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
@@ -159,7 +170,60 @@ bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLower
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(Prepare(m_windowXMLRootElement).get());
+  std::unique_ptr<TiXmlElement> preparedRoot = Prepare(m_windowXMLRootElement);
+  if (preparedRoot && !cacheKey.empty())
+    SaveToSkinCache(cacheFile, cacheKey, *preparedRoot);
+
+  return Load(preparedRoot.get());
+}
+
+bool CGUIWindow::GetSkinCacheKey(const std::string &strPath, std::string &cacheFile, std::string &cacheKey) const
+{
+  // skinners need to see their changes straight away
+  if (!g_SkinInfo || g_SkinInfo->IsDebugging() || g_SkinInfo->GetCacheStamp().empty())
+    return false;
+
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(strPath, &st) != 0)
+    return false;
+
+  std::string id = StringUtils::Format("%s|%s|%dx%d", g_SkinInfo->ID().c_str(), strPath.c_str(),
+                                       m_coordsRes.iWidth, m_coordsRes.iHeight);
+  cacheFile = CGUISkinCache::GetCacheFile(id);
+  cacheKey = StringUtils::Format("%s|%s|%" PRId64 "|%" PRId64, id.c_str(), g_SkinInfo->GetCacheStamp().c_str(),
+                                 static_cast<int64_t>(st.st_mtime), static_cast<int64_t>(st.st_size));
+  return true;
+}
+
+std::unique_ptr<TiXmlElement> CGUIWindow::LoadFromSkinCache(const std::string &cacheFile, const std::string &cacheKey)
+{
+  CGUISkinCache::Conditions conditions;
+  std::unique_ptr<TiXmlElement> root = CGUISkinCache::Load(cacheFile, cacheKey, conditions);
+  if (!root)
+    return nullptr;
+
+  // the includes were resolved for these condition values, rebuild if any changed
+  std::map<INFO::InfoPtr, bool> xmlIncludeConditions;
+  for (const auto &condition : conditions)
+  {
+    INFO::InfoPtr conditionID = g_infoManager.Register(condition.first);
+    if (!conditionID || conditionID->Get() != condition.second)
+      return nullptr;
+    xmlIncludeConditions.insert(std::make_pair(conditionID, condition.second));
+  }
+
+  CLog::Log(LOGDEBUG, "Using cached skin file %s", cacheFile.c_str());
+  m_xmlIncludeConditions.swap(xmlIncludeConditions);
+  return root;
+}
+
+void CGUIWindow::SaveToSkinCache(const std::string &cacheFile, const std::string &cacheKey, const TiXmlElement &root) const
+{
+  CGUISkinCache::Conditions conditions;
+  for (const auto &condition : m_xmlIncludeConditions)
+    conditions.emplace_back(condition.first->GetExpression(), condition.second);
+
+  CGUISkinCache::Save(cacheFile, cacheKey, root, conditions);
 }
 
 std::unique_ptr<TiXmlElement> CGUIWindow::Prepare(TiXmlElement *pRootElement)
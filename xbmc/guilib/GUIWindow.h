@@ -243,6 +243,26 @@ protected:
    */
   virtual std::unique_ptr<TiXmlElement> Prepare(TiXmlElement *pRootElement);
 
+  /*!
+   \brief Get the skin cache file and key for the window XML
+   \param strPath the path to the window XML
+   \param cacheFile [out] the skin cache file for the window
+   \param cacheKey [out] the key identifying the skin, resolution and window XML
+   \return true if the skin cache can be used for this window
+   */
+  bool GetSkinCacheKey(const std::string &strPath, std::string &cacheFile, std::string &cacheKey) const;
+
+  /*!
+   \brief Load the prepared XML from the skin cache
+   \return the prepared XML, nullptr if not cached or resolved with other include conditions
+   */
+  std::unique_ptr<TiXmlElement> LoadFromSkinCache(const std::string &cacheFile, const std::string &cacheKey);
+
+  /*!
+   \brief Store the prepared XML and its include conditions in the skin cache
+   */
+  void SaveToSkinCache(const std::string &cacheFile, const std::string &cacheKey, const TiXmlElement &root) const;
+
   /*!
    \brief Check if window needs a (re)load. The window need to be (re)loaded when window is not loaded or include conditions values were changed
    */
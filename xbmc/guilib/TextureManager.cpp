@@ -21,6 +21,7 @@
 #include "TextureManager.h"
 
 #include <cassert>
+#include <iterator>
 
 #include "addons/Skin.h"
 #include "filesystem/Directory.h"
@@ -28,7 +29,6 @@
 #include "GraphicContext.h"
 #include "Texture.h"
 #include "threads/SingleLock.h"
-#include "threads/SystemClock.h"
 #include "URL.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -222,6 +222,7 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
 /*                                                                      */
 /************************************************************************/
 CGUITextureManager::CGUITextureManager(void)
+  : m_unusedMaxSize(64 * 1024 * 1024)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
@@ -262,25 +263,25 @@ bool CGUITextureManager::HasTexture(const std::string &textureName, std::string
   if (!CanLoad(textureName))
     return false;
 
-  // Check our loaded and bundled textures - we store in bundles using \\.
-  std::string bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  // Check our loaded and released textures
+  if (m_textures.find(textureName) != m_textures.end())
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
-    {
-      if (size) *size = 1;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
   }
 
-  for (int i = 0; i < 2; i++)
+  auto unused = m_unusedIndex.find(textureName);
+  if (unused != m_unusedIndex.end() && !unused->second->immediately)
   {
-    if (m_TexBundle[i].HasFile(bundledName))
-    {
-      if (bundle) *bundle = i;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
+  }
+
+  int bundleIndex = FindBundle(textureName);
+  if (bundleIndex >= 0)
+  {
+    if (bundle) *bundle = bundleIndex;
+    return true;
   }
 
   std::string fullPath = GetTexturePath(textureName);
@@ -305,33 +306,33 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
   if (size) // we found the texture
   {
-    for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+    auto loaded = m_textures.find(strTextureName);
+    if (loaded != m_textures.end())
     {
-      CTextureMap *pMap = m_vecTextures[i];
-      if (pMap->GetName() == strTextureName)
-      {
-        //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-        return pMap->GetTexture();
-      }
+      m_hits++;
+      return loaded->second->GetTexture();
     }
-    // Whoops, not there.
-    return emptyTexture;
-  }
 
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
-  {
-    CTextureMap* pMap = i->first;
-    if (pMap->GetName() == strTextureName && i->second > 0)
+    auto unused = m_unusedIndex.find(strTextureName);
+    if (unused != m_unusedIndex.end() && !unused->second->immediately)
     {
-      m_vecTextures.push_back(pMap);
-      m_unusedTextures.erase(i);
+      CTextureMap* pMap = unused->second->map;
+      m_unusedSize -= pMap->GetMemoryUsage();
+      m_unusedTextures.erase(unused->second);
+      m_unusedIndex.erase(unused);
+      m_textures[strTextureName] = pMap;
+      m_hits++;
       return pMap->GetTexture();
     }
+    // Whoops, not there.
+    return emptyTexture;
   }
 
   if (checkBundleOnly && bundle == -1)
     return emptyTexture;
 
+  m_misses++;
+
   //Lock here, we will do stuff that could break rendering
   CSingleLock lock(g_graphicsContext);
 
@@ -371,7 +372,7 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
     delete[] pTextures;
     delete[] Delay;
 
-    m_vecTextures.push_back(pMap);
+    m_textures[strTextureName] = pMap;
     return pMap->GetTexture();
   }
   else if (StringUtils::EndsWithNoCase(strPath, ".gif") ||
@@ -428,7 +429,7 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
     file.Close();
 
-    m_vecTextures.push_back(pMap);
+    m_textures[strTextureName] = pMap;
     return pMap->GetTexture();
   }
 
@@ -455,7 +456,7 @@ const CTextureArray& CGUITextureManager::Load(const std::string& strTextureName,
 
   CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
   pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+  m_textures[strTextureName] = pMap;
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -474,40 +475,58 @@ void CGUITextureManager::ReleaseTexture(const std::string& strTextureName, bool
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  auto i = m_textures.find(strTextureName);
+  if (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    CTextureMap* pMap = i->second;
+    if (pMap->Release())
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(std::make_pair(pMap, immediately ? 0 : XbmcThreads::SystemClockMillis()));
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      // add to our textures to free
+      m_textures.erase(i);
+      AddUnused(pMap, immediately);
     }
-    ++i;
+    return;
   }
   CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
 
-void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
+void CGUITextureManager::AddUnused(CTextureMap* map, bool immediately)
+{
+  // a texture released immediately may still be waiting to be freed
+  auto old = m_unusedIndex.find(map->GetName());
+  if (old != m_unusedIndex.end())
+    FreeUnused(old->second);
+
+  m_unusedTextures.push_back({map, immediately});
+  m_unusedIndex[map->GetName()] = std::prev(m_unusedTextures.end());
+  m_unusedSize += map->GetMemoryUsage();
+}
+
+void CGUITextureManager::FreeUnused(UnusedList::iterator it)
+{
+  CTextureMap* pMap = it->map;
+  m_unusedSize -= pMap->GetMemoryUsage();
+  m_unusedIndex.erase(pMap->GetName());
+  m_unusedTextures.erase(it);
+  delete pMap;
+}
+
+void CGUITextureManager::FreeUnusedTextures(bool all)
 {
-  unsigned int currFrameTime = XbmcThreads::SystemClockMillis();
   CSingleLock lock(g_graphicsContext);
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end();)
+  for (auto i = m_unusedTextures.begin(); i != m_unusedTextures.end();)
   {
-    if (currFrameTime - i->second >= timeDelay)
-    {
-      delete i->first;
-      i = m_unusedTextures.erase(i);
-    }
-    else
-      ++i;
+    auto next = std::next(i);
+    if (all || i->immediately)
+      FreeUnused(i);
+    i = next;
+  }
+
+  // drop the least recently released textures until we are within budget
+  while (m_unusedSize > m_unusedMaxSize && !m_unusedTextures.empty())
+  {
+    FreeUnused(m_unusedTextures.begin());
+    m_evictions++;
   }
 
 #if defined(HAS_GL) || defined(HAS_GLES)
@@ -536,47 +555,71 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  for (auto& i : m_textures)
   {
-    CTextureMap* pMap = *i;
-    CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
-    delete pMap;
-    i = m_vecTextures.erase(i);
+    CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, i.first.c_str());
+    delete i.second;
   }
+  m_textures.clear();
 
   m_TexBundle[0] = CTextureBundle(true);
   m_TexBundle[1] = CTextureBundle();
-  FreeUnusedTextures();
+  {
+    CSingleLock lock(m_section);
+    m_bundleIndex.clear();
+  }
+  FreeUnusedTextures(true);
 }
 
 void CGUITextureManager::Dump() const
 {
-  CLog::Log(LOGDEBUG, "{0}: total texturemaps size: {1}", __FUNCTION__, m_vecTextures.size());
+  Stats stats = GetStats();
+  CLog::Log(LOGDEBUG, "{0}: total texturemaps size: {1} ({2} bytes)", __FUNCTION__, stats.loaded, stats.loadedSize);
+  CLog::Log(LOGDEBUG, "{0}: unused texturemaps size: {1} ({2} of {3} bytes)", __FUNCTION__, stats.unused,
+    stats.unusedSize, stats.unusedMaxSize);
+  CLog::Log(LOGDEBUG, "{0}: lookups: {1} hits, {2} misses, {3} evictions", __FUNCTION__, stats.hits, stats.misses,
+    stats.evictions);
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (const auto& i : m_textures)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
-    if (!pMap->IsEmpty())
-      pMap->Dump();
+    if (!i.second->IsEmpty())
+      i.second->Dump();
   }
 }
 
+CGUITextureManager::Stats CGUITextureManager::GetStats() const
+{
+  Stats stats;
+  stats.hits = m_hits;
+  stats.misses = m_misses;
+  stats.evictions = m_evictions;
+  stats.loaded = m_textures.size();
+  stats.unused = m_unusedTextures.size();
+  for (const auto& i : m_textures)
+    stats.loadedSize += i.second->GetMemoryUsage();
+  stats.unusedSize = m_unusedSize;
+  stats.unusedMaxSize = m_unusedMaxSize;
+  return stats;
+}
+
+void CGUITextureManager::SetUnusedMemoryBudget(size_t bytes)
+{
+  CSingleLock lock(g_graphicsContext);
+  m_unusedMaxSize = bytes;
+}
+
 void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  for (auto i = m_textures.begin(); i != m_textures.end();)
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     pMap->Flush();
     if (pMap->IsEmpty() )
     {
       delete pMap;
-      i = m_vecTextures.erase(i);
+      i = m_textures.erase(i);
     }
     else
     {
@@ -587,11 +630,9 @@ void CGUITextureManager::Flush()
 
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
-  unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
-  {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
-  }
+  unsigned int memUsage = m_unusedSize;
+  for (const auto& i : m_textures)
+    memUsage += i.second->GetMemoryUsage();
   return memUsage;
 }
 
@@ -599,6 +640,8 @@ void CGUITextureManager::SetTexturePath(const std::string &texturePath)
 {
   CSingleLock lock(m_section);
   m_texturePaths.clear();
+  // the bundles follow the skin media path
+  m_bundleIndex.clear();
   AddTexturePath(texturePath);
 }
 
@@ -649,6 +692,30 @@ std::string CGUITextureManager::GetTexturePath(const std::string &textureName, b
   return "";
 }
 
+int CGUITextureManager::FindBundle(const std::string& textureName)
+{
+  // we store in bundles using \\.
+  std::string bundledName = CTextureBundle::Normalize(textureName);
+
+  // HasTexture() is also called from worker and python threads
+  CSingleLock lock(m_section);
+  auto it = m_bundleIndex.find(bundledName);
+  if (it != m_bundleIndex.end())
+    return it->second;
+
+  int bundle = -1;
+  for (int i = 0; i < 2; i++)
+  {
+    if (m_TexBundle[i].HasFile(bundledName))
+    {
+      bundle = i;
+      break;
+    }
+  }
+  m_bundleIndex[bundledName] = bundle;
+  return bundle;
+}
+
 void CGUITextureManager::GetBundledTexturesFromPath(const std::string& texturePath, std::vector<std::string> &items)
 {
   m_TexBundle[0].GetTexturesFromPath(texturePath, items);
@@ -24,7 +24,10 @@
 */
 #pragma once
 
+#include <atomic>
 #include <list>
+#include <stdint.h>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
@@ -122,16 +125,55 @@ public:
   void SetTexturePath(const std::string &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
   void RemoveTexturePath(const std::string &texturePath); ///< Remove a path from the paths to check when loading media
 
-  void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
+  void FreeUnusedTextures(bool all = false); ///< Free textures released immediately or beyond the unused budget, or all unused textures (called from app thread only)
   void ReleaseHwTexture(unsigned int texture);
+
+  /*!
+   \brief Set how many bytes of released textures are kept around for reuse
+   */
+  void SetUnusedMemoryBudget(size_t bytes);
+
+  struct Stats
+  {
+    uint64_t hits = 0;      ///< lookups served from loaded or unused textures
+    uint64_t misses = 0;    ///< lookups that had to load the texture
+    uint64_t evictions = 0; ///< unused textures freed to stay within the budget
+    unsigned int loaded = 0;
+    unsigned int unused = 0;
+    size_t loadedSize = 0;
+    size_t unusedSize = 0;
+    size_t unusedMaxSize = 0;
+  };
+  Stats GetStats() const;
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
-  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
+  struct CUnusedTexture
+  {
+    CTextureMap* map;
+    bool immediately; ///< released with immediately set, must not be reused
+  };
+  typedef std::list<CUnusedTexture> UnusedList;
+
+  void AddUnused(CTextureMap* map, bool immediately);
+  void FreeUnused(UnusedList::iterator it);
+  int FindBundle(const std::string& textureName);
+
+  // loaded textures by name
+  std::unordered_map<std::string, CTextureMap*> m_textures;
+  // released textures, least recently released first
+  UnusedList m_unusedTextures;
+  std::unordered_map<std::string, UnusedList::iterator> m_unusedIndex;
+  size_t m_unusedSize = 0;
+  size_t m_unusedMaxSize;
   std::vector<unsigned int> m_unusedHwTextures;
-  typedef std::vector<CTextureMap*>::iterator ivecTextures;
-  typedef std::list<std::pair<CTextureMap*, unsigned int> >::iterator ilistUnused;
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
+  // bundle holding each normalized texture name looked up so far, -1 if none.
+  // Reset when the skin media path changes.
+  std::unordered_map<std::string, int> m_bundleIndex;
+
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+  uint64_t m_evictions = 0;
 
   std::vector<std::string> m_texturePaths;
   CCriticalSection m_section;
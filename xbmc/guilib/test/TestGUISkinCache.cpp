@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2017 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "guilib/GUISkinCache.h"
+#include "test/TestUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace
+{
+std::string ToString(const TiXmlNode &node)
+{
+  TiXmlPrinter printer;
+  node.Accept(&printer);
+  return printer.Str();
+}
+}
+
+class TestGUISkinCache : public testing::Test
+{
+protected:
+  TestGUISkinCache()
+  {
+    cacheFile = CGUISkinCache::GetCacheFile("TestGUISkinCache");
+  }
+  ~TestGUISkinCache() override
+  {
+    XFILE::CFile::Delete(cacheFile);
+  }
+  std::string cacheFile;
+};
+
+TEST_F(TestGUISkinCache, RoundTrip)
+{
+  CXBMCTinyXML doc;
+  doc.Parse("<window id=\"1\"><defaultcontrol always=\"true\">50</defaultcontrol>"
+            "<controls><control type=\"label\"><!-- comment --><label><![CDATA[a < b]]></label></control>"
+            "<control type=\"group\"/></controls></window>");
+  ASSERT_NE(nullptr, doc.RootElement());
+
+  CGUISkinCache::Conditions conditions = { { "skin.hassetting(foo)", true }, { "!player.hasvideo", false } };
+  EXPECT_TRUE(CGUISkinCache::Save(cacheFile, "key", *doc.RootElement(), conditions));
+
+  CGUISkinCache::Conditions loaded;
+  std::unique_ptr<TiXmlElement> root = CGUISkinCache::Load(cacheFile, "key", loaded);
+  ASSERT_NE(nullptr, root);
+  EXPECT_EQ(conditions, loaded);
+
+  // comments are dropped, everything else is kept as is
+  CXBMCTinyXML expected;
+  expected.Parse("<window id=\"1\"><defaultcontrol always=\"true\">50</defaultcontrol>"
+                 "<controls><control type=\"label\"><label><![CDATA[a < b]]></label></control>"
+                 "<control type=\"group\"/></controls></window>");
+  EXPECT_EQ(ToString(*expected.RootElement()), ToString(*root));
+}
+
+TEST_F(TestGUISkinCache, KeyMismatch)
+{
+  TiXmlElement window("window");
+  EXPECT_TRUE(CGUISkinCache::Save(cacheFile, "skin-1.0", window, CGUISkinCache::Conditions()));
+
+  CGUISkinCache::Conditions conditions;
+  EXPECT_EQ(nullptr, CGUISkinCache::Load(cacheFile, "skin-1.1", conditions));
+  EXPECT_NE(nullptr, CGUISkinCache::Load(cacheFile, "skin-1.0", conditions));
+  EXPECT_EQ(nullptr, CGUISkinCache::Load(cacheFile + ".missing", "skin-1.0", conditions));
+}
+
+TEST_F(TestGUISkinCache, Corrupt)
+{
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(cacheFile, true));
+  file.Write("KSC garbage", 11);
+  file.Close();
+
+  CGUISkinCache::Conditions conditions;
+  EXPECT_EQ(nullptr, CGUISkinCache::Load(cacheFile, "key", conditions));
+  EXPECT_TRUE(conditions.empty());
+}
+
+TEST_F(TestGUISkinCache, SkinWindows)
+{
+  // every window of the default skin makes it through the cache
+  CFileItemList items;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(XBMC_REF_FILE_PATH("addons/skin.estuary/xml/"), items, ".xml",
+                                              XFILE::DIR_FLAG_NO_FILE_DIRS));
+  ASSERT_FALSE(items.IsEmpty());
+
+  std::vector<std::string> files;
+  for (int i = 0; i < items.Size(); i++)
+    files.push_back(CGUISkinCache::GetCacheFile("TestGUISkinCache" + items[i]->GetPath()));
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CXBMCTinyXML doc;
+    ASSERT_TRUE(doc.LoadFile(items[i]->GetPath()));
+    ASSERT_TRUE(CGUISkinCache::Save(files[i], items[i]->GetPath(), *doc.RootElement(), CGUISkinCache::Conditions()));
+
+    CGUISkinCache::Conditions conditions;
+    std::unique_ptr<TiXmlElement> root = CGUISkinCache::Load(files[i], items[i]->GetPath(), conditions);
+    ASSERT_NE(nullptr, root);
+    EXPECT_EQ(doc.RootElement()->ValueStr(), root->ValueStr());
+  }
+
+  for (const auto &file : files)
+    XFILE::CFile::Delete(file);
+}
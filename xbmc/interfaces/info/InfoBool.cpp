@@ -23,13 +23,15 @@
 
 namespace INFO
 {
-  InfoBool::InfoBool(const std::string &expression, int context, unsigned int &refreshCounter)
+  InfoBool::InfoBool(const std::string &expression, int context, InfoRefreshCounters &refreshCounters)
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
       m_expression(expression),
+      m_dependencies(1 << INFO_DEPENDENCY_FRAME),
+      m_evaluated(false),
       m_refreshCounter(0),
-      m_parentRefreshCounter(refreshCounter)
+      m_parentRefreshCounters(refreshCounters)
   {
     StringUtils::ToLower(m_expression);
   }
@@ -27,6 +27,30 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \ingroup info
+ \brief Sources of state an info bool may depend on
+ Each source has its own refresh counter which is bumped when the source publishes a change.
+ */
+enum InfoDependency
+{
+  INFO_DEPENDENCY_FRAME = 0, ///< anything without change notifications, refreshed every frame
+  INFO_DEPENDENCY_SKIN,      ///< skin settings
+  INFO_DEPENDENCY_SETTINGS,  ///< settings
+  INFO_DEPENDENCY_LIBRARY,   ///< library content flags
+  INFO_DEPENDENCY_COUNT
+};
+
+/*!
+ \ingroup info
+ \brief Refresh counters shared by all info bools
+ */
+struct InfoRefreshCounters
+{
+  unsigned int counters[INFO_DEPENDENCY_COUNT] = {};
+  unsigned int evaluations = 0; ///< number of info bool updates since the last frame
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -34,7 +58,7 @@ namespace INFO
 class InfoBool
 {
 public:
-  InfoBool(const std::string &expression, int context, unsigned int &refreshCounter);
+  InfoBool(const std::string &expression, int context, InfoRefreshCounters &refreshCounters);
   virtual ~InfoBool() = default;
 
   virtual void Initialize() {};
@@ -46,11 +70,20 @@ public:
   inline bool Get(const CGUIListItem *item = NULL)
   {
     if (item && m_listItemDependent)
+    {
       Update(item);
-    else if (m_refreshCounter != m_parentRefreshCounter || m_refreshCounter == 0)
+      m_parentRefreshCounters.evaluations++;
+    }
+    else
     {
-      Update(NULL);
-      m_refreshCounter = m_parentRefreshCounter;
+      unsigned int refreshCounter = GetRefreshCounter();
+      if (refreshCounter != m_refreshCounter || !m_evaluated)
+      {
+        Update(NULL);
+        m_parentRefreshCounters.evaluations++;
+        m_refreshCounter = refreshCounter;
+        m_evaluated = true;
+      }
     }
     return m_value;
   }
@@ -78,16 +111,36 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+
+  /*! \brief Get the sources this info bool depends on
+   \return bitmask of (1 << InfoDependency) values, 0 if the value never changes
+   */
+  unsigned int GetDependencies() const { return m_dependencies; }
 protected:
+  /*! \brief Combine the refresh counters of our dependencies
+   The counters only ever increase, so the sum changes whenever any of them does.
+   */
+  inline unsigned int GetRefreshCounter() const
+  {
+    unsigned int refreshCounter = 0;
+    for (unsigned int i = 0; i < INFO_DEPENDENCY_COUNT; i++)
+    {
+      if (m_dependencies & (1 << i))
+        refreshCounter += m_parentRefreshCounters.counters[i];
+    }
+    return refreshCounter;
+  }
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
   std::string  m_expression;   ///< original expression
+  unsigned int m_dependencies; ///< sources the value depends on, see InfoDependency
 
 private:
+  bool m_evaluated;
   unsigned int m_refreshCounter;
-  unsigned int &m_parentRefreshCounter;
+  InfoRefreshCounters &m_parentRefreshCounters;
 };
 
 typedef std::shared_ptr<InfoBool> InfoPtr;
@@ -30,6 +30,7 @@ using namespace INFO;
 void InfoSingle::Initialize()
 {
   m_condition = g_infoManager.TranslateSingleString(m_expression, m_listItemDependent);
+  m_dependencies = g_infoManager.GetBoolDependencies(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -39,10 +40,13 @@ void InfoSingle::Update(const CGUIListItem *item)
 
 void InfoExpression::Initialize()
 {
+  // collected from the operands while parsing
+  m_dependencies = 0;
   if (!Parse(m_expression))
   {
     CLog::Log(LOGERROR, "Error parsing boolean expression %s", m_expression.c_str());
     m_expression_tree = std::make_shared<InfoLeaf>(g_infoManager.Register("false", 0), false);
+    m_dependencies = 0;
   }
 }
 
@@ -246,8 +250,9 @@ bool InfoExpression::Parse(const std::string &expression)
           CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
           return false;
         }
-        /* Propagate any listItem dependency from the operand to the expression */
+        /* Propagate any listItem and state dependencies from the operand to the expression */
         m_listItemDependent |= info->ListItemDependent();
+        m_dependencies |= info->GetDependencies();
         nodes.push(std::make_shared<InfoLeaf>(info, invert));
         /* Reuse operand string for next operand */
         operand.clear();
@@ -297,8 +302,9 @@ bool InfoExpression::Parse(const std::string &expression)
       CLog::Log(LOGERROR, "Bad operand '%s'", operand.c_str());
       return false;
     }
-    /* Propagate any listItem dependency from the operand to the expression */
+    /* Propagate any listItem and state dependencies from the operand to the expression */
     m_listItemDependent |= info->ListItemDependent();
+    m_dependencies |= info->GetDependencies();
     nodes.push(std::make_shared<InfoLeaf>(info, invert));
   }
   while (!operator_stack.empty())
@@ -0,0 +1,147 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "ServiceBroker.h"
+#include "interfaces/info/InfoBool.h"
+#include "settings/Settings.h"
+
+#include "gtest/gtest.h"
+
+using namespace INFO;
+
+namespace
+{
+  class CCountingInfoBool : public InfoBool
+  {
+  public:
+    CCountingInfoBool(unsigned int dependencies, InfoRefreshCounters &counters)
+      : InfoBool("counting", 0, counters), m_updates(0)
+    {
+      m_dependencies = dependencies;
+    }
+
+    void Update(const CGUIListItem *item) override { m_updates++; }
+
+    unsigned int m_updates;
+  };
+}
+
+TEST(TestInfoBool, RefreshedByDependencies)
+{
+  InfoRefreshCounters counters;
+  CCountingInfoBool settingsBool(1 << INFO_DEPENDENCY_SETTINGS, counters);
+  CCountingInfoBool frameBool(1 << INFO_DEPENDENCY_FRAME, counters);
+  CCountingInfoBool constantBool(0, counters);
+
+  settingsBool.Get();
+  frameBool.Get();
+  constantBool.Get();
+  EXPECT_EQ(1u, settingsBool.m_updates);
+  EXPECT_EQ(1u, frameBool.m_updates);
+  EXPECT_EQ(1u, constantBool.m_updates);
+
+  // a new frame only refreshes what depends on per frame state
+  counters.counters[INFO_DEPENDENCY_FRAME]++;
+  settingsBool.Get();
+  frameBool.Get();
+  constantBool.Get();
+  EXPECT_EQ(1u, settingsBool.m_updates);
+  EXPECT_EQ(2u, frameBool.m_updates);
+  EXPECT_EQ(1u, constantBool.m_updates);
+
+  // a changed setting only refreshes what depends on settings
+  counters.counters[INFO_DEPENDENCY_SETTINGS]++;
+  settingsBool.Get();
+  frameBool.Get();
+  constantBool.Get();
+  EXPECT_EQ(2u, settingsBool.m_updates);
+  EXPECT_EQ(2u, frameBool.m_updates);
+  EXPECT_EQ(1u, constantBool.m_updates);
+
+  // nothing changed
+  settingsBool.Get();
+  EXPECT_EQ(2u, settingsBool.m_updates);
+}
+
+class TestInfoBoolSettings : public testing::Test
+{
+protected:
+  TestInfoBoolSettings()
+  {
+    CSettings &settings = CServiceBroker::GetSettings();
+    if (!settings.IsInitialized())
+      settings.Initialize();
+    // callbacks are only run once the settings are loaded
+    m_wasLoaded = settings.IsLoaded();
+    settings.SetLoaded();
+    m_value = settings.GetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO);
+  }
+
+  ~TestInfoBoolSettings() override
+  {
+    CSettings &settings = CServiceBroker::GetSettings();
+    settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, m_value);
+    if (!m_wasLoaded)
+      settings.Unload();
+  }
+
+  bool m_wasLoaded;
+  bool m_value;
+};
+
+TEST_F(TestInfoBoolSettings, RefreshedOnSettingChange)
+{
+  CSettings &settings = CServiceBroker::GetSettings();
+  InfoPtr info = g_infoManager.Register("System.GetBool(debug.showloginfo)");
+  ASSERT_TRUE(info);
+  EXPECT_EQ(1u << INFO_DEPENDENCY_SETTINGS, info->GetDependencies());
+
+  ASSERT_TRUE(settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, false));
+  EXPECT_FALSE(info->Get());
+  ASSERT_TRUE(settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, true));
+  EXPECT_TRUE(info->Get());
+
+  // no update without a change, whatever the frames do
+  g_infoManager.ResetFrameCache();
+  info->Get();
+  info->Get();
+  g_infoManager.ResetFrameCache();
+  EXPECT_EQ(0u, g_infoManager.GetEvaluations());
+}
+
+TEST_F(TestInfoBoolSettings, RefreshedAfterClear)
+{
+  CSettings &settings = CServiceBroker::GetSettings();
+  InfoPtr info = g_infoManager.Register("System.GetBool(debug.showloginfo)");
+  ASSERT_TRUE(info);
+
+  ASSERT_TRUE(settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, false));
+  EXPECT_FALSE(info->Get());
+
+  // like a skin reload, bools held elsewhere survive it and keep following their setting
+  g_infoManager.Clear();
+  EXPECT_EQ(info, g_infoManager.Register("System.GetBool(debug.showloginfo)"));
+
+  ASSERT_TRUE(settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, true));
+  EXPECT_TRUE(info->Get());
+  ASSERT_TRUE(settings.SetBool(CSettings::SETTING_DEBUG_SHOWLOGINFO, false));
+  EXPECT_FALSE(info->Get());
+}
@@ -24,6 +24,7 @@
 #include "MediaSource.h"
 #include "ServiceBroker.h"
 #include "filesystem/Directory.h"
+#include "filesystem/DirectoryCache.h"
 #include "filesystem/File.h"
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
@@ -284,6 +285,20 @@ JSONRPC_STATUS CFileOperations::Download(const std::string &method, ITransportLa
   return transport->Download(parameterObject["path"].asString().c_str(), result) ? OK : InvalidParams;
 }
 
+JSONRPC_STATUS CFileOperations::GetDirectoryCacheStats(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  XFILE::CDirectoryCache::Stats stats = g_directoryCache.GetStats();
+  result["hits"] = stats.hits;
+  result["misses"] = stats.misses;
+  result["evictions"] = stats.evictions;
+  result["folders"] = stats.folders;
+  result["items"] = stats.items;
+  result["size"] = static_cast<uint64_t>(stats.size);
+  result["maxsize"] = static_cast<uint64_t>(stats.maxSize);
+
+  return OK;
+}
+
 bool CFileOperations::FillFileItem(const CFileItemPtr &originalItem, CFileItemPtr &item, std::string media /* = "" */, const CVariant &parameterObject /* = CVariant(CVariant::VariantTypeArray) */)
 {
   if (originalItem.get() == NULL)
@@ -202,6 +202,15 @@ void CMusicDatabase::CreateTables()
   CLog::Log(LOGINFO, "create versiontagscan table");
   m_pDS->exec("CREATE TABLE versiontagscan (idVersion integer, iNeedsScan integer)");
   m_pDS->exec(PrepareSQL("INSERT INTO versiontagscan (idVersion, iNeedsScan) values(%i, 0)", GetSchemaVersion()));
+
+  CreateSearchTables();
+}
+
+void CMusicDatabase::CreateSearchTables()
+{
+  CreateSearchTable("artistsearch", "artist", "idArtist", "strArtist");
+  CreateSearchTable("albumsearch", "album", "idAlbum", "strAlbum");
+  CreateSearchTable("songsearch", "song", "idSong", "strTitle");
 }
 
 void CMusicDatabase::CreateAnalytics()
@@ -262,6 +271,10 @@ void CMusicDatabase::CreateAnalytics()
               "  DELETE FROM song_genre WHERE song_genre.idSong = old.idSong;"
               "  DELETE FROM art WHERE media_id=old.idSong AND media_type='song';"
               " END");
+
+  CreateSearchTriggers("artistsearch", "artist", "idArtist", "strArtist");
+  CreateSearchTriggers("albumsearch", "album", "idAlbum", "strAlbum");
+  CreateSearchTriggers("songsearch", "song", "idSong", "strTitle");
   
   // we create views last to ensure all indexes are rolled in
   CreateViews();
@@ -2306,15 +2319,15 @@ bool CMusicDatabase::SearchArtists(const std::string& search, CFileItemList &art
     if (NULL == m_pDS.get()) return false;
 
     std::string strVariousArtists = g_localizeStrings.Get(340).c_str();
+    Filter filter;
+    if (search.size() < MIN_FULL_SEARCH_LENGTH)
+      filter.AppendWhere(PrepareSQL("strArtist like '%s%%'", search.c_str()));
+    else if (!GetSearchFilter("artistsearch", "artist.idArtist", search, filter))
+      filter.AppendWhere(PrepareSQL("strArtist like '%s%%' or strArtist like '%% %s%%'", search.c_str(), search.c_str()));
+    filter.AppendWhere(PrepareSQL("artist.strArtist <> '%s'", strVariousArtists.c_str()));
+
     std::string strSQL;
-    if (search.size() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from artist "
-                                "where (strArtist like '%s%%' or strArtist like '%% %s%%') and strArtist <> '%s' "
-                                , search.c_str(), search.c_str(), strVariousArtists.c_str() );
-    else
-      strSQL=PrepareSQL("select * from artist "
-                                "where strArtist like '%s%%' and strArtist <> '%s' "
-                                , search.c_str(), strVariousArtists.c_str() );
+    BuildSQL("select artist.* from artist ", filter, strSQL);
 
     if (!m_pDS->query(strSQL)) return false;
     if (m_pDS->num_rows() == 0)
@@ -2851,11 +2864,15 @@ bool CMusicDatabase::SearchSongs(const std::string& search, CFileItemList &items
     if (!baseUrl.FromString("musicdb://songs/"))
       return false;
 
+    Filter filter;
+    if (search.size() < MIN_FULL_SEARCH_LENGTH)
+      filter.AppendWhere(PrepareSQL("strTitle like '%s%%'", search.c_str()));
+    else if (!GetSearchFilter("songsearch", "songview.idSong", search, filter))
+      filter.AppendWhere(PrepareSQL("strTitle like '%s%%' or strTitle like '%% %s%%'", search.c_str(), search.c_str()));
+    filter.limit = "1000";
+
     std::string strSQL;
-    if (search.size() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
-    else
-      strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
+    BuildSQL("select songview.* from songview ", filter, strSQL);
 
     if (!m_pDS->query(strSQL)) return false;
     if (m_pDS->num_rows() == 0) return false;
@@ -2887,11 +2904,14 @@ bool CMusicDatabase::SearchAlbums(const std::string& search, CFileItemList &albu
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
+    Filter filter;
+    if (search.size() < MIN_FULL_SEARCH_LENGTH)
+      filter.AppendWhere(PrepareSQL("strAlbum like '%s%%'", search.c_str()));
+    else if (!GetSearchFilter("albumsearch", "albumview.idAlbum", search, filter))
+      filter.AppendWhere(PrepareSQL("strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str()));
+
     std::string strSQL;
-    if (search.size() >= MIN_FULL_SEARCH_LENGTH)
-      strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
-    else
-      strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
+    BuildSQL("select albumview.* from albumview ", filter, strSQL);
 
     if (!m_pDS->query(strSQL)) return false;
 
@@ -4410,76 +4430,113 @@ bool CMusicDatabase::GetSongsFullByWhere(const std::string &baseDir, const Filte
     else
       strSQL = "SELECT songview.* FROM songview " + strSQLExtra;
 
-    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL))
-      return false;
-
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
-    {
-      m_pDS->close();
-      return true;
-    }
-
-    // Store the total number of songs as a property
-    items.SetProperty("total", total);
-
-    DatabaseResults results;
-    results.reserve(iRowsFound);
     // Avoid sorting with limits when have join with songartistview 
     // Limit when SortByNone already applied in SQL, 
     // apply sort later to fileitems list rather than dataset
     sorting = sortDescription;
     if (artistData && sortDescription.sortBy != SortByNone)
       sorting.sortBy = SortByNone;
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeSong, m_pDS, results))
-      return false;
 
     // Get songs from returned rows. If join songartistview then there is a row for every artist
-    items.Reserve(total);
     int songArtistOffset = song_enumCount;
     int songId = -1;
     VECARTISTCREDITS artistCredits;
-    const dbiplus::query_data &data = m_pDS->get_result_set().records;
     int count = 0;
-    for (const auto &i : results)
+    auto addRecord = [&](const dbiplus::sql_record* const record)
     {
-      unsigned int targetRow = (unsigned int)i.at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
-      try
+      if (songId != record->at(song_idSong).get_asInt())
+      { //New song
+        if (songId > 0 && !artistCredits.empty())
+        {
+          //Store artist credits for previous song
+          GetFileItemFromArtistCredits(artistCredits, items[items.Size()-1].get());
+          artistCredits.clear();
+        }
+        songId = record->at(song_idSong).get_asInt();
+        CFileItemPtr item(new CFileItem);
+        GetFileItemFromDataset(record, item.get(), musicUrl);
+        // HACK for sorting by database returned order
+        item->m_iprogramCount = ++count;
+        items.Add(item);
+      }
+      // Get song artist credits and contributors
+      if (artistData)
       {
-        if (songId != record->at(song_idSong).get_asInt())
-        { //New song
-          if (songId > 0 && !artistCredits.empty())
-          {
-            //Store artist credits for previous song
-            GetFileItemFromArtistCredits(artistCredits, items[items.Size()-1].get());
-            artistCredits.clear();
-          }
-          songId = record->at(song_idSong).get_asInt();
-          CFileItemPtr item(new CFileItem);
-          GetFileItemFromDataset(record, item.get(), musicUrl);
-          // HACK for sorting by database returned order
-          item->m_iprogramCount = ++count;
-          items.Add(item);
+        int idSongArtistRole = record->at(songArtistOffset + artistCredit_idRole).get_asInt();
+        if (idSongArtistRole == ROLE_ARTIST)
+          artistCredits.push_back(GetArtistCreditFromDataset(record, songArtistOffset));
+        else
+          items[items.Size() - 1]->GetMusicInfoTag()->AppendArtistRole(GetArtistRoleFromDataset(record, songArtistOffset));
+      }
+    };
+
+    CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
+    if (sorting.sortBy == SortByNone)
+    {
+      // rows are used in the order they are returned, so build the items
+      // while reading them instead of loading the whole result set first
+      if (!m_pDS->stream_query(strSQL))
+        return false;
+      if (m_pDS->eof())
+      {
+        m_pDS->close();
+        return true;
+      }
+
+      // Store the total number of songs as a property
+      items.SetProperty("total", total);
+      items.Reserve(total);
+      while (!m_pDS->eof())
+      {
+        try
+        {
+          addRecord(m_pDS->get_sql_record());
         }
-        // Get song artist credits and contributors
-        if (artistData)
+        catch (...)
         {
-          int idSongArtistRole = record->at(songArtistOffset + artistCredit_idRole).get_asInt();
-          if (idSongArtistRole == ROLE_ARTIST)
-            artistCredits.push_back(GetArtistCreditFromDataset(record, songArtistOffset));
-          else
-            items[items.Size() - 1]->GetMusicInfoTag()->AppendArtistRole(GetArtistRoleFromDataset(record, songArtistOffset));
+          m_pDS->close();
+          CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
+          return (items.Size() > 0);
         }
+        m_pDS->next();
       }
-      catch (...)
+    }
+    else
+    {
+      // run query
+      if (!m_pDS->query(strSQL))
+        return false;
+
+      int iRowsFound = m_pDS->num_rows();
+      if (iRowsFound == 0)
       {
         m_pDS->close();
-        CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
-        return (items.Size() > 0);
+        return true;
+      }
+
+      // Store the total number of songs as a property
+      items.SetProperty("total", total);
+
+      DatabaseResults results;
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sorting, MediaTypeSong, m_pDS, results))
+        return false;
+
+      items.Reserve(total);
+      const dbiplus::query_data &data = m_pDS->get_result_set().records;
+      for (const auto &i : results)
+      {
+        unsigned int targetRow = (unsigned int)i.at(FieldRow).asInteger();
+        try
+        {
+          addRecord(data.at(targetRow));
+        }
+        catch (...)
+        {
+          m_pDS->close();
+          CLog::Log(LOGERROR, "%s: out of memory loading query: %s", __FUNCTION__, filter.where.c_str());
+          return (items.Size() > 0);
+        }
       }
     }
     if (!artistCredits.empty())
@@ -5260,6 +5317,11 @@ void CMusicDatabase::UpdateTables(int version)
     // Update all songs iStartOffset and iEndOffset to milliseconds instead of frames (* 1000 / 75)
     m_pDS->exec("UPDATE song SET iStartOffset = iStartOffset * 40 / 3, iEndOffset = iEndOffset * 40 / 3 \n");
   }
+  if (version < 71)
+  {
+    // Full text search tables for the library search, filled when the analytics are created
+    CreateSearchTables();
+  }
 
   // Set the verion of tag scanning required. 
   // Not every schema change requires the tags to be rescanned, set to the highest schema version 
@@ -5280,7 +5342,7 @@ void CMusicDatabase::UpdateTables(int version)
 
 int CMusicDatabase::GetSchemaVersion() const
 {
-  return 70;
+  return 71;
 }
 
 int CMusicDatabase::GetMusicNeedsTagScan()
@@ -7066,20 +7128,19 @@ void CMusicDatabase::SetArtForItem(int mediaId, const std::string &mediaType, co
     if (artType.find('.') != std::string::npos)
       return;
 
-    std::string sql = PrepareSQL("SELECT art_id FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-    m_pDS->query(sql);
+    m_pDS->query("SELECT art_id FROM art WHERE media_id=? AND media_type=? AND type=?",
+                 { dbiplus::field_value(mediaId), dbiplus::field_value(mediaType), dbiplus::field_value(artType) });
     if (!m_pDS->eof())
     { // update
       int artId = m_pDS->fv(0).get_asInt();
       m_pDS->close();
-      sql = PrepareSQL("UPDATE art SET url='%s' where art_id=%d", url.c_str(), artId);
-      m_pDS->exec(sql);
+      m_pDS->exec("UPDATE art SET url=? where art_id=?", { dbiplus::field_value(url), dbiplus::field_value(artId) });
     }
     else
     { // insert
       m_pDS->close();
-      sql = PrepareSQL("INSERT INTO art(media_id, media_type, type, url) VALUES (%d, '%s', '%s', '%s')", mediaId, mediaType.c_str(), artType.c_str(), url.c_str());
-      m_pDS->exec(sql);
+      m_pDS->exec("INSERT INTO art(media_id, media_type, type, url) VALUES (?, ?, ?, ?)",
+                  { dbiplus::field_value(mediaId), dbiplus::field_value(mediaType), dbiplus::field_value(artType), dbiplus::field_value(url) });
     }
   }
   catch (...)
@@ -7185,6 +7246,98 @@ bool CMusicDatabase::GetArtForItem(int songId, int albumId, int artistId, bool b
   return false;
 }
 
+bool CMusicDatabase::GetArtForItems(const std::string &mediaType, const std::vector<int> &ids, std::map<int, std::vector<ArtForThumbLoader> > &art)
+{
+  if (ids.empty())
+    return true;
+
+  std::string strSQL;
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
+
+    std::vector<std::string> idList;
+    for (std::vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+    {
+      art[*it];
+      idList.push_back(StringUtils::Format("%i", *it));
+    }
+    const std::string strIds = StringUtils::Join(idList, ",");
+
+    // the owner column says which of the requested items the art is fetched for
+    if (mediaType == MediaTypeSong)
+    {
+      strSQL = PrepareSQL(
+        "SELECT art_id, song.idSong AS owner, media_type, type, '' AS prefix, url, 0 AS iorder FROM art "
+        "JOIN song ON art.media_id = song.idSong AND art.media_type = '%s' "
+        "WHERE song.idSong IN (%s) "
+        "UNION "
+        "SELECT art_id, song.idSong AS owner, media_type, type, '' AS prefix, url, 0 AS iorder FROM art "
+        "JOIN song ON art.media_id = song.idAlbum AND art.media_type = '%s' "
+        "WHERE song.idSong IN (%s) "
+        "UNION "
+        "SELECT art_id, song.idSong AS owner, media_type, type, 'albumartist' AS prefix, "
+        "url, album_artist.iOrder AS iorder FROM art "
+        "JOIN album_artist ON art.media_id = album_artist.idArtist AND art.media_type = '%s' "
+        "JOIN song ON song.idAlbum = album_artist.idAlbum "
+        "WHERE song.idSong IN (%s) "
+        "UNION "
+        "SELECT art_id, song_artist.idSong AS owner, media_type, type, 'artist' AS prefix, "
+        "url, song_artist.iOrder AS iorder FROM art "
+        "JOIN song_artist ON art.media_id = song_artist.idArtist AND art.media_type = '%s' "
+        "WHERE song_artist.idSong IN (%s) AND song_artist.idRole = %i",
+        MediaTypeSong, strIds.c_str(), MediaTypeAlbum, strIds.c_str(),
+        MediaTypeArtist, strIds.c_str(), MediaTypeArtist, strIds.c_str(), ROLE_ARTIST);
+    }
+    else if (mediaType == MediaTypeAlbum)
+    {
+      strSQL = PrepareSQL(
+        "SELECT art_id, media_id AS owner, media_type, type, '' AS prefix, url, 0 AS iorder FROM art "
+        "WHERE media_type = '%s' AND media_id IN (%s) "
+        "UNION "
+        "SELECT art_id, album_artist.idAlbum AS owner, media_type, type, 'albumartist' AS prefix, "
+        "url, album_artist.iOrder AS iorder FROM art "
+        "JOIN album_artist ON art.media_id = album_artist.idArtist AND art.media_type = '%s' "
+        "WHERE album_artist.idAlbum IN (%s)",
+        MediaTypeAlbum, strIds.c_str(), MediaTypeArtist, strIds.c_str());
+    }
+    else if (mediaType == MediaTypeArtist)
+    {
+      strSQL = PrepareSQL(
+        "SELECT art_id, media_id AS owner, media_type, type, '' AS prefix, url, 0 AS iorder FROM art "
+        "WHERE media_type = '%s' AND media_id IN (%s)",
+        MediaTypeArtist, strIds.c_str());
+    }
+    else
+      return false;
+
+    m_pDS2->query(strSQL);
+    while (!m_pDS2->eof())
+    {
+      ArtForThumbLoader artitem;
+      artitem.artType = m_pDS2->fv("type").get_asString();
+      artitem.mediaType = m_pDS2->fv("media_type").get_asString();
+      artitem.prefix = m_pDS2->fv("prefix").get_asString();
+      artitem.url = m_pDS2->fv("url").get_asString();
+      int iOrder = m_pDS2->fv("iorder").get_asInt();
+      // Add order to prefix for multiple artist art for songs and albums e.g. "albumartist2"
+      if (iOrder > 0)
+        artitem.prefix += m_pDS2->fv("iorder").get_asString();
+
+      art[m_pDS2->fv("owner").get_asInt()].emplace_back(artitem);
+      m_pDS2->next();
+    }
+    m_pDS2->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, strSQL.c_str());
+  }
+  return false;
+}
+
 bool CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, std::map<std::string, std::string> &art)
 {
   try
@@ -7192,8 +7345,7 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, st
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    std::string sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql);
+    m_pDS2->query("SELECT type,url FROM art WHERE media_id=? AND media_type=?", { dbiplus::field_value(mediaId), dbiplus::field_value(mediaType) });
     while (!m_pDS2->eof())
     {
       art.insert(std::make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
@@ -7211,8 +7363,8 @@ bool CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, st
 
 std::string CMusicDatabase::GetArtForItem(int mediaId, const std::string &mediaType, const std::string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  return GetSingleValue("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?",
+                        { dbiplus::field_value(mediaId), dbiplus::field_value(mediaType), dbiplus::field_value(artType) }, m_pDS2);
 }
 
 bool CMusicDatabase::RemoveArtForItem(int mediaId, const MediaType & mediaType, const std::string & artType)
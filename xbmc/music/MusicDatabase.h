@@ -205,6 +205,9 @@ public:
   //// Misc Song
   bool GetSongByFileName(const std::string& strFileName, CSong& song, int64_t startOffset = 0);
   bool GetSongsByPath(const std::string& strPath, MAPSONGS& songs, bool bAppendToMap = false);
+  /*! \brief Search artists, albums and songs by name
+   With a full text search index the matches of each kind are ranked by relevance, best first.
+   */
   bool Search(const std::string& search, CFileItemList &items);
   bool RemoveSongsFromPath(const std::string &path, MAPSONGS& songs, bool exact=true);
   bool SetSongUserrating(const std::string &filePath, int userrating);
@@ -512,6 +515,17 @@ public:
   */
   bool GetArtForItem(int songId, int albumId, int artistId, bool bPrimaryArtist, std::vector<ArtForThumbLoader> &art);
 
+  /*! \brief Fetch the art of several songs, albums or artists for the thumbloader at once.
+  Fetches the same art as GetArtForItem() does for each item: songs also get the art of their
+  album, album artists and song artists, albums that of their album artists.
+  \param mediaType the type of the items, "song", "album" or "artist".
+  \param ids ids of the items in the table of their media type.
+  \param art [out] the art of every item, empty for items without art.
+  \return true if the query succeeded, false otherwise.
+  \sa GetArtForItem
+  */
+  bool GetArtForItems(const std::string &mediaType, const std::vector<int> &ids, std::map<int, std::vector<ArtForThumbLoader> > &art);
+
   /*! \brief Fetch art for a database item.
    Fetches multiple pieces of art for a database item.
    \param mediaId the id in the media (song/artist/album) table.
@@ -588,6 +602,10 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full text search tables for artist, album and song names
+   */
+  void CreateSearchTables();
+
   CSong GetSongFromDataset();
   CSong GetSongFromDataset(const dbiplus::sql_record* const record, int offset = 0);
   CArtist GetArtistFromDataset(dbiplus::Dataset* pDS, int offset = 0, bool needThumb = true);
@@ -41,10 +41,52 @@ CMusicThumbLoader::~CMusicThumbLoader()
   delete m_musicDatabase;
 }
 
+/* Names the art of a library item according to the media type of the item.
+   For example: artists have "thumb", "fanart", "poster" etc.,
+   albums have "thumb", "artist.thumb", "artist.fanart",... "artist1.thumb", "artist1.fanart" etc.,
+   songs have "thumb", "album.thumb", "artist.thumb", "albumartist.thumb", "albumartist1.thumb" etc.
+*/
+static void NameLibraryArt(const std::string &mediaType, std::vector<ArtForThumbLoader> &art,
+                           std::map<std::string, std::string> &artmap, std::map<std::string, std::string> &fallbacks)
+{
+  std::string fanartfallback;
+  for (auto artitem : art)
+  {
+    std::string artname;
+    if (mediaType == artitem.mediaType)
+      artname = artitem.artType;
+    else if (artitem.prefix.empty())
+      artname = artitem.mediaType + "." + artitem.artType;
+    else
+    {
+      if (mediaType == MediaTypeAlbum)
+        StringUtils::Replace(artitem.prefix, "albumartist", "artist");
+      artname = artitem.prefix + "." + artitem.artType;
+    }
+
+    artmap.insert(std::make_pair(artname, artitem.url));
+
+    // Add fallback art for "thumb" and "fanart" art types only
+    // Set album thumb as the fallback used when song thumb is missing
+    if (mediaType == MediaTypeSong && artitem.mediaType == MediaTypeAlbum && artitem.artType == "thumb")
+      fallbacks[artitem.artType] = artname;
+
+    // For albums and songs set fallback fanart from the artist.
+    // For songs prefer primary song artist over primary albumartist fanart as fallback fanart
+    if (artitem.prefix == "artist" && artitem.artType == "fanart")
+      fanartfallback = artname;
+    if (artitem.prefix == "albumartist" && artitem.artType == "fanart" && fanartfallback.empty())
+      fanartfallback = artname;
+  }
+  if (!fanartfallback.empty())
+    fallbacks["fanart"] = fanartfallback;
+}
+
 void CMusicThumbLoader::OnLoaderStart()
 {
   m_musicDatabase->Open();
   m_albumArt.clear();
+  m_prefetchedArt.clear();
   CThumbLoader::OnLoaderStart();
 }
 
@@ -52,9 +94,47 @@ void CMusicThumbLoader::OnLoaderFinish()
 {
   m_musicDatabase->Close();
   m_albumArt.clear();
+  m_prefetchedArt.clear();
   CThumbLoader::OnLoaderFinish();
 }
 
+void CMusicThumbLoader::PrefetchItems(const std::vector<CFileItemPtr>& items)
+{
+  m_prefetchedArt.clear();
+
+  // collect the items FillLibraryArt() would look up, so the art of each media type is fetched in one query
+  std::map<std::string, std::vector<int> > ids;
+  for (std::vector<CFileItemPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    const CFileItem &item = **it;
+    if (item.m_bIsShareOrDrive || !item.HasMusicInfoTag() || !item.GetArt().empty())
+      continue;
+
+    const CMusicInfoTag &tag = *item.GetMusicInfoTag();
+    if (tag.GetDatabaseId() > -1 && !tag.GetType().empty())
+      ids[tag.GetType()].push_back(tag.GetDatabaseId());
+  }
+
+  if (ids.empty())
+    return;
+
+  m_musicDatabase->Open();
+  for (std::map<std::string, std::vector<int> >::const_iterator type = ids.begin(); type != ids.end(); ++type)
+  {
+    std::map<int, std::vector<ArtForThumbLoader> > art;
+    if (!m_musicDatabase->GetArtForItems(type->first, type->second, art))
+      continue;
+
+    std::map<int, CLibraryArt> &prefetched = m_prefetchedArt[type->first];
+    for (std::map<int, std::vector<ArtForThumbLoader> >::iterator i = art.begin(); i != art.end(); ++i)
+    {
+      CLibraryArt &libraryArt = prefetched[i->first];
+      NameLibraryArt(type->first, i->second, libraryArt.art, libraryArt.fallbacks);
+    }
+  }
+  m_musicDatabase->Close();
+}
+
 bool CMusicThumbLoader::LoadItem(CFileItem* pItem)
 {
   bool result  = LoadItemCached(pItem);
@@ -162,59 +242,36 @@ bool CMusicThumbLoader::FillLibraryArt(CFileItem &item)
   CMusicInfoTag &tag = *item.GetMusicInfoTag();
   if (tag.GetDatabaseId() > -1 && !tag.GetType().empty())
   {
-    m_musicDatabase->Open();
-    std::vector<ArtForThumbLoader> art;
-    bool artfound;
-    if (tag.GetType() == MediaTypeSong)
-      artfound = m_musicDatabase->GetArtForItem(tag.GetDatabaseId(), tag.GetAlbumId(), -1, false, art);
-    else if (tag.GetType() == MediaTypeAlbum)
-      artfound = m_musicDatabase->GetArtForItem(-1, tag.GetDatabaseId(), -1, false, art);
-    else //Artist
-      artfound = m_musicDatabase->GetArtForItem(-1, -1, tag.GetDatabaseId(), true, art);
-    
-    m_musicDatabase->Close();
-    if (artfound)
+    CLibraryArt libraryArt;
+    std::map<std::string, std::map<int, CLibraryArt> >::const_iterator prefetched = m_prefetchedArt.find(tag.GetType());
+    std::map<int, CLibraryArt>::const_iterator i;
+    if (prefetched != m_prefetchedArt.end() &&
+        (i = prefetched->second.find(tag.GetDatabaseId())) != prefetched->second.end())
+      libraryArt = i->second;
+    else
     {
-      std::string fanartfallback;
-      std::map<std::string, std::string> artmap;
-      for (auto artitem : art)
-      {
-        /* Add art to artmap, naming according to media type. 
-           For example: artists have "thumb", "fanart", "poster" etc.,
-           albums have "thumb", "artist.thumb", "artist.fanart",... "artist1.thumb", "artist1.fanart" etc.,
-           songs have "thumb", "album.thumb", "artist.thumb", "albumartist.thumb", "albumartist1.thumb" etc.
-        */
-        std::string artname;
-        if (tag.GetType() == artitem.mediaType)
-          artname = artitem.artType;
-        else if (artitem.prefix.empty())
-          artname = artitem.mediaType + "." + artitem.artType;
-        else
-        {
-          if (tag.GetType() == MediaTypeAlbum)
-            StringUtils::Replace(artitem.prefix, "albumartist", "artist");
-          artname = artitem.prefix + "." + artitem.artType;
-        }
-
-        artmap.insert(std::make_pair(artname, artitem.url));
-
-        // Add fallback art for "thumb" and "fanart" art types only
-        // Set album thumb as the fallback used when song thumb is missing
-        if (tag.GetType() == MediaTypeSong && artitem.mediaType == MediaTypeAlbum && artitem.artType == "thumb")
-          item.SetArtFallback(artitem.artType, artname);
-
-        // For albums and songs set fallback fanart from the artist.
-        // For songs prefer primary song artist over primary albumartist fanart as fallback fanart 
-        if (artitem.prefix == "artist" && artitem.artType == "fanart")
-          fanartfallback = artname;
-        if (artitem.prefix == "albumartist" && artitem.artType == "fanart" && fanartfallback.empty())
-          fanartfallback = artname;
-      }
-      if (!fanartfallback.empty())
-        item.SetArtFallback("fanart", fanartfallback);
+      m_musicDatabase->Open();
+      std::vector<ArtForThumbLoader> art;
+      bool artfound;
+      if (tag.GetType() == MediaTypeSong)
+        artfound = m_musicDatabase->GetArtForItem(tag.GetDatabaseId(), tag.GetAlbumId(), -1, false, art);
+      else if (tag.GetType() == MediaTypeAlbum)
+        artfound = m_musicDatabase->GetArtForItem(-1, tag.GetDatabaseId(), -1, false, art);
+      else //Artist
+        artfound = m_musicDatabase->GetArtForItem(-1, -1, tag.GetDatabaseId(), true, art);
+
+      m_musicDatabase->Close();
+      if (artfound)
+        NameLibraryArt(tag.GetType(), art, libraryArt.art, libraryArt.fallbacks);
+    }
+
+    if (!libraryArt.art.empty())
+    {
+      for (std::map<std::string, std::string>::const_iterator fallback = libraryArt.fallbacks.begin(); fallback != libraryArt.fallbacks.end(); ++fallback)
+        item.SetArtFallback(fallback->first, fallback->second);
 
-      item.SetArt(artmap);
-    }       
+      item.SetArt(libraryArt.art);
+    }
   }
   return !item.GetArt().empty();
 }
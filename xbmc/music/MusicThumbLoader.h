@@ -20,9 +20,10 @@
  */
 
 #include <map>
+#include <vector>
 #include "ThumbLoader.h"
+#include "FileItem.h"
 
-class CFileItem;
 class CMusicDatabase;
 class EmbeddedArt;
 
@@ -64,7 +65,18 @@ public:
   static bool GetEmbeddedThumb(const std::string &path, EmbeddedArt &art);
 
 protected:
+  void PrefetchItems(const std::vector<CFileItemPtr>& items) override;
+
+  /*! \brief Art of a music library item, named for the item's media type
+   */
+  struct CLibraryArt
+  {
+    std::map<std::string, std::string> art;
+    std::map<std::string, std::string> fallbacks; ///< art type -> art name used when it is missing
+  };
+
   CMusicDatabase *m_musicDatabase;
   typedef std::map<int, std::map<std::string, std::string> > ArtCache;
   ArtCache m_albumArt;
+  std::map<std::string, std::map<int, CLibraryArt> > m_prefetchedArt; ///< art of the current page by media type
 };
@@ -21,6 +21,7 @@
 #include "MusicInfoScanner.h"
 
 #include <algorithm>
+#include <map>
 #include <utility>
 
 #include "ServiceBroker.h"
@@ -47,14 +48,15 @@
 #include "music/MusicLibraryQueue.h"
 #include "music/MusicThumbLoader.h"
 #include "music/tags/MusicInfoTag.h"
-#include "music/tags/MusicInfoTagLoaderFactory.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
+#include "MusicTagReader.h"
 #include "NfoFile.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "TextureCache.h"
 #include "threads/SystemClock.h"
+#include "URL.h"
 #include "Util.h"
 #include "utils/FileExtensionProvider.h"
 #include "utils/log.h"
@@ -543,11 +545,9 @@ CInfoScanner::INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items,
 {
   std::vector<std::string> regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
+  std::vector<CFileItemPtr> files;
   for (int i = 0; i < items.Size(); ++i)
   {
-    if (m_bStop)
-      return INFO_CANCELLED;
-
     CFileItemPtr pItem = items[i];
 
     if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
@@ -556,15 +556,18 @@ CInfoScanner::INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items,
     if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
       continue;
 
+    files.push_back(pItem);
+  }
+
+  // the tags are read in parallel, but the items are handled in the order of the files,
+  // so grouping them into albums doesn't depend on which read finishes first
+  CMusicTagReader reader(files, g_advancedSettings.m_musicScannerThreads);
+  CFileItemPtr pItem;
+  while (reader.Next(pItem, m_bStop))
+  {
     m_currentItem++;
 
     CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-    if (!tag.Loaded())
-    {
-      std::unique_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(*pItem));
-      if (NULL != pLoader.get())
-        pLoader->Load(pItem->GetPath(), tag);
-    }
 
     if (m_handle && m_itemCount>0)
       m_handle->SetPercentage(static_cast<float>(m_currentItem * 100) / static_cast<float>(m_itemCount));
@@ -585,6 +588,10 @@ CInfoScanner::INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items,
     else
       scannedItems.Add(pItem);
   }
+
+  if (m_bStop)
+    return INFO_CANCELLED;
+
   return INFO_ADDED;
 }
 
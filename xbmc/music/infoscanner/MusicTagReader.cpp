@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MusicTagReader.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+
+#include "FileItem.h"
+#include "music/tags/MusicInfoTag.h"
+#include "music/tags/MusicInfoTagLoaderFactory.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Condition.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "URL.h"
+
+using namespace MUSIC_INFO;
+
+namespace
+{
+  /*! \brief Limits the tags read at once from the same host, over all scans.
+   Network shares are latency bound, so reading several files at once pays off,
+   but too many at once only make the server seek between them.
+   */
+  class CHostThrottle
+  {
+  public:
+    /*! \brief Wait for a slot for a host.
+     \param host the host the file is read from.
+     \param cancelled stop waiting once this is set.
+     \return true if a slot was acquired, false if cancelled.
+     */
+    bool Acquire(const std::string& host, const std::atomic<bool>& cancelled)
+    {
+      CSingleLock lock(m_critSection);
+      while (m_hosts[host] >= g_advancedSettings.m_musicScannerHostThreads)
+      {
+        if (cancelled)
+          return false;
+        m_released.wait(lock, 100);
+      }
+      m_hosts[host]++;
+      return true;
+    }
+
+    void Release(const std::string& host)
+    {
+      CSingleLock lock(m_critSection);
+      if (--m_hosts[host] == 0)
+        m_hosts.erase(host);
+      m_released.notifyAll();
+    }
+
+  private:
+    CCriticalSection m_critSection;
+    XbmcThreads::ConditionVariable m_released;
+    std::map<std::string, unsigned int> m_hosts;
+  };
+
+  CHostThrottle hostThrottle;
+}
+
+struct CMusicTagReader::CEntry
+{
+  explicit CEntry(const CFileItemPtr& fileItem)
+    : item(fileItem), tag(*fileItem->GetMusicInfoTag()), done(true) {}
+
+  CFileItemPtr item;
+  CMusicInfoTag tag;
+  CEvent done;
+};
+
+/*! \brief The state shared with the reading jobs.
+ It outlives the reader until the last job is done.
+ */
+class CMusicTagReader::CReadState
+{
+public:
+  explicit CReadState(const TagLoader& loader) : m_loader(loader), m_cancelled(false) {}
+
+  void Read(CEntry& entry)
+  {
+    // local files are only limited by the number of threads
+    const std::string host = CURL(entry.item->GetPath()).GetHostName();
+    if (host.empty())
+      m_loader(*entry.item, entry.tag);
+    else if (hostThrottle.Acquire(host, m_cancelled))
+    {
+      m_loader(*entry.item, entry.tag);
+      hostThrottle.Release(host);
+    }
+    entry.done.Set();
+  }
+
+  void Cancel() { m_cancelled = true; }
+
+private:
+  TagLoader m_loader;
+  std::atomic<bool> m_cancelled;
+};
+
+CMusicTagReader::CMusicTagReader(const std::vector<CFileItemPtr>& files, unsigned int threads, TagLoader loader)
+  : m_files(files),
+    m_maxPending(4 * threads),
+    m_state(std::make_shared<CReadState>(loader)),
+    m_queue(false, threads, CJob::PRIORITY_DEDICATED)
+{
+  m_next = m_files.begin();
+}
+
+CMusicTagReader::~CMusicTagReader()
+{
+  // reads that are still queued or running only touch their shared state
+  m_state->Cancel();
+  m_queue.CancelJobs();
+}
+
+bool CMusicTagReader::Next(CFileItemPtr& item, const bool& stop)
+{
+  // keep the reads going, without holding too many tags in memory
+  while (m_next != m_files.end() && m_pending.size() < m_maxPending)
+  {
+    std::shared_ptr<CEntry> entry = std::make_shared<CEntry>(*m_next);
+    if (entry->tag.Loaded())
+      entry->done.Set();
+    else
+    {
+      std::shared_ptr<CReadState> state = m_state;
+      m_queue.Submit([state, entry]() { state->Read(*entry); });
+    }
+    m_pending.push_back(entry);
+    ++m_next;
+  }
+
+  if (m_pending.empty())
+    return false;
+
+  std::shared_ptr<CEntry> entry = m_pending.front();
+  while (!entry->done.WaitMSec(100))
+  {
+    if (stop)
+      break;
+  }
+
+  if (stop)
+    return false;
+
+  m_pending.pop_front();
+  item = entry->item;
+  *item->GetMusicInfoTag() = entry->tag;
+  return true;
+}
+
+void CMusicTagReader::LoadTag(const CFileItem& item, CMusicInfoTag& tag)
+{
+  std::unique_ptr<IMusicInfoTagLoader> pLoader(CMusicInfoTagLoaderFactory::CreateLoader(item));
+  if (NULL != pLoader.get())
+    pLoader->Load(item.GetPath(), tag);
+}
@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "utils/JobManager.h"
+
+class CFileItem; typedef std::shared_ptr<CFileItem> CFileItemPtr;
+
+namespace MUSIC_INFO
+{
+  class CMusicInfoTag;
+
+  /*! \brief Reads the tags of files on a pool of jobs and hands the files out in their order.
+   The tags are read into copies and only set on the items by Next(), on the caller's thread,
+   so the caller sees the same items in the same order as when reading them one by one.
+   */
+  class CMusicTagReader
+  {
+  public:
+    /*! \brief Loads the tag of a file. Called from the reading jobs.
+     */
+    typedef std::function<void(const CFileItem& item, CMusicInfoTag& tag)> TagLoader;
+
+    /*! \brief Start reading the tags of files.
+     Files whose tag is already loaded are not read again.
+     \param files the files to read the tags of.
+     \param threads the number of tags read at once.
+     \param loader loads a tag, the tag loader of the file type by default.
+     */
+    CMusicTagReader(const std::vector<CFileItemPtr>& files, unsigned int threads, TagLoader loader = LoadTag);
+    ~CMusicTagReader();
+
+    /*! \brief Get the next file, with its tag set once it is read.
+     \param item [out] the next file.
+     \param stop stop waiting for the tag once this is set.
+     \return false once all files were handed out or if stopped, true otherwise.
+     */
+    bool Next(CFileItemPtr& item, const bool& stop);
+
+    /*! \brief Load a tag with the tag loader of the file type.
+     */
+    static void LoadTag(const CFileItem& item, CMusicInfoTag& tag);
+
+  private:
+    CMusicTagReader(const CMusicTagReader&) = delete;
+    CMusicTagReader& operator=(const CMusicTagReader&) = delete;
+
+    struct CEntry;
+    class CReadState;
+
+    std::vector<CFileItemPtr> m_files;
+    std::vector<CFileItemPtr>::const_iterator m_next;
+    std::deque<std::shared_ptr<CEntry>> m_pending;
+    size_t m_maxPending;
+    std::shared_ptr<CReadState> m_state;
+    CJobQueue m_queue;
+  };
+}
@@ -0,0 +1,177 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "music/infoscanner/MusicTagReader.h"
+#include "music/tags/MusicInfoTag.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef TARGET_POSIX
+#include "platform/linux/XTimeUtils.h"
+#endif
+
+using namespace MUSIC_INFO;
+
+namespace
+{
+  /* names the tag after the file, the later files of a directory take less time to read */
+  void LoadTag(const CFileItem& item, CMusicInfoTag& tag, std::atomic<int>& reads)
+  {
+    const std::string name = URIUtils::GetFileName(item.GetPath());
+    const int track = atoi(name.c_str());
+    Sleep((40 - track) % 7);
+    tag.SetTitle("Title " + name);
+    tag.SetTrackNumber(track);
+    tag.SetLoaded(true);
+    reads++;
+  }
+
+  std::vector<CFileItemPtr> Files(int count)
+  {
+    std::vector<CFileItemPtr> files;
+    for (int i = 0; i < count; i++)
+      files.push_back(CFileItemPtr(new CFileItem(StringUtils::Format("special://temp/%02i.mp3", i), false)));
+    return files;
+  }
+
+  std::string Describe(const CFileItem& item)
+  {
+    const CMusicInfoTag& tag = *item.GetMusicInfoTag();
+    return StringUtils::Format("%s %s %i %i", item.GetPath().c_str(), tag.GetTitle().c_str(),
+                               tag.GetTrackNumber(), tag.Loaded() ? 1 : 0);
+  }
+
+  /* what ScanTags did before the tags were read in parallel */
+  std::vector<std::string> ReadSerially(const std::vector<CFileItemPtr>& files)
+  {
+    std::atomic<int> reads(0);
+    std::vector<std::string> result;
+    for (const auto &file : files)
+    {
+      CFileItem item(*file);
+      if (!item.GetMusicInfoTag()->Loaded())
+        LoadTag(item, *item.GetMusicInfoTag(), reads);
+      result.push_back(Describe(item));
+    }
+    return result;
+  }
+
+  std::vector<std::string> ReadInParallel(const std::vector<CFileItemPtr>& files, unsigned int threads, int& reads)
+  {
+    std::shared_ptr<std::atomic<int>> count = std::make_shared<std::atomic<int>>(0);
+    std::vector<std::string> result;
+    {
+      CMusicTagReader reader(files, threads,
+        [count](const CFileItem& item, CMusicInfoTag& tag) { LoadTag(item, tag, *count); });
+      bool stop = false;
+      CFileItemPtr item;
+      while (reader.Next(item, stop))
+        result.push_back(Describe(*item));
+    }
+    reads = *count;
+    return result;
+  }
+}
+
+TEST(TestMusicTagReader, FileOrder)
+{
+  const std::vector<CFileItemPtr> serial = Files(40);
+  const std::vector<std::string> expected = ReadSerially(serial);
+
+  for (unsigned int threads : { 1, 8 })
+  {
+    int reads = 0;
+    EXPECT_EQ(expected, ReadInParallel(Files(40), threads, reads)) << threads << " threads";
+    EXPECT_EQ(40, reads);
+  }
+}
+
+TEST(TestMusicTagReader, LoadedTagsNotRead)
+{
+  std::vector<CFileItemPtr> files = Files(10);
+  for (int i = 0; i < 10; i += 2)
+  {
+    files[i]->GetMusicInfoTag()->SetTitle("Cached");
+    files[i]->GetMusicInfoTag()->SetLoaded(true);
+  }
+  const std::vector<std::string> expected = ReadSerially(files);
+
+  int reads = 0;
+  EXPECT_EQ(expected, ReadInParallel(files, 4, reads));
+  EXPECT_EQ(5, reads);
+  EXPECT_EQ("Cached", files[0]->GetMusicInfoTag()->GetTitle());
+}
+
+TEST(TestMusicTagReader, ItemsSetInOrder)
+{
+  // the tags are read into copies, an item only gets its tag when it is handed out
+  std::vector<CFileItemPtr> files = Files(8);
+  std::atomic<int> reads(0);
+  CMusicTagReader reader(files, 8,
+    [&reads](const CFileItem& item, CMusicInfoTag& tag) { LoadTag(item, tag, reads); });
+
+  bool stop = false;
+  CFileItemPtr item;
+  ASSERT_TRUE(reader.Next(item, stop));
+  EXPECT_EQ(files[0], item);
+  EXPECT_TRUE(item->GetMusicInfoTag()->Loaded());
+  while (reads < 8)
+    Sleep(1);
+  for (size_t i = 1; i < files.size(); i++)
+    EXPECT_FALSE(files[i]->GetMusicInfoTag()->Loaded());
+
+  for (size_t i = 1; i < files.size(); i++)
+  {
+    ASSERT_TRUE(reader.Next(item, stop));
+    EXPECT_EQ(files[i], item);
+  }
+  EXPECT_FALSE(reader.Next(item, stop));
+}
+
+TEST(TestMusicTagReader, Stopped)
+{
+  std::vector<CFileItemPtr> files = Files(40);
+  std::shared_ptr<std::atomic<int>> reads = std::make_shared<std::atomic<int>>(0);
+  bool stop = false;
+  {
+    CMusicTagReader reader(files, 2,
+      [reads](const CFileItem& item, CMusicInfoTag& tag) { LoadTag(item, tag, *reads); });
+
+    CFileItemPtr item;
+    ASSERT_TRUE(reader.Next(item, stop));
+    stop = true;
+    EXPECT_FALSE(reader.Next(item, stop));
+  }
+
+  // reads still running when the reader is gone leave the items alone
+  Sleep(50);
+  for (size_t i = 1; i < files.size(); i++)
+    EXPECT_FALSE(files[i]->GetMusicInfoTag()->Loaded());
+  EXPECT_LT(*reads, 40);
+}
@@ -18,6 +18,7 @@
  *
  */
 #include "limits.h"
+#include <algorithm>
 #include "TagLibVFSStream.h"
 #include "filesystem/File.h"
 #include <taglib/tiostream.h>
@@ -26,6 +27,10 @@ using namespace XFILE;
 using namespace TagLib;
 using namespace MUSIC_INFO;
 
+// tags mostly sit at the start of a file, reading that in one go saves a round trip
+// per block TagLib reads when the file is on a network share
+#define HEADER_PREFETCH_SIZE (64 * 1024)
+
 /*!
  * Construct a File object and opens the \a file.  \a file should be a
  * be an XBMC Vfile.
@@ -45,6 +50,22 @@ TagLibVFSStream::TagLibVFSStream(const std::string& strFileName, bool readOnly)
   }
   m_strFileName = strFileName;
   m_bIsReadOnly = readOnly || !m_bIsOpen;
+
+  if (readOnly && m_bIsOpen)
+  {
+    int64_t fileLen = m_file.GetLength();
+    m_header.resize(static_cast<size_t>(fileLen > 0 && fileLen < HEADER_PREFETCH_SIZE ? fileLen : HEADER_PREFETCH_SIZE));
+    size_t filled = 0;
+    while (filled < m_header.size())
+    {
+      ssize_t read = m_file.Read(m_header.data() + filled, m_header.size() - filled);
+      if (read <= 0)
+        break;
+      filled += read;
+    }
+    m_header.resize(filled);
+    m_file.Seek(0, SEEK_SET);
+  }
 }
 
 /*!
@@ -68,6 +89,17 @@ FileName TagLibVFSStream::name() const
  */
 ByteVector TagLibVFSStream::readBlock(TagLib::ulong length)
 {
+  int64_t pos = m_file.GetPosition();
+  if (pos >= 0 && pos < static_cast<int64_t>(m_header.size()))
+  {
+    TagLib::ulong inHeader = std::min(length, static_cast<TagLib::ulong>(m_header.size() - pos));
+    ByteVector byteVector(m_header.data() + pos, static_cast<TagLib::uint>(inHeader));
+    m_file.Seek(pos + inHeader, SEEK_SET);
+    if (inHeader < length)
+      byteVector.append(readBlock(length - inHeader));
+    return byteVector;
+  }
+
   ByteVector byteVector(static_cast<TagLib::uint>(length));
   ssize_t read = m_file.Read(byteVector.data(), length);
   if (read > 0)
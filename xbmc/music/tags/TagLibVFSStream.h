@@ -20,6 +20,7 @@
  */
 #include "filesystem/File.h"
 #include <taglib/tiostream.h>
+#include <vector>
 
 namespace MUSIC_INFO
 {
@@ -124,6 +125,7 @@ namespace MUSIC_INFO
   private:
     std::string   m_strFileName;
     XFILE::CFile  m_file;
+    std::vector<char> m_header; ///< start of a read only file, fetched at once when opening
     bool          m_bIsReadOnly;
     bool          m_bIsOpen;
   };
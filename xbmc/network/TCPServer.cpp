@@ -19,12 +19,21 @@
  */
 
 #include "TCPServer.h"
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#include <sys/epoll.h>
+#define HAS_EPOLL 1
+#endif
+#if defined(TARGET_POSIX)
+#include <fcntl.h>
+#endif
+
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "interfaces/AnnouncementManager.h"
@@ -62,6 +71,196 @@ using namespace ANNOUNCEMENT;
 
 #define RECEIVEBUFFER 1024
 
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static void SetNonBlocking(SOCKET socket)
+{
+#if defined(TARGET_WINDOWS)
+  u_long nonBlocking = 1;
+  ioctlsocket(socket, FIONBIO, &nonBlocking);
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  if (flags != -1)
+    fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+static bool WouldBlock()
+{
+#if defined(TARGET_WINDOWS)
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/* Waits for activity on the server and client sockets. epoll is used where it is
+   available, it isn't limited by FD_SETSIZE and doesn't need the socket sets to be
+   rebuilt for every wait. Elsewhere the sockets are polled with select(). */
+class CTCPServer::CSocketPoller
+{
+public:
+  struct Event
+  {
+    SOCKET socket;
+    bool readable;
+    bool writable;
+  };
+
+  CSocketPoller();
+  ~CSocketPoller();
+
+  bool Add(SOCKET socket);
+  void Remove(SOCKET socket);
+  void SetPollWrite(SOCKET socket, bool pollWrite);
+  bool Wait(int timeoutMs, std::vector<Event>& events);
+
+private:
+#ifdef HAS_EPOLL
+  int m_epoll;
+#else
+  CCriticalSection m_critSection;
+  std::map<SOCKET, bool> m_sockets; // socket -> poll for writing
+#endif
+};
+
+#ifdef HAS_EPOLL
+CTCPServer::CSocketPoller::CSocketPoller()
+{
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epoll < 0)
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance: %d", errno);
+}
+
+CTCPServer::CSocketPoller::~CSocketPoller()
+{
+  if (m_epoll >= 0)
+    close(m_epoll);
+}
+
+bool CTCPServer::CSocketPoller::Add(SOCKET socket)
+{
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = socket;
+  return epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+void CTCPServer::CSocketPoller::Remove(SOCKET socket)
+{
+  struct epoll_event event = {};
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, &event);
+}
+
+void CTCPServer::CSocketPoller::SetPollWrite(SOCKET socket, bool pollWrite)
+{
+  struct epoll_event event = {};
+  event.events = EPOLLIN | (pollWrite ? EPOLLOUT : 0);
+  event.data.fd = socket;
+  epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &event);
+}
+
+bool CTCPServer::CSocketPoller::Wait(int timeoutMs, std::vector<Event>& events)
+{
+  events.clear();
+  if (m_epoll < 0)
+    return false;
+
+  struct epoll_event ready[64];
+  int count = epoll_wait(m_epoll, ready, sizeof(ready) / sizeof(ready[0]), timeoutMs);
+  if (count < 0)
+    return errno == EINTR;
+
+  for (int i = 0; i < count; i++)
+  {
+    Event event;
+    event.socket = ready[i].data.fd;
+    // errors and hangups are reported as readable, the following recv() reveals them
+    event.readable = (ready[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+    event.writable = (ready[i].events & EPOLLOUT) != 0;
+    events.push_back(event);
+  }
+
+  return true;
+}
+#else
+CTCPServer::CSocketPoller::CSocketPoller() = default;
+
+CTCPServer::CSocketPoller::~CSocketPoller() = default;
+
+bool CTCPServer::CSocketPoller::Add(SOCKET socket)
+{
+  CSingleLock lock(m_critSection);
+  m_sockets[socket] = false;
+  return true;
+}
+
+void CTCPServer::CSocketPoller::Remove(SOCKET socket)
+{
+  CSingleLock lock(m_critSection);
+  m_sockets.erase(socket);
+}
+
+void CTCPServer::CSocketPoller::SetPollWrite(SOCKET socket, bool pollWrite)
+{
+  CSingleLock lock(m_critSection);
+  std::map<SOCKET, bool>::iterator it = m_sockets.find(socket);
+  if (it != m_sockets.end())
+    it->second = pollWrite;
+}
+
+bool CTCPServer::CSocketPoller::Wait(int timeoutMs, std::vector<Event>& events)
+{
+  events.clear();
+
+  SOCKET          max_fd = 0;
+  fd_set          rfds, wfds;
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+  bool pollWrite = false;
+  {
+    CSingleLock lock(m_critSection);
+    for (std::map<SOCKET, bool>::const_iterator it = m_sockets.begin(); it != m_sockets.end(); ++it)
+    {
+      FD_SET(it->first, &rfds);
+      if (it->second)
+      {
+        FD_SET(it->first, &wfds);
+        pollWrite = true;
+      }
+      if ((intptr_t)it->first > (intptr_t)max_fd)
+        max_fd = it->first;
+    }
+  }
+
+  // output queued while waiting is only noticed on the next round, so keep it short
+  if (pollWrite)
+    timeoutMs = std::min(timeoutMs, 50);
+  struct timeval to = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res < 0)
+    return false;
+
+  CSingleLock lock(m_critSection);
+  for (std::map<SOCKET, bool>::const_iterator it = m_sockets.begin(); it != m_sockets.end() && res > 0; ++it)
+  {
+    Event event;
+    event.socket = it->first;
+    event.readable = FD_ISSET(it->first, &rfds) != 0;
+    event.writable = FD_ISSET(it->first, &wfds) != 0;
+    if (event.readable || event.writable)
+      events.push_back(event);
+  }
+
+  return true;
+}
+#endif
+
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
 bool CTCPServer::StartServer(int port, bool nonlocal)
@@ -119,116 +318,181 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
   m_sdpd = NULL;
 }
 
+CTCPServer::~CTCPServer() = default;
+
 void CTCPServer::Process()
 {
   m_bStop = false;
 
+  std::vector<CSocketPoller::Event> events;
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
-
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+    if (m_poller == nullptr || !m_poller->Wait(1000, events))
     {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for the sockets failed");
+      Sleep(1000);
+      Initialize();
+      continue;
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (std::vector<CSocketPoller::Event>::const_iterator event = events.begin(); event != events.end(); ++event)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      if (std::find(m_servers.begin(), m_servers.end(), event->socket) != m_servers.end())
+      {
+        // the servers have been reinitialized, the remaining events are stale
+        if (event->readable && !AcceptConnection(event->socket))
+          break;
+        continue;
+      }
+
+      if (event->writable)
+        WriteToConnection(event->socket);
+      if (event->readable)
+        ReadFromConnection(event->socket);
     }
+  }
+
+  Deinitialize();
+}
+
+bool CTCPServer::AcceptConnection(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  CTCPClient *newconnection = new CTCPClient();
+  newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    int error = errno;
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", error);
+    delete newconnection;
+    if (EBADF == error)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
+      return false;
     }
-    else if (res > 0)
+    return true;
+  }
+
+  // writes must never block the server, slow clients get their output queued
+  SetNonBlocking(newconnection->m_socket);
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  CSingleLock lock(m_critSection);
+  m_connections[newconnection->m_socket] = newconnection;
+  m_poller->Add(newconnection->m_socket);
+  return true;
+}
+
+void CTCPServer::ReadFromConnection(SOCKET socket)
+{
+  // connections are only removed by this thread, so the client stays valid without the lock
+  CTCPClient *client = NULL;
+  {
+    CSingleLock lock(m_critSection);
+    std::map<SOCKET, CTCPClient*>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+      return;
+    client = it->second;
+  }
+
+  char buffer[RECEIVEBUFFER] = {};
+  int  nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+  if (nread < 0 && WouldBlock())
+    return;
+
+  bool close = false;
+  if (nread > 0)
+  {
+    std::string response;
+    if (client->IsNew())
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (!response.empty())
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+      if (!response.empty())
+        client->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        // Replace the CTCPClient with a CWebSocketClient
+        CSingleLock lock(m_critSection);
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *client);
+        m_connections[socket] = websocketClient;
+        delete client;
+        client = websocketClient;
       }
     }
+
+    if (response.size() <= 0)
+      client->PushBuffer(this, buffer, nread);
+
+    close = client->Closing();
   }
+  else
+    close = true;
 
-  Deinitialize();
+  if (close)
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    CloseConnection(socket);
+  }
+  else
+    UpdateWritePolling(client);
+}
+
+void CTCPServer::WriteToConnection(SOCKET socket)
+{
+  CTCPClient *client = NULL;
+  {
+    CSingleLock lock(m_critSection);
+    std::map<SOCKET, CTCPClient*>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+      return;
+    client = it->second;
+  }
+
+  {
+    CSingleLock lock(client->m_critSection);
+    client->FlushOutput();
+  }
+
+  if (client->Closing())
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnecting client that failed to receive its data");
+    CloseConnection(socket);
+  }
+  else
+    UpdateWritePolling(client);
+}
+
+void CTCPServer::UpdateWritePolling(CTCPClient *client)
+{
+  CSingleLock lock(client->m_critSection);
+  const bool pending = client->HasPendingOutput();
+  if (pending != client->m_pollingWrite && m_poller != nullptr)
+  {
+    m_poller->SetPollWrite(client->m_socket, pending);
+    client->m_pollingWrite = pending;
+  }
+}
+
+void CTCPServer::CloseConnection(SOCKET socket)
+{
+  CTCPClient *client = NULL;
+  {
+    CSingleLock lock(m_critSection);
+    std::map<SOCKET, CTCPClient*>::iterator it = m_connections.find(socket);
+    if (it == m_connections.end())
+      return;
+    client = it->second;
+    m_connections.erase(it);
+    if (m_poller != nullptr)
+      m_poller->Remove(socket);
+  }
+
+  client->Disconnect();
+  delete client;
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -248,17 +512,22 @@ int CTCPServer::GetCapabilities()
 
 void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
-  std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
+  // serialized once and shared by the output queues of all clients
+  std::shared_ptr<const std::string> str = std::make_shared<const std::string>(
+    IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact));
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  CSingleLock lock(m_critSection);
+  for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
+    CTCPClient *client = it->second;
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
+      CSingleLock lock (client->m_critSection);
+      if ((client->GetAnnouncementFlags() & flag) == 0)
         continue;
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    client->SendAnnouncement(str);
+    UpdateWritePolling(client);
   }
 }
 
@@ -273,6 +542,10 @@ bool CTCPServer::Initialize()
 
   if (started)
   {
+    m_poller.reset(new CSocketPoller());
+    for (std::vector<SOCKET>::const_iterator it = m_servers.begin(); it != m_servers.end(); ++it)
+      m_poller->Add(*it);
+
     CAnnouncementManager::GetInstance().AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -487,13 +760,18 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  // before taking the lock, announcements hold the announcer lock while they take ours
+  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
+
+  CSingleLock lock(m_critSection);
+  for (std::map<SOCKET, CTCPClient*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
+    it->second->Disconnect();
+    delete it->second;
   }
 
   m_connections.clear();
+  m_poller.reset();
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -505,8 +783,6 @@ void CTCPServer::Deinitialize()
     sdp_close((sdp_session_t*)m_sdpd);
   m_sdpd = NULL;
 #endif
-
-  CAnnouncementManager::GetInstance().RemoveAnnouncer(this);
 }
 
 CTCPServer::CTCPClient::CTCPClient()
@@ -520,6 +796,11 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endChar = 0;
 
   m_addrlen = sizeof(m_cliaddr);
+  m_pollingWrite = false;
+  m_outputOffset = 0;
+  m_outputSize = 0;
+  m_droppedAnnouncements = 0;
+  m_sendFailed = false;
 }
 
 CTCPServer::CTCPClient::CTCPClient(const CTCPClient& client)
@@ -551,12 +832,69 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  QueueOutput(std::make_shared<const std::string>(data, size), false);
+  FlushOutput();
+}
+
+void CTCPServer::CTCPClient::SendAnnouncement(const std::shared_ptr<const std::string>& announcement)
+{
+  CSingleLock lock (m_critSection);
+  if (QueueOutput(announcement, true))
+    FlushOutput();
+}
+
+bool CTCPServer::CTCPClient::QueueOutput(const std::shared_ptr<const std::string>& data, bool droppable)
+{
+  if (droppable)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    // announcements are dropped for clients that don't keep up, so they can't hold up the others
+    if (m_outputSize + data->size() > MAX_OUTPUT_SIZE)
+    {
+      if (m_droppedAnnouncements++ == 0)
+        CLog::Log(LOGWARNING, "JSONRPC Server: Client is too slow, dropping announcements");
+      return false;
+    }
+
+    if (m_droppedAnnouncements > 0)
+    {
+      CLog::Log(LOGINFO, "JSONRPC Server: Client caught up after %u announcements were dropped", m_droppedAnnouncements);
+      m_droppedAnnouncements = 0;
+    }
+  }
+
+  m_output.push_back(data);
+  m_outputSize += data->size();
+  return true;
+}
+
+bool CTCPServer::CTCPClient::FlushOutput()
+{
+  CSingleLock lock (m_critSection);
+  while (!m_output.empty())
+  {
+    const std::string& data = *m_output.front();
+    if (m_outputOffset < data.size())
+    {
+      int sent = send(m_socket, data.c_str() + m_outputOffset, data.size() - m_outputOffset, SEND_FLAGS);
+      if (sent < 0)
+      {
+        if (!WouldBlock())
+          m_sendFailed = true;
+        return false;
+      }
+
+      m_outputOffset += sent;
+      m_outputSize -= sent;
+      if (m_outputOffset < data.size())
+        return false;
+    }
+
+    m_output.pop_front();
+    m_outputOffset = 0;
+  }
+
+  return true;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -619,6 +957,12 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_pollingWrite      = client.m_pollingWrite;
+  m_output            = client.m_output;
+  m_outputOffset      = client.m_outputOffset;
+  m_outputSize        = client.m_outputSize;
+  m_droppedAnnouncements = client.m_droppedAnnouncements;
+  m_sendFailed        = client.m_sendFailed;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -654,6 +998,7 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
 
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
+  CSingleLock lock (m_critSection);
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
   if (msg == NULL || !msg->IsComplete())
     return;
@@ -663,6 +1008,23 @@ void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
     CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
 }
 
+void CTCPServer::CWebSocketClient::SendAnnouncement(const std::shared_ptr<const std::string>& announcement)
+{
+  CSingleLock lock (m_critSection);
+  const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, announcement->c_str(), announcement->size());
+  if (msg == NULL || !msg->IsComplete())
+    return;
+
+  // queue all frames of the message as one, so that a dropped announcement is never sent partially
+  std::string frameData;
+  std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
+  for (unsigned int index = 0; index < frames.size(); index++)
+    frameData.append(frames.at(index)->GetFrameData(), frames.at(index)->GetFrameLength());
+
+  if (QueueOutput(std::make_shared<const std::string>(std::move(frameData)), true))
+    FlushOutput();
+}
+
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
 {
   bool send;
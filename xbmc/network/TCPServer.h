@@ -19,6 +19,9 @@
  *
  */
 
+#include <deque>
+#include <map>
+#include <memory>
 #include <vector>
 #include <sys/socket.h>
 
@@ -50,11 +53,21 @@ namespace JSONRPC
     void Process() override;
   private:
     CTCPServer(int port, bool nonlocal);
+    ~CTCPServer() override;
     bool Initialize();
     bool InitializeBlue();
     bool InitializeTCP();
     void Deinitialize();
 
+    class CSocketPoller;
+    class CTCPClient;
+
+    bool AcceptConnection(SOCKET server);
+    void ReadFromConnection(SOCKET socket);
+    void WriteToConnection(SOCKET socket);
+    void UpdateWritePolling(CTCPClient *client);
+    void CloseConnection(SOCKET socket);
+
     class CTCPClient : public IClient
     {
     public:
@@ -70,25 +83,44 @@ namespace JSONRPC
       bool SetAnnouncementFlags(int flags) override;
 
       virtual void Send(const char *data, unsigned int size);
+      virtual void SendAnnouncement(const std::shared_ptr<const std::string>& announcement);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
       virtual bool IsNew() const { return m_new; }
-      virtual bool Closing() const { return false; }
+      virtual bool Closing() const { return m_sendFailed || m_outputSize > MAX_OUTPUT_SIZE_RESPONSES; }
+
+      /*!
+       \brief Sends as much of the queued output as the socket accepts without blocking.
+       \return True if all queued output has been sent
+       */
+      bool FlushOutput();
+      bool HasPendingOutput() const { return !m_output.empty(); }
 
       SOCKET m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t m_addrlen;
       CCriticalSection m_critSection;
+      bool m_pollingWrite;
 
     protected:
       void Copy(const CTCPClient& client);
+      bool QueueOutput(const std::shared_ptr<const std::string>& data, bool droppable);
+
+      static const size_t MAX_OUTPUT_SIZE = 1024 * 1024; //!< announcements are dropped beyond this
+      static const size_t MAX_OUTPUT_SIZE_RESPONSES = 4 * MAX_OUTPUT_SIZE; //!< the client is disconnected beyond this
     private:
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+
+      std::deque<std::shared_ptr<const std::string>> m_output;
+      size_t m_outputOffset;  //!< bytes of the first queued buffer that have been sent
+      size_t m_outputSize;    //!< bytes still to send
+      unsigned int m_droppedAnnouncements;
+      bool m_sendFailed;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -101,18 +133,21 @@ namespace JSONRPC
       ~CWebSocketClient() override;
 
       void Send(const char *data, unsigned int size) override;
+      void SendAnnouncement(const std::shared_ptr<const std::string>& announcement) override;
       void PushBuffer(CTCPServer *host, const char *buffer, int length) override;
       void Disconnect() override;
 
       bool IsNew() const override { return m_websocket == NULL; }
-      bool Closing() const override { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
+      bool Closing() const override { return CTCPClient::Closing() || (m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed); }
 
     private:
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    std::map<SOCKET, CTCPClient*> m_connections;
     std::vector<SOCKET> m_servers;
+    std::unique_ptr<CSocketPoller> m_poller;
+    CCriticalSection m_critSection; //!< protects m_connections against announcements from other threads
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
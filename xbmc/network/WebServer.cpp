@@ -26,10 +26,13 @@
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
@@ -768,7 +771,11 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
   std::shared_ptr<XFILE::CFile> file = std::make_shared<XFILE::CFile>();
   std::string filePath = handler->GetResponseFile();
 
-  if (!file->Open(filePath, XFILE::READ_NO_CACHE))
+  // remote sources are read ahead by the file cache while the client receives the previous block
+  const bool isLocal = URIUtils::IsHD(filePath);
+  const unsigned int flags = (isLocal || request.method == HEAD) ? XFILE::READ_NO_CACHE : (XFILE::READ_CHUNKED | XFILE::READ_CACHED);
+
+  if (!file->Open(filePath, flags))
   {
     CLog::Log(LOGERROR, "CWebServer[%hu]: Failed to open %s", m_port, filePath.c_str());
     return SendErrorResponse(request, MHD_HTTP_NOT_FOUND, request.method);
@@ -853,18 +860,26 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     // set the initial write position
     context->ranges.GetFirstPosition(context->writePosition);
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
+    // a single range of a local file is sent straight from its file descriptor so that MHD can use sendfile()
+    response = nullptr;
+    if (isLocal && context->rangeCountTotal == 1)
+      response = CreateFileDescriptorResponse(filePath, context->writePosition, totalLength);
+
     if (response == nullptr)
     {
-      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      // create the response object
+      response = MHD_create_response_from_callback(totalLength, g_advancedSettings.m_webserverBlockSize,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -1083,6 +1098,32 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
   CLog::Log(LOGDEBUG, LOGWEBSERVER, "CWebServer [OUT] done");
 }
 
+struct MHD_Response* CWebServer::CreateFileDescriptorResponse(const std::string& filePath, uint64_t offset, uint64_t length)
+{
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00094400)
+  const std::string localPath = CSpecialProtocol::TranslatePath(filePath);
+  if (!CURL(localPath).GetProtocol().empty())
+    return nullptr;
+
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  // mhd takes ownership of the descriptor and closes it with the response
+  struct MHD_Response* response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == nullptr)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  CLog::Log(LOGDEBUG, LOGWEBSERVER, "CWebServer [OUT] sending %" PRIu64 " bytes from %" PRIu64 " of %s from its file descriptor", length, offset, localPath.c_str());
+  return response;
+#else
+  return nullptr;
+#endif
+}
+
 // local helper
 static void panicHandlerForMHD(void* unused, const char* file, unsigned int line, const char *reason)
 {
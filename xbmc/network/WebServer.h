@@ -94,6 +94,7 @@ private:
   int CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response) const;
   int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const;
   int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response) const;
+  static struct MHD_Response* CreateFileDescriptorResponse(const std::string& filePath, uint64_t offset, uint64_t length);
 
   int SendResponse(const HTTPRequest& request, int responseStatus, MHD_Response *response) const;
   int SendErrorResponse(const HTTPRequest& request, int errorType, HTTPMethod method) const;
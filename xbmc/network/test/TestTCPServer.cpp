@@ -0,0 +1,188 @@
+/*
+ *      Copyright (C) 2018 Team XBMC
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined(TARGET_POSIX)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "interfaces/AnnouncementManager.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "network/TCPServer.h"
+#include "utils/Variant.h"
+
+#define TEST_CLIENTS_READING    20
+#define TEST_CLIENTS_STALLED    5
+#define TEST_ANNOUNCEMENTS      100
+#define TEST_ANNOUNCEMENT_SIZE  8192
+#define TEST_ANNOUNCEMENT_NAME  "TestLoad"
+#define TEST_TIMEOUT_MS         30000
+
+class TestTCPServer : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::random_device rd;
+    std::mt19937 mt(rd());
+    std::uniform_int_distribution<uint16_t> dist(49152, 65535);
+    port = dist(mt);
+
+    JSONRPC::CJSONRPC::Initialize();
+    ASSERT_TRUE(JSONRPC::CTCPServer::StartServer(port, false));
+  }
+
+  void TearDown() override
+  {
+    for (std::vector<int>::const_iterator it = sockets.begin(); it != sockets.end(); ++it)
+      close(*it);
+    sockets.clear();
+
+    JSONRPC::CTCPServer::StopServer(true);
+    JSONRPC::CJSONRPC::Cleanup();
+  }
+
+  int Connect()
+  {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0)
+      return -1;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+      close(sock);
+      return -1;
+    }
+
+    sockets.push_back(sock);
+    return sock;
+  }
+
+  /* Sends a ping and waits for the pong, after which the server has accepted the
+     connection and will deliver all following announcements to it. */
+  bool Ping(int sock)
+  {
+    static const std::string ping = "{\"jsonrpc\":\"2.0\",\"method\":\"JSONRPC.Ping\",\"id\":1}";
+    if (send(sock, ping.c_str(), ping.size(), 0) != (ssize_t)ping.size())
+      return false;
+
+    std::string response;
+    char buffer[1024];
+    while (response.find("pong") == std::string::npos)
+    {
+      struct pollfd pfd = { sock, POLLIN, 0 };
+      if (poll(&pfd, 1, TEST_TIMEOUT_MS) <= 0)
+        return false;
+
+      ssize_t read = recv(sock, buffer, sizeof(buffer), 0);
+      if (read <= 0)
+        return false;
+      response.append(buffer, read);
+    }
+
+    return true;
+  }
+
+  uint16_t port;
+  std::vector<int> sockets;
+};
+
+TEST_F(TestTCPServer, AnnouncementLoad)
+{
+  std::vector<int> readers;
+  for (int i = 0; i < TEST_CLIENTS_READING; i++)
+  {
+    int sock = Connect();
+    ASSERT_GE(sock, 0);
+    ASSERT_TRUE(Ping(sock));
+    readers.push_back(sock);
+  }
+
+  // these never read, their announcements pile up in the server without holding up the readers
+  for (int i = 0; i < TEST_CLIENTS_STALLED; i++)
+    ASSERT_GE(Connect(), 0);
+
+  CVariant data;
+  data["payload"] = std::string(TEST_ANNOUNCEMENT_SIZE, 'x');
+
+  for (int i = 0; i < TEST_ANNOUNCEMENTS; i++)
+    ANNOUNCEMENT::CAnnouncementManager::GetInstance().Announce(ANNOUNCEMENT::Other, "xbmc", TEST_ANNOUNCEMENT_NAME, data);
+
+  // count the announcements per reader, keeping the tail of each read to find names split between reads
+  static const std::string name = "Other." TEST_ANNOUNCEMENT_NAME;
+  std::vector<std::string> tails(readers.size());
+  std::vector<int> received(readers.size(), 0);
+  int complete = 0;
+  char buffer[16384];
+
+  while (complete < (int)readers.size())
+  {
+    std::vector<struct pollfd> pfds;
+    for (size_t i = 0; i < readers.size(); i++)
+    {
+      struct pollfd pfd = { readers[i], POLLIN, 0 };
+      pfds.push_back(pfd);
+    }
+
+    int ready = poll(pfds.data(), pfds.size(), TEST_TIMEOUT_MS);
+    ASSERT_GT(ready, 0) << "timed out with " << complete << " of " << readers.size() << " clients complete";
+
+    for (size_t i = 0; i < pfds.size(); i++)
+    {
+      if ((pfds[i].revents & POLLIN) == 0)
+        continue;
+
+      ssize_t read = recv(readers[i], buffer, sizeof(buffer), 0);
+      ASSERT_GT(read, 0);
+
+      std::string stream = tails[i];
+      stream.append(buffer, read);
+
+      size_t pos = 0;
+      while ((pos = stream.find(name, pos)) != std::string::npos)
+      {
+        pos += name.size();
+        if (++received[i] == TEST_ANNOUNCEMENTS)
+          complete++;
+      }
+
+      size_t keep = std::min(name.size() - 1, stream.size());
+      tails[i] = stream.substr(stream.size() - keep);
+    }
+  }
+
+  for (size_t i = 0; i < readers.size(); i++)
+    EXPECT_EQ(TEST_ANNOUNCEMENTS, received[i]);
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "platform/xbmc.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/CPUInfo.h"
+#include "utils/log.h"
 #include "platform/Environment.h"
 #include "utils/CharsetConverter.h" // Required to initialize converters before usage
 
@@ -40,6 +41,7 @@
 // Minidump creation function
 LONG WINAPI CreateMiniDump(EXCEPTION_POINTERS* pEp)
 {
+  CLog::Flush();
   win32_exception::write_stacktrace(pEp);
   win32_exception::write_minidump(pEp);
   return pEp->ExceptionRecord->ExceptionCode;
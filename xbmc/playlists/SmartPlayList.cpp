@@ -788,9 +788,39 @@ std::string CSmartPlaylistRule::FormatLinkQuery(const char *field, const char *t
                              field, table, table, table, field, table, field, mediaField.c_str(), table, parameter.c_str(), field, mediaType.c_str());
 }
 
+std::string CSmartPlaylistRule::GetSearchTable(int field, const std::string &type)
+{
+  // the full text search tables of CMusicDatabase and CVideoDatabase
+  if (type == "songs" && field == FieldTitle)
+    return "songsearch";
+  else if (type == "albums" && field == FieldAlbum)
+    return "albumsearch";
+  else if (type == "artists" && field == FieldArtist)
+    return "artistsearch";
+  else if (type == "movies" && field == FieldTitle)
+    return "moviesearch";
+  else if (type == "tvshows" && field == FieldTitle)
+    return "tvshowsearch";
+  else if (type == "episodes" && field == FieldTitle)
+    return "episodesearch";
+  else if (type == "musicvideos" && field == FieldTitle)
+    return "musicvideosearch";
+  return "";
+}
+
 std::string CSmartPlaylistRule::FormatWhereClause(const std::string &negate, const std::string &oper, const std::string &param,
                                                  const CDatabase &db, const std::string &strType) const
 {
+  // word searches go through the full text search table of the field if there is one, otherwise they're a LIKE
+  if (m_operator == OPERATOR_SEARCH && db.HasSearchIndex())
+  {
+    std::string searchTable = GetSearchTable(m_field, strType);
+    std::string match = CDatabase::GetSearchMatch(param);
+    if (!searchTable.empty() && !match.empty())
+      return GetField(FieldId, strType) + db.PrepareSQL(" IN (SELECT rowid FROM %s WHERE %s MATCH '%s')",
+                                                        searchTable.c_str(), searchTable.c_str(), match.c_str());
+  }
+
   std::string parameter = FormatParameter(oper, param, db, strType);
 
   std::string query;
@@ -78,6 +78,7 @@ protected:
 private:
   std::string GetVideoResolutionQuery(const std::string &parameter) const;
   static std::string FormatLinkQuery(const char *field, const char *table, const MediaType& mediaType, const std::string& mediaField, const std::string& parameter);
+  static std::string GetSearchTable(int field, const std::string &type);
 };
 
 class CSmartPlaylistRuleCombination : public CDatabaseQueryRuleCombination
@@ -20,6 +20,8 @@
 
 #include "PVRChannel.h"
 
+#include <atomic>
+
 #include "ServiceBroker.h"
 #include "filesystem/File.h"
 #include "guilib/LocalizeStrings.h"
@@ -37,6 +39,11 @@
 
 using namespace PVR;
 
+namespace
+{
+  std::atomic<unsigned int> iIdGeneration(0);
+}
+
 bool CPVRChannel::operator==(const CPVRChannel &right) const
 {
   return (m_bIsRadio  == right.m_bIsRadio &&
@@ -178,6 +185,7 @@ bool CPVRChannel::CreateEPG(bool bForce)
       if (epg->EpgID() != m_iEpgId)
       {
         m_iEpgId = epg->EpgID();
+        ++iIdGeneration;
         m_bChanged = true;
       }
       return true;
@@ -243,6 +251,7 @@ bool CPVRChannel::SetChannelID(int iChannelId)
   {
     /* update the id */
     m_iChannelId = iChannelId;
+    ++iIdGeneration;
     SetChanged();
     m_bChanged = true;
 
@@ -252,6 +261,11 @@ bool CPVRChannel::SetChannelID(int iChannelId)
   return false;
 }
 
+unsigned int CPVRChannel::IdGeneration(void)
+{
+  return iIdGeneration;
+}
+
 const CPVRChannelNumber& CPVRChannel::ChannelNumber() const
 {
   CSingleLock lock(m_critSection);
@@ -778,6 +792,7 @@ void CPVRChannel::SetEpgID(int iEpgId)
   if (m_iEpgId != iEpgId)
   {
     m_iEpgId = iEpgId;
+    ++iIdGeneration;
     SetChanged();
     m_bChanged = true;
   }
@@ -102,6 +102,12 @@ namespace PVR
      */
     bool SetChannelID(int iDatabaseId);
 
+    /*!
+     * @brief Get a counter that is increased whenever the database id or the EPG id of any channel changes.
+     * @return The counter value. Lookup indexes by these ids are stale when it differs from the value they were built with.
+     */
+    static unsigned int IdGeneration(void);
+
     /*!
      * @brief Set the channel number for this channel.
      * @param channelNumber The new channel number
@@ -57,7 +57,9 @@ CPVRChannelGroup::CPVRChannelGroup(void) :
     m_bPreventSortAndRenumber(false),
     m_iLastWatched(0),
     m_bHidden(false),
-    m_iPosition(0)
+    m_iPosition(0),
+    m_bLookupIndexesValid(false),
+    m_iLookupIdGeneration(0)
 {
   OnInit();
 }
@@ -75,7 +77,9 @@ CPVRChannelGroup::CPVRChannelGroup(bool bRadio, unsigned int iGroupId, const std
     m_bPreventSortAndRenumber(false),
     m_iLastWatched(0),
     m_bHidden(false),
-    m_iPosition(0)
+    m_iPosition(0),
+    m_bLookupIndexesValid(false),
+    m_iLookupIdGeneration(0)
 {
   OnInit();
 }
@@ -93,7 +97,9 @@ CPVRChannelGroup::CPVRChannelGroup(const PVR_CHANNEL_GROUP &group) :
     m_bPreventSortAndRenumber(false),
     m_iLastWatched(0),
     m_bHidden(false),
-    m_iPosition(group.iPosition)
+    m_iPosition(group.iPosition),
+    m_bLookupIndexesValid(false),
+    m_iLookupIdGeneration(0)
 {
   OnInit();
 }
@@ -117,6 +123,8 @@ CPVRChannelGroup::CPVRChannelGroup(const CPVRChannelGroup &group) :
   m_iPosition                   = group.m_iPosition;
   m_failedClientsForChannels    = group.m_failedClientsForChannels;
   m_failedClientsForChannelGroupMembers = group.m_failedClientsForChannelGroupMembers;
+  m_bLookupIndexesValid         = false;
+  m_iLookupIdGeneration         = 0;
   OnInit();
 }
 
@@ -186,6 +194,7 @@ void CPVRChannelGroup::Unload(void)
   CSingleLock lock(m_critSection);
   m_sortedMembers.clear();
   m_members.clear();
+  InvalidateLookupIndexes();
   m_failedClientsForChannels.clear();
   m_failedClientsForChannelGroupMembers.clear();
 }
@@ -224,6 +233,7 @@ bool CPVRChannelGroup::SetChannelNumber(const CPVRChannelPtr &channel, const CPV
         m_bChanged = true;
         bReturn = true;
         member.channelNumber = channelNumber;
+        InvalidateLookupIndexes();
       }
       break;
     }
@@ -344,14 +354,20 @@ void CPVRChannelGroup::SortByClientChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   if (!PreventSortAndRenumber())
+  {
     sort(m_sortedMembers.begin(), m_sortedMembers.end(), sortByClientChannelNumber());
+    InvalidateLookupIndexes();
+  }
 }
 
 void CPVRChannelGroup::SortByChannelNumber(void)
 {
   CSingleLock lock(m_critSection);
   if (!PreventSortAndRenumber())
+  {
     sort(m_sortedMembers.begin(), m_sortedMembers.end(), sortByChannelNumber());
+    InvalidateLookupIndexes();
+  }
 }
 
 bool CPVRChannelGroup::UpdateClientPriorities()
@@ -385,6 +401,41 @@ bool CPVRChannelGroup::UpdateClientPriorities()
   return bChanged;
 }
 
+void CPVRChannelGroup::InvalidateLookupIndexes(void)
+{
+  CSingleLock lock(m_critSection);
+  m_bLookupIndexesValid = false;
+}
+
+void CPVRChannelGroup::UpdateLookupIndexes(void) const
+{
+  /* channel and EPG ids are assigned when channels are persisted or their EPG is created,
+     which doesn't go through the group, so those changes are noticed by their generation */
+  const unsigned int iIdGeneration = CPVRChannel::IdGeneration();
+  if (m_bLookupIndexesValid && m_iLookupIdGeneration == iIdGeneration)
+    return;
+
+  m_channelsById.clear();
+  m_channelsByEpgId.clear();
+  m_channelsById.reserve(m_members.size());
+  m_channelsByEpgId.reserve(m_members.size());
+  for (const auto &member : m_members)
+  {
+    m_channelsById.insert(std::make_pair(member.second.channel->ChannelID(), member.second.channel));
+    m_channelsByEpgId.insert(std::make_pair(member.second.channel->EpgID(), member.second.channel));
+  }
+
+  m_channelsByNumber.clear();
+  m_channelsByNumber.reserve(m_sortedMembers.size());
+  for (const auto &member : m_sortedMembers)
+    m_channelsByNumber.emplace_back(member.channelNumber, member.channel);
+  std::stable_sort(m_channelsByNumber.begin(), m_channelsByNumber.end(),
+    [](const PVR_CHANNEL_NUMBER_INDEX::value_type &left, const PVR_CHANNEL_NUMBER_INDEX::value_type &right) { return left.first < right.first; });
+
+  m_bLookupIndexesValid = true;
+  m_iLookupIdGeneration = iIdGeneration;
+}
+
 /********** getters **********/
 PVRChannelGroupMember& CPVRChannelGroup::GetByUniqueID(const std::pair<int, int>& id)
 {
@@ -407,30 +458,20 @@ CPVRChannelPtr CPVRChannelGroup::GetByUniqueID(int iUniqueChannelId, int iClient
 
 CPVRChannelPtr CPVRChannelGroup::GetByChannelID(int iChannelID) const
 {
-  CPVRChannelPtr retval;
   CSingleLock lock(m_critSection);
+  UpdateLookupIndexes();
 
-  for (PVR_CHANNEL_GROUP_MEMBERS::const_iterator it = m_members.begin(); !retval && it != m_members.end(); ++it)
-  {
-    if (it->second.channel->ChannelID() == iChannelID)
-      retval = it->second.channel;
-  }
-
-  return retval;
+  const auto it = m_channelsById.find(iChannelID);
+  return it != m_channelsById.end() ? it->second : CPVRChannelPtr();
 }
 
 CPVRChannelPtr CPVRChannelGroup::GetByChannelEpgID(int iEpgID) const
 {
-  CPVRChannelPtr retval;
   CSingleLock lock(m_critSection);
+  UpdateLookupIndexes();
 
-  for (PVR_CHANNEL_GROUP_MEMBERS::const_iterator it = m_members.begin(); !retval && it != m_members.end(); ++it)
-  {
-    if (it->second.channel->EpgID() == iEpgID)
-      retval = it->second.channel;
-  }
-
-  return retval;
+  const auto it = m_channelsByEpgId.find(iEpgID);
+  return it != m_channelsByEpgId.end() ? it->second : CPVRChannelPtr();
 }
 
 CFileItemPtr CPVRChannelGroup::GetLastPlayedChannel(int iCurrentChannel /* = -1 */) const
@@ -464,12 +505,12 @@ CFileItemPtr CPVRChannelGroup::GetByChannelNumber(const CPVRChannelNumber &chann
 {
   CFileItemPtr retval;
   CSingleLock lock(m_critSection);
+  UpdateLookupIndexes();
 
-  for (PVR_CHANNEL_GROUP_SORTED_MEMBERS::const_iterator it = m_sortedMembers.begin(); !retval && it != m_sortedMembers.end(); ++it)
-  {
-    if ((*it).channelNumber == channelNumber)
-      retval = CFileItemPtr(new CFileItem((*it).channel));
-  }
+  const auto it = std::lower_bound(m_channelsByNumber.begin(), m_channelsByNumber.end(), channelNumber,
+    [](const PVR_CHANNEL_NUMBER_INDEX::value_type &entry, const CPVRChannelNumber &number) { return entry.first < number; });
+  if (it != m_channelsByNumber.end() && it->first == channelNumber)
+    retval = CFileItemPtr(new CFileItem(it->second));
 
   return retval;
 }
@@ -658,6 +699,7 @@ bool CPVRChannelGroup::RemoveDeletedChannels(const CPVRChannelGroup &channels)
           __FUNCTION__, m_bRadio ? "radio" : "TV", (*it).channel->ChannelName().c_str(), GroupName().c_str());
 
       m_members.erase((*it).channel->StorageId());
+      InvalidateLookupIndexes();
 
       //we need a copy of our iterators data so that we can find it later on
       //if the vector has changed.
@@ -749,6 +791,7 @@ bool CPVRChannelGroup::RemoveFromGroup(const CPVRChannelPtr &channel)
       //! @todo notify observers
       m_members.erase((*it).channel->StorageId());
       it = m_sortedMembers.erase(it);
+      InvalidateLookupIndexes();
       bReturn = true;
       m_bChanged = true;
       break;
@@ -791,6 +834,7 @@ bool CPVRChannelGroup::AddToGroup(const CPVRChannelPtr &channel, const CPVRChann
       newMember.channelNumber = CPVRChannelNumber(iChannelNumber, channelNumber.GetSubChannelNumber());
       m_sortedMembers.push_back(newMember);
       m_members.insert(std::make_pair(realChannel.channel->StorageId(), newMember));
+      InvalidateLookupIndexes();
       m_bChanged = true;
 
       SortAndRenumber();
@@ -811,13 +855,10 @@ bool CPVRChannelGroup::IsGroupMember(const CPVRChannelPtr &channel) const
 
 bool CPVRChannelGroup::IsGroupMember(int iChannelId) const
 {
-  bool bReturn(false);
   CSingleLock lock(m_critSection);
+  UpdateLookupIndexes();
 
-  for (PVR_CHANNEL_GROUP_MEMBERS::const_iterator it = m_members.begin(); !bReturn && it != m_members.end(); ++it)
-    bReturn = (iChannelId == it->second.channel->ChannelID());
-
-  return bReturn;
+  return m_channelsById.find(iChannelId) != m_channelsById.end();
 }
 
 bool CPVRChannelGroup::SetGroupName(const std::string &strGroupName, bool bSaveInDb /* = false */)
@@ -914,6 +955,7 @@ bool CPVRChannelGroup::Renumber(void)
       (*it).channelNumber = currentChannelNumber;
     }
   }
+  InvalidateLookupIndexes();
 
   SortByChannelNumber();
   ResetChannelNumberCache();
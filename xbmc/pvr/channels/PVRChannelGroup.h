@@ -21,6 +21,7 @@
 
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -516,6 +517,12 @@ namespace PVR
      */
     bool UpdateClientPriorities();
 
+    /*!
+     * @brief Mark the lookup indexes by channel id, EPG id and channel number as outdated.
+     *        Call after adding or removing members or changing their order or channel numbers.
+     */
+    void InvalidateLookupIndexes(void);
+
     bool             m_bRadio;                      /*!< true if this container holds radio channels, false if it holds TV channels */
     int              m_iGroupType;                  /*!< The type of this group */
     int              m_iGroupId;                    /*!< The ID of this group in the database */
@@ -536,6 +543,14 @@ namespace PVR
     std::vector<int> m_failedClientsForChannelGroupMembers;
 
   private:
+    typedef std::unordered_map<int, CPVRChannelPtr> PVR_CHANNEL_ID_INDEX;
+    typedef std::vector<std::pair<CPVRChannelNumber, CPVRChannelPtr>> PVR_CHANNEL_NUMBER_INDEX;
+
+    /*!
+     * @brief Rebuild the lookup indexes if members changed or channel ids changed since they were built. Must be called with m_critSection held.
+     */
+    void UpdateLookupIndexes(void) const;
+
     CDateTime GetEPGDate(EpgDateType epgDateType) const;
     /*!
      * @brief Get all entries that will be active next.
@@ -544,5 +559,11 @@ namespace PVR
      * @return The amount of entries that were added.
      */
     int GetEPGNowOrNext(CFileItemList &results, bool bGetNext) const;
+
+    mutable PVR_CHANNEL_ID_INDEX     m_channelsById;         /*!< first member for each channel id, in m_members order */
+    mutable PVR_CHANNEL_ID_INDEX     m_channelsByEpgId;      /*!< first member for each EPG id, in m_members order */
+    mutable PVR_CHANNEL_NUMBER_INDEX m_channelsByNumber;     /*!< members sorted by channel number, ties in m_sortedMembers order */
+    mutable bool                     m_bLookupIndexesValid;  /*!< false when the lookup indexes have to be rebuilt */
+    mutable unsigned int             m_iLookupIdGeneration;  /*!< CPVRChannel::IdGeneration() when the lookup indexes were built */
   };
 }
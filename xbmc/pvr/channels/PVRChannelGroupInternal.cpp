@@ -118,6 +118,7 @@ CPVRChannelPtr CPVRChannelGroupInternal::UpdateFromClient(const CPVRChannelPtr &
     channel->UpdatePath(this);
     m_sortedMembers.push_back(newMember);
     m_members.insert(std::make_pair(channel->StorageId(), newMember));
+    InvalidateLookupIndexes();
     m_bChanged = true;
 
     SortAndRenumber();
@@ -165,6 +166,7 @@ bool CPVRChannelGroupInternal::AddToGroup(const CPVRChannelPtr &channel, const C
   if (groupMember.channelNumber.GetChannelNumber() != iChannelNumber)
   {
     groupMember.channelNumber = CPVRChannelNumber(iChannelNumber, channelNumber.GetSubChannelNumber());
+    InvalidateLookupIndexes();
     bSort = true;
   }
 
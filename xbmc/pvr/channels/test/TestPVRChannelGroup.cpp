@@ -0,0 +1,96 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+#include "FileItem.h"
+#include "pvr/channels/PVRChannel.h"
+#include "pvr/channels/PVRChannelGroup.h"
+
+using namespace PVR;
+
+namespace
+{
+  /* members are added the way CPVRDatabase loads them, without the PVR manager */
+  class CTestChannelGroup : public CPVRChannelGroup
+  {
+  public:
+    CTestChannelGroup() : CPVRChannelGroup(false, 1, "test")
+    {
+      SetPreventSortAndRenumber();
+    }
+
+    void Add(const CPVRChannelPtr &channel, const CPVRChannelNumber &channelNumber)
+    {
+      PVRChannelGroupMember newMember(channel, channelNumber, 0);
+      m_sortedMembers.push_back(newMember);
+      m_members.insert(std::make_pair(channel->StorageId(), newMember));
+      InvalidateLookupIndexes();
+    }
+  };
+
+  CPVRChannelPtr CreateChannel(unsigned int iUniqueId)
+  {
+    PVR_CHANNEL data = {};
+    data.iUniqueId = iUniqueId;
+    strncpy(data.strChannelName, "Channel", sizeof(data.strChannelName) - 1);
+    return CPVRChannelPtr(new CPVRChannel(data, 1));
+  }
+}
+
+TEST(TestPVRChannelGroup, Lookup)
+{
+  CTestChannelGroup group;
+  CPVRChannelPtr first = CreateChannel(1);
+  CPVRChannelPtr second = CreateChannel(2);
+  first->SetChannelID(10);
+  first->SetEpgID(100);
+  group.Add(first, CPVRChannelNumber(1, 0));
+  group.Add(second, CPVRChannelNumber(2, 0));
+
+  EXPECT_EQ(first, group.GetByChannelID(10));
+  EXPECT_EQ(first, group.GetByChannelEpgID(100));
+  EXPECT_EQ(second, group.GetByChannelID(-1)); // not persisted yet
+  EXPECT_FALSE(group.GetByChannelID(20));
+  EXPECT_TRUE(group.IsGroupMember(10));
+
+  // ids assigned after the channel was added are picked up
+  second->SetChannelID(20);
+  second->SetEpgID(200);
+  EXPECT_EQ(second, group.GetByChannelID(20));
+  EXPECT_EQ(second, group.GetByChannelEpgID(200));
+  EXPECT_FALSE(group.GetByChannelID(-1));
+
+  ASSERT_TRUE(group.GetByChannelNumber(CPVRChannelNumber(2, 0)));
+  EXPECT_EQ(second, group.GetByChannelNumber(CPVRChannelNumber(2, 0))->GetPVRChannelInfoTag());
+  EXPECT_FALSE(group.GetByChannelNumber(CPVRChannelNumber(3, 0)));
+
+  EXPECT_TRUE(group.SetChannelNumber(second, CPVRChannelNumber(3, 0)));
+  EXPECT_FALSE(group.GetByChannelNumber(CPVRChannelNumber(2, 0)));
+  EXPECT_EQ(second, group.GetByChannelNumber(CPVRChannelNumber(3, 0))->GetPVRChannelInfoTag());
+
+  EXPECT_TRUE(group.RemoveFromGroup(first));
+  EXPECT_FALSE(group.GetByChannelID(10));
+  EXPECT_FALSE(group.GetByChannelEpgID(100));
+  EXPECT_FALSE(group.GetByChannelNumber(CPVRChannelNumber(1, 0)));
+  EXPECT_FALSE(group.IsGroupMember(10));
+}
+
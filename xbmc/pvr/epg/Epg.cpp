@@ -20,6 +20,7 @@
 
 #include "Epg.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
@@ -30,6 +31,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
+#include "threads/Thread.h"
 #include "utils/log.h"
 
 #include "pvr/PVRManager.h"
@@ -43,11 +45,14 @@ CPVREpg::CPVREpg(int iEpgID, const std::string &strName /* = "" */, const std::s
     m_bChanged(!bLoadedFromDb),
     m_bTagsChanged(false),
     m_bLoaded(false),
+    m_bPartiallyLoaded(false),
+    m_bLoadingRemaining(false),
     m_bUpdatePending(false),
     m_iEpgID(iEpgID),
     m_strName(strName),
     m_strScraperName(strScraperName),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_searchIndex(new CPVREpgSearchIndex())
 {
 }
 
@@ -55,12 +60,15 @@ CPVREpg::CPVREpg(const CPVRChannelPtr &channel, bool bLoadedFromDb /* = false */
     m_bChanged(!bLoadedFromDb),
     m_bTagsChanged(false),
     m_bLoaded(false),
+    m_bPartiallyLoaded(false),
+    m_bLoadingRemaining(false),
     m_bUpdatePending(false),
     m_iEpgID(channel->EpgID()),
     m_strName(channel->ChannelName()),
     m_strScraperName(channel->EPGScraper()),
     m_pvrChannel(channel),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_searchIndex(new CPVREpgSearchIndex())
 {
 }
 
@@ -68,9 +76,12 @@ CPVREpg::CPVREpg(void) :
     m_bChanged(false),
     m_bTagsChanged(false),
     m_bLoaded(false),
+    m_bPartiallyLoaded(false),
+    m_bLoadingRemaining(false),
     m_bUpdatePending(false),
     m_iEpgID(0),
-    m_bUpdateLastScanTime(false)
+    m_bUpdateLastScanTime(false),
+    m_searchIndex(new CPVREpgSearchIndex())
 {
 }
 
@@ -84,6 +95,9 @@ CPVREpg &CPVREpg::operator =(const CPVREpg &right)
   m_bChanged          = right.m_bChanged;
   m_bTagsChanged      = right.m_bTagsChanged;
   m_bLoaded           = right.m_bLoaded;
+  m_bPartiallyLoaded  = right.m_bPartiallyLoaded;
+  m_loadedStart       = right.m_loadedStart;
+  m_loadedEnd         = right.m_loadedEnd;
   m_bUpdatePending    = right.m_bUpdatePending;
   m_iEpgID            = right.m_iEpgID;
   m_strName           = right.m_strName;
@@ -93,7 +107,11 @@ CPVREpg &CPVREpg::operator =(const CPVREpg &right)
   m_pvrChannel        = right.m_pvrChannel;
 
   for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = right.m_tags.begin(); it != right.m_tags.end(); ++it)
+  {
     m_tags.insert(make_pair(it->first, it->second));
+    if (m_searchIndex)
+      m_searchIndex->Add(it->second);
+  }
 
   return *this;
 }
@@ -141,6 +159,8 @@ void CPVREpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  if (m_searchIndex)
+    m_searchIndex->Clear();
 }
 
 void CPVREpg::Cleanup(void)
@@ -162,6 +182,8 @@ void CPVREpg::Cleanup(const CDateTime &Time)
 
       it->second->ClearTimer();
       it->second->ClearRecording();
+      if (m_searchIndex)
+        m_searchIndex->Remove(it->second);
       it = m_tags.erase(it);
     }
     else
@@ -246,7 +268,9 @@ bool CPVREpg::CheckPlayingEvent(void)
 
 CPVREpgInfoTagPtr CPVREpg::GetTagByBroadcastId(unsigned int iUniqueBroadcastId) const
 {
-  if (iUniqueBroadcastId != EPG_TAG_INVALID_UID)
+  if (iUniqueBroadcastId == EPG_TAG_INVALID_UID)
+    return CPVREpgInfoTagPtr();
+
   {
     CSingleLock lock(m_critSection);
     for (const auto &infoTag : m_tags)
@@ -254,12 +278,34 @@ CPVREpgInfoTagPtr CPVREpg::GetTagByBroadcastId(unsigned int iUniqueBroadcastId)
       if (infoTag.second->UniqueBroadcastID() == iUniqueBroadcastId)
         return infoTag.second;
     }
+
+    if (!m_bPartiallyLoaded)
+      return CPVREpgInfoTagPtr();
   }
+
+  /* the tag may not have been loaded yet, only that one is read from the database */
+  CPVREpgDatabasePtr database = CServiceBroker::GetPVRManager().EpgContainer().GetEpgDatabase();
+  if (!database)
+    return CPVREpgInfoTagPtr();
+
+  CPVREpgInfoTagPtr tag = database->GetByBroadcastUid(m_iEpgID, iUniqueBroadcastId);
+  if (!tag)
+    return CPVREpgInfoTagPtr();
+
+  const_cast<CPVREpg*>(this)->AddEntry(*tag);
+
+  CSingleLock lock(m_critSection);
+  std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(tag->StartAsUTC());
+  if (it != m_tags.end() && it->second->UniqueBroadcastID() == iUniqueBroadcastId)
+    return it->second;
+
   return CPVREpgInfoTagPtr();
 }
 
 CPVREpgInfoTagPtr CPVREpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
 {
+  EnsureLoaded(beginTime, endTime);
+
   CSingleLock lock(m_critSection);
   for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
   {
@@ -274,6 +320,8 @@ std::vector<CPVREpgInfoTagPtr> CPVREpg::GetTagsBetween(const CDateTime &beginTim
 {
   std::vector<CPVREpgInfoTagPtr> epgTags;
 
+  EnsureLoaded(beginTime, endTime);
+
   CSingleLock lock(m_critSection);
   for (const auto &infoTag : m_tags)
   {
@@ -290,31 +338,46 @@ std::vector<CPVREpgInfoTagPtr> CPVREpg::GetTagsBetween(const CDateTime &beginTim
 }
 
 void CPVREpg::AddEntry(const CPVREpgInfoTag &tag)
+{
+  CPVREpgInfoTagPtr newTag = InsertEntry(tag);
+  if (newTag)
+    SetTimerAndRecording(newTag);
+}
+
+CPVREpgInfoTagPtr CPVREpg::InsertEntry(const CPVREpgInfoTag &tag)
 {
   CPVREpgInfoTagPtr newTag;
   CPVRChannelPtr channel;
   {
     CSingleLock lock(m_critSection);
-    std::map<CDateTime, CPVREpgInfoTagPtr>::iterator itr = m_tags.find(tag.StartAsUTC());
-    if (itr != m_tags.end())
-      newTag = itr->second;
-    else
-    {
-      newTag.reset(new CPVREpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
-      m_tags.insert(make_pair(tag.StartAsUTC(), newTag));
-    }
+    /* entries in memory are at least as recent as the ones in the database, which matters when
+       the remaining entries are loaded after the table has been updated */
+    if (m_tags.find(tag.StartAsUTC()) != m_tags.end())
+      return CPVREpgInfoTagPtr();
+
+    newTag.reset(new CPVREpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : ""));
+    m_tags.insert(make_pair(tag.StartAsUTC(), newTag));
 
     channel = m_pvrChannel;
   }
 
-  if (newTag)
+  newTag->Update(tag);
+  newTag->SetChannel(channel);
+  newTag->SetEpg(this);
+
   {
-    newTag->Update(tag);
-    newTag->SetChannel(channel);
-    newTag->SetEpg(this);
-    newTag->SetTimer(CServiceBroker::GetPVRManager().Timers()->GetTimerForEpgTag(newTag));
-    newTag->SetRecording(CServiceBroker::GetPVRManager().Recordings()->GetRecordingForEpgTag(newTag));
+    CSingleLock lock(m_critSection);
+    if (m_searchIndex)
+      m_searchIndex->Add(newTag);
   }
+
+  return newTag;
+}
+
+void CPVREpg::SetTimerAndRecording(const CPVREpgInfoTagPtr &tag)
+{
+  tag->SetTimer(CServiceBroker::GetPVRManager().Timers()->GetTimerForEpgTag(tag));
+  tag->SetRecording(CServiceBroker::GetPVRManager().Recordings()->GetRecordingForEpgTag(tag));
 }
 
 bool CPVREpg::Load(void)
@@ -328,7 +391,24 @@ bool CPVREpg::Load(void)
     return bReturn;
   }
 
-  int iEntriesLoaded = database->Get(*this);
+  int iEntriesLoaded;
+  if (g_advancedSettings.m_iEpgLoadWindowHours > 0)
+  {
+    const CDateTime now(CDateTime::GetUTCDateTime());
+    const CDateTimeSpan window(0, g_advancedSettings.m_iEpgLoadWindowHours, 0, 0);
+    {
+      CSingleLock lock(m_critSection);
+      m_loadedStart = now - window;
+      m_loadedEnd = now + window;
+      m_bPartiallyLoaded = true;
+    }
+    std::vector<CPVREpgInfoTagPtr> tags;
+    iEntriesLoaded = database->GetBetween(m_iEpgID, now - window, now + window, tags);
+    for (const auto &tag : tags)
+      AddEntry(*tag);
+  }
+  else
+    iEntriesLoaded = database->Get(*this);
 
   CSingleLock lock(m_critSection);
   if (iEntriesLoaded <= 0)
@@ -349,6 +429,83 @@ bool CPVREpg::Load(void)
   return bReturn;
 }
 
+bool CPVREpg::LoadRemaining(void)
+{
+  CDateTime start, end;
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_bPartiallyLoaded || m_bLoadingRemaining)
+      return true;
+
+    m_bLoadingRemaining = true;
+    m_loadingThread = CThread::GetCurrentThreadId();
+    start = m_loadedStart;
+    end = m_loadedEnd;
+  }
+
+  bool bReturn(false);
+  std::vector<CPVREpgInfoTagPtr> newTags;
+  CPVREpgDatabasePtr database = CServiceBroker::GetPVRManager().EpgContainer().GetEpgDatabase();
+  if (!database)
+    CLog::Log(LOGERROR, "EPG - %s - could not open the database", __FUNCTION__);
+  else
+  {
+    std::vector<CPVREpgInfoTagPtr> tags;
+    bReturn = database->GetOutside(m_iEpgID, start, end, tags) >= 0;
+    for (const auto &tag : tags)
+    {
+      CPVREpgInfoTagPtr newTag = InsertEntry(*tag);
+      if (newTag)
+        newTags.push_back(newTag);
+    }
+  }
+
+  {
+    /* a table that failed to load isn't retried on every access */
+    CSingleLock lock(m_critSection);
+    m_bPartiallyLoaded = false;
+    m_bLoadingRemaining = false;
+    m_remainingLoaded.notifyAll();
+  }
+
+  /* only once nobody waits for the entries anymore, as threads waiting in EnsureLoaded()
+     may hold the timers or recordings lock the lookups need */
+  for (const auto &tag : newTags)
+    SetTimerAndRecording(tag);
+
+  return bReturn;
+}
+
+void CPVREpg::EnsureLoaded(void) const
+{
+  /* called before taking the lock, as loading entries looks up their timers and recordings */
+  bool bLoad(false);
+  {
+    CSingleLock lock(m_critSection);
+    /* another thread is loading them, wait for it instead of returning a part of the table */
+    if (m_bLoadingRemaining && !CThread::IsCurrentThread(m_loadingThread))
+    {
+      while (m_bLoadingRemaining)
+        m_remainingLoaded.wait(lock);
+    }
+    bLoad = m_bPartiallyLoaded && !m_bLoadingRemaining;
+  }
+
+  if (bLoad)
+    const_cast<CPVREpg*>(this)->LoadRemaining();
+}
+
+void CPVREpg::EnsureLoaded(const CDateTime &start, const CDateTime &end) const
+{
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_bPartiallyLoaded || (start >= m_loadedStart && end <= m_loadedEnd))
+      return;
+  }
+
+  EnsureLoaded();
+}
+
 bool CPVREpg::UpdateEntries(const CPVREpg &epg, bool bStoreInDb /* = true */)
 {
   CSingleLock lock(m_critSection);
@@ -415,6 +572,8 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, bool bUpdateDatabase)
 {
   CPVREpgInfoTagPtr infoTag;
 
+  EnsureLoaded();
+
   {
     CSingleLock lock(m_critSection);
     std::map<CDateTime, CPVREpgInfoTagPtr>::iterator it = m_tags.find(tag->StartAsUTC());
@@ -434,6 +593,8 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, bool bUpdateDatabase)
     infoTag->Update(*tag, bNewTag);
     infoTag->SetEpg(this);
     infoTag->SetChannel(m_pvrChannel);
+    if (m_searchIndex)
+      m_searchIndex->Add(infoTag);
 
     if (bUpdateDatabase)
       m_changedTags.insert(std::make_pair(infoTag->UniqueBroadcastID(), infoTag));
@@ -456,6 +617,8 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
   }
   else if (newState == EPG_EVENT_DELETED)
   {
+    EnsureLoaded();
+
     CSingleLock lock(m_critSection);
 
     auto it = m_tags.begin();
@@ -481,6 +644,8 @@ bool CPVREpg::UpdateEntry(const CPVREpgInfoTagPtr &tag, EPG_EVENT_STATE newState
 
         it->second->ClearTimer();
         it->second->ClearRecording();
+        if (m_searchIndex)
+          m_searchIndex->Remove(it->second);
         m_tags.erase(it);
       }
       else
@@ -537,7 +702,11 @@ bool CPVREpg::Update(const time_t start, const time_t end, int iUpdateTime, bool
     bUpdate = true;
 
   if (bUpdate)
+  {
+    /* the update is merged into the complete table */
+    LoadRemaining();
     bGrabSuccess = LoadFromClients(start, end);
+  }
 
   if (bGrabSuccess)
   {
@@ -560,6 +729,8 @@ int CPVREpg::Get(CFileItemList &results) const
 {
   int iInitialSize = results.Size();
 
+  EnsureLoaded();
+
   CSingleLock lock(m_critSection);
 
   for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
@@ -572,15 +743,32 @@ int CPVREpg::Get(CFileItemList &results, const CPVREpgSearchFilter &filter) cons
 {
   int iInitialSize = results.Size();
 
+  EnsureLoaded();
+
   if (!HasValidEntries())
     return -1;
 
   CSingleLock lock(m_critSection);
 
-  for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+  std::vector<CPVREpgInfoTagPtr> candidates;
+  if (m_searchIndex && filter.GetCandidates(*m_searchIndex, candidates))
   {
-    if (filter.FilterEntry(it->second))
-      results.Add(CFileItemPtr(new CFileItem(it->second)));
+    std::sort(candidates.begin(), candidates.end(),
+              [](const CPVREpgInfoTagPtr &a, const CPVREpgInfoTagPtr &b) { return a->StartAsUTC() < b->StartAsUTC(); });
+
+    for (const auto &tag : candidates)
+    {
+      if (filter.FilterEntry(tag))
+        results.Add(CFileItemPtr(new CFileItem(tag)));
+    }
+  }
+  else
+  {
+    for (std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); ++it)
+    {
+      if (filter.FilterEntry(it->second))
+        results.Add(CFileItemPtr(new CFileItem(it->second)));
+    }
   }
 
   return results.Size() - iInitialSize;
@@ -602,34 +790,50 @@ bool CPVREpg::Persist(void)
     return false;
   }
 
+  bool bRet(true);
+
   database->Lock();
+  database->BeginTransaction();
 
   {
     CSingleLock lock(m_critSection);
     if (m_iEpgID <= 0 || m_bChanged)
     {
-      int iId = database->Persist(*this, m_iEpgID > 0);
+      int iId = database->Persist(*this);
       if (iId > 0)
         m_iEpgID = iId;
+      else
+        bRet = false;
     }
 
+    /* only the tags that changed are written, each set with a single prepared statement */
+    std::vector<CPVREpgInfoTagPtr> tags;
+    tags.reserve(m_deletedTags.size());
     for (std::map<int, CPVREpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); ++it)
-      database->Delete(*it->second);
+      tags.push_back(it->second);
+    bRet &= database->Delete(tags);
 
+    tags.clear();
+    tags.reserve(m_changedTags.size());
     for (std::map<int, CPVREpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); ++it)
-      it->second->Persist(false);
+      tags.push_back(it->second);
+    bRet &= database->Persist(tags);
 
     if (m_bUpdateLastScanTime)
-      database->PersistLastEpgScanTime(m_iEpgID, true);
+      bRet &= database->PersistLastEpgScanTime(m_iEpgID);
 
-    m_deletedTags.clear();
-    m_changedTags.clear();
-    m_bChanged            = false;
-    m_bTagsChanged        = false;
-    m_bUpdateLastScanTime = false;
+    /* the statements are idempotent, so a table that failed is written again on the next persist */
+    if (bRet)
+    {
+      m_deletedTags.clear();
+      m_changedTags.clear();
+      m_bChanged            = false;
+      m_bTagsChanged        = false;
+      m_bUpdateLastScanTime = false;
+    }
   }
 
-  bool bRet = database->CommitInsertQueries();
+  bRet &= database->CommitTransaction();
 
   database->Unlock();
   return bRet;
@@ -638,10 +842,26 @@ bool CPVREpg::Persist(void)
 CDateTime CPVREpg::GetFirstDate(void) const
 {
   CDateTime first;
+  bool bPartiallyLoaded(false);
 
-  CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    first = m_tags.begin()->second->StartAsUTC();
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_tags.empty())
+      first = m_tags.begin()->second->StartAsUTC();
+    bPartiallyLoaded = m_bPartiallyLoaded;
+  }
+
+  /* the entries that are not loaded yet are asked for, instead of loading them */
+  if (bPartiallyLoaded)
+  {
+    CPVREpgDatabasePtr database = CServiceBroker::GetPVRManager().EpgContainer().GetEpgDatabase();
+    if (database)
+    {
+      const CDateTime stored(database->GetFirstStartTime(m_iEpgID));
+      if (stored.IsValid() && (!first.IsValid() || stored < first))
+        first = stored;
+    }
+  }
 
   return first;
 }
@@ -649,10 +869,25 @@ CDateTime CPVREpg::GetFirstDate(void) const
 CDateTime CPVREpg::GetLastDate(void) const
 {
   CDateTime last;
+  bool bPartiallyLoaded(false);
 
-  CSingleLock lock(m_critSection);
-  if (!m_tags.empty())
-    last = m_tags.rbegin()->second->StartAsUTC();
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_tags.empty())
+      last = m_tags.rbegin()->second->StartAsUTC();
+    bPartiallyLoaded = m_bPartiallyLoaded;
+  }
+
+  if (bPartiallyLoaded)
+  {
+    CPVREpgDatabasePtr database = CServiceBroker::GetPVRManager().EpgContainer().GetEpgDatabase();
+    if (database)
+    {
+      const CDateTime stored(database->GetLastStartTime(m_iEpgID));
+      if (stored.IsValid() && (!last.IsValid() || stored > last))
+        last = stored;
+    }
+  }
 
   return last;
 }
@@ -687,6 +922,8 @@ bool CPVREpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
 
       it->second->ClearTimer();
       it->second->ClearRecording();
+      if (m_searchIndex)
+        m_searchIndex->Remove(it->second);
       m_tags.erase(it++);
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
@@ -809,12 +1046,14 @@ bool CPVREpg::LoadFromClients(time_t start, time_t end)
   if (channel)
   {
     CPVREpg tmpEpg(channel);
+    tmpEpg.m_searchIndex.reset(); // only merged into this table
     if (tmpEpg.UpdateFromScraper(start, end))
       bReturn = UpdateEntries(tmpEpg, !CServiceBroker::GetSettings().GetBool(CSettings::SETTING_EPG_IGNOREDBFORCLIENT));
   }
   else
   {
     CPVREpg tmpEpg(m_iEpgID, m_strName, m_strScraperName);
+    tmpEpg.m_searchIndex.reset(); // only merged into this table
     if (tmpEpg.UpdateFromScraper(start, end))
       bReturn = UpdateEntries(tmpEpg, !CServiceBroker::GetSettings().GetBool(CSettings::SETTING_EPG_IGNOREDBFORCLIENT));
   }
@@ -824,10 +1063,18 @@ bool CPVREpg::LoadFromClients(time_t start, time_t end)
 
 CPVREpgInfoTagPtr CPVREpg::GetNextEvent(const CPVREpgInfoTag& tag) const
 {
-  CSingleLock lock(m_critSection);
-  std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(tag.StartAsUTC());
-  if (it != m_tags.end() && ++it != m_tags.end())
-    return it->second;
+  for (int iAttempt = 0; iAttempt < 2; ++iAttempt)
+  {
+    {
+      CSingleLock lock(m_critSection);
+      std::map<CDateTime, CPVREpgInfoTagPtr>::const_iterator it = m_tags.find(tag.StartAsUTC());
+      if (it != m_tags.end() && ++it != m_tags.end())
+        return it->second;
+    }
+
+    /* the next event may not have been loaded yet */
+    EnsureLoaded();
+  }
 
   CPVREpgInfoTagPtr retVal;
   return retVal;
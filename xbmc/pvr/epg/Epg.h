@@ -20,17 +20,21 @@
  */
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "FileItem.h"
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
+#include "threads/ThreadImpl.h"
 #include "utils/Observer.h"
 
 #include "pvr/PVRTypes.h"
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/epg/EpgInfoTag.h"
 #include "pvr/epg/EpgSearchFilter.h"
+#include "pvr/epg/EpgSearchIndex.h"
 
 /** EPG container for CPVREpgInfoTag instances */
 namespace PVR
@@ -66,11 +70,18 @@ namespace PVR
     CPVREpg &operator =(const CPVREpg &right);
 
     /*!
-     * @brief Load all entries for this table from the database.
+     * @brief Load the entries for this table from the database. With a load window configured, only the
+     *        entries around the current time are loaded and the rest follows on demand.
      * @return True if any entries were loaded, false otherwise.
      */
     bool Load(void);
 
+    /*!
+     * @brief Load the entries Load() left in the database.
+     * @return True if the entries were loaded or there were none left, false otherwise.
+     */
+    bool LoadRemaining(void);
+
     /*!
      * @brief The channel this EPG belongs to.
      * @return The channel this EPG belongs to
@@ -308,6 +319,19 @@ namespace PVR
      */
     void AddEntry(const CPVREpgInfoTag &tag);
 
+    /*!
+     * @brief Add an infotag to this container, without looking up its timer and recording.
+     * @param tag The tag to add.
+     * @return The added tag, or an empty pointer if there already was a tag at its start time.
+     */
+    CPVREpgInfoTagPtr InsertEntry(const CPVREpgInfoTag &tag);
+
+    /*!
+     * @brief Look up the timer and the recording of an added infotag.
+     * @param tag The added tag.
+     */
+    static void SetTimerAndRecording(const CPVREpgInfoTagPtr &tag);
+
     /*!
      * @brief Load all EPG entries from clients into a temporary table and update this table with the contents of that temporary table.
      * @param start Only get entries after this start time. Use 0 to get all entries before "end".
@@ -324,12 +348,30 @@ namespace PVR
      */
     bool UpdateEntries(const CPVREpg &epg, bool bStoreInDb = true);
 
+    /*!
+     * @brief Load the entries left in the database if Load() only loaded a window of them.
+     */
+    void EnsureLoaded(void) const;
+
+    /*!
+     * @brief Load the entries left in the database if Load() only loaded a window of them that doesn't cover the given time span.
+     * @param start The start of the time span.
+     * @param end The end of the time span.
+     */
+    void EnsureLoaded(const CDateTime &start, const CDateTime &end) const;
+
     std::map<CDateTime, CPVREpgInfoTagPtr> m_tags;
     std::map<int, CPVREpgInfoTagPtr>       m_changedTags;
     std::map<int, CPVREpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
     bool                                m_bTagsChanged;    /*!< true when any tags are changed and not persisted, false otherwise */
     bool                                m_bLoaded;         /*!< true when the initial entries have been loaded */
+    bool                                m_bPartiallyLoaded; /*!< true when only the entries between m_loadedStart and m_loadedEnd have been loaded */
+    bool                                m_bLoadingRemaining; /*!< true while the remaining entries are being loaded */
+    ThreadIdentifier                    m_loadingThread;   /*!< the thread loading the remaining entries */
+    mutable XbmcThreads::ConditionVariable m_remainingLoaded; /*!< notified when the remaining entries have been loaded */
+    CDateTime                           m_loadedStart;     /*!< the start of the window of loaded entries */
+    CDateTime                           m_loadedEnd;       /*!< the end of the window of loaded entries */
     bool                                m_bUpdatePending;  /*!< true if manual update is pending */
     int                                 m_iEpgID;          /*!< the database ID of this table */
     std::string                         m_strName;         /*!< the name of this table */
@@ -342,5 +384,6 @@ namespace PVR
 
     CCriticalSection                    m_critSection;     /*!< critical section for changes in this table */
     bool                                m_bUpdateLastScanTime;
+    std::unique_ptr<CPVREpgSearchIndex> m_searchIndex;     /*!< text and genre index over m_tags, none for temporary tables */
   };
 }
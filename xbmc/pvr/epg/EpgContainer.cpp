@@ -341,6 +341,12 @@ bool CPVREpgContainer::PersistAll(void)
   auto copy = m_epgs;
   m_critSection.unlock();
 
+  /* all tables are written in one transaction instead of one per table. the database isn't
+     locked in between, readers on other threads use the same connection and see the changes */
+  m_database->Lock();
+  m_database->BeginBatchTransaction();
+  m_database->Unlock();
+
   for (EPGMAP::const_iterator it = copy.begin(); it != copy.end() && !m_bStop; ++it)
   {
     CPVREpgPtr epg = it->second;
@@ -350,6 +356,10 @@ bool CPVREpgContainer::PersistAll(void)
     }
   }
 
+  m_database->Lock();
+  bReturn &= m_database->CommitBatchTransaction();
+  m_database->Unlock();
+
   return bReturn;
 }
 
@@ -234,11 +234,77 @@ int CPVREpgDatabase::Get(CPVREpgContainer &container)
 }
 
 int CPVREpgDatabase::Get(CPVREpg &epg)
+{
+  std::vector<CPVREpgInfoTagPtr> tags;
+  int iReturn = Get(epg.EpgID(), "", tags);
+
+  /* added without holding the database lock, adding looks up the timer and recording of the entries */
+  for (const auto &tag : tags)
+    epg.AddEntry(*tag);
+
+  return iReturn;
+}
+
+int CPVREpgDatabase::GetBetween(int iEpgId, const CDateTime &start, const CDateTime &end, std::vector<CPVREpgInfoTagPtr> &tags)
+{
+  time_t iStartTime, iEndTime;
+  start.GetAsTime(iStartTime);
+  end.GetAsTime(iEndTime);
+
+  return Get(iEpgId, PrepareSQL("iEndTime > %u AND iStartTime < %u",
+      static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime)), tags);
+}
+
+int CPVREpgDatabase::GetOutside(int iEpgId, const CDateTime &start, const CDateTime &end, std::vector<CPVREpgInfoTagPtr> &tags)
+{
+  time_t iStartTime, iEndTime;
+  start.GetAsTime(iStartTime);
+  end.GetAsTime(iEndTime);
+
+  return Get(iEpgId, PrepareSQL("(iEndTime <= %u OR iStartTime >= %u)",
+      static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime)), tags);
+}
+
+CPVREpgInfoTagPtr CPVREpgDatabase::GetByBroadcastUid(int iEpgId, unsigned int iUniqueBroadcastId)
+{
+  std::vector<CPVREpgInfoTagPtr> tags;
+  if (Get(iEpgId, PrepareSQL("iBroadcastUid = %u", iUniqueBroadcastId), tags) > 0)
+    return tags.front();
+
+  return CPVREpgInfoTagPtr();
+}
+
+CDateTime CPVREpgDatabase::GetFirstStartTime(int iEpgId)
+{
+  return GetTime(PrepareSQL("SELECT MIN(iStartTime) FROM epgtags WHERE idEpg = %u", iEpgId));
+}
+
+CDateTime CPVREpgDatabase::GetLastStartTime(int iEpgId)
+{
+  return GetTime(PrepareSQL("SELECT MAX(iStartTime) FROM epgtags WHERE idEpg = %u", iEpgId));
+}
+
+CDateTime CPVREpgDatabase::GetTime(const std::string &strQuery)
+{
+  CDateTime time;
+
+  CSingleLock lock(m_critSection);
+  /* MIN and MAX of an empty table are NULL, which reads as an empty value */
+  std::string strValue = GetSingleValue(strQuery);
+  if (!strValue.empty())
+    time = CDateTime(static_cast<time_t>(atoi(strValue.c_str())));
+
+  return time;
+}
+
+int CPVREpgDatabase::Get(int iEpgId, const std::string &strWhere, std::vector<CPVREpgInfoTagPtr> &tags)
 {
   int iReturn(-1);
 
   CSingleLock lock(m_critSection);
-  std::string strQuery = PrepareSQL("SELECT * FROM epgtags WHERE idEpg = %u;", epg.EpgID());
+  std::string strQuery = PrepareSQL("SELECT * FROM epgtags WHERE idEpg = %u", iEpgId);
+  if (!strWhere.empty())
+    strQuery += " AND " + strWhere;
   if (ResultQuery(strQuery))
   {
     iReturn = 0;
@@ -288,7 +354,7 @@ int CPVREpgDatabase::Get(CPVREpg &epg)
         newTag->m_strIconPath        = m_pDS->fv("sIconPath").get_asString().c_str();
         newTag->m_iFlags             = m_pDS->fv("iFlags").get_asInt();
 
-        epg.AddEntry(*newTag);
+        tags.push_back(newTag);
         ++iReturn;
 
         m_pDS->next();
@@ -430,6 +496,94 @@ int CPVREpgDatabase::Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate /* =
   return iReturn;
 }
 
+bool CPVREpgDatabase::Persist(const std::vector<CPVREpgInfoTagPtr> &tags)
+{
+  if (NULL == m_pDB.get() || NULL == m_pDS.get())
+    return false;
+
+  /* new tags get their id from the database, as with the REPLACE in Persist(tag) that omits it */
+  static const std::string strQuery = "REPLACE INTO epgtags (idEpg, iStartTime, "
+      "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
+      "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+      "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, iBroadcastUid, idBroadcast) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+
+  bool bReturn(true);
+
+  CSingleLock lock(m_critSection);
+  for (const auto &tag : tags)
+  {
+    if (tag->EpgID() <= 0)
+    {
+      CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag->Title(true).c_str());
+      bReturn = false;
+      continue;
+    }
+
+    time_t iStartTime, iEndTime, iFirstAired;
+    tag->StartAsUTC().GetAsTime(iStartTime);
+    tag->EndAsUTC().GetAsTime(iEndTime);
+    tag->FirstAiredAsUTC().GetAsTime(iFirstAired);
+
+    /* Only store the genre string when needed */
+    std::string strGenre = (tag->GenreType() == EPG_GENRE_USE_STRING) ? tag->DeTokenize(tag->Genre()) : "";
+
+    field_value broadcastId;
+    if (tag->BroadcastId() < 0)
+      broadcastId.set_isNull();
+    else
+      broadcastId = tag->BroadcastId();
+
+    try
+    {
+      m_pDS->exec(strQuery, {
+          field_value(tag->EpgID()), field_value(static_cast<unsigned int>(iStartTime)), field_value(static_cast<unsigned int>(iEndTime)),
+          field_value(tag->Title(true)), field_value(tag->PlotOutline(true)), field_value(tag->Plot(true)),
+          field_value(tag->OriginalTitle(true)), field_value(tag->DeTokenize(tag->Cast())), field_value(tag->DeTokenize(tag->Directors())),
+          field_value(tag->DeTokenize(tag->Writers())), field_value(tag->Year()), field_value(tag->IMDBNumber()),
+          field_value(tag->Icon()), field_value(tag->GenreType()), field_value(tag->GenreSubType()), field_value(strGenre),
+          field_value(static_cast<unsigned int>(iFirstAired)), field_value(tag->ParentalRating()), field_value(tag->StarRating()), field_value(tag->Notify()),
+          field_value(tag->SeriesNumber()), field_value(tag->EpisodeNumber()), field_value(tag->EpisodePart()), field_value(tag->EpisodeName(true)), field_value(tag->Flags()),
+          field_value(tag->UniqueBroadcastID()), broadcastId });
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - failed to persist tag '%s' of table %d", __FUNCTION__, tag->Title(true).c_str(), tag->EpgID());
+      bReturn = false;
+    }
+  }
+
+  return bReturn;
+}
+
+bool CPVREpgDatabase::Delete(const std::vector<CPVREpgInfoTagPtr> &tags)
+{
+  if (NULL == m_pDB.get() || NULL == m_pDS.get())
+    return false;
+
+  bool bReturn(true);
+
+  CSingleLock lock(m_critSection);
+  for (const auto &tag : tags)
+  {
+    /* tag without a database ID was not persisted */
+    if (tag->BroadcastId() <= 0)
+      continue;
+
+    try
+    {
+      m_pDS->exec("DELETE FROM epgtags WHERE idBroadcast = ?", { field_value(tag->BroadcastId()) });
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - failed to delete tag %d", __FUNCTION__, tag->BroadcastId());
+      bReturn = false;
+    }
+  }
+
+  return bReturn;
+}
+
 int CPVREpgDatabase::GetLastEPGId(void)
 {
   CSingleLock lock(m_critSection);
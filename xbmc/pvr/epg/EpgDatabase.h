@@ -19,6 +19,9 @@
  *
  */
 
+#include <string>
+#include <vector>
+
 #include "XBDateTime.h"
 #include "dbwrappers/Database.h"
 #include "threads/CriticalSection.h"
@@ -122,6 +125,48 @@ namespace PVR
      */
     int Get(CPVREpg &epg);
 
+    /*!
+     * @brief Get the EPG entries of a table that overlap a time window.
+     * @param iEpgId The table to get the entries for.
+     * @param start The start of the window.
+     * @param end The end of the window.
+     * @param tags The entries found are added to this list.
+     * @return The amount of entries that was added or -1 if the query failed.
+     */
+    int GetBetween(int iEpgId, const CDateTime &start, const CDateTime &end, std::vector<CPVREpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Get the EPG entries of a table that don't overlap a time window, i.e. the ones GetBetween() leaves out.
+     * @param iEpgId The table to get the entries for.
+     * @param start The start of the window.
+     * @param end The end of the window.
+     * @param tags The entries found are added to this list.
+     * @return The amount of entries that was added or -1 if the query failed.
+     */
+    int GetOutside(int iEpgId, const CDateTime &start, const CDateTime &end, std::vector<CPVREpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Get a single EPG entry of a table.
+     * @param iEpgId The table to get the entry for.
+     * @param iUniqueBroadcastId The unique broadcast id of the entry.
+     * @return The entry or NULL if it wasn't found.
+     */
+    CPVREpgInfoTagPtr GetByBroadcastUid(int iEpgId, unsigned int iUniqueBroadcastId);
+
+    /*!
+     * @brief Get the start time of the first EPG entry of a table.
+     * @param iEpgId The table to get the time for.
+     * @return The start time or an invalid time if the table has no entries.
+     */
+    CDateTime GetFirstStartTime(int iEpgId);
+
+    /*!
+     * @brief Get the start time of the last EPG entry of a table.
+     * @param iEpgId The table to get the time for.
+     * @return The start time or an invalid time if the table has no entries.
+     */
+    CDateTime GetLastStartTime(int iEpgId);
+
     /*!
      * @brief Get the last stored EPG scan time.
      * @param iEpgId The table to update the time for. Use 0 for a global value.
@@ -154,6 +199,20 @@ namespace PVR
      */
     int Persist(const CPVREpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Persist infotags with a single prepared statement. Call within a transaction to write them at once.
+     * @param tags The tags to persist.
+     * @return True if all tags were persisted, false otherwise.
+     */
+    bool Persist(const std::vector<CPVREpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Remove infotags with a single prepared statement. Call within a transaction to remove them at once.
+     * @param tags The tags to remove. Tags that were never persisted are skipped.
+     * @return True if all tags were removed, false otherwise.
+     */
+    bool Delete(const std::vector<CPVREpgInfoTagPtr> &tags);
+
     /*!
      * @return Last EPG id in the database
      */
@@ -180,6 +239,22 @@ namespace PVR
 
     int GetMinSchemaVersion() const override { return 4; }
 
+    /*!
+     * @brief Get the EPG entries of a table matching a condition.
+     * @param iEpgId The table to get the entries for.
+     * @param strWhere The condition, in addition to the table.
+     * @param tags The entries found are added to this list.
+     * @return The amount of entries that was added or -1 if the query failed.
+     */
+    int Get(int iEpgId, const std::string &strWhere, std::vector<CPVREpgInfoTagPtr> &tags);
+
+    /*!
+     * @brief Get the time in a column of the first row a query returns.
+     * @param strQuery The query.
+     * @return The time or an invalid time if the query returned nothing.
+     */
+    CDateTime GetTime(const std::string &strQuery);
+
     CCriticalSection m_critSection;
   };
 }
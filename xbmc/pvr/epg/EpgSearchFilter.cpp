@@ -29,6 +29,7 @@
 #include "pvr/PVRManager.h"
 #include "pvr/channels/PVRChannelGroupsContainer.h"
 #include "pvr/epg/EpgContainer.h"
+#include "pvr/epg/EpgSearchIndex.h"
 #include "pvr/recordings/PVRRecordings.h"
 #include "pvr/timers/PVRTimers.h"
 
@@ -43,6 +44,7 @@ CPVREpgSearchFilter::CPVREpgSearchFilter(bool bRadio)
 void CPVREpgSearchFilter::Reset()
 {
   m_strSearchTerm.clear();
+  m_textSearch.reset();
   m_bIsCaseSensitive         = false;
   m_bSearchInDescription     = false;
   m_iGenreType               = EPG_SEARCH_UNSET;
@@ -114,6 +116,15 @@ void CPVREpgSearchFilter::SetSearchPhrase(const std::string &strSearchPhrase)
   m_strSearchTerm = "\"";
   m_strSearchTerm.append(strSearchPhrase);
   m_strSearchTerm.append("\"");
+  m_textSearch.reset();
+}
+
+const CTextSearch &CPVREpgSearchFilter::GetTextSearch() const
+{
+  if (!m_textSearch)
+    m_textSearch = std::make_shared<CTextSearch>(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+
+  return *m_textSearch;
 }
 
 bool CPVREpgSearchFilter::MatchSearchTerm(const CPVREpgInfoTagPtr &tag) const
@@ -122,7 +133,7 @@ bool CPVREpgSearchFilter::MatchSearchTerm(const CPVREpgInfoTagPtr &tag) const
 
   if (!m_strSearchTerm.empty())
   {
-    CTextSearch search(m_strSearchTerm, m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+    const CTextSearch &search = GetTextSearch();
     bReturn = search.Search(tag->Title()) ||
               search.Search(tag->PlotOutline()) ||
               (m_bSearchInDescription && search.Search(tag->Plot()));
@@ -155,6 +166,20 @@ bool CPVREpgSearchFilter::FilterEntry(const CPVREpgInfoTagPtr &tag) const
         MatchFreeToAir(tag)));
 }
 
+bool CPVREpgSearchFilter::GetCandidates(const CPVREpgSearchIndex &index, std::vector<CPVREpgInfoTagPtr> &tags) const
+{
+  if (!m_strSearchTerm.empty())
+    return index.GetCandidates(GetTextSearch(), tags);
+
+  if (m_iGenreType != EPG_SEARCH_UNSET && !m_bIncludeUnknownGenres)
+  {
+    index.GetCandidates(m_iGenreType, tags);
+    return true;
+  }
+
+  return false;
+}
+
 int CPVREpgSearchFilter::RemoveDuplicates(CFileItemList &results)
 {
   unsigned int iSize = results.Size();
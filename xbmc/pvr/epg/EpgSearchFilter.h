@@ -19,17 +19,23 @@
  *
  */
 
+#include <memory>
+#include <vector>
+
 #include "XBDateTime.h"
 
 #include "pvr/PVRTypes.h"
 #include "pvr/channels/PVRChannelNumber.h"
 
 class CFileItemList;
+class CTextSearch;
 
 namespace PVR
 {
   #define EPG_SEARCH_UNSET (-1)
 
+  class CPVREpgSearchIndex;
+
   /** Filter to apply with on a CPVREpgInfoTag */
 
   class CPVREpgSearchFilter
@@ -55,6 +61,14 @@ namespace PVR
      */
     bool FilterEntry(const CPVREpgInfoTagPtr &tag) const;
 
+    /*!
+     * @brief Get the tags of an index that may pass this filter, to be checked with FilterEntry.
+     * @param index The search index of an EPG table.
+     * @param tags The candidates.
+     * @return False if the index can't narrow this filter down and all tags have to be checked.
+     */
+    bool GetCandidates(const CPVREpgSearchIndex &index, std::vector<CPVREpgInfoTagPtr> &tags) const;
+
     /*!
      * @brief remove duplicates from a list of epg tags.
      * @param results the list of epg tags.
@@ -69,11 +83,11 @@ namespace PVR
     bool IsRadio() const { return m_bIsRadio; }
 
     const std::string &GetSearchTerm() const { return m_strSearchTerm; }
-    void SetSearchTerm(const std::string &strSearchTerm) { m_strSearchTerm = strSearchTerm; }
+    void SetSearchTerm(const std::string &strSearchTerm) { m_strSearchTerm = strSearchTerm; m_textSearch.reset(); }
     void SetSearchPhrase(const std::string &strSearchPhrase);
 
     bool IsCaseSensitive() const { return m_bIsCaseSensitive; }
-    void SetCaseSensitive(bool bIsCaseSensitive) { m_bIsCaseSensitive = bIsCaseSensitive; }
+    void SetCaseSensitive(bool bIsCaseSensitive) { m_bIsCaseSensitive = bIsCaseSensitive; m_textSearch.reset(); }
 
     bool ShouldSearchInDescription() const { return m_bSearchInDescription; }
     void SetSearchInDescription(bool bSearchInDescription) {m_bSearchInDescription = bSearchInDescription; }
@@ -132,6 +146,7 @@ namespace PVR
     bool MatchFreeToAir(const CPVREpgInfoTagPtr &tag) const;
     bool MatchTimers(const CPVREpgInfoTagPtr &tag) const;
     bool MatchRecordings(const CPVREpgInfoTagPtr &tag) const;
+    const CTextSearch &GetTextSearch() const;
 
     std::string   m_strSearchTerm;            /*!< The term to search for */
     bool          m_bIsCaseSensitive;         /*!< Do a case sensitive search */
@@ -153,5 +168,7 @@ namespace PVR
     bool          m_bIgnorePresentTimers;     /*!< True to ignore currently present timers (future recordings), false if not */
     bool          m_bIgnorePresentRecordings; /*!< True to ignore currently active recordings, false if not */
     unsigned int  m_iUniqueBroadcastId;       /*!< The broadcastid to search for */
+
+    mutable std::shared_ptr<CTextSearch> m_textSearch; /*!< The parsed search term, created on first use */
   };
 }
@@ -0,0 +1,236 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgSearchIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+
+#include "pvr/epg/EpgInfoTag.h"
+
+using namespace PVR;
+
+namespace
+{
+  /* ASCII letters and digits make up tokens, as does everything outside of ASCII so that
+     multibyte UTF-8 sequences are never split. A search term without separators therefore
+     always lies within a single token of the text it's found in. */
+  bool IsTokenChar(char c)
+  {
+    return (static_cast<unsigned char>(c) & 0x80) || isalnum(static_cast<unsigned char>(c));
+  }
+
+  template<typename T>
+  void RemoveFromPosting(std::vector<T> &posting, const T &value)
+  {
+    auto it = std::find(posting.begin(), posting.end(), value);
+    if (it != posting.end())
+    {
+      *it = posting.back();
+      posting.pop_back();
+    }
+  }
+}
+
+void CPVREpgSearchIndex::Tokenize(const std::string &strText, std::vector<std::string> &tokens)
+{
+  std::string strFolded(strText);
+  StringUtils::ToLower(strFolded);
+
+  size_t iStart = std::string::npos;
+  for (size_t i = 0; i <= strFolded.size(); ++i)
+  {
+    bool bTokenChar = i < strFolded.size() && IsTokenChar(strFolded[i]);
+    if (bTokenChar && iStart == std::string::npos)
+      iStart = i;
+    else if (!bTokenChar && iStart != std::string::npos)
+    {
+      tokens.emplace_back(strFolded.substr(iStart, i - iStart));
+      iStart = std::string::npos;
+    }
+  }
+}
+
+void CPVREpgSearchIndex::Add(const CPVREpgInfoTagPtr &tag)
+{
+  Remove(tag);
+
+  std::vector<std::string> tokens;
+  Tokenize(tag->Title(true), tokens);
+  Tokenize(tag->PlotOutline(true), tokens);
+  Tokenize(tag->Plot(true), tokens);
+  std::sort(tokens.begin(), tokens.end());
+  tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+  IndexedTag &indexed = m_tags[tag.get()];
+  indexed.tag = tag;
+  indexed.iGenreType = tag->GenreType();
+  indexed.tokens.reserve(tokens.size());
+  for (auto &token : tokens)
+  {
+    TokenMap::iterator it = m_tokens.find(token);
+    if (it == m_tokens.end())
+      it = m_tokens.emplace(std::move(token), std::vector<const CPVREpgInfoTag*>()).first;
+
+    it->second.push_back(tag.get());
+    indexed.tokens.push_back(&*it);
+  }
+
+  m_genres[indexed.iGenreType].push_back(tag.get());
+}
+
+void CPVREpgSearchIndex::Remove(const CPVREpgInfoTagPtr &tag)
+{
+  auto it = m_tags.find(tag.get());
+  if (it == m_tags.end())
+    return;
+
+  for (TokenMap::value_type *token : it->second.tokens)
+  {
+    RemoveFromPosting(token->second, static_cast<const CPVREpgInfoTag*>(tag.get()));
+    if (token->second.empty())
+      m_tokens.erase(m_tokens.find(token->first));
+  }
+
+  auto genre = m_genres.find(it->second.iGenreType);
+  if (genre != m_genres.end())
+  {
+    RemoveFromPosting(genre->second, static_cast<const CPVREpgInfoTag*>(tag.get()));
+    if (genre->second.empty())
+      m_genres.erase(genre);
+  }
+
+  m_tags.erase(it);
+}
+
+void CPVREpgSearchIndex::Clear()
+{
+  m_tags.clear();
+  m_tokens.clear();
+  m_genres.clear();
+}
+
+bool CPVREpgSearchIndex::GetTermCandidates(const std::string &strTerm, TagSet &tags) const
+{
+  std::vector<std::string> words;
+  Tokenize(strTerm, words);
+  if (words.empty())
+    return false;
+
+  /* every word of the term has to be found within a token, but not necessarily as a whole
+     token as CTextSearch matches substrings */
+  bool bFirst(true);
+  for (const auto &word : words)
+  {
+    TagSet wordTags;
+    for (const auto &token : m_tokens)
+    {
+      if (token.first.find(word) != std::string::npos)
+        wordTags.insert(token.second.begin(), token.second.end());
+    }
+
+    if (bFirst)
+      tags.swap(wordTags);
+    else
+    {
+      for (TagSet::iterator it = tags.begin(); it != tags.end();)
+      {
+        if (wordTags.find(*it) == wordTags.end())
+          it = tags.erase(it);
+        else
+          ++it;
+      }
+    }
+
+    bFirst = false;
+    if (tags.empty())
+      break;
+  }
+
+  return true;
+}
+
+bool CPVREpgSearchIndex::GetCandidates(const CTextSearch &search, std::vector<CPVREpgInfoTagPtr> &tags) const
+{
+  TagSet candidates;
+
+  if (!search.GetAndTerms().empty())
+  {
+    /* all 'and' terms must match, the ones consisting of separators only can't narrow it down */
+    bool bConstrained(false);
+    for (const auto &term : search.GetAndTerms())
+    {
+      TagSet termTags;
+      if (!GetTermCandidates(term, termTags))
+        continue;
+
+      if (!bConstrained)
+        candidates.swap(termTags);
+      else
+      {
+        for (TagSet::iterator it = candidates.begin(); it != candidates.end();)
+        {
+          if (termTags.find(*it) == termTags.end())
+            it = candidates.erase(it);
+          else
+            ++it;
+        }
+      }
+      bConstrained = true;
+    }
+
+    if (!bConstrained)
+      return false;
+  }
+  else if (!search.GetOrTerms().empty())
+  {
+    /* any 'or' term may match, so each of them has to narrow it down */
+    for (const auto &term : search.GetOrTerms())
+    {
+      TagSet termTags;
+      if (!GetTermCandidates(term, termTags))
+        return false;
+
+      candidates.insert(termTags.begin(), termTags.end());
+    }
+  }
+  else
+    return false;
+
+  tags.reserve(tags.size() + candidates.size());
+  for (const CPVREpgInfoTag *candidate : candidates)
+    tags.emplace_back(m_tags.at(candidate).tag);
+
+  return true;
+}
+
+void CPVREpgSearchIndex::GetCandidates(int iGenreType, std::vector<CPVREpgInfoTagPtr> &tags) const
+{
+  auto genre = m_genres.find(iGenreType);
+  if (genre == m_genres.end())
+    return;
+
+  tags.reserve(tags.size() + genre->second.size());
+  for (const CPVREpgInfoTag *candidate : genre->second)
+    tags.emplace_back(m_tags.at(candidate).tag);
+}
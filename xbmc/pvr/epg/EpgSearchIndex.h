@@ -0,0 +1,94 @@
+#pragma once
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pvr/PVRTypes.h"
+
+class CTextSearch;
+
+namespace PVR
+{
+  /** Inverted index over the text of the tags of an EPG table, maintained by CPVREpg. Not thread safe. */
+
+  class CPVREpgSearchIndex
+  {
+  public:
+    /*!
+     * @brief Add a tag to the index, or re-index it if it's already in there.
+     * @param tag The tag.
+     */
+    void Add(const CPVREpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove a tag from the index.
+     * @param tag The tag.
+     */
+    void Remove(const CPVREpgInfoTagPtr &tag);
+
+    /*!
+     * @brief Remove all tags from the index.
+     */
+    void Clear();
+
+    /*!
+     * @brief Get the tags that may match a text search on title, plot outline or plot.
+     * @param search The search.
+     * @param tags The candidates. Contains every tag the search matches, but may contain more.
+     * @return False if the search can't be narrowed down by the index, e.g. if it only has 'not' terms.
+     */
+    bool GetCandidates(const CTextSearch &search, std::vector<CPVREpgInfoTagPtr> &tags) const;
+
+    /*!
+     * @brief Get the tags of a genre type.
+     * @param iGenreType The genre type.
+     * @param tags The tags of this genre type.
+     */
+    void GetCandidates(int iGenreType, std::vector<CPVREpgInfoTagPtr> &tags) const;
+
+    /*!
+     * @brief Split a text into case folded tokens the way the index does.
+     * @param strText The text.
+     * @param tokens The tokens.
+     */
+    static void Tokenize(const std::string &strText, std::vector<std::string> &tokens);
+
+  private:
+    typedef std::unordered_set<const CPVREpgInfoTag*> TagSet;
+    typedef std::unordered_map<std::string, std::vector<const CPVREpgInfoTag*>> TokenMap;
+
+    struct IndexedTag
+    {
+      CPVREpgInfoTagPtr tag;
+      int iGenreType;
+      std::vector<TokenMap::value_type*> tokens;
+    };
+
+    bool GetTermCandidates(const std::string &strTerm, TagSet &tags) const;
+
+    std::unordered_map<const CPVREpgInfoTag*, IndexedTag> m_tags;
+    TokenMap m_tokens;
+    std::unordered_map<int, std::vector<const CPVREpgInfoTag*>> m_genres;
+  };
+}
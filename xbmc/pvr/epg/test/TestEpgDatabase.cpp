@@ -0,0 +1,143 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "dbwrappers/dataset.h"
+#include "pvr/epg/EpgDatabase.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "test/TestDatabase.h"
+
+using namespace PVR;
+
+#define TEST_START_TIME  1500000000
+#define TEST_DURATION    3600
+
+namespace
+{
+  /* an EPG database with the tags written directly, as adding them through a table needs the PVR manager */
+  class CTestEpgDatabase : public CPVREpgDatabase
+  {
+  public:
+    void AddTag(int iEpgId, unsigned int iUid, int iHour)
+    {
+      time_t iStartTime = TEST_START_TIME + iHour * TEST_DURATION;
+      m_pDS->exec(PrepareSQL("INSERT INTO epgtags (idEpg, iBroadcastUid, sTitle, iStartTime, iEndTime) VALUES (%i, %u, 'tag %u', %u, %u)",
+          iEpgId, iUid, iUid, static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iStartTime + TEST_DURATION)));
+    }
+  };
+}
+
+class TestEpgDatabase : public testing::Test
+{
+protected:
+  TestEpgDatabase() : m_file(m_db, "TestEpgDatabase")
+  {
+    /* table 1 has a tag every hour of a day, table 2 a single one */
+    if (m_file.IsConnected())
+    {
+      for (int iHour = 0; iHour < 24; iHour++)
+        m_db.AddTag(1, 100 + iHour, iHour);
+      m_db.AddTag(2, 200, 12);
+    }
+  }
+
+  static CDateTime Hour(int iHour)
+  {
+    return CDateTime(static_cast<time_t>(TEST_START_TIME + iHour * TEST_DURATION));
+  }
+
+  static std::vector<unsigned int> Uids(const std::vector<CPVREpgInfoTagPtr> &tags)
+  {
+    std::vector<unsigned int> uids;
+    for (const auto &tag : tags)
+      uids.push_back(tag->UniqueBroadcastID());
+    std::sort(uids.begin(), uids.end());
+    return uids;
+  }
+
+  CTestEpgDatabase m_db;
+  CTestDatabase m_file;
+};
+
+TEST_F(TestEpgDatabase, LoadWindow)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  // tags overlapping the window, the one ending at its start and the one starting at its end are left out
+  std::vector<CPVREpgInfoTagPtr> window;
+  EXPECT_EQ(3, m_db.GetBetween(1, Hour(10), Hour(13), window));
+  EXPECT_EQ(std::vector<unsigned int>({ 110, 111, 112 }), Uids(window));
+
+  // a window starting within a tag includes it
+  std::vector<CPVREpgInfoTagPtr> overlap;
+  EXPECT_EQ(2, m_db.GetBetween(1, Hour(10) + CDateTimeSpan(0, 0, 30, 0), Hour(12), overlap));
+  EXPECT_EQ(std::vector<unsigned int>({ 110, 111 }), Uids(overlap));
+
+  // loading the remaining tags completes the table without loading any twice
+  std::vector<CPVREpgInfoTagPtr> remaining;
+  EXPECT_EQ(21, m_db.GetOutside(1, Hour(10), Hour(13), remaining));
+  std::vector<CPVREpgInfoTagPtr> all(window);
+  all.insert(all.end(), remaining.begin(), remaining.end());
+  std::vector<unsigned int> uids(Uids(all));
+  EXPECT_EQ(24u, uids.size());
+  EXPECT_TRUE(std::adjacent_find(uids.begin(), uids.end()) == uids.end());
+
+  // only the table asked for
+  std::vector<CPVREpgInfoTagPtr> other;
+  EXPECT_EQ(1, m_db.GetOutside(2, Hour(0), Hour(1), other));
+  EXPECT_EQ(std::vector<unsigned int>({ 200 }), Uids(other));
+  other.clear();
+  EXPECT_EQ(0, m_db.GetBetween(2, Hour(0), Hour(1), other));
+}
+
+TEST_F(TestEpgDatabase, GetByBroadcastUid)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  // a tag outside any window is read on its own
+  CPVREpgInfoTagPtr tag = m_db.GetByBroadcastUid(1, 123);
+  ASSERT_TRUE(tag.get() != nullptr);
+  EXPECT_EQ(123u, tag->UniqueBroadcastID());
+  EXPECT_EQ("tag 123", tag->Title(true));
+  EXPECT_EQ(Hour(23), tag->StartAsUTC());
+  EXPECT_EQ(Hour(24), tag->EndAsUTC());
+
+  EXPECT_TRUE(m_db.GetByBroadcastUid(1, 200).get() == nullptr); // belongs to another table
+  EXPECT_TRUE(m_db.GetByBroadcastUid(1, 999).get() == nullptr);
+}
+
+TEST_F(TestEpgDatabase, FirstAndLastStartTime)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  EXPECT_EQ(Hour(0), m_db.GetFirstStartTime(1));
+  EXPECT_EQ(Hour(23), m_db.GetLastStartTime(1));
+  EXPECT_EQ(Hour(12), m_db.GetFirstStartTime(2));
+  EXPECT_EQ(Hour(12), m_db.GetLastStartTime(2));
+
+  // a table without tags has no dates
+  EXPECT_FALSE(m_db.GetFirstStartTime(3).IsValid());
+  EXPECT_FALSE(m_db.GetLastStartTime(3).IsValid());
+}
@@ -0,0 +1,168 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "addons/kodi-addon-dev-kit/include/kodi/xbmc_epg_types.h"
+#include "pvr/epg/EpgInfoTag.h"
+#include "pvr/epg/EpgSearchIndex.h"
+#include "utils/TextSearch.h"
+
+using namespace PVR;
+
+#define TEST_TAGS              500
+#define TEST_VOCABULARY_SIZE   200
+
+static CPVREpgInfoTagPtr CreateTag(unsigned int iUid, const std::string &strTitle, const std::string &strPlot, int iGenreType = 0)
+{
+  EPG_TAG data = {};
+  data.iUniqueBroadcastId = iUid;
+  data.strTitle = strTitle.c_str();
+  data.strPlot = strPlot.c_str();
+  data.startTime = 1500000000 + iUid * 1800;
+  data.endTime = data.startTime + 1800;
+  data.iGenreType = iGenreType;
+  return CPVREpgInfoTagPtr(new CPVREpgInfoTag(data, -1));
+}
+
+/* the search as CPVREpgSearchFilter::MatchSearchTerm does it, tags are created without channel so are never locked */
+static bool Matches(const CTextSearch &search, const CPVREpgInfoTagPtr &tag)
+{
+  return search.Search(tag->Title()) || search.Search(tag->PlotOutline()) || search.Search(tag->Plot());
+}
+
+static std::vector<CPVREpgInfoTagPtr> Find(const CPVREpgSearchIndex &index, const std::string &strTerm)
+{
+  CTextSearch search(strTerm);
+  std::vector<CPVREpgInfoTagPtr> candidates, results;
+  EXPECT_TRUE(index.GetCandidates(search, candidates));
+  for (const auto &tag : candidates)
+  {
+    if (Matches(search, tag))
+      results.push_back(tag);
+  }
+  return results;
+}
+
+TEST(TestEpgSearchIndex, Search)
+{
+  CPVREpgSearchIndex index;
+  CPVREpgInfoTagPtr football = CreateTag(1, "Football Tonight", "Live from the stadium.", EPG_EVENT_CONTENTMASK_SPORTS);
+  CPVREpgInfoTagPtr news = CreateTag(2, "Evening News", "All the news of the day, and the football results.", EPG_EVENT_CONTENTMASK_NEWSCURRENTAFFAIRS);
+  CPVREpgInfoTagPtr movie = CreateTag(3, "Die Hard", "An off-duty cop at a Christmas party.", EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+  index.Add(football);
+  index.Add(news);
+  index.Add(movie);
+
+  // substrings of tokens match like they do with CTextSearch
+  EXPECT_EQ(2u, Find(index, "ball").size());
+  EXPECT_EQ(1u, Find(index, "+ foot + tonight").size());
+  EXPECT_EQ(0u, Find(index, "+ foot + stadium").size()); // title and plot are searched separately
+  EXPECT_EQ(2u, Find(index, "stadium | christ").size());
+  EXPECT_EQ(1u, Find(index, "\"off-duty cop\"").size());
+  EXPECT_EQ(0u, Find(index, "basketball").size());
+
+  // these can't be narrowed down
+  std::vector<CPVREpgInfoTagPtr> candidates;
+  EXPECT_FALSE(index.GetCandidates(CTextSearch("!news"), candidates));
+  EXPECT_FALSE(index.GetCandidates(CTextSearch("- | news"), candidates));
+
+  candidates.clear();
+  index.GetCandidates(EPG_EVENT_CONTENTMASK_SPORTS, candidates);
+  ASSERT_EQ(1u, candidates.size());
+  EXPECT_EQ(football, candidates[0]);
+
+  // re-adding an updated tag replaces its tokens
+  EPG_TAG data = {};
+  data.strTitle = "Basketball Tonight";
+  data.strPlot = "Live from the arena.";
+  data.iGenreType = EPG_EVENT_CONTENTMASK_SPORTS;
+  football->Update(CPVREpgInfoTag(data, -1));
+  index.Add(football);
+  EXPECT_EQ(1u, Find(index, "football").size());
+  EXPECT_EQ(1u, Find(index, "arena").size());
+  EXPECT_EQ(0u, Find(index, "stadium").size());
+
+  index.Remove(news);
+  EXPECT_EQ(0u, Find(index, "news").size());
+  EXPECT_EQ(1u, Find(index, "ball").size());
+
+  index.Clear();
+  EXPECT_EQ(0u, Find(index, "tonight").size());
+}
+
+TEST(TestEpgSearchIndex, MatchesScan)
+{
+  std::mt19937 mt(42);
+  std::vector<std::string> vocabulary;
+  for (int i = 0; i < TEST_VOCABULARY_SIZE; i++)
+  {
+    std::string word;
+    for (int len = 4 + mt() % 6; len > 0; len--)
+      word += static_cast<char>('a' + mt() % 26);
+    vocabulary.push_back(word);
+  }
+
+  auto words = [&](int count)
+  {
+    std::string text;
+    for (int i = 0; i < count; i++)
+    {
+      if (!text.empty())
+        text += ' ';
+      text += vocabulary[mt() % vocabulary.size()];
+    }
+    return text;
+  };
+
+  std::vector<CPVREpgInfoTagPtr> tags;
+  CPVREpgSearchIndex index;
+  for (int i = 0; i < TEST_TAGS; i++)
+  {
+    tags.push_back(CreateTag(i + 1, words(3), words(12)));
+    index.Add(tags.back());
+  }
+
+  std::vector<std::string> terms;
+  for (int i = 0; i < 5; i++)
+    terms.push_back(vocabulary[mt() % vocabulary.size()]);
+  terms.push_back(vocabulary[mt() % vocabulary.size()].substr(1, 3));
+  terms.push_back("+ " + vocabulary[mt() % vocabulary.size()].substr(0, 2) + " + " + vocabulary[mt() % vocabulary.size()].substr(0, 2));
+
+  // the index finds what a CTextSearch per tag finds
+  for (const auto &term : terms)
+  {
+    std::vector<CPVREpgInfoTagPtr> scanned;
+    for (const auto &tag : tags)
+    {
+      if (Matches(CTextSearch(term), tag))
+        scanned.push_back(tag);
+    }
+
+    std::vector<CPVREpgInfoTagPtr> found(Find(index, term));
+    std::sort(found.begin(), found.end(),
+              [](const CPVREpgInfoTagPtr &a, const CPVREpgInfoTagPtr &b) { return a->UniqueBroadcastID() < b->UniqueBroadcastID(); });
+    EXPECT_EQ(scanned, found) << term;
+  }
+}
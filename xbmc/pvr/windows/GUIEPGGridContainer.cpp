@@ -1407,13 +1407,7 @@ int CGUIEPGGridContainer::GetBlock(const CGUIListItemPtr &item, int channel)
 
 int CGUIEPGGridContainer::GetRealBlock(const CGUIListItemPtr &item, int channel)
 {
-  int channelIndex = channel + m_channelOffset;
-  int block = 0;
-
-  while (block < m_gridModel->GetBlockCount() && m_gridModel->GetGridItem(channelIndex, block) != item)
-    block++;
-
-  return block;
+  return m_gridModel->GetGridItemStartBlock(channel + m_channelOffset, item);
 }
 
 GridItem *CGUIEPGGridContainer::GetNextItem(int channel)
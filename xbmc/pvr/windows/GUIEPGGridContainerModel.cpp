@@ -20,6 +20,7 @@
 
 #include "GUIEPGGridContainerModel.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "FileItem.h"
@@ -31,9 +32,6 @@
 #include "pvr/channels/PVRChannel.h"
 #include "pvr/epg/EpgInfoTag.h"
 
-class CGUIListItem;
-typedef std::shared_ptr<CGUIListItem> CGUIListItemPtr;
-
 using namespace PVR;
 
 static const unsigned int GRID_START_PADDING = 30; // minutes
@@ -52,10 +50,10 @@ void CGUIEPGGridContainerModel::Reset()
 {
   for (auto &channel : m_gridIndex)
   {
-    for (const auto &block : channel)
+    for (const auto &gridItem : channel)
     {
-      if (block.item)
-        block.item->ClearProperties();
+      if (gridItem.item)
+        gridItem.item->ClearProperties();
     }
     channel.clear();
   }
@@ -157,7 +155,6 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
 
   ////////////////////////////////////////////////////////////////////////
   // Create epg grid
-  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
   const CDateTimeSpan gridDuration(m_gridEnd - m_gridStart);
   m_blocks = (gridDuration.GetDays() * 24 * 60 + gridDuration.GetHours() * 60 + gridDuration.GetMinutes()) / MINSPERBLOCK;
   if (m_blocks >= MAXBLOCKS)
@@ -165,118 +162,110 @@ void CGUIEPGGridContainerModel::Refresh(const std::unique_ptr<CFileItemList> &it
   else if (m_blocks < iBlocksPerPage)
     m_blocks = iBlocksPerPage;
 
-  m_gridIndex.reserve(m_channelItems.size());
-  const std::vector<GridItem> blocks(m_blocks);
+  // the grid of a channel is created when it gets accessed for the first time
+  m_fBlockSize = fBlockSize;
+  m_gridIndex.resize(m_channelItems.size());
+}
+
+int CGUIEPGGridContainerModel::GetBlockCeil(const CDateTime &datetime) const
+{
+  static const int iBlockSeconds = MINSPERBLOCK * 60;
+
+  if (datetime >= m_gridStart)
+    return ((datetime - m_gridStart).GetSecondsTotal() + iBlockSeconds - 1) / iBlockSeconds;
 
-  for (size_t channel = 0; channel < m_channelItems.size(); ++channel)
+  return -((m_gridStart - datetime).GetSecondsTotal() / iBlockSeconds);
+}
+
+void CGUIEPGGridContainerModel::CreateChannelGrid(int iChannel, std::vector<GridItem> &grid) const
+{
+  // Note: Start block of an event is start-time-based calculated block + 1,
+  //       unless start times matches exactly the begin of a block. An event
+  //       covers all blocks starting before its end, unless an earlier event
+  //       still covers them.
+
+  const auto addItem = [this, &grid](const CFileItemPtr &item, int progIndex, int startBlock, int endBlock)
   {
-    m_gridIndex.emplace_back(blocks);
-
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[channel].start;
-    unsigned long lastIdx = m_epgItemsPtr[channel].stop;
-    int iEpgId            = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
-    int itemSize          = 1; // size of the programme in blocks
-    int savedBlock        = 0;
-    CFileItemPtr item;
-    CPVREpgInfoTagPtr tag;
-
-    for (int block = 0; block < m_blocks; ++block)
-    {
-      while (progIdx <= lastIdx)
-      {
-        item = m_programmeItems[progIdx];
-        tag = item->GetEPGInfoTag();
+    GridItem gridItem;
+    gridItem.item = item;
+    gridItem.progIndex = progIndex;
+    gridItem.startBlock = startBlock;
+    gridItem.endBlock = endBlock;
+    gridItem.originWidth = (endBlock - startBlock + 1) * m_fBlockSize;
+    gridItem.width = gridItem.originWidth;
+    grid.emplace_back(gridItem);
+  };
+
+  const auto addGap = [this, iChannel, &addItem](int startBlock, int endBlock)
+  {
+    CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
+    gapTag->SetChannel(m_channelItems[iChannel]->GetPVRChannelInfoTag());
+    addItem(CFileItemPtr(new CFileItem(gapTag)), -1, startBlock, endBlock);
+  };
 
-        // Note: Start block of an event is start-time-based calculated block + 1,
-        //       unless start times matches exactly the begin of a block.
+  const long lastIdx = m_epgItemsPtr[iChannel].stop;
+  const int iEpgId = m_programmeItems[m_epgItemsPtr[iChannel].start]->GetEPGInfoTag()->EpgID();
+  int block = 0;
 
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break;
+  for (long progIdx = m_epgItemsPtr[iChannel].start; progIdx <= lastIdx && block < m_blocks; ++progIdx)
+  {
+    const CFileItemPtr item(m_programmeItems[progIdx]);
+    const CPVREpgInfoTagPtr tag(item->GetEPGInfoTag());
+    if (tag->EpgID() != iEpgId || m_gridEnd <= tag->StartAsUTC())
+      break;
 
-        if (gridCursor < tag->EndAsUTC())
-        {
-          m_gridIndex[channel][block].item = item;
-          m_gridIndex[channel][block].progIndex = progIdx;
-          break;
-        }
+    const int startBlock = std::max(GetBlockCeil(tag->StartAsUTC()), block);
+    const int endBlock = std::min(GetBlockCeil(tag->EndAsUTC()) - 1, m_blocks - 1);
+    if (startBlock > endBlock)
+      continue;
 
-        progIdx++;
-      }
+    if (startBlock > block)
+      addGap(block, startBlock - 1);
 
-      gridCursor += blockDuration;
+    item->SetProperty("GenreType", tag->GenreType());
+    addItem(item, progIdx, startBlock, endBlock);
+    block = endBlock + 1;
+  }
 
-      if (block == 0)
-        continue;
+  if (block < m_blocks)
+    addGap(block, m_blocks - 1);
+}
 
-      const CFileItemPtr prevItem(m_gridIndex[channel][block - 1].item);
-      const CFileItemPtr currItem(m_gridIndex[channel][block].item);
+std::vector<GridItem> &CGUIEPGGridContainerModel::GetChannelGrid(int iChannel) const
+{
+  std::vector<GridItem> &grid = m_gridIndex[iChannel];
+  if (grid.empty() && m_blocks > 0)
+    CreateChannelGrid(iChannel, grid);
 
-      if (block == m_blocks - 1 || prevItem != currItem)
-      {
-        // special handling for last block.
-        int blockDelta = -1;
-        int sizeDelta = 0;
-        if (block == m_blocks - 1 && prevItem == currItem)
-        {
-          itemSize++;
-          blockDelta = 0;
-          sizeDelta = 1;
-        }
-
-        if (prevItem)
-        {
-          m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", prevItem->GetEPGInfoTag()->GenreType());
-        }
-        else
-        {
-          CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
-          gapTag->SetChannel(m_channelItems[channel]->GetPVRChannelInfoTag());
-          CFileItemPtr gapItem(new CFileItem(gapTag));
-          for (int i = block + blockDelta; i >= block - itemSize + sizeDelta; --i)
-          {
-            m_gridIndex[channel][i].item = gapItem;
-          }
-        }
-
-        float fItemWidth = itemSize * fBlockSize;
-        m_gridIndex[channel][savedBlock].originWidth = fItemWidth;
-        m_gridIndex[channel][savedBlock].width = fItemWidth;
-
-        itemSize = 1;
-        savedBlock = block;
-
-        // special handling for last block.
-        if (block == m_blocks - 1 && prevItem != currItem)
-        {
-          if (currItem)
-          {
-            m_gridIndex[channel][savedBlock].item->SetProperty("GenreType", currItem->GetEPGInfoTag()->GenreType());
-          }
-          else
-          {
-            CPVREpgInfoTagPtr gapTag(CPVREpgInfoTag::CreateDefaultTag());
-            gapTag->SetChannel(m_channelItems[channel]->GetPVRChannelInfoTag());
-            CFileItemPtr gapItem(new CFileItem(gapTag));
-            m_gridIndex[channel][block].item = gapItem;
-          }
-
-          m_gridIndex[channel][savedBlock].originWidth = fBlockSize; // size always 1 block here
-          m_gridIndex[channel][savedBlock].width = fBlockSize;
-        }
-      }
-      else
-      {
-        itemSize++;
-      }
-    }
+  return grid;
+}
+
+GridItem &CGUIEPGGridContainerModel::FindGridItem(int iChannel, int iBlock) const
+{
+  std::vector<GridItem> &grid = GetChannelGrid(iChannel);
+
+  // the last item starting at or before the block
+  auto it = std::upper_bound(grid.begin(), grid.end(), iBlock,
+                             [](int block, const GridItem &gridItem) { return block < gridItem.startBlock; });
+  if (it != grid.begin())
+    --it;
+
+  return *it;
+}
+
+int CGUIEPGGridContainerModel::GetGridItemStartBlock(int iChannel, const CGUIListItemPtr &item) const
+{
+  for (const auto &gridItem : GetChannelGrid(iChannel))
+  {
+    if (gridItem.item == item)
+      return gridItem.startBlock;
   }
+
+  return m_blocks;
 }
 
 void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigned int broadcastUid, int eventOffset, int &newChannelIndex, int &newBlockIndex) const
 {
-  const CDateTimeSpan blockDuration(0, 0, MINSPERBLOCK, 0);
-
   newChannelIndex = INVALID_INDEX;
   newBlockIndex = INVALID_INDEX;
 
@@ -292,35 +281,16 @@ void CGUIEPGGridContainerModel::FindChannelAndBlockIndex(int channelUid, unsigne
     iCurrentChannel++;
   }
 
-  if (newChannelIndex != INVALID_INDEX)
+  if (newChannelIndex != INVALID_INDEX && broadcastUid > 0)
   {
     // find the block
-    CDateTime gridCursor(m_gridStart); //reset cursor for new channel
-    unsigned long progIdx = m_epgItemsPtr[newChannelIndex].start;
-    unsigned long lastIdx = m_epgItemsPtr[newChannelIndex].stop;
-    int iEpgId = m_programmeItems[progIdx]->GetEPGInfoTag()->EpgID();
-    CPVREpgInfoTagPtr tag;
-    for (int block = 0; block < m_blocks; ++block)
+    for (const auto &gridItem : GetChannelGrid(newChannelIndex))
     {
-      while (progIdx <= lastIdx)
+      if (gridItem.progIndex != -1 && gridItem.item->GetEPGInfoTag()->UniqueBroadcastID() == broadcastUid)
       {
-        tag = m_programmeItems[progIdx]->GetEPGInfoTag();
-
-        if (tag->EpgID() != iEpgId || gridCursor < tag->StartAsUTC() || m_gridEnd <= tag->StartAsUTC())
-          break; // next block
-
-        if (gridCursor < tag->EndAsUTC())
-        {
-          if (broadcastUid > 0 && tag->UniqueBroadcastID() == broadcastUid)
-          {
-            newBlockIndex = block + eventOffset;
-            return; // done.
-          }
-          break; // next block
-        }
-        progIdx++;
+        newBlockIndex = gridItem.startBlock + eventOffset;
+        return; // done.
       }
-      gridCursor += blockDuration;
     }
   }
 }
@@ -357,39 +327,13 @@ void CGUIEPGGridContainerModel::FreeProgrammeMemory(int channel, int keepStart,
 {
   if (keepStart < keepEnd)
   {
-    // remove before keepStart and after keepEnd
-    if (keepStart > 0 && keepStart < m_blocks)
+    // remove items ending before keepStart and starting after keepEnd.
+    // only grids already created can hold items using memory
+    for (const auto &gridItem : m_gridIndex[channel])
     {
-      // if item exist and block is not part of visible item
-      CGUIListItemPtr last(m_gridIndex[channel][keepStart].item);
-      for (int i = keepStart - 1; i > 0; --i)
-      {
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
-    }
-
-    if (keepEnd > 0 && keepEnd < m_blocks)
-    {
-      CGUIListItemPtr last(m_gridIndex[channel][keepEnd].item);
-      for (int i = keepEnd + 1; i < m_blocks; ++i)
-      {
-        // if item exist and block is not part of visible item
-        if (m_gridIndex[channel][i].item && m_gridIndex[channel][i].item != last)
-        {
-          m_gridIndex[channel][i].item->FreeMemory();
-          // FreeMemory() is smart enough to not cause any problems when called multiple times on same item
-          // but we can make use of condition needed to not call FreeMemory() on item that is partially visible
-          // to avoid calling FreeMemory() multiple times on item that occupy few blocks in a row
-          last = m_gridIndex[channel][i].item;
-        }
-      }
+      if ((keepStart > 0 && gridItem.endBlock < keepStart) ||
+          (keepEnd > 0 && gridItem.startBlock > keepEnd))
+        gridItem.item->FreeMemory();
     }
   }
 }
@@ -31,16 +31,22 @@ typedef std::shared_ptr<CFileItem> CFileItemPtr;
 
 class CFileItemList;
 
+class CGUIListItem;
+typedef std::shared_ptr<CGUIListItem> CGUIListItemPtr;
+
 namespace PVR
 {
+  //! A programme (or a gap between programmes) covering the blocks startBlock..endBlock of a channel
   struct GridItem
   {
     CFileItemPtr item;
     float originWidth;
     float width;
     int progIndex;
+    int startBlock;
+    int endBlock;
 
-    GridItem() : originWidth(0.0f), width(0.0f), progIndex(-1) {}
+    GridItem() : originWidth(0.0f), width(0.0f), progIndex(-1), startBlock(0), endBlock(0) {}
   };
 
   class CGUIEPGGridContainerModel
@@ -49,7 +55,7 @@ namespace PVR
     static const int MINSPERBLOCK = 5; // minutes
     static const int MAXBLOCKS = 33 * 24 * 60 / MINSPERBLOCK; //! 33 days of 5 minute blocks (31 days for upcoming data + 1 day for past data + 1 day for fillers)
 
-    CGUIEPGGridContainerModel() : m_blocks(0) {}
+    CGUIEPGGridContainerModel() : m_blocks(0), m_fBlockSize(0.0f) {}
     virtual ~CGUIEPGGridContainerModel() { Reset(); }
 
     void Refresh(const std::unique_ptr<CFileItemList> &items, const CDateTime &gridStart, const CDateTime &gridEnd, int iRulerUnit, int iBlocksPerPage, float fBlockSize);
@@ -75,12 +81,13 @@ namespace PVR
 
     int GetBlockCount() const { return m_blocks; }
     bool HasGridItems() const { return !m_gridIndex.empty(); }
-    GridItem *GetGridItemPtr(int iChannel, int iBlock) { return &m_gridIndex[iChannel][iBlock]; }
-    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].item; }
-    float GetGridItemWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].width; }
-    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].originWidth; }
-    int GetGridItemIndex(int iChannel, int iBlock) const { return m_gridIndex[iChannel][iBlock].progIndex; }
-    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { m_gridIndex[iChannel][iBlock].width = fWidth; }
+    GridItem *GetGridItemPtr(int iChannel, int iBlock) { return &FindGridItem(iChannel, iBlock); }
+    CFileItemPtr GetGridItem(int iChannel, int iBlock) const { return FindGridItem(iChannel, iBlock).item; }
+    float GetGridItemWidth(int iChannel, int iBlock) const { return FindGridItem(iChannel, iBlock).width; }
+    float GetGridItemOriginWidth(int iChannel, int iBlock) const { return FindGridItem(iChannel, iBlock).originWidth; }
+    int GetGridItemIndex(int iChannel, int iBlock) const { return FindGridItem(iChannel, iBlock).progIndex; }
+    void SetGridItemWidth(int iChannel, int iBlock, float fWidth) { FindGridItem(iChannel, iBlock).width = fWidth; }
+    int GetGridItemStartBlock(int iChannel, const CGUIListItemPtr &item) const;
 
     bool IsZeroGridDuration() const { return (m_gridEnd - m_gridStart) == CDateTimeSpan(0, 0, 0, 0); }
     const CDateTime &GetGridStart() const { return m_gridStart; }
@@ -99,6 +106,11 @@ namespace PVR
     void FreeItemsMemory();
     void Reset();
 
+    GridItem &FindGridItem(int iChannel, int iBlock) const;
+    std::vector<GridItem> &GetChannelGrid(int iChannel) const;
+    void CreateChannelGrid(int iChannel, std::vector<GridItem> &grid) const;
+    int GetBlockCeil(const CDateTime &datetime) const;
+
     struct ItemsPtr
     {
       long start;
@@ -112,8 +124,9 @@ namespace PVR
     std::vector<CFileItemPtr> m_channelItems;
     std::vector<CFileItemPtr> m_rulerItems;
     std::vector<ItemsPtr> m_epgItemsPtr;
-    std::vector<std::vector<GridItem> > m_gridIndex;
+    mutable std::vector<std::vector<GridItem> > m_gridIndex; //! per channel, sorted by block, created on first access
 
     int m_blocks;
+    float m_fBlockSize;
   };
 }
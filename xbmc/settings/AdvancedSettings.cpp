@@ -36,6 +36,7 @@
 #include "settings/lib/Setting.h"
 #include "settings/Settings.h"
 #include "settings/SettingUtils.h"
+#include "utils/JobManager.h"
 #include "utils/LangCodeExpander.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
@@ -81,6 +82,8 @@ void CAdvancedSettings::OnSettingsLoaded()
   }
   CLog::SetLogLevel(m_logLevel);
 
+  CJobManager::GetInstance().SetWorkStealing(m_jobStealingWorkers);
+
   m_extraLogEnabled = CServiceBroker::GetSettings().GetBool(CSettings::SETTING_DEBUG_EXTRALOGGING);
   setExtraLogLevel(CServiceBroker::GetSettings().GetList(CSettings::SETTING_DEBUG_SETEXTRALOGLEVEL));
 }
@@ -284,6 +287,8 @@ void CAdvancedSettings::Initialize()
   m_musicArtistSeparators = { ";", " feat. ", " ft. " };
   m_videoItemSeparator = " / ";
   m_iMusicLibraryDateAdded = 1; // prefer mtime over ctime and current time
+  m_musicScannerThreads = 8;
+  m_musicScannerHostThreads = 4;
 
   m_bVideoLibraryAllItemsOnBottom = false;
   m_iVideoLibraryRecentlyAddedItems = 25;
@@ -293,6 +298,8 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
   m_bVideoScannerIgnoreErrors = false;
+  m_videoScannerThreads = 4;
+  m_videoScannerBatchSize = 50;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
   m_iEpgUpdateCheckInterval = 300; /* check if tables need to be updated every 5 minutes */
@@ -300,6 +307,7 @@ void CAdvancedSettings::Initialize()
   m_iEpgActiveTagCheckInterval = 60; /* check for updated active tags every minute */
   m_iEpgRetryInterruptedUpdateInterval = 30; /* retry an interrupted epg update after 30 seconds */
   m_iEpgUpdateEmptyTagsInterval = 60; /* override user selectable EPG update interval for empty EPG tags */
+  m_iEpgLoadWindowHours = 24; /* load the EPG entries within 24 hours of now at startup, the rest on demand. 0 loads all */
   m_bEpgDisplayUpdatePopup = true; /* display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* also display a progress popup while doing incremental EPG updates */
 
@@ -361,12 +369,18 @@ void CAdvancedSettings::Initialize()
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_cacheReadFactor = 4.0f;
+  // number of connections internet streams with a known size may be fetched over
+  m_cacheRangeConnections = 4;
 
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverBlockSize = 256 * 1024;
+
+  m_jobStealingWorkers = 0;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
@@ -748,6 +762,13 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     }
   }
 
+  pElement = pRootElement->FirstChildElement("musicscanner");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "threads", m_musicScannerThreads, 1, 32);
+    XMLUtils::GetUInt(pElement, "hostthreads", m_musicScannerHostThreads, 1, 32);
+  }
+
   pElement = pRootElement->FirstChildElement("videolibrary");
   if (pElement)
   {
@@ -766,6 +787,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   if (pElement)
   {
     XMLUtils::GetBoolean(pElement, "ignoreerrors", m_bVideoScannerIgnoreErrors);
+    XMLUtils::GetUInt(pElement, "threads", m_videoScannerThreads, 1, 16);
+    XMLUtils::GetUInt(pElement, "batchsize", m_videoScannerBatchSize, 1, 1000);
   }
 
   // Backward-compatibility of ExternalPlayer config
@@ -797,6 +820,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "memorysize", m_cacheMemSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_cacheBufferMode, 0, 4);
     XMLUtils::GetFloat(pElement, "readfactor", m_cacheReadFactor);
+    XMLUtils::GetUInt(pElement, "rangeconnections", m_cacheRangeConnections, 1, 16);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -806,6 +830,14 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "blocksize", m_webserverBlockSize, 2048, 16 * 1024 * 1024);
+
+  pElement = pRootElement->FirstChildElement("jobmanager");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "workstealingworkers", m_jobStealingWorkers, 0, CJobManager::MAX_STEALING_WORKERS);
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -877,6 +909,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "activetagcheckinterval", m_iEpgActiveTagCheckInterval);
     XMLUtils::GetInt(pElement, "retryinterruptedupdateinterval", m_iEpgRetryInterruptedUpdateInterval);
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
+    XMLUtils::GetInt(pElement, "loadwindowhours", m_iEpgLoadWindowHours, 0, 24 * 365);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
   }
@@ -263,6 +263,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     std::string m_videoItemSeparator;
     std::vector<std::string> m_musicTagsFromFileFilters;
     bool m_musicUseArtistSortName;
+    unsigned int m_musicScannerThreads;     //!< tags read in parallel
+    unsigned int m_musicScannerHostThreads; //!< tags read in parallel from the same network host
 
     bool m_bVideoLibraryAllItemsOnBottom;
     int m_iVideoLibraryRecentlyAddedItems;
@@ -273,6 +275,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_bVideoLibraryImportResumePoint;
 
     bool m_bVideoScannerIgnoreErrors;
+    unsigned int m_videoScannerThreads;   //!< episodes looked up in parallel
+    unsigned int m_videoScannerBatchSize; //!< episodes written per database transaction
     int m_iVideoLibraryDateAdded;
 
     std::set<std::string> m_vecTokens;
@@ -282,6 +286,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgActiveTagCheckInterval; // seconds
     int m_iEpgRetryInterruptedUpdateInterval; // seconds
     int m_iEpgUpdateEmptyTagsInterval; // seconds
+    int m_iEpgLoadWindowHours; // hours
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
 
@@ -346,10 +351,15 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_cacheMemSize;
     unsigned int m_cacheBufferMode;
     float m_cacheReadFactor;
+    unsigned int m_cacheRangeConnections;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    unsigned int m_webserverBlockSize;
+
+    unsigned int m_jobStealingWorkers;
+
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
     void ParseSettingsFile(const std::string &file);
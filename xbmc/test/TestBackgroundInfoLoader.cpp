@@ -0,0 +1,119 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "BackgroundInfoLoader.h"
+#include "FileItem.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+  /* records the pages handed to PrefetchItems() and the items loaded from the cache */
+  class CRecordingLoader : public CBackgroundInfoLoader
+  {
+  public:
+    explicit CRecordingLoader(int count) : m_failItem(-1), m_stopItem(-1)
+    {
+      for (int i = 0; i < count; i++)
+        m_vecItems.push_back(CFileItemPtr(new CFileItem(StringUtils::Format("item%i", i), false)));
+      m_bStop = false;
+    }
+
+    bool LoadItemCached(CFileItem* pItem) override
+    {
+      int item = static_cast<int>(m_loaded.size());
+      m_loaded.push_back(pItem->GetPath());
+      if (item == m_stopItem)
+        StopAsync();
+      if (item == m_failItem)
+        throw std::runtime_error("failing item");
+      return false;
+    }
+
+    std::vector<std::vector<std::string> > m_pages;
+    std::vector<size_t> m_loadedBeforePage; ///< number of items loaded when each page was prefetched
+    std::vector<std::string> m_loaded;
+    int m_failItem;
+    int m_stopItem;
+
+  protected:
+    void PrefetchItems(const std::vector<CFileItemPtr>& items) override
+    {
+      std::vector<std::string> page;
+      for (const auto &item : items)
+        page.push_back(item->GetPath());
+      m_pages.push_back(page);
+      m_loadedBeforePage.push_back(m_loaded.size());
+    }
+  };
+}
+
+TEST(TestBackgroundInfoLoader, Pages)
+{
+  CRecordingLoader loader(120);
+  loader.Run();
+
+  // every page is prefetched before its first item is loaded
+  ASSERT_EQ(3u, loader.m_pages.size());
+  EXPECT_EQ(std::vector<size_t>({ 0, 50, 100 }), loader.m_loadedBeforePage);
+  EXPECT_EQ(50u, loader.m_pages[0].size());
+  EXPECT_EQ(50u, loader.m_pages[1].size());
+  EXPECT_EQ(20u, loader.m_pages[2].size());
+  EXPECT_EQ("item0", loader.m_pages[0].front());
+  EXPECT_EQ("item50", loader.m_pages[1].front());
+  EXPECT_EQ("item119", loader.m_pages[2].back());
+  EXPECT_EQ(120u, loader.m_loaded.size());
+  EXPECT_FALSE(loader.IsLoading());
+}
+
+TEST(TestBackgroundInfoLoader, NoItems)
+{
+  CRecordingLoader loader(0);
+  loader.Run();
+  EXPECT_TRUE(loader.m_pages.empty());
+}
+
+TEST(TestBackgroundInfoLoader, FailingItem)
+{
+  // an item throwing neither skips the rest of its page nor the pages after it
+  CRecordingLoader loader(60);
+  loader.m_failItem = 10;
+  loader.Run();
+
+  EXPECT_EQ(2u, loader.m_pages.size());
+  EXPECT_EQ(60u, loader.m_loaded.size());
+  EXPECT_FALSE(loader.IsLoading());
+}
+
+TEST(TestBackgroundInfoLoader, Stopped)
+{
+  // pages after the stop are not prefetched
+  CRecordingLoader loader(120);
+  loader.m_stopItem = 60;
+  loader.Run();
+
+  EXPECT_EQ(2u, loader.m_pages.size());
+  EXPECT_EQ(61u, loader.m_loaded.size());
+}
@@ -0,0 +1,46 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestDatabase.h"
+
+#include <cstdio>
+
+#include "dbwrappers/Database.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+
+CTestDatabase::CTestDatabase(CDatabase &db, const std::string &name)
+  : m_db(db)
+{
+  const std::string path = CSpecialProtocol::TranslatePath("special://temp/");
+  m_file = path + name + ".db";
+  std::remove(m_file.c_str());
+
+  DatabaseSettings settings;
+  settings.type = "sqlite3";
+  settings.host = path;
+  m_connected = m_db.Connect(name, settings, true);
+}
+
+CTestDatabase::~CTestDatabase()
+{
+  m_db.Close();
+  std::remove(m_file.c_str());
+}
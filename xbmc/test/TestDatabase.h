@@ -0,0 +1,47 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+
+class CDatabase;
+
+/* Connects a database to a new sqlite file in the temp directory, which is
+ * closed and deleted again when this object goes away. Declare it after the
+ * database it connects, so it is destroyed first.
+ */
+class CTestDatabase
+{
+public:
+  /* 'name' is the name of the database file, without the .db extension. */
+  CTestDatabase(CDatabase &db, const std::string &name);
+  ~CTestDatabase();
+
+  /* Whether the database could be connected. */
+  bool IsConnected() const { return m_connected; }
+
+private:
+  CTestDatabase(const CTestDatabase&) = delete;
+  CTestDatabase& operator=(const CTestDatabase&) = delete;
+
+  CDatabase &m_db;
+  std::string m_file;
+  bool m_connected;
+};
@@ -80,30 +80,146 @@ bool Message::Reply(int sig, void *data /* = NULL*/, int size /* = 0 */)
   return true;
 }
 
-Protocol::~Protocol()
+MessageRing::MessageRing()
 {
-  Message *msg;
-  Purge();
-  while (!freeMessageQueue.empty())
+  for (size_t i = 0; i < MSG_RING_SIZE; i++)
   {
-    msg = freeMessageQueue.front();
-    freeMessageQueue.pop();
-    delete msg;
+    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    m_cells[i].msg = NULL;
   }
+  m_writePos.store(0, std::memory_order_relaxed);
+  m_readPos.store(0, std::memory_order_relaxed);
 }
 
-Message *Protocol::GetMessage()
+bool MessageRing::Push(Message *msg)
+{
+  Cell *cell;
+  size_t pos = m_writePos.load(std::memory_order_relaxed);
+  while (true)
+  {
+    cell = &m_cells[pos % MSG_RING_SIZE];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0)
+    {
+      if (m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // full
+    else
+      pos = m_writePos.load(std::memory_order_relaxed);
+  }
+  cell->msg = msg;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool MessageRing::Pop(Message **msg)
+{
+  Cell *cell;
+  size_t pos = m_readPos.load(std::memory_order_relaxed);
+  while (true)
+  {
+    cell = &m_cells[pos % MSG_RING_SIZE];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (diff == 0)
+    {
+      if (m_readPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // empty
+    else
+      pos = m_readPos.load(std::memory_order_relaxed);
+  }
+  *msg = cell->msg;
+  cell->sequence.store(pos + MSG_RING_SIZE, std::memory_order_release);
+  return true;
+}
+
+void MessageQueue::Push(Message *msg)
+{
+  // once the ring has overflowed, keep queueing behind the overflowed
+  // messages until the reader caught up to preserve the order
+  if (m_overflowCount == 0 && m_ring.Push(msg))
+    return;
+
+  CSingleLock lock(m_section);
+  m_overflow.push_back(msg);
+  m_overflowCount++;
+}
+
+bool MessageQueue::Pop(Message **msg)
+{
+  if (m_pendingCount > 0)
+  {
+    CSingleLock lock(m_section);
+    if (!m_pending.empty())
+    {
+      *msg = m_pending.front();
+      m_pending.pop_front();
+      m_pendingCount--;
+      return true;
+    }
+  }
+
+  if (m_ring.Pop(msg))
+    return true;
+
+  if (m_overflowCount > 0)
+  {
+    CSingleLock lock(m_section);
+    if (!m_overflow.empty())
+    {
+      *msg = m_overflow.front();
+      m_overflow.pop_front();
+      m_overflowCount--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void MessageQueue::Purge(int signal)
 {
   Message *msg;
 
-  CSingleLock lock(criticalSection);
+  CSingleLock lock(m_section);
+
+  // move everything queued so far out of the ring, new messages will
+  // only be read after the pending ones
+  while (m_ring.Pop(&msg))
+    m_pending.push_back(msg);
+  m_pending.insert(m_pending.end(), m_overflow.begin(), m_overflow.end());
+  m_overflow.clear();
+  m_overflowCount = 0;
 
-  if (!freeMessageQueue.empty())
+  std::deque<Message*> msgs;
+  for (auto it : m_pending)
   {
-    msg = freeMessageQueue.front();
-    freeMessageQueue.pop();
+    if (it->signal != signal)
+      msgs.push_back(it);
   }
-  else
+  m_pending.swap(msgs);
+  m_pendingCount = m_pending.size();
+}
+
+Protocol::~Protocol()
+{
+  Message *msg;
+  Purge();
+  while (freeMessageQueue.Pop(&msg))
+    delete msg;
+}
+
+Message *Protocol::GetMessage()
+{
+  Message *msg;
+
+  if (!freeMessageQueue.Pop(&msg))
     msg = new Message();
 
   msg->isSync = false;
@@ -120,9 +236,8 @@ Message *Protocol::GetMessage()
 
 void Protocol::ReturnMessage(Message *msg)
 {
-  CSingleLock lock(criticalSection);
-
-  freeMessageQueue.push(msg);
+  if (!freeMessageQueue.Push(msg))
+    delete msg;
 }
 
 bool Protocol::SendOutMessage(int signal, void *data /* = NULL */, int size /* = 0 */, Message *outMsg /* = NULL */)
@@ -145,9 +260,7 @@ bool Protocol::SendOutMessage(int signal, void *data /* = NULL */, int size /* =
     memcpy(msg->data, data, size);
   }
 
-  { CSingleLock lock(criticalSection);
-    outMessages.push(msg);
-  }
+  outMessages.Push(msg);
   if (containerOutEvent)
     containerOutEvent->Set();
 
@@ -174,9 +287,7 @@ bool Protocol::SendInMessage(int signal, void *data /* = NULL */, int size /* =
     memcpy(msg->data, data, size);
   }
 
-  { CSingleLock lock(criticalSection);
-    inMessages.push(msg);
-  }
+  inMessages.Push(msg);
   if (containerInEvent)
     containerInEvent->Set();
 
@@ -218,28 +329,18 @@ bool Protocol::SendOutMessageSync(int signal, Message **retMsg, int timeout, voi
 
 bool Protocol::ReceiveOutMessage(Message **msg)
 {
-  CSingleLock lock(criticalSection);
-
-  if (outMessages.empty() || outDefered)
+  if (outDefered)
     return false;
 
-  *msg = outMessages.front();
-  outMessages.pop();
-
-  return true;
+  return outMessages.Pop(msg);
 }
 
 bool Protocol::ReceiveInMessage(Message **msg)
 {
-  CSingleLock lock(criticalSection);
-
-  if (inMessages.empty() || inDefered)
+  if (inDefered)
     return false;
 
-  *msg = inMessages.front();
-  inMessages.pop();
-
-  return true;
+  return inMessages.Pop(msg);
 }
 
 
@@ -256,44 +357,10 @@ void Protocol::Purge()
 
 void Protocol::PurgeIn(int signal)
 {
-  Message *msg;
-  std::queue<Message*> msgs;
-
-  CSingleLock lock(criticalSection);
-
-  while (!inMessages.empty())
-  {
-    msg = inMessages.front();
-    inMessages.pop();
-    if (msg->signal != signal)
-      msgs.push(msg);
-  }
-  while (!msgs.empty())
-  {
-    msg = msgs.front();
-    msgs.pop();
-    inMessages.push(msg);
-  }
+  inMessages.Purge(signal);
 }
 
 void Protocol::PurgeOut(int signal)
 {
-  Message *msg;
-  std::queue<Message*> msgs;
-
-  CSingleLock lock(criticalSection);
-
-  while (!outMessages.empty())
-  {
-    msg = outMessages.front();
-    outMessages.pop();
-    if (msg->signal != signal)
-      msgs.push(msg);
-  }
-  while (!msgs.empty())
-  {
-    msg = msgs.front();
-    msgs.pop();
-    outMessages.push(msg);
-  }
+  outMessages.Purge(signal);
 }
@@ -21,10 +21,13 @@
 #pragma once
 
 #include "threads/Thread.h"
+#include <atomic>
+#include <deque>
 #include <queue>
 #include "memory.h"
 
 #define MSG_INTERNAL_BUFFER_SIZE 32
+#define MSG_RING_SIZE 128
 
 namespace Actor
 {
@@ -54,6 +57,47 @@ private:
   Message() {isSync = false; data = NULL; event = NULL; replyMessage = NULL;};
 };
 
+/*!
+ * Bounded lock-free queue of messages, safe for multiple producers and consumers.
+ * Each cell carries a sequence number telling whether it is ready to be written
+ * or read for the current lap, which avoids ABA problems when used as free-list.
+ */
+class MessageRing
+{
+public:
+  MessageRing();
+  bool Push(Message *msg);
+  bool Pop(Message **msg);
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    Message *msg;
+  };
+  Cell m_cells[MSG_RING_SIZE];
+  std::atomic<size_t> m_writePos;
+  std::atomic<size_t> m_readPos;
+};
+
+/*!
+ * FIFO of messages. Messages are passed through a lock-free ring, the critical
+ * section is only taken if the ring overflows or messages were purged.
+ */
+class MessageQueue
+{
+public:
+  void Push(Message *msg);
+  bool Pop(Message **msg);
+  void Purge(int signal);
+private:
+  MessageRing m_ring;
+  std::deque<Message*> m_pending; // older than anything in the ring
+  std::deque<Message*> m_overflow; // newer than anything in the ring
+  std::atomic<int> m_pendingCount{0};
+  std::atomic<int> m_overflowCount{0};
+  CCriticalSection m_section;
+};
+
 class Protocol
 {
 public:
@@ -81,9 +125,9 @@ public:
 protected:
   CEvent *containerInEvent, *containerOutEvent;
   CCriticalSection criticalSection;
-  std::queue<Message*> outMessages;
-  std::queue<Message*> inMessages;
-  std::queue<Message*> freeMessageQueue;
+  MessageQueue outMessages;
+  MessageQueue inMessages;
+  MessageRing freeMessageQueue;
   bool inDefered, outDefered;
 };
 
@@ -21,6 +21,14 @@
 #include "CharsetConverter.h"
 
 #include <algorithm>
+#include <atomic>
+#include <map>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAS_SSE2_ASCII_PATH 1
+#endif
 
 #ifndef TARGET_FREEBSD
 #include <iconv.h>
@@ -99,7 +107,16 @@ enum SpecialCharset
   AsciiCharset
 };
 
-class CConverterType : public CCriticalSection
+/* iconv handles are not shareable between threads, so every thread opens its own
+   handle for each converter type. The handles are reopened when the converter
+   generation changes and are closed when the thread exits. */
+struct CThreadConverterHandle
+{
+  iconv_t      iconv = NO_ICONV;
+  unsigned int generation = 0;
+};
+
+class CConverterType
 {
 public:
   CConverterType(const std::string&  sourceCharset,        const std::string&  targetCharset,        unsigned int targetSingleCharMaxLen = 1);
@@ -107,140 +124,128 @@ public:
   CConverterType(const std::string&  sourceCharset,        enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen = 1);
   CConverterType(enum SpecialCharset sourceSpecialCharset, enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen = 1);
   CConverterType(const CConverterType& other);
-  ~CConverterType();
 
-  iconv_t GetConverter(CSingleLock& converterLock);
+  iconv_t GetConverter(CThreadConverterHandle& handle);
 
   void Reset(void);
   void ReinitTo(const std::string& sourceCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen = 1);
-  std::string GetSourceCharset(void) const  { return m_sourceCharset; }
-  std::string GetTargetCharset(void) const  { return m_targetCharset; }
+  std::string GetSourceCharset(void) const  { CSingleLock lock(m_critSection); return m_sourceCharset; }
+  std::string GetTargetCharset(void) const  { CSingleLock lock(m_critSection); return m_targetCharset; }
   unsigned int GetTargetSingleCharMaxLen(void) const  { return m_targetSingleCharMaxLen; }
 
 private:
   static std::string ResolveSpecialCharset(enum SpecialCharset charset);
 
+  mutable CCriticalSection m_critSection; // protects the charset names, not the conversion itself
   enum SpecialCharset m_sourceSpecialCharset;
   std::string         m_sourceCharset;
   enum SpecialCharset m_targetSpecialCharset;
   std::string         m_targetCharset;
-  iconv_t             m_iconv;
-  unsigned int        m_targetSingleCharMaxLen;
+  std::atomic<unsigned int> m_generation;
+  std::atomic<unsigned int> m_targetSingleCharMaxLen;
 };
 
-CConverterType::CConverterType(const std::string& sourceCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen /*= 1*/) : CCriticalSection(),
+CConverterType::CConverterType(const std::string& sourceCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen /*= 1*/) :
   m_sourceSpecialCharset(NotSpecialCharset),
   m_sourceCharset(sourceCharset),
   m_targetSpecialCharset(NotSpecialCharset),
   m_targetCharset(targetCharset),
-  m_iconv(NO_ICONV),
+  m_generation(1),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
 
-CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen /*= 1*/) : CCriticalSection(),
+CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen /*= 1*/) :
   m_sourceSpecialCharset(sourceSpecialCharset),
   m_sourceCharset(),
   m_targetSpecialCharset(NotSpecialCharset),
   m_targetCharset(targetCharset),
-  m_iconv(NO_ICONV),
+  m_generation(1),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
 
-CConverterType::CConverterType(const std::string& sourceCharset, enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen /*= 1*/) : CCriticalSection(),
+CConverterType::CConverterType(const std::string& sourceCharset, enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen /*= 1*/) :
   m_sourceSpecialCharset(NotSpecialCharset),
   m_sourceCharset(sourceCharset),
   m_targetSpecialCharset(targetSpecialCharset),
   m_targetCharset(),
-  m_iconv(NO_ICONV),
+  m_generation(1),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
 
-CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen /*= 1*/) : CCriticalSection(),
+CConverterType::CConverterType(enum SpecialCharset sourceSpecialCharset, enum SpecialCharset targetSpecialCharset, unsigned int targetSingleCharMaxLen /*= 1*/) :
   m_sourceSpecialCharset(sourceSpecialCharset),
   m_sourceCharset(),
   m_targetSpecialCharset(targetSpecialCharset),
   m_targetCharset(),
-  m_iconv(NO_ICONV),
+  m_generation(1),
   m_targetSingleCharMaxLen(targetSingleCharMaxLen)
 {
 }
 
-CConverterType::CConverterType(const CConverterType& other) : CCriticalSection(),
+CConverterType::CConverterType(const CConverterType& other) :
   m_sourceSpecialCharset(other.m_sourceSpecialCharset),
   m_sourceCharset(other.m_sourceCharset),
   m_targetSpecialCharset(other.m_targetSpecialCharset),
   m_targetCharset(other.m_targetCharset),
-  m_iconv(NO_ICONV),
-  m_targetSingleCharMaxLen(other.m_targetSingleCharMaxLen)
+  m_generation(1),
+  m_targetSingleCharMaxLen(other.m_targetSingleCharMaxLen.load())
 {
 }
 
-CConverterType::~CConverterType()
+iconv_t CConverterType::GetConverter(CThreadConverterHandle& handle)
 {
-  CSingleLock lock(*this);
-  if (m_iconv != NO_ICONV)
-    iconv_close(m_iconv);
-  lock.Leave(); // ensure unlocking before final destruction
-}
+  const unsigned int generation = m_generation.load(std::memory_order_acquire);
+  if (handle.iconv != NO_ICONV && handle.generation == generation)
+    return handle.iconv;
 
-iconv_t CConverterType::GetConverter(CSingleLock& converterLock)
-{
-  // ensure that this unique instance is locked externally
-  if (&converterLock.get_underlying() != this)
-    return NO_ICONV;
-
-  if (m_iconv == NO_ICONV)
+  if (handle.iconv != NO_ICONV)
   {
-    if (m_sourceSpecialCharset)
-      m_sourceCharset = ResolveSpecialCharset(m_sourceSpecialCharset);
-    if (m_targetSpecialCharset)
-      m_targetCharset = ResolveSpecialCharset(m_targetSpecialCharset);
-
-    m_iconv = iconv_open(m_targetCharset.c_str(), m_sourceCharset.c_str());
-    
-    if (m_iconv == NO_ICONV)
-      CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
-                __FUNCTION__, m_sourceCharset.c_str(), m_targetCharset.c_str(), errno, strerror(errno));
+    iconv_close(handle.iconv);
+    handle.iconv = NO_ICONV;
   }
 
-  return m_iconv;
+  CSingleLock lock(m_critSection);
+  if (m_sourceSpecialCharset)
+    m_sourceCharset = ResolveSpecialCharset(m_sourceSpecialCharset);
+  if (m_targetSpecialCharset)
+    m_targetCharset = ResolveSpecialCharset(m_targetSpecialCharset);
+
+  handle.iconv = iconv_open(m_targetCharset.c_str(), m_sourceCharset.c_str());
+  handle.generation = generation;
+
+  if (handle.iconv == NO_ICONV)
+    CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
+              __FUNCTION__, m_sourceCharset.c_str(), m_targetCharset.c_str(), errno, strerror(errno));
+
+  return handle.iconv;
 }
 
 void CConverterType::Reset(void)
 {
-  CSingleLock lock(*this);
-  if (m_iconv != NO_ICONV)
-  {
-    iconv_close(m_iconv);
-    m_iconv = NO_ICONV;
-  }
-
+  CSingleLock lock(m_critSection);
   if (m_sourceSpecialCharset)
     m_sourceCharset.clear();
   if (m_targetSpecialCharset)
     m_targetCharset.clear();
 
+  // threads drop their handles on next use
+  m_generation.fetch_add(1, std::memory_order_release);
 }
 
 void CConverterType::ReinitTo(const std::string& sourceCharset, const std::string& targetCharset, unsigned int targetSingleCharMaxLen /*= 1*/)
 {
-  CSingleLock lock(*this);
+  CSingleLock lock(m_critSection);
   if (sourceCharset != m_sourceCharset || targetCharset != m_targetCharset)
   {
-    if (m_iconv != NO_ICONV)
-    {
-      iconv_close(m_iconv);
-      m_iconv = NO_ICONV;
-    }
-
     m_sourceSpecialCharset = NotSpecialCharset;
     m_sourceCharset = sourceCharset;
     m_targetSpecialCharset = NotSpecialCharset;
     m_targetCharset = targetCharset;
     m_targetSingleCharMaxLen = targetSingleCharMaxLen;
+    m_generation.fetch_add(1, std::memory_order_release);
   }
 }
 
@@ -286,6 +291,340 @@ enum StdConversionType /* Keep it in sync with CCharsetConverter::CInnerConverte
   NumberOfStdConversionTypes /* Dummy sentinel entry */
 };
 
+/* Per thread iconv handles, indexed by StdConversionType, plus the most recently
+   used custom conversions keyed by target and source charset */
+struct CThreadConverters
+{
+  static const size_t MAX_CUSTOM_CONVERTERS = 8;
+
+  CThreadConverterHandle handles[NumberOfStdConversionTypes];
+  std::map<std::pair<std::string, std::string>, iconv_t> custom;
+
+  ~CThreadConverters()
+  {
+    for (CThreadConverterHandle& handle : handles)
+    {
+      if (handle.iconv != NO_ICONV)
+        iconv_close(handle.iconv);
+    }
+    ClearCustom();
+  }
+
+  void ClearCustom()
+  {
+    for (auto& it : custom)
+      iconv_close(it.second);
+    custom.clear();
+  }
+};
+
+static thread_local CThreadConverters t_threadConverters;
+
+/* Native conversions between the Unicode encodings, used instead of iconv for the
+   standard conversions that don't involve a legacy charset. The encoding is selected
+   by the code unit size of the string type: 1 is UTF-8, 2 is UTF-16 and 4 is UTF-32.
+   Invalid sequences either fail the conversion or are skipped, like with iconv. */
+namespace
+{
+const char32_t INVALID_CODEPOINT = 0xFFFFFFFF;
+
+template<class STRING>
+inline uint32_t ReadUnit(const STRING& str, size_t pos, bool swap)
+{
+  uint32_t unit = static_cast<uint32_t>(str[pos]);
+  if (sizeof(typename STRING::value_type) == 1)
+    return unit & 0xFF;
+  if (sizeof(typename STRING::value_type) == 2)
+  {
+    unit &= 0xFFFF;
+    return swap ? (((unit & 0xFF) << 8) | (unit >> 8)) : unit;
+  }
+  return unit;
+}
+
+/* Decode the character starting at pos and advance pos behind it. An invalid
+   sequence advances pos by one code unit and returns INVALID_CODEPOINT. */
+template<class INPUT>
+inline char32_t DecodeChar(const INPUT& src, size_t& pos, bool swap)
+{
+  const size_t avail = src.length() - pos;
+  const uint32_t c = ReadUnit(src, pos, swap);
+
+  if (sizeof(typename INPUT::value_type) == 1)
+  {
+    if (c < 0x80)
+    {
+      pos++;
+      return c;
+    }
+
+    // see CUtf8Utils::SizeOfUtf8Char for the table of valid sequences
+    size_t len = 0;
+    char32_t cp = 0;
+    char32_t minCp = 0;
+    if (c >= 0xC2 && c <= 0xDF)
+    {
+      len = 2;
+      cp = c & 0x1F;
+      minCp = 0x80;
+    }
+    else if (c >= 0xE0 && c <= 0xEF)
+    {
+      len = 3;
+      cp = c & 0x0F;
+      minCp = 0x800;
+    }
+    else if (c >= 0xF0 && c <= 0xF4)
+    {
+      len = 4;
+      cp = c & 0x07;
+      minCp = 0x10000;
+    }
+
+    if (len == 0 || avail < len)
+    {
+      pos++;
+      return INVALID_CODEPOINT;
+    }
+
+    for (size_t i = 1; i < len; i++)
+    {
+      const uint32_t cont = ReadUnit(src, pos + i, false);
+      if ((cont & 0xC0) != 0x80)
+      {
+        pos++;
+        return INVALID_CODEPOINT;
+      }
+      cp = (cp << 6) | (cont & 0x3F);
+    }
+
+    if (cp < minCp || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+    {
+      pos++;
+      return INVALID_CODEPOINT;
+    }
+
+    pos += len;
+    return cp;
+  }
+
+  pos++;
+  if (sizeof(typename INPUT::value_type) == 2)
+  {
+    if (c < 0xD800 || c > 0xDFFF)
+      return c;
+    if (c <= 0xDBFF && avail >= 2)
+    {
+      const uint32_t low = ReadUnit(src, pos, swap);
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        pos++;
+        return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+      }
+    }
+    return INVALID_CODEPOINT;
+  }
+
+  if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+    return INVALID_CODEPOINT;
+  return c;
+}
+
+/* Encode a valid code point at out and return the number of code units written */
+template<class UNIT>
+inline size_t EncodeChar(char32_t cp, UNIT* out)
+{
+  if (sizeof(UNIT) == 1)
+  {
+    if (cp < 0x80)
+    {
+      out[0] = static_cast<UNIT>(cp);
+      return 1;
+    }
+    if (cp < 0x800)
+    {
+      out[0] = static_cast<UNIT>(0xC0 | (cp >> 6));
+      out[1] = static_cast<UNIT>(0x80 | (cp & 0x3F));
+      return 2;
+    }
+    if (cp < 0x10000)
+    {
+      out[0] = static_cast<UNIT>(0xE0 | (cp >> 12));
+      out[1] = static_cast<UNIT>(0x80 | ((cp >> 6) & 0x3F));
+      out[2] = static_cast<UNIT>(0x80 | (cp & 0x3F));
+      return 3;
+    }
+    out[0] = static_cast<UNIT>(0xF0 | (cp >> 18));
+    out[1] = static_cast<UNIT>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<UNIT>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<UNIT>(0x80 | (cp & 0x3F));
+    return 4;
+  }
+  if (sizeof(UNIT) == 2 && cp >= 0x10000)
+  {
+    cp -= 0x10000;
+    out[0] = static_cast<UNIT>(0xD800 + (cp >> 10));
+    out[1] = static_cast<UNIT>(0xDC00 + (cp & 0x3FF));
+    return 2;
+  }
+  out[0] = static_cast<UNIT>(cp);
+  return 1;
+}
+
+/* Copy a run of ASCII characters from src[pos] to out as long as whole blocks are
+   ASCII only. Returns the number of characters copied, each of them needs one
+   code unit on both sides. */
+template<class INPUT, class UNIT>
+inline size_t CopyAsciiRun(const INPUT& src, size_t pos, UNIT* out, bool swap)
+{
+  const size_t len = src.length();
+  size_t done = 0;
+
+#ifdef HAS_SSE2_ASCII_PATH
+  if (!swap && sizeof(typename INPUT::value_type) == 1)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    while (pos + done + 16 <= len)
+    {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + pos + done));
+      if (_mm_movemask_epi8(bytes) != 0)
+        break;
+
+      if (sizeof(UNIT) == 1)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done), bytes);
+      else
+      {
+        const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        if (sizeof(UNIT) == 2)
+        {
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done), lo);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done + 8), hi);
+        }
+        else
+        {
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done), _mm_unpacklo_epi16(lo, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done + 4), _mm_unpackhi_epi16(lo, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done + 8), _mm_unpacklo_epi16(hi, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+      }
+      done += 16;
+    }
+  }
+  else if (!swap && sizeof(typename INPUT::value_type) == 2 && sizeof(UNIT) == 1)
+  {
+    const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    while (pos + done + 16 <= len)
+    {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + pos + done));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + pos + done + 8));
+      const __m128i high = _mm_and_si128(_mm_or_si128(a, b), highBits);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+        break;
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done), _mm_packus_epi16(a, b));
+      done += 16;
+    }
+  }
+  else if (sizeof(typename INPUT::value_type) == 4 && sizeof(UNIT) == 1)
+  {
+    const __m128i highBits = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+    const __m128i zero = _mm_setzero_si128();
+    while (pos + done + 16 <= len)
+    {
+      const __m128i* block = reinterpret_cast<const __m128i*>(src.data() + pos + done);
+      const __m128i a = _mm_loadu_si128(block);
+      const __m128i b = _mm_loadu_si128(block + 1);
+      const __m128i c = _mm_loadu_si128(block + 2);
+      const __m128i d = _mm_loadu_si128(block + 3);
+      const __m128i high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), highBits);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF)
+        break;
+
+      // all values are below 0x80, so the signed saturation is lossless
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + done),
+                       _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+      done += 16;
+    }
+  }
+#endif
+
+  // portable path for the remaining characters, and for all of them without SSE2
+  if (sizeof(typename INPUT::value_type) == 1)
+  {
+    while (pos + done + 8 <= len)
+    {
+      uint64_t block;
+      memcpy(&block, src.data() + pos + done, sizeof(block));
+      if (block & 0x8080808080808080ULL)
+        break;
+
+      for (size_t i = 0; i < 8; i++)
+        out[done + i] = static_cast<UNIT>(ReadUnit(src, pos + done + i, false));
+      done += 8;
+    }
+  }
+
+  while (pos + done < len)
+  {
+    const uint32_t unit = ReadUnit(src, pos + done, swap);
+    if (unit >= 0x80)
+      break;
+    out[done++] = static_cast<UNIT>(unit);
+  }
+
+  return done;
+}
+
+template<class INPUT, class OUTPUT>
+bool UnicodeConvert(const INPUT& strSource, OUTPUT& strDest, bool swapSource, bool failOnInvalidChar)
+{
+  typedef typename OUTPUT::value_type UNIT;
+  const size_t inUnitSize = sizeof(typename INPUT::value_type);
+  const size_t len = strSource.length();
+
+  // worst case number of output code units for one input code unit
+  size_t expansion = 1;
+  if (sizeof(UNIT) == 1 && inUnitSize == 2)
+    expansion = 3;
+  else if (sizeof(UNIT) == 1 && inUnitSize == 4)
+    expansion = 4;
+  else if (sizeof(UNIT) == 2 && inUnitSize == 4)
+    expansion = 2;
+
+  strDest.resize(len * expansion);
+  UNIT* out = &strDest[0];
+  size_t written = 0;
+
+  size_t pos = 0;
+  while (pos < len)
+  {
+    const size_t ascii = CopyAsciiRun(strSource, pos, out + written, swapSource);
+    pos += ascii;
+    written += ascii;
+    if (pos >= len)
+      break;
+
+    const char32_t cp = DecodeChar(strSource, pos, swapSource);
+    if (cp == INVALID_CODEPOINT)
+    {
+      if (failOnInvalidChar)
+      {
+        strDest.clear();
+        return false;
+      }
+      continue;
+    }
+    written += EncodeChar(cp, out + written);
+  }
+
+  strDest.resize(written);
+  return true;
+}
+} // unnamed namespace
+
 /* We don't want to pollute header file with many additional includes and definitions, so put 
    here all staff that require usage of types defined in this file or in additional headers */
 class CCharsetConverter::CInnerConverter
@@ -301,6 +640,8 @@ public:
   template<class INPUT,class OUTPUT>
   static bool convert(iconv_t type, int multiplier, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar = false);
 
+  static bool isNativeConversion(StdConversionType convertType, bool& swapSource);
+
   static CConverterType m_stdConversion[NumberOfStdConversionTypes];
   static CCriticalSection m_critSectionFriBiDi;
 };
@@ -343,10 +684,45 @@ bool CCharsetConverter::CInnerConverter::stdConvert(StdConversionType convertTyp
   if (convertType < 0 || convertType >= NumberOfStdConversionTypes)
     return false;
 
+  bool swapSource;
+  if (isNativeConversion(convertType, swapSource))
+    return UnicodeConvert(strSource, strDest, swapSource, failOnInvalidChar);
+
   CConverterType& convType = m_stdConversion[convertType];
-  CSingleLock converterLock(convType);
+  return convert(convType.GetConverter(t_threadConverters.handles[convertType]), convType.GetTargetSingleCharMaxLen(), strSource, strDest, failOnInvalidChar);
+}
+
+bool CCharsetConverter::CInnerConverter::isNativeConversion(StdConversionType convertType, bool& swapSource)
+{
+#ifdef WORDS_BIGENDIAN
+  const bool bigEndianHost = true;
+#else
+  const bool bigEndianHost = false;
+#endif
 
-  return convert(convType.GetConverter(converterLock), convType.GetTargetSingleCharMaxLen(), strSource, strDest, failOnInvalidChar);
+  swapSource = false;
+  switch (convertType)
+  {
+#if !defined(TARGET_DARWIN)
+  // on Darwin UTF-8 sources are read as UTF-8-MAC by iconv, which also composes characters
+  case Utf8ToUtf32:
+  case Utf8toW:
+#endif
+  case Utf32ToUtf8:
+  case Utf32ToW:
+  case WToUtf32:
+  case WtoUtf8:
+    return true;
+  case Utf16LEtoW:
+  case Utf16LEtoUtf8:
+    swapSource = bigEndianHost;
+    return true;
+  case Utf16BEtoUtf8:
+    swapSource = !bigEndianHost;
+    return true;
+  default:
+    return false;
+  }
 }
 
 template<class INPUT,class OUTPUT>
@@ -356,18 +732,25 @@ bool CCharsetConverter::CInnerConverter::customConvert(const std::string& source
   if (strSource.empty())
     return true;
 
-  iconv_t conv = iconv_open(targetCharset.c_str(), sourceCharset.c_str());
-  if (conv == NO_ICONV)
+  std::map<std::pair<std::string, std::string>, iconv_t>& custom = t_threadConverters.custom;
+  const std::pair<std::string, std::string> key(targetCharset, sourceCharset);
+  auto it = custom.find(key);
+  if (it == custom.end())
   {
-    CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
-              __FUNCTION__, sourceCharset.c_str(), targetCharset.c_str(), errno, strerror(errno));
-    return false;
+    iconv_t conv = iconv_open(targetCharset.c_str(), sourceCharset.c_str());
+    if (conv == NO_ICONV)
+    {
+      CLog::Log(LOGERROR, "%s: iconv_open() for \"%s\" -> \"%s\" failed, errno = %d (%s)",
+                __FUNCTION__, sourceCharset.c_str(), targetCharset.c_str(), errno, strerror(errno));
+      return false;
+    }
+    if (custom.size() >= CThreadConverters::MAX_CUSTOM_CONVERTERS)
+      t_threadConverters.ClearCustom();
+    it = custom.insert(std::make_pair(key, conv)).first;
   }
-  const int dstMultp = (targetCharset.compare(0, 5, "UTF-8") == 0) ? CCharsetConverter::m_Utf8CharMaxSize : 1;
-  const bool result = convert(conv, dstMultp, strSource, strDest, failOnInvalidChar);
-  iconv_close(conv);
 
-  return result;
+  const int dstMultp = (targetCharset.compare(0, 5, "UTF-8") == 0) ? CCharsetConverter::m_Utf8CharMaxSize : 1;
+  return convert(it->second, dstMultp, strSource, strDest, failOnInvalidChar);
 }
 
 /* iconv may declare inbuf to be char** rather than const char** depending on platform and version,
@@ -497,6 +880,15 @@ bool CCharsetConverter::CInnerConverter::logicalToVisualBiDi(const std::u32strin
   if (srcLen == 0)
     return true;
 
+  // Nothing below the Hebrew block is right-to-left or a bidi mark, so the visual
+  // order of such text is the logical order whichever base direction is used
+  if (base != FRIBIDI_TYPE_RTL &&
+      std::all_of(stringSrc.begin(), stringSrc.end(), [](char32_t c) { return c < 0x0590; }))
+  {
+    stringDst = stringSrc;
+    return true;
+  }
+
   stringDst.reserve(srcLen);
   size_t lineStart = 0;
 
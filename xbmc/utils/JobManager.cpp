@@ -35,9 +35,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, int slot) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_slot = slot;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -182,6 +183,12 @@ CJobManager::CJobManager()
   m_jobCounter = 0;
   m_running = true;
   m_pauseJobs = false;
+  m_slotsUsed = 0;
+  m_stealingWorkers = 0;
+  m_nextSlot = 0;
+  for (auto &queued : m_stealingQueued)
+    queued = 0;
+  m_stealingProcessing = 0;
 }
 
 void CJobManager::Restart()
@@ -208,11 +215,27 @@ void CJobManager::CancelJobs()
   // cancel any callbacks on jobs still processing
   for_each(m_processing.begin(), m_processing.end(), std::mem_fun_ref(&CWorkItem::Cancel));
 
+  // and the same for the work-stealing slots
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    CWorkerSlot &slot = *m_slots[i];
+    CSingleLock slotLock(slot.m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority < CJob::PRIORITY_DEDICATED; ++priority)
+    {
+      for_each(slot.m_jobQueue[priority].begin(), slot.m_jobQueue[priority].end(), std::mem_fun_ref(&CWorkItem::FreeJob));
+      m_stealingQueued[priority] -= slot.m_jobQueue[priority].size();
+      slot.m_jobQueue[priority].clear();
+    }
+    for_each(slot.m_processing.begin(), slot.m_processing.end(), std::mem_fun_ref(&CWorkItem::Cancel));
+  }
+
   // tell our workers to finish
   while (m_workers.size())
   {
     lock.Leave();
     m_jobEvent.Set();
+    for (unsigned int i = 0; i < m_slotsUsed; ++i)
+      m_slots[i]->m_jobEvent.Set();
     Sleep(0); // yield after setting the event to give the workers some time to die
     lock.Enter();
   }
@@ -220,28 +243,150 @@ void CJobManager::CancelJobs()
 
 CJobManager::~CJobManager() = default;
 
+unsigned int CJobManager::NextJobID()
+{
+  // increment the job counter, ensuring 0 (invalid job) is never hit
+  unsigned int id = ++m_jobCounter;
+  while (id == 0)
+    id = ++m_jobCounter;
+  return id;
+}
+
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
+  if (priority != CJob::PRIORITY_DEDICATED && m_stealingWorkers > 0)
+    return AddStealingJob(job, callback, priority);
+
   CSingleLock lock(m_section);
 
   if (!m_running)
     return 0;
 
-  // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
-
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
+  CWorkItem work(job, NextJobID(), priority, callback);
   m_jobQueue[priority].push_back(work);
 
   StartWorkers(priority);
   return work.m_id;
 }
 
+unsigned int CJobManager::AddStealingJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
+{
+  unsigned int workers = m_stealingWorkers;
+  if (workers == 0)
+    workers = m_slotsUsed; // work-stealing was disabled meanwhile, any slot will do
+
+  // spread jobs over the slots, only the slot we queue in needs to be locked
+  unsigned int index = m_nextSlot++ % workers;
+  CWorkerSlot &slot = *m_slots[index];
+  unsigned int id;
+  bool startWorker = false;
+  {
+    CSingleLock lock(slot.m_section);
+    if (!m_running)
+      return 0;
+
+    id = NextJobID();
+    slot.m_jobQueue[priority].push_back(CWorkItem(job, id, priority, callback));
+    ++m_stealingQueued[priority];
+
+    if (!slot.m_hasWorker)
+    {
+      slot.m_hasWorker = true;
+      startWorker = true;
+    }
+  }
+
+  if (startWorker)
+    StartStealingWorker(index);
+  else
+    WakeStealingWorker(index);
+  return id;
+}
+
+void CJobManager::WakeStealingWorker(unsigned int slot)
+{
+  if (m_slots[slot]->m_idle)
+  {
+    m_slots[slot]->m_jobEvent.Set();
+    return;
+  }
+
+  // the owner is busy, wake a single sleeping worker to steal the job
+  const unsigned int slots = m_slotsUsed;
+  for (unsigned int i = 1; i < slots; ++i)
+  {
+    CWorkerSlot &thief = *m_slots[(slot + i) % slots];
+    if (thief.m_idle)
+    {
+      thief.m_jobEvent.Set();
+      return;
+    }
+  }
+}
+
+void CJobManager::StartStealingWorker(unsigned int slot)
+{
+  CSingleLock lock(m_section);
+  if (!m_running)
+  {
+    // cancelled while we were queueing, so the job is gone already
+    CSingleLock slotLock(m_slots[slot]->m_section);
+    m_slots[slot]->m_hasWorker = false;
+    return;
+  }
+  m_workers.push_back(new CJobWorker(this, slot));
+}
+
+void CJobManager::SetWorkStealing(unsigned int workers)
+{
+  CSingleLock lock(m_section);
+
+  if (workers > MAX_STEALING_WORKERS)
+    workers = MAX_STEALING_WORKERS;
+
+  // slots are never freed while we're alive, so workers and thieves may access
+  // any slot below m_slotsUsed without holding our lock
+  for (unsigned int i = m_slotsUsed; i < workers; ++i)
+    m_slots[i].reset(new CWorkerSlot);
+  if (workers > m_slotsUsed)
+    m_slotsUsed = workers;
+
+  m_stealingWorkers = workers;
+  CLog::Log(LOGDEBUG, "%s - work-stealing %s (%u workers)", __FUNCTION__, workers ? "enabled" : "disabled", workers);
+}
+
+bool CJobManager::IsWorkStealing() const
+{
+  return m_stealingWorkers > 0;
+}
+
 void CJobManager::CancelJob(unsigned int jobID)
 {
+  // check the work-stealing slots first
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    CWorkerSlot &slot = *m_slots[i];
+    CSingleLock slotLock(slot.m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority < CJob::PRIORITY_DEDICATED; ++priority)
+    {
+      JobQueue::iterator it = find(slot.m_jobQueue[priority].begin(), slot.m_jobQueue[priority].end(), jobID);
+      if (it != slot.m_jobQueue[priority].end())
+      {
+        delete it->m_job;
+        slot.m_jobQueue[priority].erase(it);
+        --m_stealingQueued[priority];
+        return;
+      }
+    }
+    Processing::iterator it = find(slot.m_processing.begin(), slot.m_processing.end(), jobID);
+    if (it != slot.m_processing.end())
+    {
+      it->m_callback = NULL;
+      return;
+    }
+  }
+
   CSingleLock lock(m_section);
 
   // check whether we have this job in the queue
@@ -304,6 +449,57 @@ CJob *CJobManager::PopJob()
   return NULL;
 }
 
+bool CJobManager::ReserveStealingWorker(CJob::PRIORITY priority)
+{
+  unsigned int workers = m_stealingWorkers;
+  if (workers == 0)
+    workers = m_slotsUsed; // still draining jobs queued before work-stealing was disabled
+
+  const unsigned int maxWorkers = GetMaxWorkers(priority, workers);
+  unsigned int processing = m_stealingProcessing;
+  do
+  {
+    if (processing >= maxWorkers)
+      return false;
+  } while (!m_stealingProcessing.compare_exchange_weak(processing, processing + 1));
+  return true;
+}
+
+CJob *CJobManager::StealJob(unsigned int slot)
+{
+  const unsigned int slots = m_slotsUsed;
+  for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
+  {
+    // Check whether we're pausing pausable jobs
+    if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
+      continue;
+
+    if (m_stealingQueued[priority] == 0 || !ReserveStealingWorker(CJob::PRIORITY(priority)))
+      continue;
+
+    // try our own slot first, then steal from the others
+    for (unsigned int i = 0; i < slots; ++i)
+    {
+      CWorkerSlot &victim = *m_slots[(slot + i) % slots];
+      CSingleLock lock(victim.m_section);
+      JobQueue &queue = victim.m_jobQueue[priority];
+      if (!queue.empty())
+      {
+        // the job stays in the slot it was queued in while processing
+        CWorkItem job = queue.front();
+        queue.pop_front();
+        --m_stealingQueued[priority];
+
+        victim.m_processing.push_back(job);
+        job.m_job->m_callback = this;
+        return job.m_job;
+      }
+    }
+    --m_stealingProcessing;
+  }
+  return NULL;
+}
+
 void CJobManager::PauseJobs()
 {
   CSingleLock lock(m_section);
@@ -314,15 +510,29 @@ void CJobManager::UnPauseJobs()
 {
   CSingleLock lock(m_section);
   m_pauseJobs = false;
+
+  // stealing workers found nothing to do while the jobs were paused and may be asleep
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+    m_slots[i]->m_jobEvent.Set();
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
   if (m_pauseJobs)
     return false;
 
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    CSingleLock slotLock(m_slots[i]->m_section);
+    for (const auto &item : m_slots[i]->m_processing)
+    {
+      if (priority == item.m_priority)
+        return true;
+    }
+  }
+
+  CSingleLock lock(m_section);
+
   for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
   {
     if (priority == it->m_priority)
@@ -334,11 +544,22 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    CSingleLock slotLock(m_slots[i]->m_section);
+    for (const auto &item : m_slots[i]->m_processing)
+    {
+      if (type == std::string(item.m_job->GetType()))
+        jobsMatched++;
+    }
+  }
+
+  CSingleLock lock(m_section);
+
   for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
   {
     if (type == std::string(it->m_job->GetType()))
@@ -349,6 +570,9 @@ int CJobManager::IsProcessing(const std::string &type) const
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
+  if (worker->m_slot >= 0)
+    return GetNextStealingJob(worker);
+
   CSingleLock lock(m_section);
   while (m_running)
   {
@@ -373,8 +597,65 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
   return NULL;
 }
 
+CJob *CJobManager::GetNextStealingJob(const CJobWorker *worker)
+{
+  CWorkerSlot &slot = *m_slots[worker->m_slot];
+  while (true)
+  {
+    bool newJob = false;
+    if (m_running)
+    {
+      CJob *job = StealJob(worker->m_slot);
+      if (job)
+        return job;
+
+      // announce that we're going to sleep, then look once more so that
+      // a job queued in the meantime doesn't go unnoticed
+      slot.m_idle = true;
+      job = StealJob(worker->m_slot);
+      if (job)
+      {
+        slot.m_idle = false;
+        return job;
+      }
+      // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+      newJob = slot.m_jobEvent.WaitMSec(30000);
+      slot.m_idle = false;
+    }
+    if (newJob)
+      continue;
+
+    // timed out or cancelled - give up our slot unless jobs came in meanwhile
+    CSingleLock lock(slot.m_section);
+    if (!m_running || slot.IsEmpty())
+    {
+      slot.m_hasWorker = false;
+      break;
+    }
+  }
+  RemoveWorker(worker);
+  return NULL;
+}
+
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    CSingleLock slotLock(m_slots[i]->m_section);
+    Processing::const_iterator it = find(m_slots[i]->m_processing.begin(), m_slots[i]->m_processing.end(), job);
+    if (it != m_slots[i]->m_processing.end())
+    {
+      CWorkItem item(*it);
+      slotLock.Leave(); // leave section prior to call
+      if (item.m_callback)
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
+      return true;
+    }
+  }
+
   CSingleLock lock(m_section);
   // find the job in the processing queue, and check whether it's cancelled (no callback)
   Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
@@ -393,10 +674,23 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
+  for (unsigned int i = 0; i < m_slotsUsed; ++i)
+  {
+    if (CompleteJob(m_slots[i]->m_processing, m_slots[i]->m_section, success, job))
+    {
+      --m_stealingProcessing;
+      return;
+    }
+  }
+  CompleteJob(m_processing, m_section, success, job);
+}
+
+bool CJobManager::CompleteJob(Processing &processing, CCriticalSection &section, bool success, CJob *job)
+{
+  CSingleLock lock(section);
   // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  Processing::iterator i = find(processing.begin(), processing.end(), job);
+  if (i != processing.end())
   {
     // tell any listeners we're done with the job, then delete it
     CWorkItem item(*i);
@@ -411,12 +705,14 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+    Processing::iterator j = find(processing.begin(), processing.end(), job);
+    if (j != processing.end())
+      processing.erase(j);
     lock.Leave();
     item.FreeJob();
+    return true;
   }
+  return false;
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
@@ -431,7 +727,14 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
 {
   static const unsigned int max_workers = 5;
+  return GetMaxWorkers(priority, max_workers);
+}
+
+unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority, unsigned int workers)
+{
   if (priority == CJob::PRIORITY_DEDICATED)
     return 10000; // A large number..
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  // keep a worker free for each higher priority, but always allow one job to run
+  const unsigned int reserved = CJob::PRIORITY_HIGH - priority;
+  return workers > reserved ? workers - reserved : 1;
 }
@@ -19,6 +19,8 @@
  *
  */
 
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <vector>
 #include <string>
@@ -31,12 +33,20 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  explicit CJobWorker(CJobManager *manager);
+  /*!
+   \brief Create a worker thread for the given manager
+   \param manager the job manager to request jobs from
+   \param slot index of the work-stealing slot this worker owns, or -1 for the shared queue
+   */
+  explicit CJobWorker(CJobManager *manager, int slot = -1);
   ~CJobWorker() override;
 
   void Process() override;
 private:
+  friend class CJobManager;
+
   CJobManager  *m_jobManager;
+  int           m_slot;
 };
 
 template<typename F>
@@ -197,6 +207,12 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Optionally jobs may be scheduled in work-stealing mode (see SetWorkStealing()).  Each
+ worker then owns a slot with its own per-priority queues, new jobs are spread over the
+ slots without taking the manager lock, and idle workers steal from the other slots.
+ Priorities, pausing and cancellation behave as in the default mode. Dedicated jobs always
+ use the shared queue.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -234,7 +250,42 @@ class CJobManager
     CJob::PRIORITY m_priority;
   };
 
+  typedef std::deque<CWorkItem>    JobQueue;
+  typedef std::vector<CWorkItem>   Processing;
+  typedef std::vector<CJobWorker*> Workers;
+
+  /*!
+   \brief Per-worker queues used in work-stealing mode.
+   Jobs stay in the slot they were queued in while processing, so lookups by job or id
+   only need to take the lock of one slot at a time.
+   */
+  class CWorkerSlot
+  {
+  public:
+    bool IsEmpty() const
+    {
+      for (const auto &queue : m_jobQueue)
+      {
+        if (!queue.empty())
+          return false;
+      }
+      return true;
+    }
+    JobQueue         m_jobQueue[CJob::PRIORITY_DEDICATED];
+    Processing       m_processing;
+    CCriticalSection m_section;
+    bool             m_hasWorker = false;
+    std::atomic<bool> m_idle{false};
+    CEvent           m_jobEvent;
+  };
+
 public:
+  /*!
+   \brief Maximum number of workers supported in work-stealing mode.
+   \sa SetWorkStealing()
+   */
+  static const unsigned int MAX_STEALING_WORKERS = 32;
+
   /*!
    \brief The only way through which the global instance of the CJobManager should be accessed.
    \return the global instance.
@@ -319,6 +370,22 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Enable or disable the work-stealing execution mode.
+   Jobs added after this call are distributed over the given number of workers, each with
+   its own job queues. Jobs already queued are still processed. Dedicated jobs are not affected.
+   \param workers number of workers to use, at most MAX_STEALING_WORKERS. 0 disables work-stealing.
+   \sa IsWorkStealing()
+   */
+  void SetWorkStealing(unsigned int workers);
+
+  /*!
+   \brief Checks whether new jobs are scheduled in work-stealing mode.
+   \return true if work-stealing is enabled, else returns false
+   \sa SetWorkStealing()
+   */
+  bool IsWorkStealing() const;
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -366,19 +433,53 @@ private:
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
+  static unsigned int GetMaxWorkers(CJob::PRIORITY priority, unsigned int workers);
 
-  unsigned int m_jobCounter;
+  unsigned int NextJobID();
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
+  /*! \brief Queue a job in one of the work-stealing slots
+   \return the id of the queued job, 0 if the job manager is not running
+   */
+  unsigned int AddStealingJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority);
+
+  /*! \brief Get the next job for a work-stealing worker. Blocks until a job is available,
+   or a timeout has occurred.
+   */
+  CJob *GetNextStealingJob(const CJobWorker *worker);
+
+  /*! \brief Pop the highest priority job from the worker's own slot, or steal it from another slot
+   \return the job to process, NULL if no jobs are available
+   */
+  CJob *StealJob(unsigned int slot);
+
+  /*! \brief Reserve a processing place for a job of the given priority in work-stealing mode */
+  bool ReserveStealingWorker(CJob::PRIORITY priority);
+
+  void StartStealingWorker(unsigned int slot);
+
+  /*! \brief Wake the owner of the given slot if it's sleeping, or any other sleeping worker to steal the job */
+  void WakeStealingWorker(unsigned int slot);
+
+  /*! \brief Call the job's callback and remove it from the given processing queue
+   \return true if the job was found in the queue, else returns false
+   */
+  static bool CompleteJob(Processing &processing, CCriticalSection &section, bool success, CJob *job);
+
+  std::atomic<unsigned int> m_jobCounter;
 
   JobQueue   m_jobQueue[CJob::PRIORITY_DEDICATED + 1];
-  bool       m_pauseJobs;
+  std::atomic<bool> m_pauseJobs;
   Processing m_processing;
   Workers    m_workers;
 
+  std::unique_ptr<CWorkerSlot> m_slots[MAX_STEALING_WORKERS];
+  std::atomic<unsigned int> m_slotsUsed;        //!< number of allocated slots, never decreases
+  std::atomic<unsigned int> m_stealingWorkers;  //!< number of slots new jobs are queued in, 0 if disabled
+  std::atomic<unsigned int> m_nextSlot;
+  std::atomic<unsigned int> m_stealingQueued[CJob::PRIORITY_DEDICATED];
+  std::atomic<unsigned int> m_stealingProcessing;
+
   CCriticalSection m_section;
   CEvent           m_jobEvent;
-  bool             m_running;
+  std::atomic<bool> m_running;
 };
@@ -29,6 +29,7 @@
 #include "utils/log.h"
 
 #include <algorithm>
+#include <cmath>
 
 std::string ArrayToString(SortAttribute attributes, const CVariant &variant, const std::string &separator = " / ")
 {
@@ -433,130 +434,202 @@ std::string ByLastUsed(SortAttribute attributes, const SortItem &values)
   return values.at(FieldLastUsed).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+void PrepareSortLabel(const std::string &label, std::wstring &sortLabel)
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
-  {
-    result = false;
-    return true;
-  }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+#ifdef TARGET_ANDROID
+  // Android does not support locale; Translate to ASCII
+  std::string dest;
+  g_charsetConverter.utf8ToASCII(label, dest);
+  for (char c : dest)
   {
-    result = true;
-    return true;
+    if (::isalnum(c) || c == ' ')
+      sortLabel.push_back(c);
   }
+#else
+  g_charsetConverter.utf8ToW(label, sortLabel, false);
+#endif
+}
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
-  {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
-    {
-      result = true;
-      return true;
-    }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
-  }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
-  {
-    result = false;
-    return true;
-  }
+// typed counterparts of the string preparators above for sort methods that
+// are (mainly) numeric. the number is compared first and the label only
+// when the numbers are equal, which is the same order the alphanumeric
+// comparison of the formatted string results in
+void KeyBySize(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldSize).asInteger();
+}
 
-  if (handleFolder)
-  {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
-    {
-      result = itLeft->second.asBoolean();
-      return true;
-    }
-  }
+void KeyByDriveType(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldDriveType).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+void KeyByTrackNumber(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldTrackNumber).asInteger();
+}
+
+void KeyByProgramCount(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldProgramCount).asInteger();
+}
 
-  return false;
+void KeyByRating(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.number = values.at(FieldRating).asFloat();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByUserRating(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldUserRating).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
 }
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+void KeyByVotes(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  key.integer = values.at(FieldVotes).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByTop250(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldTop250).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByEpisodeNumber(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  // see ByEpisodeNumber
+  uint64_t num;
+  const CVariant &episodeSpecial = values.at(FieldEpisodeNumberSpecialSort);
+  const CVariant &seasonSpecial = values.at(FieldSeasonSpecialSort);
+  if (!episodeSpecial.isNull() && !seasonSpecial.isNull() &&
+     (episodeSpecial.asInteger() > 0 || seasonSpecial.asInteger() > 0))
+    num = ((uint64_t)seasonSpecial.asInteger() << 32) + (episodeSpecial.asInteger() << 16) - ((2 << 15) - values.at(FieldEpisodeNumber).asInteger());
+  else
+    num = ((uint64_t)values.at(FieldSeason).asInteger() << 32) + (values.at(FieldEpisodeNumber).asInteger() << 16);
+  // flip the sign bit so the signed comparison keeps the unsigned order
+  key.integer = static_cast<int64_t>(num ^ (UINT64_C(1) << 63));
+
+  std::string title;
+  if (values.find(FieldMediaType) != values.end() && values.at(FieldMediaType).asString() == MediaTypeMovie)
+    title = BySortTitle(attributes, values);
+  if (title.empty())
+    title = ByLabel(attributes, values);
+  PrepareSortLabel(title, key.label);
+}
+
+void KeyBySeason(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldSeason).asInteger();
+  const CVariant &specialSeason = values.at(FieldSeasonSpecialSort);
+  if (!specialSeason.isNull())
+    key.integer = specialSeason.asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByNumberOfEpisodes(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldNumberOfEpisodes).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByNumberOfWatchedEpisodes(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldNumberOfWatchedEpisodes).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
+
+void KeyByVideoResolution(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldVideoResolution).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
+void KeyByVideoAspectRatio(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  // ByVideoAspectRatio only uses three decimals
+  key.integer = static_cast<int64_t>(std::llround(values.at(FieldVideoAspectRatio).asFloat() * 1000));
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
 }
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
+void KeyByAudioChannels(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  key.integer = values.at(FieldAudioChannels).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
+}
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
+void KeyByPlaycount(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldPlaycount).asInteger();
+  PrepareSortLabel(ByLabel(attributes, values), key.label);
 }
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
+void KeyByListeners(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  key.integer = values.at(FieldListeners).asInteger();
+}
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
+void KeyByBitrate(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldBitrate).asInteger();
 }
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
+void KeyByRandom(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  key.integer = CUtil::GetRandomNumber();
+}
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
+void KeyByRelevance(SortAttribute attributes, const SortItem &values, SortUtils::SortKey &key)
+{
+  key.integer = values.at(FieldRelevance).asInteger();
 }
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
+int64_t CompareKeys(const SortUtils::SortKey &left, const SortUtils::SortKey &right, bool handleFolder)
 {
-  return SorterAscending(*left, *right);
+  // look at special sorting behaviour
+  if (left.special != right.special)
+  {
+    // left should be sorted on top
+    // or right should be sorted on bottom
+    // => left is sorted above right
+    if (left.special == SortSpecialOnTop ||
+        right.special == SortSpecialOnBottom)
+      return -1;
+
+    // otherwise right is sorted above left
+    return 1;
+  }
+  // both have either sort on top or sort on bottom -> leave as-is
+  else if (left.special != SortSpecialNone)
+    return 0;
+
+  if (handleFolder && left.folder >= 0 && right.folder >= 0 && left.folder != right.folder)
+    return left.folder ? -1 : 1;
+
+  return 0;
 }
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
+int64_t CompareValues(const SortUtils::SortKey &left, const SortUtils::SortKey &right)
 {
-  return SorterDescending(*left, *right);
+  if (left.integer != right.integer)
+    return left.integer < right.integer ? -1 : 1;
+  if (left.number != right.number)
+    return left.number < right.number ? -1 : 1;
+
+  return StringUtils::AlphaNumericCompare(left.label.c_str(), right.label.c_str());
 }
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
+SortItem& GetSortItem(DatabaseResult &item)
 {
-  return SorterIgnoreFoldersAscending(*left, *right);
+  return item;
 }
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
+SortItem& GetSortItem(SortItemPtr &item)
 {
-  return SorterIgnoreFoldersDescending(*left, *right);
+  return *item;
 }
 
 std::map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -620,6 +693,35 @@ std::map<SortBy, SortUtils::SortPreparator> fillPreparators()
   return preparators;
 }
 
+std::map<SortBy, SortUtils::SortKeyPreparator> fillKeyPreparators()
+{
+  std::map<SortBy, SortUtils::SortKeyPreparator> preparators;
+
+  preparators[SortBySize]                     = KeyBySize;
+  preparators[SortByDriveType]                = KeyByDriveType;
+  preparators[SortByTrackNumber]              = KeyByTrackNumber;
+  preparators[SortByRating]                   = KeyByRating;
+  preparators[SortByUserRating]               = KeyByUserRating;
+  preparators[SortByVotes]                    = KeyByVotes;
+  preparators[SortByTop250]                   = KeyByTop250;
+  preparators[SortByProgramCount]             = KeyByProgramCount;
+  preparators[SortByPlaylistOrder]            = KeyByProgramCount;
+  preparators[SortByEpisodeNumber]            = KeyByEpisodeNumber;
+  preparators[SortBySeason]                   = KeyBySeason;
+  preparators[SortByNumberOfEpisodes]         = KeyByNumberOfEpisodes;
+  preparators[SortByNumberOfWatchedEpisodes]  = KeyByNumberOfWatchedEpisodes;
+  preparators[SortByVideoResolution]          = KeyByVideoResolution;
+  preparators[SortByVideoAspectRatio]         = KeyByVideoAspectRatio;
+  preparators[SortByAudioChannels]            = KeyByAudioChannels;
+  preparators[SortByPlaycount]                = KeyByPlaycount;
+  preparators[SortByListeners]                = KeyByListeners;
+  preparators[SortByBitrate]                  = KeyByBitrate;
+  preparators[SortByRandom]                   = KeyByRandom;
+  preparators[SortByRelevance]                = KeyByRelevance;
+
+  return preparators;
+}
+
 std::map<SortBy, Fields> fillSortingFields()
 {
   std::map<SortBy, Fields> sortingFields;
@@ -707,9 +809,11 @@ std::map<SortBy, Fields> fillSortingFields()
 }
 
 std::map<SortBy, SortUtils::SortPreparator> SortUtils::m_preparators = fillPreparators();
+std::map<SortBy, SortUtils::SortKeyPreparator> SortUtils::m_keyPreparators = fillKeyPreparators();
 std::map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
-void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+template<class Items>
+void SortUtils::sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, Items& items, int limitEnd, int limitStart, bool storeLabel)
 {
   if (sortBy != SortByNone)
   {
@@ -717,86 +821,82 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     SortPreparator preparator = getPreparator(sortBy);
     if (preparator != NULL)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
+      SortKeyPreparator keyPreparator = getKeyPreparator(sortBy);
+      const Fields& sortingFields = GetFieldsForSorting(sortBy);
+      bool handleFolder = !(attributes & SortAttributeIgnoreFolders);
 
-      // Prepare the string used for sorting and store it under FieldSort
-      for (DatabaseResults::iterator item = items.begin(); item != items.end(); ++item)
+      // Prepare the keys used for sorting once, typed where the sort method allows it
+      std::vector<SortKey> keys(items.size());
+      for (size_t i = 0; i < items.size(); ++i)
       {
+        SortItem& item = GetSortItem(items[i]);
         // add all fields to the item that are required for sorting if they are currently missing
         for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
         {
-          if (item->find(*field) == item->end())
-            item->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+          if (item.find(*field) == item.end())
+            item.insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
         }
 
-        std::wstring sortLabel;
-#ifdef TARGET_ANDROID
-        // Android does not support locale; Translate to ASCII
-        std::string dest;
-        g_charsetConverter.utf8ToASCII(preparator(attributes, *item), dest);
-        for (char c : dest)
-        {
-          if (::isalnum(c) || c == ' ')
-            sortLabel.push_back(c);
-        }
-#else
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-#endif
-        item->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
+        SortKey& key = keys[i];
+        if (keyPreparator != NULL)
+          keyPreparator(attributes, item, key);
+        else
+          PrepareSortLabel(preparator(attributes, item), key.label);
+
+        SortItem::const_iterator it;
+        if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+          key.special = (SortSpecial)it->second.asInteger();
+        if (handleFolder && (it = item.find(FieldFolder)) != item.end())
+          key.folder = it->second.asBoolean() ? 1 : 0;
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
-    }
-  }
-
-  if (limitStart > 0 && (size_t)limitStart < items.size())
-  {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
-  }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
-}
-
-void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
-{
-  if (sortBy != SortByNone)
-  {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
-    {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); ++item)
+      // Do the sorting on a permutation of the items, ties are kept in their
+      // original order. Only the items up to the limit need to be in order
+      std::vector<size_t> order(items.size());
+      for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+      bool descending = sortOrder == SortOrderDescending;
+      auto less = [&keys, handleFolder, descending](size_t left, size_t right)
       {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); ++field)
+        int64_t result = CompareKeys(keys[left], keys[right], handleFolder);
+        if (result == 0 && keys[left].special == SortSpecialNone)
         {
-          if ((*item)->find(*field) == (*item)->end())
-            (*item)->insert(std::pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
+          result = CompareValues(keys[left], keys[right]);
+          if (descending)
+            result = -result;
         }
+        if (result != 0)
+          return result < 0;
+        return left < right;
+      };
+
+      size_t start = limitStart > 0 && (size_t)limitStart < items.size() ? limitStart : 0;
+      size_t end = items.size();
+      if (limitEnd > 0 && (size_t)limitEnd > start && (size_t)limitEnd < end)
+        end = limitEnd;
+      if (end < items.size())
+        std::partial_sort(order.begin(), order.begin() + end, order.end(), less);
+      else
+        std::sort(order.begin(), order.end(), less);
 
-        std::wstring sortLabel;
-#ifdef TARGET_ANDROID
-        // Android does not support locale; Translate to ASCII
-        std::string dest;
-        g_charsetConverter.utf8ToASCII(preparator(attributes, **item), dest);
-        for (char c : dest)
+      Items sorted;
+      sorted.reserve(end - start);
+      for (size_t i = start; i < end; ++i)
+      {
+        sorted.push_back(std::move(items[order[i]]));
+        if (storeLabel)
         {
-          if (::isalnum(c) || c == ' ')
-            sortLabel.push_back(c);
+          // store the label used for sorting under FieldSort
+          std::wstring sortLabel;
+          if (keyPreparator != NULL)
+            PrepareSortLabel(preparator(attributes, GetSortItem(sorted.back())), sortLabel);
+          else
+            sortLabel.swap(keys[order[i]].label);
+          GetSortItem(sorted.back()).insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
         }
-#else
-        g_charsetConverter.utf8ToW(preparator(attributes, **item), sortLabel, false);
-#endif
-        (*item)->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
       }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+      items.swap(sorted);
+      return;
     }
   }
 
@@ -809,6 +909,16 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
     items.erase(items.begin() + limitEnd, items.end());
 }
 
+void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, DatabaseResults& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  sort(sortBy, sortOrder, attributes, items, limitEnd, limitStart, false);
+}
+
+void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
+{
+  sort(sortBy, sortOrder, attributes, items, limitEnd, limitStart, true);
+}
+
 void SortUtils::Sort(const SortDescription &sortDescription, DatabaseResults& items)
 {
   Sort(sortDescription.sortBy, sortDescription.sortOrder, sortDescription.sortAttributes, items, sortDescription.limitEnd, sortDescription.limitStart);
@@ -849,20 +959,13 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
+SortUtils::SortKeyPreparator SortUtils::getKeyPreparator(SortBy sortBy)
 {
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
+  std::map<SortBy, SortKeyPreparator>::const_iterator it = m_keyPreparators.find(sortBy);
+  if (it != m_keyPreparators.end())
+    return it->second;
 
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
+  return NULL;
 }
 
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
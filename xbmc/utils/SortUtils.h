@@ -216,15 +216,29 @@ public:
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
   
+  /*! \brief Key of an item prepared once before sorting.
+   Items are compared by integer, then number and finally label, typed sort
+   methods fill the numeric members and only use the label for ties.
+   */
+  struct SortKey
+  {
+    int64_t integer = 0;
+    double number = 0.0;
+    std::wstring label;
+    SortSpecial special = SortSpecialNone;
+    int folder = -1; ///< -1 if unknown
+  };
+
   typedef std::string (*SortPreparator) (SortAttribute, const SortItem&);
-  typedef bool (*Sorter) (const DatabaseResult &, const DatabaseResult &);
-  typedef bool (*SorterIndirect) (const SortItemPtr &, const SortItemPtr &);
+  typedef void (*SortKeyPreparator) (SortAttribute, const SortItem&, SortKey&);
   
 private:
   static const SortPreparator& getPreparator(SortBy sortBy);
-  static Sorter getSorter(SortOrder sortOrder, SortAttribute attributes);
-  static SorterIndirect getSorterIndirect(SortOrder sortOrder, SortAttribute attributes);
+  static SortKeyPreparator getKeyPreparator(SortBy sortBy);
+  template<class Items>
+  static void sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, Items& items, int limitEnd, int limitStart, bool storeLabel);
 
   static std::map<SortBy, SortPreparator> m_preparators;
+  static std::map<SortBy, SortKeyPreparator> m_keyPreparators;
   static std::map<SortBy, Fields> m_sortingFields;
 };
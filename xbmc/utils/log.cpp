@@ -22,10 +22,14 @@
 #include "CompileInfo.h"
 #include "settings/AdvancedSettings.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StringUtils.h"
 
+#include <atomic>
+#include <thread>
+
 #if defined(TARGET_POSIX)
 #include "posix/PosixInterfaceForCLog.h"
 typedef class CPosixInterfaceForCLog PlatformInterfaceForCLog;
@@ -44,62 +48,229 @@ static const char* const logLevelNames[] =
 
 namespace
 {
+/* A line waiting to be written. The prefix is formatted by the writer, so only
+   the time and thread of the call are captured by the logging thread. */
+struct CLogEntry
+{
+  CLogEntry*  next;
+  int         level;
+  int         hour, minute, second;
+  double      millisecond;
+  uint64_t    threadId;
+  std::string line;
+};
+
 class CLogGlobals
 {
 public:
-  CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
-  ~CLogGlobals() = default;
+  CLogGlobals(void) : m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0),
+                      m_pending(nullptr), m_pendingBytes(0), m_droppedLines(0), m_writerRunning(false), m_stopWriter(false) {}
+  ~CLogGlobals()
+  {
+    StopWriter();
+    CSingleLock waitLock(critSec);
+    WritePending();
+  }
+
+  void StartWriter();
+  void StopWriter();
+  void Push(CLogEntry* entry);
+  void WritePending();
+
   PlatformInterfaceForCLog m_platform;
   int         m_repeatCount;
   int         m_repeatLogLevel;
   std::string m_repeatLine;
   int         m_logLevel;
   int         m_extraLogLevels;
-  CCriticalSection critSec;
+  CCriticalSection critSec; // held while writing, never while queueing
+
+  // lines queued by the logging threads, newest first
+  std::atomic<CLogEntry*>   m_pending;
+  std::atomic<size_t>       m_pendingBytes;
+  std::atomic<unsigned int> m_droppedLines;
+
+  // writer thread, a plain std::thread as CThread logs itself
+  std::thread   m_writer;
+  std::atomic<bool> m_writerRunning;
+  std::atomic<bool> m_stopWriter;
+  CEvent        m_wakeWriter;
+
+  static const size_t MAX_PENDING_BYTES = 8 * 1024 * 1024;
+  static const size_t WAKE_PENDING_BYTES = 64 * 1024;
+  static const unsigned int WRITE_INTERVAL_MS = 100;
 };
 
 static CLogGlobals g_logState;
-}
 
-CLog::CLog() = default;
+void CLogGlobals::StartWriter()
+{
+  if (m_writerRunning)
+    return;
 
-CLog::~CLog() = default;
+  m_stopWriter = false;
+  m_writerRunning = true;
+  m_writer = std::thread([this]()
+  {
+    while (!m_stopWriter)
+    {
+      m_wakeWriter.WaitMSec(WRITE_INTERVAL_MS);
+      CSingleLock waitLock(critSec);
+      WritePending();
+    }
+  });
+}
 
-void CLog::Close()
+void CLogGlobals::StopWriter()
 {
-  CSingleLock waitLock(g_logState.critSec);
-  g_logState.m_platform.CloseLogFile();
-  g_logState.m_repeatLine.clear();
+  if (!m_writerRunning)
+    return;
+
+  m_stopWriter = true;
+  m_wakeWriter.Set();
+  if (m_writer.joinable())
+    m_writer.join();
+  m_writerRunning = false;
 }
 
-void CLog::LogString(int logLevel, std::string&& logString)
+void CLogGlobals::Push(CLogEntry* entry)
 {
-  CSingleLock waitLock(g_logState.critSec);
-  std::string strData(logString);
-  StringUtils::TrimRight(strData);
-  if (!strData.empty())
+  const size_t size = entry->line.size() + sizeof(CLogEntry);
+  // errors are never dropped, everything else is once the writer falls too far behind
+  if (entry->level < LOGERROR && m_pendingBytes.load(std::memory_order_relaxed) + size > MAX_PENDING_BYTES)
+  {
+    m_droppedLines++;
+    delete entry;
+    return;
+  }
+  const size_t pendingBytes = m_pendingBytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+  entry->next = m_pending.load(std::memory_order_relaxed);
+  while (!m_pending.compare_exchange_weak(entry->next, entry, std::memory_order_release, std::memory_order_relaxed))
+    ;
+
+  if (!m_writerRunning || entry->level >= LOGSEVERE)
+  {
+    // no writer yet or the process may be about to die, write synchronously
+    CSingleLock waitLock(critSec);
+    WritePending();
+  }
+  else if (entry->level >= LOGERROR || pendingBytes >= WAKE_PENDING_BYTES)
+    m_wakeWriter.Set();
+}
+
+/* Must be called with critSec held */
+void CLogGlobals::WritePending()
+{
+  static const char* prefixFormat = "%02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
+
+  // take all queued lines at once and restore their order
+  CLogEntry* entry = m_pending.exchange(nullptr, std::memory_order_acquire);
+  CLogEntry* ordered = nullptr;
+  while (entry)
+  {
+    CLogEntry* next = entry->next;
+    entry->next = ordered;
+    ordered = entry;
+    entry = next;
+  }
+
+  std::string batch;
+  auto append = [&batch](const CLogEntry& item, const std::string& line)
   {
-    if (g_logState.m_repeatLogLevel == logLevel && g_logState.m_repeatLine == strData)
+    std::string strData(line);
+    /* fixup newline alignment, number of spaces should equal prefix length */
+    StringUtils::Replace(strData, "\n", "\n                                            ");
+
+    if (!batch.empty())
+      batch += '\n';
+    batch += StringUtils::Format(prefixFormat,
+                                 item.hour,
+                                 item.minute,
+                                 item.second,
+                                 static_cast<int>(item.millisecond),
+                                 item.threadId,
+                                 levelNames[item.level]);
+    batch += strData;
+  };
+
+  size_t writtenBytes = 0;
+  while (ordered)
+  {
+    std::unique_ptr<CLogEntry> current(ordered);
+    ordered = ordered->next;
+    writtenBytes += current->line.size() + sizeof(CLogEntry);
+
+    std::string& strData = current->line;
+    StringUtils::TrimRight(strData);
+    if (strData.empty())
+      continue;
+
+    if (m_repeatLogLevel == current->level && m_repeatLine == strData)
     {
-      g_logState.m_repeatCount++;
-      return;
+      m_repeatCount++;
+      continue;
     }
-    else if (g_logState.m_repeatCount)
+    else if (m_repeatCount)
     {
-      std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
-                                                g_logState.m_repeatCount);
-      PrintDebugString(strData2);
-      WriteLogString(g_logState.m_repeatLogLevel, strData2);
-      g_logState.m_repeatCount = 0;
+      std::string strData2 = StringUtils::Format("Previous line repeats %d times.", m_repeatCount);
+      CLog::PrintDebugString(strData2);
+      CLogEntry repeat(*current);
+      repeat.level = m_repeatLogLevel;
+      append(repeat, strData2);
+      m_repeatCount = 0;
     }
 
-    g_logState.m_repeatLine = strData;
-    g_logState.m_repeatLogLevel = logLevel;
+    m_repeatLine = strData;
+    m_repeatLogLevel = current->level;
 
-    PrintDebugString(strData);
+    CLog::PrintDebugString(strData);
+    append(*current, strData);
+  }
+  m_pendingBytes -= writtenBytes;
 
-    WriteLogString(logLevel, strData);
+  const unsigned int dropped = m_droppedLines.exchange(0);
+  if (dropped)
+  {
+    CLogEntry note = CLogEntry();
+    note.level = LOGWARNING;
+    m_platform.GetCurrentLocalTime(note.hour, note.minute, note.second, note.millisecond);
+    note.threadId = (uint64_t)CThread::GetCurrentThreadId();
+    append(note, StringUtils::Format("Dropped %u log lines, the log writer could not keep up.", dropped));
   }
+
+  if (!batch.empty())
+    m_platform.WriteStringToLog(batch);
+}
+}
+
+CLog::CLog() = default;
+
+CLog::~CLog() = default;
+
+void CLog::Close()
+{
+  g_logState.StopWriter();
+  CSingleLock waitLock(g_logState.critSec);
+  g_logState.WritePending();
+  g_logState.m_platform.CloseLogFile();
+  g_logState.m_repeatLine.clear();
+}
+
+void CLog::Flush()
+{
+  CSingleLock waitLock(g_logState.critSec);
+  g_logState.WritePending();
+}
+
+void CLog::LogString(int logLevel, std::string&& logString)
+{
+  CLogEntry* entry = new CLogEntry();
+  entry->level = logLevel & LOGMASK;
+  g_logState.m_platform.GetCurrentLocalTime(entry->hour, entry->minute, entry->second, entry->millisecond);
+  entry->threadId = (uint64_t)CThread::GetCurrentThreadId();
+  entry->line = std::move(logString);
+  g_logState.Push(entry);
 }
 
 void CLog::LogString(int logLevel, int component, std::string&& logString)
@@ -117,7 +288,11 @@ bool CLog::Init(const std::string& path)
 
   std::string appName = CCompileInfo::GetAppName();
   StringUtils::ToLower(appName);
-  return g_logState.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log");
+  if (!g_logState.m_platform.OpenLogFile(path + appName + ".log", path + appName + ".old.log"))
+    return false;
+
+  g_logState.StartWriter();
+  return true;
 }
 
 void CLog::MemDump(char *pData, int length)
@@ -196,26 +371,3 @@ void CLog::PrintDebugString(const std::string& line)
   g_logState.m_platform.PrintDebugString(line);
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
-
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
-{
-  static const char* prefixFormat = "%02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
-
-  std::string strData(logString);
-  /* fixup newline alignment, number of spaces should equal prefix length */
-  StringUtils::Replace(strData, "\n", "\n                                            ");
-
-  int hour, minute, second;
-  double millisecond;
-  g_logState.m_platform.GetCurrentLocalTime(hour, minute, second, millisecond);
-
-  strData = StringUtils::Format(prefixFormat,
-                                  hour,
-                                  minute,
-                                  second,
-                                  static_cast<int>(millisecond),
-                                  (uint64_t)CThread::GetCurrentThreadId(),
-                                  levelNames[logLevel]) + strData;
-
-  return g_logState.m_platform.WriteStringToLog(strData);
-}
@@ -35,6 +35,7 @@ public:
   CLog();
   ~CLog();
   static void Close();
+  static void Flush(); // writes all queued lines before returning
 
   static void Log(int loglevel, const char* format)
   {
@@ -114,5 +115,4 @@ public:
 protected:
   static void LogString(int logLevel, std::string&& logString);
   static void LogString(int logLevel, int component, std::string&& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
 };
\ No newline at end of file
@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/ActorProtocol.h"
+
+#include "gtest/gtest.h"
+
+using namespace Actor;
+
+namespace
+{
+enum Signals
+{
+  PING = 1,
+  PONG,
+  FLUSH,
+  QUIT,
+};
+
+/* Replies to every message on the out queue of the port until told to quit */
+class CResponder : public CThread
+{
+public:
+  CResponder(Protocol &port, CEvent &event) :
+    CThread("TestActorProtocol"), m_port(port), m_event(event)
+  {
+  }
+
+protected:
+  void Process() override
+  {
+    Message *msg;
+    while (!m_bStop)
+    {
+      if (!m_port.ReceiveOutMessage(&msg))
+      {
+        m_event.WaitMSec(1000);
+        continue;
+      }
+      bool quit = msg->signal == QUIT;
+      msg->Reply(PONG);
+      msg->Release();
+      if (quit)
+        break;
+    }
+  }
+
+private:
+  Protocol &m_port;
+  CEvent &m_event;
+};
+}
+
+TEST(TestActorProtocol, Order)
+{
+  Protocol port("test");
+  Message *msg;
+
+  // exceed the ring to make sure overflowed messages keep their place
+  for (int i = 0; i < 3 * MSG_RING_SIZE; i++)
+    port.SendOutMessage(PING, &i, sizeof(i));
+
+  for (int i = 0; i < 3 * MSG_RING_SIZE; i++)
+  {
+    ASSERT_TRUE(port.ReceiveOutMessage(&msg));
+    EXPECT_EQ(i, *reinterpret_cast<int*>(msg->data));
+    msg->Release();
+  }
+  EXPECT_FALSE(port.ReceiveOutMessage(&msg));
+}
+
+TEST(TestActorProtocol, PurgeOut)
+{
+  Protocol port("test");
+  Message *msg;
+
+  for (int i = 0; i < 2 * MSG_RING_SIZE; i++)
+    port.SendOutMessage(i % 2 ? FLUSH : PING, &i, sizeof(i));
+  port.PurgeOut(FLUSH);
+  int i = 2 * MSG_RING_SIZE;
+  port.SendOutMessage(PING, &i, sizeof(i));
+
+  for (i = 0; i <= 2 * MSG_RING_SIZE; i += 2)
+  {
+    ASSERT_TRUE(port.ReceiveOutMessage(&msg));
+    EXPECT_EQ(PING, msg->signal);
+    EXPECT_EQ(i, *reinterpret_cast<int*>(msg->data));
+    msg->Release();
+  }
+  EXPECT_FALSE(port.ReceiveOutMessage(&msg));
+}
+
+TEST(TestActorProtocol, DeferOut)
+{
+  Protocol port("test");
+  Message *msg;
+
+  port.SendOutMessage(PING);
+  port.DeferOut(true);
+  EXPECT_FALSE(port.ReceiveOutMessage(&msg));
+  port.DeferOut(false);
+  ASSERT_TRUE(port.ReceiveOutMessage(&msg));
+  msg->Release();
+}
+
+TEST(TestActorProtocol, SendOutMessageSync)
+{
+  CEvent event;
+  Protocol port("test", nullptr, &event);
+  CResponder responder(port, event);
+  responder.Create();
+
+  Message *reply;
+  ASSERT_TRUE(port.SendOutMessageSync(PING, &reply, 1000));
+  EXPECT_EQ(PONG, reply->signal);
+  reply->Release();
+
+  ASSERT_TRUE(port.SendOutMessageSync(QUIT, &reply, 1000));
+  reply->Release();
+  responder.StopThread();
+}
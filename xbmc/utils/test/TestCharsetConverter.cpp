@@ -25,6 +25,9 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 #if 0
 static const uint16_t refutf16LE1[] = { 0xff54, 0xff45, 0xff53, 0xff54,
                                         0xff3f, 0xff55, 0xff54, 0xff46,
@@ -411,3 +414,100 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_NonAscii)
+{
+  // 2, 3 and 4 byte sequences mixed with runs of ASCII longer than a block
+  refstra1 = "caf\xC3\xA9 \xE2\x82\xAC 0123456789abcdefghijklmnop \xF0\x9F\x90\xAD";
+  std::u32string utf32;
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(refstra1, utf32));
+  EXPECT_EQ(U"caf\u00E9 \u20AC 0123456789abcdefghijklmnop \U0001F42D", utf32);
+
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, varstra1));
+  EXPECT_EQ(refstra1, varstra1);
+
+  varstrw1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf8ToW(refstra1, varstrw1, false, false, false));
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.wToUTF8(varstrw1, varstra1));
+  EXPECT_EQ(refstra1, varstra1);
+}
+
+TEST_F(TestCharsetConverter, utf8ToUtf32_Invalid)
+{
+  // truncated sequence, encoded surrogate and code point above U+10FFFF
+  refstra1 = "ab\xC3(cd\xED\xA0\x80" "e\xF4\x90\x80\x80" "f\xE2\x82";
+  std::u32string utf32;
+  EXPECT_FALSE(g_charsetConverter.utf8ToUtf32(refstra1, utf32, true));
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(refstra1, utf32, false));
+  EXPECT_EQ(U"ab(cdef", utf32);
+}
+
+TEST_F(TestCharsetConverter, utf16ToUTF8)
+{
+  const std::u16string utf16LE = { u'a', 0x00E9, 0x20AC, 0xD83D, 0xDC2D };
+  std::u16string utf16BE;
+  for (char16_t c : utf16LE)
+    utf16BE.push_back(static_cast<char16_t>(((c & 0xFF) << 8) | (c >> 8)));
+
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(utf16LE, varstra1));
+  EXPECT_EQ("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x90\xAD", varstra1);
+
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf16BEtoUTF8(utf16BE, varstra1));
+  EXPECT_EQ("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x90\xAD", varstra1);
+}
+
+TEST_F(TestCharsetConverter, ConcurrentConversions)
+{
+  // legacy charsets use a converter per thread, so the results must not interfere
+  const std::string latin1 = "caf\xE9 cr\xE8me br\xFBl\xE9" "e";
+  const std::string utf8 = "caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e";
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4, 0);
+  for (size_t t = 0; t < failures.size(); t++)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (int i = 0; i < 2000; i++)
+      {
+        std::string converted;
+        std::u32string utf32;
+        if (!g_charsetConverter.ToUtf8("ISO-8859-1", latin1, converted) || converted != utf8)
+          failures[t]++;
+        if (!g_charsetConverter.utf8ToUtf32(utf8, utf32) || utf32.length() != latin1.length())
+          failures[t]++;
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int failed : failures)
+    EXPECT_EQ(0, failed);
+}
+
+TEST_F(TestCharsetConverter, LongText)
+{
+  // mostly ASCII text with some accents and CJK, like typical media labels
+  std::string utf8;
+  for (int i = 0; i < 1000; i++)
+    utf8 += "The Movie Title (2017) - S01E02 caf\xC3\xA9 \xE6\x97\xA5\xE6\x9C\xAC\n";
+
+  std::u32string utf32;
+  std::wstring wide;
+  std::string back;
+
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(utf8, utf32));
+  EXPECT_EQ(1000u * 40, utf32.length());
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(utf32, back));
+  EXPECT_EQ(utf8, back);
+
+  EXPECT_TRUE(g_charsetConverter.utf8ToW(utf8, wide, true, false, false));
+  EXPECT_FALSE(wide.empty());
+
+  EXPECT_TRUE(g_charsetConverter.ToUtf8("ISO-8859-1", "The Movie Title (2017) caf\xE9", back));
+  EXPECT_EQ("The Movie Title (2017) caf\xC3\xA9", back);
+}
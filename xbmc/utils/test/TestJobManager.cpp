@@ -55,6 +55,7 @@ protected:
     /* Always cancel jobs test completion */
     CJobManager::GetInstance().CancelJobs();
     CJobManager::GetInstance().Restart();
+    CJobManager::GetInstance().SetWorkStealing(0);
   }
 };
 
@@ -183,3 +184,82 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+TEST_F(TestJobManager, WorkStealingCancelJob)
+{
+  CJobManager::GetInstance().SetWorkStealing(4);
+  EXPECT_TRUE(CJobManager::GetInstance().IsWorkStealing());
+
+  cancelled = false;
+  unsigned int id = CJobManager::GetInstance().AddJob(new DummyJob(), NULL);
+  EXPECT_NE(0U, id);
+  Sleep(50);
+  CJobManager::GetInstance().CancelJob(id);
+  Sleep(100);
+  EXPECT_TRUE(cancelled);
+}
+
+TEST_F(TestJobManager, WorkStealingPauseLowPriorityJob)
+{
+  CJobManager::GetInstance().SetWorkStealing(4);
+
+  JobControlPackage package;
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_LOW_PAUSABLE, package));
+
+  EXPECT_TRUE(CJobManager::GetInstance().IsProcessing(CJob::PRIORITY_LOW_PAUSABLE));
+  EXPECT_EQ(1, CJobManager::GetInstance().IsProcessing("BroadcastingJob"));
+  CJobManager::GetInstance().PauseJobs();
+  EXPECT_FALSE(CJobManager::GetInstance().IsProcessing(CJob::PRIORITY_LOW_PAUSABLE));
+  CJobManager::GetInstance().UnPauseJobs();
+  EXPECT_TRUE(CJobManager::GetInstance().IsProcessing(CJob::PRIORITY_LOW_PAUSABLE));
+
+  job->FinishAndStopBlocking();
+}
+
+TEST_F(TestJobManager, WorkStealingJobQueue)
+{
+  CJobManager::GetInstance().SetWorkStealing(4);
+
+  std::atomic<int> done(0);
+  CJobQueue queue(false, 2, CJob::PRIORITY_NORMAL);
+  for (int i = 0; i < 100; i++)
+    queue.Submit([&done]() { done++; });
+
+  for (int i = 0; i < 500 && done < 100; i++)
+    Sleep(10);
+  EXPECT_EQ(100, done);
+}
+
+TEST_F(TestJobManager, WorkStealingCompletesJobs)
+{
+  for (unsigned int workers : { 0, 1, 4, 16 })
+  {
+    CJobManager::GetInstance().SetWorkStealing(workers);
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 1000; i++)
+      CJobManager::GetInstance().Submit([&done]() { done++; }, CJob::PRIORITY_HIGH);
+
+    for (int i = 0; i < 500 && done < 1000; i++)
+      Sleep(10);
+    EXPECT_EQ(1000, done) << workers << " workers";
+  }
+}
+
+TEST_F(TestJobManager, WorkStealingUnPauseWakesWorkers)
+{
+  CJobManager::GetInstance().SetWorkStealing(4);
+
+  std::atomic<int> done(0);
+  CJobManager::GetInstance().PauseJobs();
+  for (int i = 0; i < 10; i++)
+    CJobManager::GetInstance().Submit([&done]() { done++; }, CJob::PRIORITY_LOW_PAUSABLE);
+  Sleep(100);
+  EXPECT_EQ(0, done);
+
+  // well before the 30 seconds an idle worker sleeps
+  CJobManager::GetInstance().UnPauseJobs();
+  for (int i = 0; i < 200 && done < 10; i++)
+    Sleep(10);
+  EXPECT_EQ(10, done);
+}
@@ -133,3 +133,81 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)5, fields.size());
 }
+
+TEST(TestSortUtils, Sort_Typed)
+{
+  DatabaseResults items;
+  const double ratings[] = { 7.5, 8.25, 7.5, 10.0, 2.0, 8.25 };
+  const char *labels[] = { "b", "item 10", "a", "c", "d", "item 9" };
+  for (int i = 0; i < 6; i++)
+  {
+    DatabaseResult item;
+    item[FieldId] = i;
+    item[FieldRating] = ratings[i];
+    item[FieldLabel] = labels[i];
+    item[FieldFolder] = i == 4;
+    items.push_back(item);
+  }
+
+  // the rating is compared numerically, the label alphanumerically
+  DatabaseResults sorted = items;
+  SortUtils::Sort(SortByRating, SortOrderDescending, SortAttributeNone, sorted);
+  ASSERT_EQ(6U, sorted.size());
+  const int expected[] = { 4, 3, 1, 5, 0, 2 };
+  for (int i = 0; i < 6; i++)
+    EXPECT_EQ(expected[i], sorted[i][FieldId].asInteger());
+
+  // only the requested part is returned
+  sorted = items;
+  SortUtils::Sort(SortByRating, SortOrderDescending, SortAttributeIgnoreFolders, sorted, 4, 1);
+  ASSERT_EQ(3U, sorted.size());
+  EXPECT_EQ(1, sorted[0][FieldId].asInteger());
+  EXPECT_EQ(5, sorted[1][FieldId].asInteger());
+  EXPECT_EQ(0, sorted[2][FieldId].asInteger());
+
+  // ties keep their order
+  SortItems sortItems;
+  for (int i = 0; i < 6; i++)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldId] = i;
+    (*item)[FieldSize] = i % 2;
+    sortItems.push_back(item);
+  }
+  SortUtils::Sort(SortBySize, SortOrderAscending, SortAttributeNone, sortItems, 4);
+  ASSERT_EQ(4U, sortItems.size());
+  const int expectedBySize[] = { 0, 2, 4, 1 };
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(expectedBySize[i], sortItems[i]->at(FieldId).asInteger());
+  EXPECT_EQ(L"1", sortItems[3]->at(FieldSort).asWideString());
+}
+
+TEST(TestSortUtils, Sort_Limited)
+{
+  const int count = 1000;
+  DatabaseResults movies;
+  movies.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    DatabaseResult movie;
+    movie[FieldId] = i;
+    movie[FieldLabel] = "Movie " + std::to_string((i * 7919) % count);
+    movie[FieldRating] = ((i * 31) % 100) / 10.0;
+    movie[FieldSize] = (int64_t)((i * 104729) % count) * 1024;
+    movies.push_back(movie);
+  }
+
+  // a limited sort returns the start of the full sort, ties included
+  for (SortBy sortBy : { SortBySize, SortByRating, SortByLabel })
+  {
+    DatabaseResults all = movies;
+    SortUtils::Sort(sortBy, SortOrderDescending, SortAttributeNone, all);
+    ASSERT_EQ(movies.size(), all.size());
+
+    DatabaseResults limited = movies;
+    SortUtils::Sort(sortBy, SortOrderDescending, SortAttributeNone, limited, 50);
+    ASSERT_EQ(50U, limited.size());
+    for (int i = 0; i < 50; i++)
+      EXPECT_EQ(all[i][FieldId].asInteger(), limited[i][FieldId].asInteger()) << "sort " << sortBy << " item " << i;
+  }
+}
@@ -30,6 +30,9 @@
 
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
+
 class Testlog : public testing::Test
 {
 protected:
@@ -151,3 +154,47 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, Threads)
+{
+  std::string logfile, logstring;
+  char buf[4096];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+
+  const int threadCount = 8;
+  const int linesPerThread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([t]()
+    {
+      for (int i = 0; i < linesPerThread; i++)
+        CLog::Log(LOGDEBUG, "thread %d line %d", t, i);
+      // errors are never dropped, so these mark that every thread got through
+      CLog::Log(LOGERROR, "thread %d done", t);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  for (int t = 0; t < threadCount; t++)
+    EXPECT_NE(std::string::npos, logstring.find(StringUtils::Format("ERROR: thread %d done", t)));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
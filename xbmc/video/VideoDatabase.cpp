@@ -200,6 +200,16 @@ void CVideoDatabase::CreateTables()
 
   CLog::Log(LOGINFO, "create uniqueid table");
   m_pDS->exec("CREATE TABLE uniqueid (uniqueid_id INTEGER PRIMARY KEY, media_id INTEGER, media_type TEXT, value TEXT, type TEXT)");
+
+  CreateSearchTables();
+}
+
+void CVideoDatabase::CreateSearchTables()
+{
+  CreateSearchTable("moviesearch", "movie", "idMovie", StringUtils::Format("c%02d", VIDEODB_ID_TITLE));
+  CreateSearchTable("tvshowsearch", "tvshow", "idShow", StringUtils::Format("c%02d", VIDEODB_ID_TV_TITLE));
+  CreateSearchTable("episodesearch", "episode", "idEpisode", StringUtils::Format("c%02d", VIDEODB_ID_EPISODE_TITLE));
+  CreateSearchTable("musicvideosearch", "musicvideo", "idMVideo", StringUtils::Format("c%02d", VIDEODB_ID_MUSICVIDEO_TITLE));
 }
 
 void CVideoDatabase::CreateLinkIndex(const char *table)
@@ -341,6 +351,11 @@ void CVideoDatabase::CreateAnalytics()
               "DELETE FROM streamdetails WHERE idFile=old.idFile; "
               "END");
 
+  CreateSearchTriggers("moviesearch", "movie", "idMovie", StringUtils::Format("c%02d", VIDEODB_ID_TITLE));
+  CreateSearchTriggers("tvshowsearch", "tvshow", "idShow", StringUtils::Format("c%02d", VIDEODB_ID_TV_TITLE));
+  CreateSearchTriggers("episodesearch", "episode", "idEpisode", StringUtils::Format("c%02d", VIDEODB_ID_EPISODE_TITLE));
+  CreateSearchTriggers("musicvideosearch", "musicvideo", "idMVideo", StringUtils::Format("c%02d", VIDEODB_ID_MUSICVIDEO_TITLE));
+
   CreateViews();
 }
 
@@ -876,9 +891,8 @@ int CVideoDatabase::AddFile(const std::string& strFileNameAndPath)
     if (idPath < 0)
       return -1;
 
-    std::string strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-
-    m_pDS->query(strSQL);
+    strSQL = "select idFile from files where strFileName=? and idPath=?";
+    m_pDS->query(strSQL, { field_value(strFileName), field_value(idPath) });
     if (m_pDS->num_rows() > 0)
     {
       idFile = m_pDS->fv("idFile").get_asInt() ;
@@ -887,8 +901,8 @@ int CVideoDatabase::AddFile(const std::string& strFileNameAndPath)
     }
     m_pDS->close();
 
-    strSQL=PrepareSQL("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, strFileName.c_str());
-    m_pDS->exec(strSQL);
+    strSQL = "insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)";
+    m_pDS->exec(strSQL, { field_value(idPath), field_value(strFileName) });
     idFile = (int)m_pDS->lastinsertid();
     return idFile;
   }
@@ -3711,10 +3725,65 @@ bool CVideoDatabase::GetStreamDetails(CFileItem& item)
   return GetStreamDetails(*item.GetVideoInfoTag());
 }
 
+static bool AddStreamDetail(dbiplus::Dataset& ds, CStreamDetails& details)
+{
+  CStreamDetail::StreamType e = (CStreamDetail::StreamType)ds.fv(1).get_asInt();
+  switch (e)
+  {
+  case CStreamDetail::VIDEO:
+    {
+      CStreamDetailVideo *p = new CStreamDetailVideo();
+      p->m_strCodec = ds.fv(2).get_asString();
+      p->m_fAspect = ds.fv(3).get_asFloat();
+      p->m_iWidth = ds.fv(4).get_asInt();
+      p->m_iHeight = ds.fv(5).get_asInt();
+      p->m_iDuration = ds.fv(10).get_asInt();
+      p->m_strStereoMode = ds.fv(11).get_asString();
+      p->m_strLanguage = ds.fv(12).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  case CStreamDetail::AUDIO:
+    {
+      CStreamDetailAudio *p = new CStreamDetailAudio();
+      p->m_strCodec = ds.fv(6).get_asString();
+      if (ds.fv(7).get_isNull())
+        p->m_iChannels = -1;
+      else
+        p->m_iChannels = ds.fv(7).get_asInt();
+      p->m_strLanguage = ds.fv(8).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  case CStreamDetail::SUBTITLE:
+    {
+      CStreamDetailSubtitle *p = new CStreamDetailSubtitle();
+      p->m_strLanguage = ds.fv(9).get_asString();
+      details.AddStream(p);
+      return true;
+    }
+  }
+  return false;
+}
+
+static std::string JoinIds(const std::vector<int>& ids)
+{
+  std::string result;
+  for (std::vector<int>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+  {
+    if (!result.empty())
+      result += ",";
+    result += StringUtils::Format("%i", *it);
+  }
+  return result;
+}
+
 bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 {
   if (tag.m_iFileId < 0)
     return false;
+  if (NULL == m_pDB.get())
+    return false;
 
   bool retVal = false;
 
@@ -3724,50 +3793,12 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
   std::unique_ptr<Dataset> pDS(m_pDB->CreateDataset());
   try
   {
-    std::string strSQL = PrepareSQL("SELECT * FROM streamdetails WHERE idFile = %i", tag.m_iFileId);
-    pDS->query(strSQL);
+    pDS->query("SELECT * FROM streamdetails WHERE idFile = ?", { field_value(tag.m_iFileId) });
 
     while (!pDS->eof())
     {
-      CStreamDetail::StreamType e = (CStreamDetail::StreamType)pDS->fv(1).get_asInt();
-      switch (e)
-      {
-      case CStreamDetail::VIDEO:
-        {
-          CStreamDetailVideo *p = new CStreamDetailVideo();
-          p->m_strCodec = pDS->fv(2).get_asString();
-          p->m_fAspect = pDS->fv(3).get_asFloat();
-          p->m_iWidth = pDS->fv(4).get_asInt();
-          p->m_iHeight = pDS->fv(5).get_asInt();
-          p->m_iDuration = pDS->fv(10).get_asInt();
-          p->m_strStereoMode = pDS->fv(11).get_asString();
-          p->m_strLanguage = pDS->fv(12).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      case CStreamDetail::AUDIO:
-        {
-          CStreamDetailAudio *p = new CStreamDetailAudio();
-          p->m_strCodec = pDS->fv(6).get_asString();
-          if (pDS->fv(7).get_isNull())
-            p->m_iChannels = -1;
-          else
-            p->m_iChannels = pDS->fv(7).get_asInt();
-          p->m_strLanguage = pDS->fv(8).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      case CStreamDetail::SUBTITLE:
-        {
-          CStreamDetailSubtitle *p = new CStreamDetailSubtitle();
-          p->m_strLanguage = pDS->fv(9).get_asString();
-          details.AddStream(p);
-          retVal = true;
-          break;
-        }
-      }
+      if (AddStreamDetail(*pDS, details))
+        retVal = true;
 
       pDS->next();
     }
@@ -3785,6 +3816,38 @@ bool CVideoDatabase::GetStreamDetails(CVideoInfoTag& tag) const
 
   return retVal;
 }
+
+bool CVideoDatabase::GetStreamDetails(const std::vector<int>& fileIds, std::map<int, CStreamDetails>& details) const
+{
+  if (fileIds.empty())
+    return true;
+  if (NULL == m_pDB.get())
+    return false;
+
+  std::unique_ptr<Dataset> pDS(m_pDB->CreateDataset());
+  try
+  {
+    for (std::vector<int>::const_iterator it = fileIds.begin(); it != fileIds.end(); ++it)
+      details[*it].Reset();
+
+    pDS->query("SELECT * FROM streamdetails WHERE idFile IN (" + JoinIds(fileIds) + ")");
+    while (!pDS->eof())
+    {
+      AddStreamDetail(*pDS, details[pDS->fv(0).get_asInt()]);
+      pDS->next();
+    }
+    pDS->close();
+
+    for (std::vector<int>::const_iterator it = fileIds.begin(); it != fileIds.end(); ++it)
+      details[*it].DetermineBestStreams();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, JoinIds(fileIds).c_str());
+  }
+  return false;
+}
  
 bool CVideoDatabase::GetResumePoint(CVideoInfoTag& tag)
 {
@@ -4371,24 +4434,21 @@ void CVideoDatabase::SetArtForItem(int mediaId, const MediaType &mediaType, cons
     if (artType.find('.') != std::string::npos)
       return;
 
-    std::string sql = PrepareSQL("SELECT art_id,url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-    m_pDS->query(sql);
+    m_pDS->query("SELECT art_id,url FROM art WHERE media_id=? AND media_type=? AND type=?",
+                 { field_value(mediaId), field_value(mediaType), field_value(artType) });
     if (!m_pDS->eof())
     { // update
       int artId = m_pDS->fv(0).get_asInt();
       std::string oldUrl = m_pDS->fv(1).get_asString();
       m_pDS->close();
       if (oldUrl != url)
-      {
-        sql = PrepareSQL("UPDATE art SET url='%s' where art_id=%d", url.c_str(), artId);
-        m_pDS->exec(sql);
-      }
+        m_pDS->exec("UPDATE art SET url=? where art_id=?", { field_value(url), field_value(artId) });
     }
     else
     { // insert
       m_pDS->close();
-      sql = PrepareSQL("INSERT INTO art(media_id, media_type, type, url) VALUES (%d, '%s', '%s', '%s')", mediaId, mediaType.c_str(), artType.c_str(), url.c_str());
-      m_pDS->exec(sql);
+      m_pDS->exec("INSERT INTO art(media_id, media_type, type, url) VALUES (?, ?, ?, ?)",
+                  { field_value(mediaId), field_value(mediaType), field_value(artType), field_value(url) });
     }
   }
   catch (...)
@@ -4404,8 +4464,7 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, std:
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
 
-    std::string sql = PrepareSQL("SELECT type,url FROM art WHERE media_id=%i AND media_type='%s'", mediaId, mediaType.c_str());
-    m_pDS2->query(sql);
+    m_pDS2->query("SELECT type,url FROM art WHERE media_id=? AND media_type=?", { field_value(mediaId), field_value(mediaType) });
     while (!m_pDS2->eof())
     {
       art.insert(make_pair(m_pDS2->fv(0).get_asString(), m_pDS2->fv(1).get_asString()));
@@ -4421,10 +4480,39 @@ bool CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, std:
   return false;
 }
 
+bool CVideoDatabase::GetArtForItems(const std::vector<int> &mediaIds, const MediaType &mediaType, std::map<int, std::map<std::string, std::string> > &art)
+{
+  if (mediaIds.empty())
+    return true;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS2.get()) return false; // using dataset 2 as we're likely called in loops on dataset 1
+
+    for (std::vector<int>::const_iterator it = mediaIds.begin(); it != mediaIds.end(); ++it)
+      art[*it];
+
+    m_pDS2->query("SELECT media_id,type,url FROM art WHERE media_type=? AND media_id IN (" + JoinIds(mediaIds) + ")", { field_value(mediaType) });
+    while (!m_pDS2->eof())
+    {
+      art[m_pDS2->fv(0).get_asInt()].insert(make_pair(m_pDS2->fv(1).get_asString(), m_pDS2->fv(2).get_asString()));
+      m_pDS2->next();
+    }
+    m_pDS2->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, mediaType.c_str());
+  }
+  return false;
+}
+
 std::string CVideoDatabase::GetArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType)
 {
-  std::string query = PrepareSQL("SELECT url FROM art WHERE media_id=%i AND media_type='%s' AND type='%s'", mediaId, mediaType.c_str(), artType.c_str());
-  return GetSingleValue(query, m_pDS2);
+  return GetSingleValue("SELECT url FROM art WHERE media_id=? AND media_type=? AND type=?",
+                        { field_value(mediaId), field_value(mediaType), field_value(artType) }, m_pDS2);
 }
 
 bool CVideoDatabase::RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType)
@@ -5253,11 +5341,17 @@ void CVideoDatabase::UpdateTables(int iVersion)
     m_pDS->exec("DROP TABLE settings");
     m_pDS->exec("ALTER TABLE settingsnew RENAME TO settings");
   }
+
+  if (iVersion < 110)
+  {
+    // full text search tables for the library search, filled when the analytics are created
+    CreateSearchTables();
+  }
 }
 
 int CVideoDatabase::GetSchemaVersion() const
 {
-  return 109;
+  return 110;
 }
 
 bool CVideoDatabase::LookupByFolders(const std::string &path, bool shows)
@@ -6744,6 +6838,49 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
+    auto addMovie = [&](const dbiplus::sql_record* const record)
+    {
+      CVideoInfoTag movie = GetDetailsForMovie(record, getDetails);
+      if (m_profileManager.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
+          g_passwordManager.bMasterUser                                   ||
+          g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, *CMediaSourceSettings::GetInstance().GetSources("video")))
+      {
+        CFileItemPtr pItem(new CFileItem(movie));
+
+        CVideoDbUrl itemUrl = videoUrl;
+        std::string path = StringUtils::Format("%i", movie.m_iDbId);
+        itemUrl.AppendPath(path);
+        pItem->SetPath(itemUrl.ToString());
+
+        pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.GetPlayCount() > 0);
+        items.Add(pItem);
+      }
+    };
+
+    // without sorting the rows are used in the order they are returned (any
+    // limit is applied in SQL), so build the items while reading them
+    if (sortDescription.sortBy == SortByNone)
+    {
+      unsigned int time = XbmcThreads::SystemClockMillis();
+      if (!m_pDS->stream_query(strSQL))
+        return false;
+
+      int iRowsFound = 0;
+      while (!m_pDS->eof())
+      {
+        addMovie(m_pDS->get_sql_record());
+        iRowsFound++;
+        m_pDS->next();
+      }
+      m_pDS->close();
+      CLog::Log(LOGDEBUG, LOGDATABASE, "%s took %d ms for %d items query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, iRowsFound, strSQL.c_str());
+
+      if (total < iRowsFound)
+        total = iRowsFound;
+      items.SetProperty("total", total);
+      return true;
+    }
+
     int iRowsFound = RunQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
@@ -6765,23 +6902,7 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
     for (const auto &i : results)
     {
       unsigned int targetRow = (unsigned int)i.at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-
-      CVideoInfoTag movie = GetDetailsForMovie(record, getDetails);
-      if (m_profileManager.GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
-          g_passwordManager.bMasterUser                                   ||
-          g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, *CMediaSourceSettings::GetInstance().GetSources("video")))
-      {
-        CFileItemPtr pItem(new CFileItem(movie));
-
-        CVideoDbUrl itemUrl = videoUrl;
-        std::string path = StringUtils::Format("%i", movie.m_iDbId);
-        itemUrl.AppendPath(path);
-        pItem->SetPath(itemUrl.ToString());
-
-        pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.GetPlayCount() > 0);
-        items.Add(pItem);
-      }
+      addMovie(data.at(targetRow));
     }
 
     // cleanup
@@ -7995,10 +8116,14 @@ void CVideoDatabase::GetMoviesByName(const std::string& strSearch, CFileItemList
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    Filter filter;
+    if (!GetSearchFilter("moviesearch", "movie.idMovie", strSearch, filter))
+      filter.AppendWhere(PrepareSQL("movie.c%02d LIKE '%%%s%%'", VIDEODB_ID_TITLE, strSearch.c_str()));
+
     if (m_profileManager.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("SELECT movie.idMovie, movie.c%02d, path.strPath, movie.idSet FROM movie INNER JOIN files ON files.idFile=movie.idFile INNER JOIN path ON path.idPath=files.idPath WHERE movie.c%02d LIKE '%%%s%%'", VIDEODB_ID_TITLE, VIDEODB_ID_TITLE, strSearch.c_str());
+      BuildSQL(PrepareSQL("SELECT movie.idMovie, movie.c%02d, path.strPath, movie.idSet FROM movie INNER JOIN files ON files.idFile=movie.idFile INNER JOIN path ON path.idPath=files.idPath ", VIDEODB_ID_TITLE), filter, strSQL);
     else
-      strSQL = PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from movie where movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
+      BuildSQL(PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from movie ", VIDEODB_ID_TITLE), filter, strSQL);
     m_pDS->query( strSQL );
 
     while (!m_pDS->eof())
@@ -8040,10 +8165,14 @@ void CVideoDatabase::GetTvShowsByName(const std::string& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    Filter filter;
+    if (!GetSearchFilter("tvshowsearch", "tvshow.idShow", strSearch, filter))
+      filter.AppendWhere(PrepareSQL("tvshow.c%02d LIKE '%%%s%%'", VIDEODB_ID_TV_TITLE, strSearch.c_str()));
+
     if (m_profileManager.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("SELECT tvshow.idShow, tvshow.c%02d, path.strPath FROM tvshow INNER JOIN tvshowlinkpath ON tvshowlinkpath.idShow=tvshow.idShow INNER JOIN path ON path.idPath=tvshowlinkpath.idPath WHERE tvshow.c%02d LIKE '%%%s%%'", VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_TITLE, strSearch.c_str());
+      BuildSQL(PrepareSQL("SELECT tvshow.idShow, tvshow.c%02d, path.strPath FROM tvshow INNER JOIN tvshowlinkpath ON tvshowlinkpath.idShow=tvshow.idShow INNER JOIN path ON path.idPath=tvshowlinkpath.idPath ", VIDEODB_ID_TV_TITLE), filter, strSQL);
     else
-      strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d from tvshow where tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
+      BuildSQL(PrepareSQL("select tvshow.idShow,tvshow.c%02d from tvshow ", VIDEODB_ID_TV_TITLE), filter, strSQL);
     m_pDS->query( strSQL );
 
     while (!m_pDS->eof())
@@ -8081,10 +8210,14 @@ void CVideoDatabase::GetEpisodesByName(const std::string& strSearch, CFileItemLi
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    Filter filter;
+    if (!GetSearchFilter("episodesearch", "episode.idEpisode", strSearch, filter))
+      filter.AppendWhere(PrepareSQL("episode.c%02d LIKE '%%%s%%'", VIDEODB_ID_EPISODE_TITLE, strSearch.c_str()));
+
     if (m_profileManager.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("SELECT episode.idEpisode, episode.c%02d, episode.c%02d, episode.idShow, tvshow.c%02d, path.strPath FROM episode INNER JOIN tvshow ON tvshow.idShow=episode.idShow INNER JOIN files ON files.idFile=episode.idFile INNER JOIN path ON path.idPath=files.idPath WHERE episode.c%02d LIKE '%%%s%%'", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE, VIDEODB_ID_EPISODE_TITLE, strSearch.c_str());
+      BuildSQL(PrepareSQL("SELECT episode.idEpisode, episode.c%02d, episode.c%02d, episode.idShow, tvshow.c%02d, path.strPath FROM episode INNER JOIN tvshow ON tvshow.idShow=episode.idShow INNER JOIN files ON files.idFile=episode.idFile INNER JOIN path ON path.idPath=files.idPath ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE), filter, strSQL);
     else
-      strSQL = PrepareSQL("SELECT episode.idEpisode, episode.c%02d, episode.c%02d, episode.idShow, tvshow.c%02d FROM episode INNER JOIN tvshow ON tvshow.idShow=episode.idShow WHERE episode.c%02d like '%%%s%%'", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE, VIDEODB_ID_EPISODE_TITLE, strSearch.c_str());
+      BuildSQL(PrepareSQL("SELECT episode.idEpisode, episode.c%02d, episode.c%02d, episode.idShow, tvshow.c%02d FROM episode INNER JOIN tvshow ON tvshow.idShow=episode.idShow ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE), filter, strSQL);
     m_pDS->query( strSQL );
 
     while (!m_pDS->eof())
@@ -8124,10 +8257,14 @@ void CVideoDatabase::GetMusicVideosByName(const std::string& strSearch, CFileIte
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    Filter filter;
+    if (!GetSearchFilter("musicvideosearch", "musicvideo.idMVideo", strSearch, filter))
+      filter.AppendWhere(PrepareSQL("musicvideo.c%02d LIKE '%%%s%%'", VIDEODB_ID_MUSICVIDEO_TITLE, strSearch.c_str()));
+
     if (m_profileManager.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("SELECT musicvideo.idMVideo, musicvideo.c%02d, path.strPath FROM musicvideo INNER JOIN files ON files.idFile=musicvideo.idFile INNER JOIN path ON path.idPath=files.idPath WHERE musicvideo.c%02d LIKE '%%%s%%'", VIDEODB_ID_MUSICVIDEO_TITLE, VIDEODB_ID_MUSICVIDEO_TITLE, strSearch.c_str());
+      BuildSQL(PrepareSQL("SELECT musicvideo.idMVideo, musicvideo.c%02d, path.strPath FROM musicvideo INNER JOIN files ON files.idFile=musicvideo.idFile INNER JOIN path ON path.idPath=files.idPath ", VIDEODB_ID_MUSICVIDEO_TITLE), filter, strSQL);
     else
-      strSQL = PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d from musicvideo where musicvideo.c%02d like '%%%s%%'",VIDEODB_ID_MUSICVIDEO_TITLE,VIDEODB_ID_MUSICVIDEO_TITLE,strSearch.c_str());
+      BuildSQL(PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d from musicvideo ", VIDEODB_ID_MUSICVIDEO_TITLE), filter, strSQL);
     m_pDS->query( strSQL );
 
     while (!m_pDS->eof())
@@ -9601,7 +9738,12 @@ void CVideoDatabase::InvalidatePathHash(const std::string& strPath)
 bool CVideoDatabase::CommitTransaction()
 {
   if (CDatabase::CommitTransaction())
-  { // number of items in the db has likely changed, so recalculate
+  {
+    // recalculated once the whole batch is committed
+    if (InBatchTransaction())
+      return true;
+
+    // number of items in the db has likely changed, so recalculate
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, HasContent(VIDEODB_CONTENT_MOVIES));
     g_infoManager.SetLibraryBool(LIBRARY_HAS_TVSHOWS, HasContent(VIDEODB_CONTENT_TVSHOWS));
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSICVIDEOS, HasContent(VIDEODB_CONTENT_MUSICVIDEOS));
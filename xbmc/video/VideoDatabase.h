@@ -619,6 +619,13 @@ public:
   bool GetResumePoint(CVideoInfoTag& tag);
   bool GetStreamDetails(CFileItem& item);
   bool GetStreamDetails(CVideoInfoTag& tag) const;
+
+  /*! \brief Fetch the stream details of several files at once.
+   \param fileIds ids of the files in the files table.
+   \param details [out] the stream details of every file, empty for files without stream details.
+   \return true if the query succeeded, false otherwise.
+   */
+  bool GetStreamDetails(const std::vector<int>& fileIds, std::map<int, CStreamDetails>& details) const;
   CVideoInfoTag GetDetailsByTypeAndId(VIDEODB_CONTENT_TYPE type, int id);
 
   // scraper settings
@@ -834,6 +841,14 @@ public:
   void SetArtForItem(int mediaId, const MediaType &mediaType, const std::map<std::string, std::string> &art);
   bool GetArtForItem(int mediaId, const MediaType &mediaType, std::map<std::string, std::string> &art);
   std::string GetArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType);
+
+  /*! \brief Fetch the art of several items of the same media type at once.
+   \param mediaIds ids of the items.
+   \param mediaType the type of the items.
+   \param art [out] the <type, url> art map of every item, empty for items without art.
+   \return true if the query succeeded, false otherwise.
+   */
+  bool GetArtForItems(const std::vector<int> &mediaIds, const MediaType &mediaType, std::map<int, std::map<std::string, std::string> > &art);
   bool RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::string &artType);
   bool RemoveArtForItem(int mediaId, const MediaType &mediaType, const std::set<std::string> &artTypes);
   bool GetTvShowSeasons(int showId, std::map<int, int> &seasons);
@@ -945,6 +960,10 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full text search tables for movie, tvshow, episode and music video titles
+   */
+  void CreateSearchTables();
+
   /*! \brief Helper to get a database id given a query.
    Returns an integer, -1 if not found, and greater than 0 if found.
    \param query the SQL that will retrieve a database id.
@@ -20,9 +20,13 @@
 
 #include "VideoInfoScanner.h"
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <utility>
 
 #include "ServiceBroker.h"
+#include "addons/AddonManager.h"
 #include "dialogs/GUIDialogExtendedProgressBar.h"
 #include "dialogs/GUIDialogProgress.h"
 #include "events/EventLog.h"
@@ -44,10 +48,13 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "TextureCache.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "URL.h"
 #include "Util.h"
 #include "utils/FileExtensionProvider.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/md5.h"
 #include "utils/RegExp.h"
@@ -1485,136 +1492,44 @@ namespace VIDEO
     return fanart;
   }
 
-  CInfoScanner::INFO_RET
-  CVideoInfoScanner::OnProcessSeriesFolder(EPISODELIST& files,
-                                           const ADDON::ScraperPtr &scraper,
-                                           bool useLocal,
-                                           const CVideoInfoTag& showInfo,
-                                           CGUIDialogProgress* pDlgProgress /* = NULL */)
+  namespace
   {
-    if (pDlgProgress)
-    {
-      pDlgProgress->SetLine(1, CVariant{showInfo.m_strTitle});
-      pDlgProgress->SetLine(2, CVariant{20361});
-      pDlgProgress->SetPercentage(0);
-      pDlgProgress->ShowProgressBar(true);
-      pDlgProgress->Progress();
-    }
-
-    EPISODELIST episodes;
-    bool hasEpisodeGuide = false;
-
-    int iMax = files.size();
-    int iCurr = 1;
-    for (EPISODELIST::iterator file = files.begin(); file != files.end(); ++file)
+    /*! \brief Find the entry of the episode guide that matches an episode file.
+     \param episodes the episode guide, titles of candidates get lowercased.
+     \param file the episode file to look up.
+     \param showTitle title of the show, for logging.
+     \param match the matching guide entry.
+     \return true if a match was found, false otherwise.
+     */
+    bool FindEpisodeInGuide(EPISODELIST& episodes, const EPISODE& file, const std::string& showTitle, EPISODE& match)
     {
-      if (pDlgProgress)
-      {
-        pDlgProgress->SetLine(2, CVariant{20361});
-        pDlgProgress->SetPercentage((int)((float)(iCurr++)/iMax*100));
-        pDlgProgress->Progress();
-      }
-      if (m_handle)
-        m_handle->SetPercentage(100.f*iCurr++/iMax);
-
-      if ((pDlgProgress && pDlgProgress->IsCanceled()) || m_bStop)
-        return INFO_CANCELLED;
-
-      if (m_database.GetEpisodeId(file->strPath, file->iEpisode, file->iSeason) > -1)
-      {
-        if (m_handle)
-          m_handle->SetText(g_localizeStrings.Get(20415));
-        continue;
-      }
-
-      CFileItem item;
-      item.SetPath(file->strPath);
-
-      // handle .nfo files
-      CInfoScanner::INFO_TYPE result=CInfoScanner::NO_NFO;
-      CScraperUrl scrUrl;
-      ScraperPtr info(scraper);
-      item.GetVideoInfoTag()->m_iEpisode = file->iEpisode;
-      std::unique_ptr<IVideoInfoTagLoader> loader;
-      if (useLocal)
-      {
-        loader.reset(CVideoInfoTagLoaderFactory::CreateLoader(item, info, false));
-        if (loader)
-        {
-          // no reset here on purpose
-          result = loader->Load(*item.GetVideoInfoTag(), false);
-        }
-      }
-      if (result == CInfoScanner::FULL_NFO)
-      {
-        // override with episode and season number from file if available
-        if (file->iEpisode > -1)
-        {
-          item.GetVideoInfoTag()->m_iEpisode = file->iEpisode;
-          item.GetVideoInfoTag()->m_iSeason = file->iSeason;
-        }
-        if (AddVideo(&item, CONTENT_TVSHOWS, file->isFolder, true, &showInfo) < 0)
-          return INFO_ERROR;
-        continue;
-      }
-
-      if (!hasEpisodeGuide)
-      {
-        // fetch episode guide
-        if (!showInfo.m_strEpisodeGuide.empty())
-        {
-          CScraperUrl url;
-          url.ParseEpisodeGuide(showInfo.m_strEpisodeGuide);
-
-          if (pDlgProgress)
-          {
-            pDlgProgress->SetLine(2, CVariant{20354});
-            pDlgProgress->Progress();
-          }
-
-          CVideoInfoDownloader imdb(scraper);
-          if (!imdb.GetEpisodeList(url, episodes))
-            return INFO_NOT_FOUND;
-
-          hasEpisodeGuide = true;
-        }
-      }
-
-      if (episodes.empty())
-      {
-        CLog::Log(LOGERROR, "VideoInfoScanner: Asked to lookup episode %s"
-                            " online, but we have no episode guide. Check your tvshow.nfo and make"
-                            " sure the <episodeguide> tag is in place.", CURL::GetRedacted(file->strPath).c_str());
-        continue;
-      }
-
-      EPISODE key(file->iSeason, file->iEpisode, file->iSubepisode);
-      EPISODE backupkey(file->iSeason, file->iEpisode, 0);
+      EPISODE key(file.iSeason, file.iEpisode, file.iSubepisode);
+      EPISODE backupkey(file.iSeason, file.iEpisode, 0);
       bool bFound = false;
       EPISODELIST::iterator guide = episodes.begin();
       EPISODELIST matches;
 
       for (; guide != episodes.end(); ++guide )
       {
-        if ((file->iEpisode!=-1) && (file->iSeason!=-1))
+        if ((file.iEpisode!=-1) && (file.iSeason!=-1))
         {
           if (key==*guide)
           {
             bFound = true;
             break;
           }
-          else if ((file->iSubepisode!=0) && (backupkey==*guide))
+          else if ((file.iSubepisode!=0) && (backupkey==*guide))
           {
             matches.push_back(*guide);
             continue;
           }
         }
-        if (file->cDate.IsValid() && guide->cDate.IsValid() && file->cDate==guide->cDate)
+        if (file.cDate.IsValid() && guide->cDate.IsValid() && file.cDate==guide->cDate)
         {
           matches.push_back(*guide);
           continue;
         }
-        if (!guide->cScraperUrl.strTitle.empty() && StringUtils::EqualsNoCase(guide->cScraperUrl.strTitle, file->strTitle))
+        if (!guide->cScraperUrl.strTitle.empty() && StringUtils::EqualsNoCase(guide->cScraperUrl.strTitle, file.strTitle))
         {
           bFound = true;
           break;
@@ -1629,12 +1544,12 @@ namespace VIDEO
          *
          * Otherwise, use the title to further refine the best match.
          */
-        if (matches.size() == 1 || (file->strTitle.empty() && matches.size() > 1))
+        if (matches.size() == 1 || (file.strTitle.empty() && matches.size() > 1))
         {
           guide = matches.begin();
           bFound = true;
         }
-        else if (!file->strTitle.empty())
+        else if (!file.strTitle.empty())
         {
           double minscore = 0; // Default minimum score is 0 to find whatever is the best match.
 
@@ -1655,7 +1570,7 @@ namespace VIDEO
           }
 
           double matchscore;
-          std::string loweredTitle(file->strTitle);
+          std::string loweredTitle(file.strTitle);
           StringUtils::ToLower(loweredTitle);
           int index = StringUtils::FindBestMatch(loweredTitle, titles, matchscore);
           if (index >= 0 && matchscore >= minscore)
@@ -1663,36 +1578,339 @@ namespace VIDEO
             guide = candidates->begin() + index;
             bFound = true;
             CLog::Log(LOGDEBUG,"%s fuzzy title match for show: '%s', title: '%s', match: '%s', score: %f >= %f",
-                      __FUNCTION__, showInfo.m_strTitle.c_str(), file->strTitle.c_str(), titles[index].c_str(), matchscore, minscore);
+                      __FUNCTION__, showTitle.c_str(), file.strTitle.c_str(), titles[index].c_str(), matchscore, minscore);
           }
         }
       }
 
       if (bFound)
+        match = *guide;
+      return bFound;
+    }
+
+    /*! \brief Looks up the episodes of a series folder from a pool of jobs.
+     Reading NFO files and fetching the episode guide and details only depends on the
+     files, so it is done ahead of the scanner adding the episodes to the database.
+     The jobs share this state, it outlives a cancelled scan until the last job is done.
+     */
+    class CEpisodeLookup
+    {
+    public:
+      enum STATUS
       {
-        CVideoInfoDownloader imdb(scraper);
+        PENDING,
+        FULL_NFO,
+        FOUND,
+        NO_EPISODE_GUIDE,
+        NO_MATCH,
+        EPISODE_GUIDE_FAILED,
+        DETAILS_FAILED,
+        CANCELLED
+      };
+
+      struct CEpisode
+      {
+        explicit CEpisode(const EPISODE& episode) : file(episode), status(PENDING), done(true) {}
+
+        EPISODE file;
         CFileItem item;
-        item.SetPath(file->strPath);
-        if (!imdb.GetEpisodeDetails(guide->cScraperUrl, *item.GetVideoInfoTag(), pDlgProgress))
-          return INFO_NOT_FOUND; //! @todo should we just skip to the next episode?
-          
+        STATUS status;
+        CEvent done;
+      };
+
+      CEpisodeLookup(const ScraperPtr& scraper, const CVideoInfoTag& showInfo, bool useLocal)
+        : m_scraperId(scraper->ID()),
+          m_scraperType(scraper->Type()),
+          m_content(scraper->Content()),
+          m_scraperSettings(scraper->GetPathSettings()),
+          m_showTitle(showInfo.m_strTitle),
+          m_episodeGuide(showInfo.m_strEpisodeGuide),
+          m_useLocal(useLocal),
+          m_cancelled(false),
+          m_hasEpisodeGuide(false),
+          m_episodeGuideFailed(false)
+      {
+      }
+
+      void Lookup(CEpisode& episode)
+      {
+        ScraperPtr scraper;
+        if (!m_cancelled)
+          scraper = AcquireScraper();
+
+        if (!scraper)
+          episode.status = m_cancelled ? CANCELLED : DETAILS_FAILED;
+        else
+        {
+          episode.status = Lookup(scraper, episode.file, episode.item);
+          ReleaseScraper(scraper);
+        }
+
+        episode.done.Set();
+      }
+
+      void Cancel() { m_cancelled = true; }
+
+    private:
+      STATUS Lookup(const ScraperPtr& scraper, const EPISODE& file, CFileItem& item)
+      {
+        item.SetPath(file.strPath);
+        item.GetVideoInfoTag()->m_iEpisode = file.iEpisode;
+
+        // handle .nfo files
+        if (m_useLocal)
+        {
+          ScraperPtr info(scraper);
+          std::unique_ptr<IVideoInfoTagLoader> loader(CVideoInfoTagLoaderFactory::CreateLoader(item, info, false));
+          // no reset here on purpose
+          if (loader && loader->Load(*item.GetVideoInfoTag(), false) == CInfoScanner::FULL_NFO)
+          {
+            // override with episode and season number from file if available
+            if (file.iEpisode > -1)
+            {
+              item.GetVideoInfoTag()->m_iEpisode = file.iEpisode;
+              item.GetVideoInfoTag()->m_iSeason = file.iSeason;
+            }
+            return FULL_NFO;
+          }
+        }
+
+        if (m_cancelled)
+          return CANCELLED;
+
+        EPISODE guide;
+        {
+          CSingleLock lock(m_critSection);
+          if (!m_hasEpisodeGuide && !m_episodeGuideFailed && !m_episodeGuide.empty())
+          {
+            // fetch episode guide
+            CScraperUrl url;
+            url.ParseEpisodeGuide(m_episodeGuide);
+
+            CVideoInfoDownloader imdb(scraper);
+            if (imdb.GetEpisodeList(url, m_episodes))
+              m_hasEpisodeGuide = true;
+            else
+              m_episodeGuideFailed = true;
+          }
+
+          if (m_episodeGuideFailed)
+            return EPISODE_GUIDE_FAILED;
+          if (m_episodes.empty())
+            return NO_EPISODE_GUIDE;
+          if (!FindEpisodeInGuide(m_episodes, file, m_showTitle, guide))
+            return NO_MATCH;
+        }
+
+        CVideoInfoDownloader imdb(scraper);
+        CFileItem details;
+        details.SetPath(file.strPath);
+        if (!imdb.GetEpisodeDetails(guide.cScraperUrl, *details.GetVideoInfoTag()))
+          return DETAILS_FAILED;
+
         // Only set season/epnum from filename when it is not already set by a scraper
-        if (item.GetVideoInfoTag()->m_iSeason == -1)
-          item.GetVideoInfoTag()->m_iSeason = guide->iSeason;
-        if (item.GetVideoInfoTag()->m_iEpisode == -1)
-          item.GetVideoInfoTag()->m_iEpisode = guide->iEpisode;
-          
-        if (AddVideo(&item, CONTENT_TVSHOWS, file->isFolder, useLocal, &showInfo) < 0)
-          return INFO_ERROR;
+        if (details.GetVideoInfoTag()->m_iSeason == -1)
+          details.GetVideoInfoTag()->m_iSeason = guide.iSeason;
+        if (details.GetVideoInfoTag()->m_iEpisode == -1)
+          details.GetVideoInfoTag()->m_iEpisode = guide.iEpisode;
+
+        item = details;
+        return FOUND;
       }
-      else
+
+      ScraperPtr AcquireScraper()
+      {
+        {
+          CSingleLock lock(m_critSection);
+          if (!m_idleScrapers.empty())
+          {
+            ScraperPtr scraper = m_idleScrapers.back();
+            m_idleScrapers.pop_back();
+            return scraper;
+          }
+        }
+
+        // scrapers keep the state of their parser, so every job needs an instance of its own
+        AddonPtr addon;
+        if (!CServiceBroker::GetAddonMgr().GetAddon(m_scraperId, addon, m_scraperType))
+          return ScraperPtr();
+
+        ScraperPtr scraper = std::dynamic_pointer_cast<CScraper>(addon);
+        if (!scraper || !scraper->SetPathSettings(m_content, m_scraperSettings))
+          return ScraperPtr();
+
+        return scraper;
+      }
+
+      void ReleaseScraper(const ScraperPtr& scraper)
+      {
+        CSingleLock lock(m_critSection);
+        m_idleScrapers.push_back(scraper);
+      }
+
+      const std::string m_scraperId;
+      const TYPE m_scraperType;
+      const CONTENT_TYPE m_content;
+      const std::string m_scraperSettings;
+      const std::string m_showTitle;
+      const std::string m_episodeGuide;
+      const bool m_useLocal;
+      std::atomic<bool> m_cancelled;
+
+      CCriticalSection m_critSection;
+      std::vector<ScraperPtr> m_idleScrapers;
+      bool m_hasEpisodeGuide;
+      bool m_episodeGuideFailed;
+      EPISODELIST m_episodes;
+    };
+  }
+
+  CInfoScanner::INFO_RET
+  CVideoInfoScanner::OnProcessSeriesFolder(EPISODELIST& files,
+                                           const ADDON::ScraperPtr &scraper,
+                                           bool useLocal,
+                                           const CVideoInfoTag& showInfo,
+                                           CGUIDialogProgress* pDlgProgress /* = NULL */)
+  {
+    if (pDlgProgress)
+    {
+      pDlgProgress->SetLine(1, CVariant{showInfo.m_strTitle});
+      pDlgProgress->SetLine(2, CVariant{20361});
+      pDlgProgress->SetPercentage(0);
+      pDlgProgress->ShowProgressBar(true);
+      pDlgProgress->Progress();
+    }
+
+    // the episodes are looked up in parallel, but added in the order of the files,
+    // so the library doesn't depend on which lookup finishes first
+    std::shared_ptr<CEpisodeLookup> lookup = std::make_shared<CEpisodeLookup>(scraper, showInfo, useLocal);
+    CJobQueue lookupQueue(false, g_advancedSettings.m_videoScannerThreads, CJob::PRIORITY_DEDICATED);
+    const size_t maxPending = 4 * g_advancedSettings.m_videoScannerThreads;
+    std::deque<std::shared_ptr<CEpisodeLookup::CEpisode>> pending;
+
+    INFO_RET ret = INFO_ADDED;
+    unsigned int added = 0;
+
+    int iMax = files.size();
+    int iCurr = 1;
+    EPISODELIST::iterator file = files.begin();
+    while (ret == INFO_ADDED)
+    {
+      // keep the lookups going, without getting too far ahead of the database
+      while (file != files.end() && pending.size() < maxPending)
+      {
+        if (m_database.GetEpisodeId(file->strPath, file->iEpisode, file->iSeason) > -1)
+        {
+          if (m_handle)
+          {
+            m_handle->SetText(g_localizeStrings.Get(20415));
+            m_handle->SetPercentage(100.f*iCurr/iMax);
+          }
+          iCurr++;
+          ++file;
+          continue;
+        }
+
+        std::shared_ptr<CEpisodeLookup::CEpisode> episode = std::make_shared<CEpisodeLookup::CEpisode>(*file);
+        lookupQueue.Submit([lookup, episode]() { lookup->Lookup(*episode); });
+        pending.push_back(episode);
+        ++file;
+      }
+
+      if (pending.empty())
+        break;
+
+      std::shared_ptr<CEpisodeLookup::CEpisode> episode = pending.front();
+      pending.pop_front();
+
+      if (pDlgProgress)
+      {
+        pDlgProgress->SetLine(2, CVariant{20361});
+        pDlgProgress->SetPercentage((int)((float)iCurr/iMax*100));
+        pDlgProgress->Progress();
+      }
+      if (m_handle)
+        m_handle->SetPercentage(100.f*iCurr/iMax);
+      iCurr++;
+
+      // the batch only ever spans finished lookups, the database isn't kept locked
+      // for other writers while waiting on the scraper
+      if (!episode->done.WaitMSec(0))
+        m_database.CommitBatchTransaction();
+
+      while (!episode->done.WaitMSec(100))
+      {
+        if (pDlgProgress)
+        {
+          pDlgProgress->Progress();
+          if (pDlgProgress->IsCanceled())
+            break;
+        }
+        if (m_bStop)
+          break;
+      }
+
+      if ((pDlgProgress && pDlgProgress->IsCanceled()) || m_bStop)
+      {
+        ret = INFO_CANCELLED;
+        break;
+      }
+
+      const EPISODE& info = episode->file;
+      switch (episode->status)
       {
+      case CEpisodeLookup::FULL_NFO:
+      case CEpisodeLookup::FOUND:
+        // an earlier file may have added the same episode
+        if (m_database.GetEpisodeId(info.strPath, info.iEpisode, info.iSeason) > -1)
+          break;
+
+        // each episode is an update of its own within the batch, a failing one
+        // only rolls back itself and keeps the ones added before it
+        m_database.BeginBatchTransaction();
+        m_database.BeginTransaction();
+        if (AddVideo(&episode->item, CONTENT_TVSHOWS, info.isFolder,
+                     episode->status == CEpisodeLookup::FULL_NFO || useLocal, &showInfo) < 0)
+        {
+          m_database.RollbackTransaction();
+          ret = INFO_ERROR;
+          break;
+        }
+        m_database.CommitTransaction();
+
+        if (++added % g_advancedSettings.m_videoScannerBatchSize == 0)
+          m_database.CommitBatchTransaction();
+        break;
+
+      case CEpisodeLookup::NO_EPISODE_GUIDE:
+        CLog::Log(LOGERROR, "VideoInfoScanner: Asked to lookup episode %s"
+                            " online, but we have no episode guide. Check your tvshow.nfo and make"
+                            " sure the <episodeguide> tag is in place.", CURL::GetRedacted(info.strPath).c_str());
+        break;
+
+      case CEpisodeLookup::NO_MATCH:
         CLog::Log(LOGDEBUG,"%s - no match for show: '%s', season: %d, episode: %d.%d, airdate: '%s', title: '%s'",
-                  __FUNCTION__, showInfo.m_strTitle.c_str(), file->iSeason, file->iEpisode, file->iSubepisode,
-                  file->cDate.GetAsLocalizedDate().c_str(), file->strTitle.c_str());
+                  __FUNCTION__, showInfo.m_strTitle.c_str(), info.iSeason, info.iEpisode, info.iSubepisode,
+                  info.cDate.GetAsLocalizedDate().c_str(), info.strTitle.c_str());
+        break;
+
+      case CEpisodeLookup::EPISODE_GUIDE_FAILED:
+      case CEpisodeLookup::DETAILS_FAILED:
+        ret = INFO_NOT_FOUND; //! @todo should we just skip to the next episode?
+        break;
+
+      default:
+        ret = INFO_CANCELLED;
+        break;
       }
     }
-    return INFO_ADDED;
+
+    // lookups that are still queued or running only touch their shared state
+    lookup->Cancel();
+    lookupQueue.CancelJobs();
+
+    m_database.CommitBatchTransaction();
+    return ret;
   }
 
   bool CVideoInfoScanner::GetDetails(CFileItem *pItem, CScraperUrl &url,
@@ -21,6 +21,7 @@
 #include "VideoThumbLoader.h"
 
 #include <cstdlib>
+#include <set>
 #include <utility>
 
 #include "cores/VideoPlayer/DVDFileInfo.h"
@@ -199,6 +200,8 @@ void CVideoThumbLoader::OnLoaderStart()
   m_videoDatabase->Open();
   m_showArt.clear();
   m_seasonArt.clear();
+  m_prefetchedArt.clear();
+  m_prefetchedStreamDetails.clear();
   CThumbLoader::OnLoaderStart();
 }
 
@@ -207,9 +210,103 @@ void CVideoThumbLoader::OnLoaderFinish()
   m_videoDatabase->Close();
   m_showArt.clear();
   m_seasonArt.clear();
+  m_prefetchedArt.clear();
+  m_prefetchedStreamDetails.clear();
   CThumbLoader::OnLoaderFinish();
 }
 
+void CVideoThumbLoader::PrefetchItems(const std::vector<CFileItemPtr>& items)
+{
+  m_prefetchedArt.clear();
+  m_prefetchedStreamDetails.clear();
+
+  // collect what LoadItemCached() would look up for each item, so every kind is fetched in one query
+  std::vector<int> fileIds;
+  std::map<std::string, std::vector<int> > artIds;
+  std::set<int> showIds;
+  std::set<int> seasonIds;
+  for (std::vector<CFileItemPtr>::const_iterator it = items.begin(); it != items.end(); ++it)
+  {
+    const CFileItem &item = **it;
+    if (item.m_bIsShareOrDrive || item.IsParentFolder() || !item.HasVideoInfoTag())
+      continue;
+
+    const CVideoInfoTag &tag = *item.GetVideoInfoTag();
+    if (!tag.HasStreamDetails() && tag.m_iFileId >= 0)
+      fileIds.push_back(tag.m_iFileId);
+
+    if (item.HasArt("thumb") || tag.m_iDbId <= -1 || tag.m_type.empty())
+      continue;
+
+    artIds[tag.m_type].push_back(tag.m_iDbId);
+    if (tag.m_type == MediaTypeEpisode || tag.m_type == MediaTypeSeason)
+    {
+      if (tag.m_iIdShow >= 0 && m_showArt.find(tag.m_iIdShow) == m_showArt.end())
+        showIds.insert(tag.m_iIdShow);
+      if (tag.m_iSeason > -1 && m_seasonArt.find(tag.m_iIdSeason) == m_seasonArt.end())
+        seasonIds.insert(tag.m_iIdSeason);
+    }
+  }
+
+  if (fileIds.empty() && artIds.empty())
+    return;
+
+  m_videoDatabase->Open();
+
+  if (!m_videoDatabase->GetStreamDetails(fileIds, m_prefetchedStreamDetails))
+    m_prefetchedStreamDetails.clear();
+
+  for (std::map<std::string, std::vector<int> >::const_iterator it = artIds.begin(); it != artIds.end(); ++it)
+  {
+    if (!m_videoDatabase->GetArtForItems(it->second, it->first, m_prefetchedArt[it->first]))
+      m_prefetchedArt.erase(it->first);
+  }
+
+  // the show and season art is kept for the whole list
+  ArtCache art;
+  if (m_videoDatabase->GetArtForItems(std::vector<int>(showIds.begin(), showIds.end()), MediaTypeTvShow, art))
+    m_showArt.insert(art.begin(), art.end());
+  art.clear();
+  if (m_videoDatabase->GetArtForItems(std::vector<int>(seasonIds.begin(), seasonIds.end()), MediaTypeSeason, art))
+    m_seasonArt.insert(art.begin(), art.end());
+
+  m_videoDatabase->Close();
+}
+
+bool CVideoThumbLoader::GetLibraryArt(int dbId, const std::string &type, std::map<std::string, std::string> &artwork)
+{
+  std::map<std::string, ArtCache>::const_iterator prefetched = m_prefetchedArt.find(type);
+  if (prefetched != m_prefetchedArt.end())
+  {
+    ArtCache::const_iterator i = prefetched->second.find(dbId);
+    if (i != prefetched->second.end())
+    {
+      artwork = i->second;
+      return !artwork.empty();
+    }
+  }
+
+  return m_videoDatabase->GetArtForItem(dbId, type, artwork);
+}
+
+bool CVideoThumbLoader::GetStreamDetails(CFileItem &item)
+{
+  if (item.HasVideoInfoTag())
+  {
+    CVideoInfoTag &tag = *item.GetVideoInfoTag();
+    std::map<int, CStreamDetails>::const_iterator i = m_prefetchedStreamDetails.find(tag.m_iFileId);
+    if (i != m_prefetchedStreamDetails.end())
+    {
+      tag.m_streamDetails = i->second;
+      if (tag.m_streamDetails.GetVideoDuration() > 0)
+        tag.SetDuration(tag.m_streamDetails.GetVideoDuration());
+      return tag.m_streamDetails.HasItems();
+    }
+  }
+
+  return m_videoDatabase->GetStreamDetails(item);
+}
+
 static void SetupRarOptions(CFileItem& item, const std::string& path)
 {
   std::string path2(path);
@@ -284,7 +381,7 @@ bool CVideoThumbLoader::LoadItemCached(CFileItem* pItem)
     if ((pItem->HasVideoInfoTag() && pItem->GetVideoInfoTag()->m_iFileId >= 0) // file (or maybe folder) is in the database
     || (!pItem->m_bIsFolder && pItem->IsVideo())) // Some other video file for which we haven't yet got any database details
     {
-      if (m_videoDatabase->GetStreamDetails(*pItem))
+      if (GetStreamDetails(*pItem))
         pItem->SetInvalid();
     }
   }
@@ -459,7 +556,7 @@ bool CVideoThumbLoader::FillLibraryArt(CFileItem &item)
   {
     std::map<std::string, std::string> artwork;
     m_videoDatabase->Open();
-    if (m_videoDatabase->GetArtForItem(tag.m_iDbId, tag.m_type, artwork))
+    if (GetLibraryArt(tag.m_iDbId, tag.m_type, artwork))
       SetArt(item, artwork);
     else if (tag.m_type == "actor" && !tag.m_artist.empty())
     { // we retrieve music video art from the music database (no backward compat)
@@ -24,8 +24,8 @@
 #include "ThumbLoader.h"
 #include "utils/JobManager.h"
 #include "FileItem.h"
+#include "utils/StreamDetails.h"
 
-class CStreamDetails;
 class CVideoDatabase;
 class EmbeddedArt;
 
@@ -132,10 +132,28 @@ public:
                                EmbeddedArt& art);
 
 protected:
+  void PrefetchItems(const std::vector<CFileItemPtr>& items) override;
+
+  /*! \brief Get the library art of an item, from the prefetched art if available
+   \param dbId the id of the item in the database
+   \param type the media type of the item
+   \param artwork [out] the artwork map of the item
+   \return true if the item has art, false otherwise
+   */
+  bool GetLibraryArt(int dbId, const std::string &type, std::map<std::string, std::string> &artwork);
+
+  /*! \brief Get the stream details of an item, from the prefetched stream details if available
+   \param item the item to fill the stream details for
+   \return true if the item has stream details, false otherwise
+   */
+  bool GetStreamDetails(CFileItem &item);
+
   CVideoDatabase *m_videoDatabase;
   typedef std::map<int, std::map<std::string, std::string> > ArtCache;
   ArtCache m_showArt;
   ArtCache m_seasonArt;
+  std::map<std::string, ArtCache> m_prefetchedArt; ///< art of the current page by media type
+  std::map<int, CStreamDetails> m_prefetchedStreamDetails; ///< stream details of the current page by file id
 
   /*! \brief Tries to detect missing data/info from a file and adds those
    \param item The CFileItem to process
@@ -0,0 +1,204 @@
+/*
+ *      Copyright (C) 2018 Team Kodi
+ *      http://kodi.tv
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "test/TestDatabase.h"
+#include "utils/StreamDetails.h"
+#include "video/VideoDatabase.h"
+#include "video/VideoInfoTag.h"
+#include "video/VideoThumbLoader.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+  /* a video database that stays connected to a test file, rather than opening the profile's database */
+  class CTestVideoDatabase : public CVideoDatabase
+  {
+  public:
+    bool Open() override
+    {
+      return IsOpen() && CVideoDatabase::Open();
+    }
+  };
+
+  /* a thumb loader reading from a test database, with the prefetching exposed */
+  class CTestVideoThumbLoader : public CVideoThumbLoader
+  {
+  public:
+    explicit CTestVideoThumbLoader(CVideoDatabase *db)
+    {
+      delete m_videoDatabase;
+      m_videoDatabase = db;
+    }
+
+    using CVideoThumbLoader::PrefetchItems;
+    using CVideoThumbLoader::GetLibraryArt;
+    using CVideoThumbLoader::GetStreamDetails;
+    using CVideoThumbLoader::m_showArt;
+    using CVideoThumbLoader::m_seasonArt;
+  };
+
+  CFileItemPtr LibraryItem(const std::string &type, int dbId, int fileId)
+  {
+    CFileItemPtr item(new CFileItem(type));
+    CVideoInfoTag *tag = item->GetVideoInfoTag();
+    tag->m_type = type;
+    tag->m_iDbId = dbId;
+    tag->m_iFileId = fileId;
+    return item;
+  }
+
+  CStreamDetails VideoStream(const std::string &codec, int duration)
+  {
+    CStreamDetails details;
+    CStreamDetailVideo *video = new CStreamDetailVideo();
+    video->m_strCodec = codec;
+    video->m_iWidth = 1920;
+    video->m_iHeight = 1080;
+    video->m_iDuration = duration;
+    details.AddStream(video);
+    return details;
+  }
+}
+
+class TestVideoThumbLoader : public testing::Test
+{
+protected:
+  TestVideoThumbLoader()
+    : m_db(new CTestVideoDatabase), m_loader(m_db), m_file(*m_db, "TestVideoThumbLoader")
+  {
+    /* movies 1 and 2 have art, movie 3 has none, episode 4 is in season 7 of show 5 */
+    if (m_file.IsConnected())
+    {
+      m_db->SetArtForItem(1, MediaTypeMovie, "thumb", "movie1.jpg");
+      m_db->SetArtForItem(1, MediaTypeMovie, "fanart", "movie1-fanart.jpg");
+      m_db->SetArtForItem(2, MediaTypeMovie, "thumb", "movie2.jpg");
+      m_db->SetArtForItem(4, MediaTypeEpisode, "thumb", "episode4.jpg");
+      m_db->SetArtForItem(5, MediaTypeTvShow, "poster", "show5.jpg");
+      m_db->SetArtForItem(7, MediaTypeSeason, "poster", "season7.jpg");
+      m_db->SetStreamDetailsForFileId(VideoStream("h264", 5400), 10);
+    }
+
+    m_items.push_back(LibraryItem(MediaTypeMovie, 1, 10));
+    m_items.push_back(LibraryItem(MediaTypeMovie, 2, 11));
+    m_items.push_back(LibraryItem(MediaTypeMovie, 3, 12));
+    CFileItemPtr episode = LibraryItem(MediaTypeEpisode, 4, 13);
+    episode->GetVideoInfoTag()->m_iIdShow = 5;
+    episode->GetVideoInfoTag()->m_iSeason = 1;
+    episode->GetVideoInfoTag()->m_iIdSeason = 7;
+    m_items.push_back(episode);
+  }
+
+  CTestVideoDatabase *m_db; ///< owned by the loader
+  CTestVideoThumbLoader m_loader;
+  CTestDatabase m_file;
+  std::vector<CFileItemPtr> m_items;
+};
+
+TEST_F(TestVideoThumbLoader, Prefetch)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  m_loader.PrefetchItems(m_items);
+
+  // the lookups are answered from what was prefetched, not from the database
+  ASSERT_TRUE(m_db->ExecuteQuery("DELETE FROM art"));
+  ASSERT_TRUE(m_db->ExecuteQuery("DELETE FROM streamdetails"));
+
+  std::map<std::string, std::string> art;
+  EXPECT_TRUE(m_loader.GetLibraryArt(1, MediaTypeMovie, art));
+  EXPECT_EQ(2u, art.size());
+  EXPECT_EQ("movie1.jpg", art["thumb"]);
+  EXPECT_EQ("movie1-fanart.jpg", art["fanart"]);
+  art.clear();
+  EXPECT_TRUE(m_loader.GetLibraryArt(2, MediaTypeMovie, art));
+  EXPECT_EQ("movie2.jpg", art["thumb"]);
+  art.clear();
+  EXPECT_FALSE(m_loader.GetLibraryArt(3, MediaTypeMovie, art));
+  EXPECT_TRUE(art.empty());
+  EXPECT_TRUE(m_loader.GetLibraryArt(4, MediaTypeEpisode, art));
+
+  EXPECT_TRUE(m_loader.GetStreamDetails(*m_items[0]));
+  EXPECT_EQ("h264", m_items[0]->GetVideoInfoTag()->m_streamDetails.GetVideoCodec());
+  EXPECT_EQ(5400u, m_items[0]->GetVideoInfoTag()->GetDuration());
+  EXPECT_FALSE(m_loader.GetStreamDetails(*m_items[1]));
+
+  // the show and season art of the episode is cached for the list
+  EXPECT_EQ("show5.jpg", m_loader.m_showArt[5]["poster"]);
+  EXPECT_EQ("season7.jpg", m_loader.m_seasonArt[7]["poster"]);
+}
+
+TEST_F(TestVideoThumbLoader, NotPrefetched)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  // items of another page are read from the database on their own
+  m_loader.PrefetchItems(std::vector<CFileItemPtr>(m_items.begin(), m_items.begin() + 1));
+  m_db->SetArtForItem(9, MediaTypeMovie, "thumb", "movie9.jpg");
+  m_db->SetStreamDetailsForFileId(VideoStream("hevc", 600), 11);
+
+  std::map<std::string, std::string> art;
+  EXPECT_TRUE(m_loader.GetLibraryArt(9, MediaTypeMovie, art));
+  EXPECT_EQ("movie9.jpg", art["thumb"]);
+  EXPECT_TRUE(m_loader.GetStreamDetails(*m_items[1]));
+  EXPECT_EQ("hevc", m_items[1]->GetVideoInfoTag()->m_streamDetails.GetVideoCodec());
+
+  // the next page replaces the previous one
+  m_loader.PrefetchItems(std::vector<CFileItemPtr>(m_items.begin() + 1, m_items.end()));
+  ASSERT_TRUE(m_db->ExecuteQuery("DELETE FROM art WHERE media_id = 1"));
+  art.clear();
+  EXPECT_FALSE(m_loader.GetLibraryArt(1, MediaTypeMovie, art));
+}
+
+TEST_F(TestVideoThumbLoader, FailedPrefetch)
+{
+  ASSERT_TRUE(m_file.IsConnected());
+
+  // a page that could not be prefetched is not taken for a page without art or stream details
+  ASSERT_TRUE(m_db->ExecuteQuery("ALTER TABLE art RENAME TO art_hidden"));
+  ASSERT_TRUE(m_db->ExecuteQuery("ALTER TABLE streamdetails RENAME TO streamdetails_hidden"));
+  m_loader.PrefetchItems(m_items);
+  ASSERT_TRUE(m_db->ExecuteQuery("ALTER TABLE art_hidden RENAME TO art"));
+  ASSERT_TRUE(m_db->ExecuteQuery("ALTER TABLE streamdetails_hidden RENAME TO streamdetails"));
+
+  std::map<std::string, std::string> art;
+  EXPECT_TRUE(m_loader.GetLibraryArt(1, MediaTypeMovie, art));
+  EXPECT_EQ("movie1.jpg", art["thumb"]);
+  EXPECT_TRUE(m_loader.GetStreamDetails(*m_items[0]));
+  EXPECT_EQ("h264", m_items[0]->GetVideoInfoTag()->m_streamDetails.GetVideoCodec());
+  EXPECT_TRUE(m_loader.m_showArt.empty());
+}
+
+TEST(TestVideoThumbLoaderNoDatabase, Prefetch)
+{
+  // without a database the items are left without art or stream details
+  CTestVideoThumbLoader loader(new CTestVideoDatabase);
+  CFileItemPtr item = LibraryItem(MediaTypeMovie, 1, 10);
+  loader.PrefetchItems(std::vector<CFileItemPtr>(1, item));
+
+  std::map<std::string, std::string> art;
+  EXPECT_FALSE(loader.GetLibraryArt(1, MediaTypeMovie, art));
+  EXPECT_FALSE(loader.GetStreamDetails(*item));
+}